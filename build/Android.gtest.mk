@@ -24,6 +24,8 @@ include art/build/Android.common_path.mk
 GTEST_DEX_DIRECTORIES := \
   AbstractMethod \
   AllFields \
+  BootExtension \
+  BootExtensionUser \
   ExceptionHandle \
   GetMethodSignature \
   Instrumentation \
@@ -63,7 +65,10 @@ $(ART_TEST_TARGET_GTEST_MainStripped_DEX): $(ART_TEST_TARGET_GTEST_Main_DEX)
 
 # Dex file dependencies for each gtest.
 ART_GTEST_class_linker_test_DEX_DEPS := Interfaces MultiDex MyClass Nested Statics StaticsFromCode
+ART_GTEST_class_lookup_table_test_DEX_DEPS := Nested
+ART_GTEST_compilation_cache_test_DEX_DEPS := MultiDex MultiDexModifiedSecondary Statics
 ART_GTEST_compiler_driver_test_DEX_DEPS := AbstractMethod StaticLeafMethods
+ART_GTEST_dex2oat_test_DEX_DEPS := BootExtension BootExtensionUser
 ART_GTEST_dex_file_test_DEX_DEPS := GetMethodSignature Main Nested
 ART_GTEST_exception_test_DEX_DEPS := ExceptionHandle
 ART_GTEST_instrumentation_test_DEX_DEPS := Instrumentation
@@ -72,10 +77,22 @@ ART_GTEST_jni_internal_test_DEX_DEPS := AllFields StaticLeafMethods
 ART_GTEST_oat_file_assistant_test_DEX_DEPS := Main MainStripped MultiDex MultiDexModifiedSecondary Nested
 ART_GTEST_oat_file_test_DEX_DEPS := Main MultiDex
 ART_GTEST_object_test_DEX_DEPS := ProtoCompare ProtoCompare2 StaticsFromCode XandY
+ART_GTEST_previous_compilation_test_DEX_DEPS := MultiDex MultiDexModifiedSecondary
 ART_GTEST_proxy_test_DEX_DEPS := Interfaces
 ART_GTEST_reflection_test_DEX_DEPS := Main NonStaticLeafMethods StaticLeafMethods
 ART_GTEST_stub_test_DEX_DEPS := AllFields
 ART_GTEST_transaction_test_DEX_DEPS := Transaction
+ART_GTEST_verifier_deps_test_DEX_DEPS := Nested XandY
+
+# The dex2oat test compiles against core.oat and builds a boot image from core-libart.
+ART_GTEST_dex2oat_test_HOST_DEPS := \
+  $(HOST_CORE_IMAGE_default_no-pic_64) \
+  $(HOST_CORE_IMAGE_default_no-pic_32) \
+  $(HOST_OUT_EXECUTABLES)/dex2oatd
+ART_GTEST_dex2oat_test_TARGET_DEPS := \
+  $(TARGET_CORE_IMAGE_default_no-pic_64) \
+  $(TARGET_CORE_IMAGE_default_no-pic_32) \
+  dex2oatd
 
 # The elf writer test has dependencies on core.oat.
 ART_GTEST_elf_writer_test_HOST_DEPS := $(HOST_CORE_IMAGE_default_no-pic_64) $(HOST_CORE_IMAGE_default_no-pic_32)
@@ -120,6 +137,7 @@ LOCAL_PATH := art
 
 RUNTIME_GTEST_COMMON_SRC_FILES := \
   cmdline/cmdline_parser_test.cc \
+  dex2oat/dex2oat_test.cc \
   imgdiag/imgdiag_test.cc \
   oatdump/oatdump_test.cc \
   runtime/arch/arch_test.cc \
@@ -148,6 +166,8 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/base/variant_map_test.cc \
   runtime/base/unix_file/fd_file_test.cc \
   runtime/class_linker_test.cc \
+  runtime/class_lookup_table_test.cc \
+  runtime/compressed_section_test.cc \
   runtime/dex_file_test.cc \
   runtime/dex_file_verifier_test.cc \
   runtime/dex_instruction_visitor_test.cc \
@@ -167,7 +187,9 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/gc/space/rosalloc_space_base_test.cc \
   runtime/gc/space/rosalloc_space_static_test.cc \
   runtime/gc/space/rosalloc_space_random_test.cc \
+  runtime/gc/space/rosalloc_space_compaction_test.cc \
   runtime/gc/space/large_object_space_test.cc \
+  runtime/gc/space/region_space_test.cc \
   runtime/gc/task_processor_test.cc \
   runtime/gtest_test.cc \
   runtime/handle_scope_test.cc \
@@ -197,6 +219,7 @@ RUNTIME_GTEST_COMMON_SRC_FILES := \
   runtime/utils_test.cc \
   runtime/verifier/method_verifier_test.cc \
   runtime/verifier/reg_type_test.cc \
+  runtime/verifier/verifier_deps_test.cc \
   runtime/zip_archive_test.cc
 
 COMPILER_GTEST_COMMON_SRC_FILES := \
@@ -211,7 +234,9 @@ COMPILER_GTEST_COMMON_SRC_FILES := \
   compiler/dex/quick/quick_cfi_test.cc \
   compiler/dex/type_inference_test.cc \
   compiler/dwarf/dwarf_test.cc \
+  compiler/driver/compilation_cache_test.cc \
   compiler/driver/compiler_driver_test.cc \
+  compiler/driver/previous_compilation_test.cc \
   compiler/elf_writer_test.cc \
   compiler/image_test.cc \
   compiler/jni/jni_cfi_test.cc \
@@ -615,7 +640,12 @@ ART_TEST_TARGET_GTEST$(2ND_ART_PHONY_TEST_TARGET_SUFFIX)_RULES :=
 ART_TEST_TARGET_GTEST_RULES :=
 ART_GTEST_TARGET_ANDROID_ROOT :=
 ART_GTEST_class_linker_test_DEX_DEPS :=
+ART_GTEST_class_lookup_table_test_DEX_DEPS :=
+ART_GTEST_compilation_cache_test_DEX_DEPS :=
 ART_GTEST_compiler_driver_test_DEX_DEPS :=
+ART_GTEST_dex2oat_test_DEX_DEPS :=
+ART_GTEST_dex2oat_test_HOST_DEPS :=
+ART_GTEST_dex2oat_test_TARGET_DEPS :=
 ART_GTEST_dex_file_test_DEX_DEPS :=
 ART_GTEST_exception_test_DEX_DEPS :=
 ART_GTEST_elf_writer_test_HOST_DEPS :=
@@ -626,10 +656,12 @@ ART_GTEST_oat_file_assistant_test_DEX_DEPS :=
 ART_GTEST_oat_file_assistant_test_HOST_DEPS :=
 ART_GTEST_oat_file_assistant_test_TARGET_DEPS :=
 ART_GTEST_object_test_DEX_DEPS :=
+ART_GTEST_previous_compilation_test_DEX_DEPS :=
 ART_GTEST_proxy_test_DEX_DEPS :=
 ART_GTEST_reflection_test_DEX_DEPS :=
 ART_GTEST_stub_test_DEX_DEPS :=
 ART_GTEST_transaction_test_DEX_DEPS :=
+ART_GTEST_verifier_deps_test_DEX_DEPS :=
 ART_VALGRIND_DEPENDENCIES :=
 $(foreach dir,$(GTEST_DEX_DIRECTORIES), $(eval ART_TEST_TARGET_GTEST_$(dir)_DEX :=))
 $(foreach dir,$(GTEST_DEX_DIRECTORIES), $(eval ART_TEST_HOST_GTEST_$(dir)_DEX :=))
@@ -68,6 +68,7 @@ static constexpr bool kIntrinsicIsStatic[] = {
     false,  // kIntrinsicUnsafeGet
     false,  // kIntrinsicUnsafePut
     true,   // kIntrinsicSystemArrayCopyCharArray
+    false,  // kIntrinsicCRC32Update
 };
 static_assert(arraysize(kIntrinsicIsStatic) == kInlineOpNop,
               "arraysize of kIntrinsicIsStatic unexpected");
@@ -109,6 +110,7 @@ static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafeGet], "UnsafeGet_must_not_be_s
 static_assert(!kIntrinsicIsStatic[kIntrinsicUnsafePut], "UnsafePut must not be static");
 static_assert(kIntrinsicIsStatic[kIntrinsicSystemArrayCopyCharArray],
               "SystemArrayCopyCharArray must be static");
+static_assert(!kIntrinsicIsStatic[kIntrinsicCRC32Update], "CRC32Update must not be static");
 
 MIR* AllocReplacementMIR(MIRGraph* mir_graph, MIR* invoke) {
   MIR* insn = mir_graph->NewMIR();
@@ -169,6 +171,7 @@ const char* const DexFileMethodInliner::kClassCacheNames[] = {
     "Llibcore/io/Memory;",     // kClassCacheLibcoreIoMemory
     "Lsun/misc/Unsafe;",       // kClassCacheSunMiscUnsafe
     "Ljava/lang/System;",      // kClassCacheJavaLangSystem
+    "Ljava/util/zip/CRC32;",   // kClassCacheJavaUtilZipCRC32
 };
 
 const char* const DexFileMethodInliner::kNameCacheNames[] = {
@@ -225,6 +228,8 @@ const char* const DexFileMethodInliner::kNameCacheNames[] = {
     "putObjectVolatile",     // kNameCachePutObjectVolatile
     "putOrderedObject",      // kNameCachePutOrderedObject
     "arraycopy",             // kNameCacheArrayCopy
+    "updateImpl",            // kNameCacheUpdateImpl
+    "updateByteImpl",        // kNameCacheUpdateByteImpl
 };
 
 const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
@@ -351,6 +356,11 @@ const DexFileMethodInliner::ProtoDef DexFileMethodInliner::kProtoCacheDefs[] = {
     { kClassCacheVoid, 1, { kClassCacheJavaLangStringBuffer } },
     // kProtoCacheStringBuilder_V
     { kClassCacheVoid, 1, { kClassCacheJavaLangStringBuilder } },
+    // kProtoCacheBJ_J
+    { kClassCacheLong, 2, { kClassCacheByte, kClassCacheLong } },
+    // kProtoCacheByteArrayIIJ_J
+    { kClassCacheLong, 4, { kClassCacheJavaLangByteArray, kClassCacheInt, kClassCacheInt,
+        kClassCacheLong } },
 };
 
 const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods[] = {
@@ -455,6 +465,10 @@ const DexFileMethodInliner::IntrinsicDef DexFileMethodInliner::kIntrinsicMethods
     INTRINSIC(JavaLangSystem, ArrayCopy, CharArrayICharArrayII_V , kIntrinsicSystemArrayCopyCharArray,
               0),
 
+    INTRINSIC(JavaUtilZipCRC32, UpdateByteImpl, BJ_J, kIntrinsicCRC32Update, kIntrinsicFlagNone),
+    INTRINSIC(JavaUtilZipCRC32, UpdateImpl, ByteArrayIIJ_J, kIntrinsicCRC32Update,
+              kIntrinsicFlagIsByteArray),
+
 #undef INTRINSIC
 
 #define SPECIAL(c, n, p, o, d) \
@@ -614,6 +628,9 @@ bool DexFileMethodInliner::GenIntrinsic(Mir2Lir* backend, CallInfo* info) {
                                           intrinsic.d.data & kIntrinsicFlagIsOrdered);
     case kIntrinsicSystemArrayCopyCharArray:
       return backend->GenInlinedArrayCopyCharArray(info);
+    case kIntrinsicCRC32Update:
+      // Only the optimizing backends intrinsify CRC32; let Quick emit the regular call.
+      return false;
     default:
       LOG(FATAL) << "Unexpected intrinsic opcode: " << intrinsic.opcode;
       return false;  // avoid warning "control reaches end of non-void function"
@@ -143,6 +143,7 @@ class DexFileMethodInliner {
       kClassCacheLibcoreIoMemory,
       kClassCacheSunMiscUnsafe,
       kClassCacheJavaLangSystem,
+      kClassCacheJavaUtilZipCRC32,
       kClassCacheLast
     };
 
@@ -206,6 +207,8 @@ class DexFileMethodInliner {
       kNameCachePutObjectVolatile,
       kNameCachePutOrderedObject,
       kNameCacheArrayCopy,
+      kNameCacheUpdateImpl,
+      kNameCacheUpdateByteImpl,
       kNameCacheLast
     };
 
@@ -272,6 +275,8 @@ class DexFileMethodInliner {
       kProtoCacheString_V,
       kProtoCacheStringBuffer_V,
       kProtoCacheStringBuilder_V,
+      kProtoCacheBJ_J,
+      kProtoCacheByteArrayIIJ_J,
       kProtoCacheLast
     };
 
@@ -491,6 +491,11 @@ static bool CanCompileShorty(const char* shorty, InstructionSet instruction_set)
 // Skip the method that we do not support currently.
 bool QuickCompiler::CanCompileMethod(uint32_t method_idx, const DexFile& dex_file,
                                      CompilationUnit* cu) const {
+  // Quick does not emit read barriers.
+  if (kUseReadBarrier) {
+    return false;
+  }
+
   // This is a limitation in mir_graph. See MirGraph::SetNumSSARegs.
   if (cu->mir_graph->GetNumOfCodeAndTempVRs() > kMaxAllowedDalvikRegisters) {
     VLOG(compiler) << "Too many dalvik registers : " << cu->mir_graph->GetNumOfCodeAndTempVRs();
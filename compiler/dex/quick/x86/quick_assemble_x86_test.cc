@@ -45,6 +45,7 @@ class QuickAssembleX86TestBase : public testing::Test {
         CompilerOptions::kDefaultTopKProfileThreshold,
         false,
         CompilerOptions::kDefaultGenerateDebugInfo,
+        CompilerOptions::kDefaultGenerateMiniDebugInfo,
         false,
         false,
         false,
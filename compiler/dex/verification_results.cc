@@ -92,6 +92,13 @@ void VerificationResults::RemoveVerifiedMethod(MethodReference ref) {
   }
 }
 
+void VerificationResults::AddPreviouslyVerifiedMethod(MethodReference ref) {
+  WriterMutexLock mu(Thread::Current(), verified_methods_lock_);
+  if (verified_methods_.find(ref) == verified_methods_.end()) {
+    verified_methods_.Put(ref, VerifiedMethod::CreatePreviouslyVerified());
+  }
+}
+
 void VerificationResults::AddRejectedClass(ClassReference ref) {
   {
     WriterMutexLock mu(Thread::Current(), rejected_classes_lock_);
@@ -50,6 +50,10 @@ class VerificationResults {
         LOCKS_EXCLUDED(verified_methods_lock_);
     void RemoveVerifiedMethod(MethodReference ref) LOCKS_EXCLUDED(verified_methods_lock_);
 
+    // Records a method of a class that verified in a previous compilation, see
+    // VerifiedMethod::CreatePreviouslyVerified().
+    void AddPreviouslyVerifiedMethod(MethodReference ref) LOCKS_EXCLUDED(verified_methods_lock_);
+
     void AddRejectedClass(ClassReference ref) LOCKS_EXCLUDED(rejected_classes_lock_);
     bool IsClassRejected(ClassReference ref) LOCKS_EXCLUDED(rejected_classes_lock_);
 
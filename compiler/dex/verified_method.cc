@@ -71,6 +71,12 @@ const VerifiedMethod* VerifiedMethod::Create(verifier::MethodVerifier* method_ve
   return verified_method.release();
 }
 
+const VerifiedMethod* VerifiedMethod::CreatePreviouslyVerified() {
+  VerifiedMethod* verified_method = new VerifiedMethod;
+  verified_method->has_verification_failures_ = false;
+  return verified_method;
+}
+
 const MethodReference* VerifiedMethod::GetDevirtTarget(uint32_t dex_pc) const {
   auto it = devirt_map_.find(dex_pc);
   return (it != devirt_map_.end()) ? &it->second : nullptr;
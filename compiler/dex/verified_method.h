@@ -45,6 +45,9 @@ class VerifiedMethod {
 
   static const VerifiedMethod* Create(verifier::MethodVerifier* method_verifier, bool compile)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Create a VerifiedMethod without verifier output for a method whose class was not verified
+  // again because it verified without failures in a previous compilation.
+  static const VerifiedMethod* CreatePreviouslyVerified();
   ~VerifiedMethod() = default;
 
   const std::vector<uint8_t>& GetDexGcMap() const {
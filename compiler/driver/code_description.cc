@@ -0,0 +1,244 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "code_description.h"
+
+#include <algorithm>
+
+#include "base/stringprintf.h"
+#include "dex_file-inl.h"
+#include "dex_instruction-inl.h"
+#include "driver/compiler_options.h"
+#include "leb128.h"
+#include "oat.h"
+#include "utils.h"
+
+namespace art {
+
+// Quick inlines special methods, such as getters and setters, of at most two
+// instructions regardless of the inlining limits in the compiler options.
+static constexpr size_t kMaxSpecialMethodCodeUnits = 4u;
+
+// The oat header values that influence the generated code.
+static const char* const kCodeGenerationKeys[] = {
+    OatHeader::kPicKey,
+    OatHeader::kDebuggableKey,
+    OatHeader::kClassPathKey,
+    OatHeader::kInlineMaxCodeUnitsKey,
+};
+
+ArrayRef<const char* const> CodeGenerationKeys() {
+  return ArrayRef<const char* const>(kCodeGenerationKeys);
+}
+
+size_t MaxInlinedCodeUnits(const CompilerOptions& compiler_options) {
+  return std::max(compiler_options.GetInlineMaxCodeUnits(), kMaxSpecialMethodCodeUnits);
+}
+
+// Returns the end of the encoded array starting at `data`.
+static const uint8_t* SkipEncodedArray(const uint8_t* data);
+
+// Returns the end of the encoded value starting at `data`.
+static const uint8_t* SkipEncodedValue(const uint8_t* data) {
+  uint8_t header = *data++;
+  uint8_t value_type = header & 0x1f;
+  uint8_t value_arg = header >> 5;
+  switch (value_type) {
+    case EncodedStaticFieldValueIterator::kArray:
+      return SkipEncodedArray(data);
+    case EncodedStaticFieldValueIterator::kAnnotation: {
+      DecodeUnsignedLeb128(&data);  // Type index.
+      uint32_t size = DecodeUnsignedLeb128(&data);
+      for (uint32_t i = 0; i != size; ++i) {
+        DecodeUnsignedLeb128(&data);  // Name index.
+        data = SkipEncodedValue(data);
+      }
+      return data;
+    }
+    case EncodedStaticFieldValueIterator::kNull:
+    case EncodedStaticFieldValueIterator::kBoolean:
+      return data;
+    default:
+      return data + value_arg + 1u;
+  }
+}
+
+static const uint8_t* SkipEncodedArray(const uint8_t* data) {
+  uint32_t size = DecodeUnsignedLeb128(&data);
+  for (uint32_t i = 0; i != size; ++i) {
+    data = SkipEncodedValue(data);
+  }
+  return data;
+}
+
+void DescribeCodeItem(const DexFile& dex_file,
+                      const DexFile::CodeItem& code_item,
+                      std::string* out) {
+  StringAppendF(out, "registers=%u ins=%u outs=%u tries=%u\n",
+                code_item.registers_size_, code_item.ins_size_, code_item.outs_size_,
+                code_item.tries_size_);
+  const uint16_t* end = code_item.insns_ + code_item.insns_size_in_code_units_;
+  for (const Instruction* inst = Instruction::At(code_item.insns_);
+       reinterpret_cast<const uint16_t*>(inst) < end;
+       inst = inst->Next()) {
+    out->append(reinterpret_cast<const char*>(inst), inst->SizeInCodeUnits() * sizeof(uint16_t));
+    out->append(inst->DumpString(&dex_file));
+    out->push_back('\n');
+  }
+  for (uint32_t i = 0; i < code_item.tries_size_; ++i) {
+    const DexFile::TryItem* try_item = DexFile::GetTryItems(code_item, i);
+    StringAppendF(out, "try %u %u", try_item->start_addr_, try_item->insn_count_);
+    for (CatchHandlerIterator it(code_item, *try_item); it.HasNext(); it.Next()) {
+      uint16_t type_idx = it.GetHandlerTypeIndex();
+      StringAppendF(out, " %s@%u",
+                    (type_idx == DexFile::kDexNoIndex16) ? "<any>"
+                                                         : dex_file.StringByTypeIdx(type_idx),
+                    it.GetHandlerAddress());
+    }
+    out->push_back('\n');
+  }
+}
+
+void DescribeClassDeclaration(const DexFile& dex_file,
+                              const DexFile::ClassDef& class_def,
+                              size_t max_inlined_code_units,
+                              std::string* out) {
+  StringAppendF(out, "class %s %x", dex_file.GetClassDescriptor(class_def),
+                class_def.access_flags_);
+  if (class_def.superclass_idx_ != DexFile::kDexNoIndex16) {
+    StringAppendF(out, " extends %s", dex_file.StringByTypeIdx(class_def.superclass_idx_));
+  }
+  const DexFile::TypeList* interfaces = dex_file.GetInterfacesList(class_def);
+  if (interfaces != nullptr) {
+    for (size_t j = 0; j < interfaces->Size(); ++j) {
+      uint16_t type_idx = interfaces->GetTypeItem(j).type_idx_;
+      StringAppendF(out, " %s", dex_file.StringByTypeIdx(type_idx));
+    }
+  }
+  out->push_back('\n');
+  // The static values decide whether the class is trivially initialized, which compiled
+  // code relies on to omit class initialization checks.
+  const uint8_t* static_values = dex_file.GetEncodedStaticFieldValuesArray(class_def);
+  if (static_values != nullptr) {
+    out->append("static values ");
+    out->append(reinterpret_cast<const char*>(static_values),
+                SkipEncodedArray(static_values) - static_values);
+    out->push_back('\n');
+  }
+  const uint8_t* class_data = dex_file.GetClassData(class_def);
+  if (class_data == nullptr) {
+    return;
+  }
+  ClassDataItemIterator it(dex_file, class_data);
+  for (; it.HasNextStaticField(); it.Next()) {
+    StringAppendF(out, "static %s %x\n", PrettyField(it.GetMemberIndex(), dex_file).c_str(),
+                  it.GetFieldAccessFlags());
+  }
+  for (; it.HasNextInstanceField(); it.Next()) {
+    StringAppendF(out, "instance %s %x\n", PrettyField(it.GetMemberIndex(), dex_file).c_str(),
+                  it.GetFieldAccessFlags());
+  }
+  for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+    StringAppendF(out, "%s %s %x\n", it.HasNextDirectMethod() ? "direct" : "virtual",
+                  PrettyMethod(it.GetMemberIndex(), dex_file).c_str(),
+                  it.GetMethodAccessFlags());
+    const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+    if (code_item != nullptr &&
+        code_item->insns_size_in_code_units_ <= max_inlined_code_units) {
+      DescribeCodeItem(dex_file, *code_item, out);
+    }
+  }
+}
+
+void AddClassReference(const char* descriptor, std::set<std::string>* references) {
+  while (descriptor[0] == '[') {
+    ++descriptor;
+  }
+  if (descriptor[0] == 'L') {
+    references->insert(descriptor);
+  }
+}
+
+void CollectClassReferences(const DexFile& dex_file,
+                            const DexFile::CodeItem& code_item,
+                            std::set<std::string>* references) {
+  const uint16_t* end = code_item.insns_ + code_item.insns_size_in_code_units_;
+  for (const Instruction* inst = Instruction::At(code_item.insns_);
+       reinterpret_cast<const uint16_t*>(inst) < end;
+       inst = inst->Next()) {
+    int flags = Instruction::VerifyFlagsOf(inst->Opcode());
+    if ((flags & (Instruction::kVerifyRegBType | Instruction::kVerifyRegBNewInstance)) != 0) {
+      AddClassReference(dex_file.StringByTypeIdx(inst->VRegB()), references);
+    }
+    if ((flags & (Instruction::kVerifyRegCType | Instruction::kVerifyRegCNewArray)) != 0) {
+      AddClassReference(dex_file.StringByTypeIdx(inst->VRegC()), references);
+    }
+    if ((flags & Instruction::kVerifyRegBField) != 0) {
+      const DexFile::FieldId& field_id = dex_file.GetFieldId(inst->VRegB());
+      AddClassReference(dex_file.StringByTypeIdx(field_id.class_idx_), references);
+    }
+    if ((flags & Instruction::kVerifyRegCField) != 0) {
+      const DexFile::FieldId& field_id = dex_file.GetFieldId(inst->VRegC());
+      AddClassReference(dex_file.StringByTypeIdx(field_id.class_idx_), references);
+    }
+    if ((flags & Instruction::kVerifyRegBMethod) != 0) {
+      const DexFile::MethodId& method_id = dex_file.GetMethodId(inst->VRegB());
+      AddClassReference(dex_file.StringByTypeIdx(method_id.class_idx_), references);
+    }
+  }
+  for (uint32_t i = 0; i < code_item.tries_size_; ++i) {
+    const DexFile::TryItem* try_item = DexFile::GetTryItems(code_item, i);
+    for (CatchHandlerIterator it(code_item, *try_item); it.HasNext(); it.Next()) {
+      uint16_t type_idx = it.GetHandlerTypeIndex();
+      if (type_idx != DexFile::kDexNoIndex16) {
+        AddClassReference(dex_file.StringByTypeIdx(type_idx), references);
+      }
+    }
+  }
+}
+
+void CollectDeclarationReferences(const DexFile& dex_file,
+                                  const DexFile::ClassDef& class_def,
+                                  size_t max_inlined_code_units,
+                                  std::set<std::string>* references) {
+  if (class_def.superclass_idx_ != DexFile::kDexNoIndex16) {
+    AddClassReference(dex_file.StringByTypeIdx(class_def.superclass_idx_), references);
+  }
+  const DexFile::TypeList* interfaces = dex_file.GetInterfacesList(class_def);
+  if (interfaces != nullptr) {
+    for (size_t j = 0; j < interfaces->Size(); ++j) {
+      AddClassReference(dex_file.StringByTypeIdx(interfaces->GetTypeItem(j).type_idx_),
+                        references);
+    }
+  }
+  const uint8_t* class_data = dex_file.GetClassData(class_def);
+  if (class_data == nullptr) {
+    return;
+  }
+  ClassDataItemIterator it(dex_file, class_data);
+  while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+    it.Next();
+  }
+  for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+    const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+    if (code_item != nullptr &&
+        code_item->insns_size_in_code_units_ <= max_inlined_code_units) {
+      CollectClassReferences(dex_file, *code_item, references);
+    }
+  }
+}
+
+}  // namespace art
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_CODE_DESCRIPTION_H_
+#define ART_COMPILER_DRIVER_CODE_DESCRIPTION_H_
+
+#include <set>
+#include <string>
+
+#include "dex_file.h"
+#include "utils/array_ref.h"
+
+namespace art {
+
+class CompilerOptions;
+
+// Helpers describing what compiled code depends on as text, for reusing compiled code
+// across compilations. Two descriptions are equal only if the described entities are
+// the same as far as the generated code is concerned.
+
+// Returns the oat header keys whose values influence the generated code.
+ArrayRef<const char* const> CodeGenerationKeys();
+
+// Returns the maximum size of the methods that the compilers may inline.
+size_t MaxInlinedCodeUnits(const CompilerOptions& compiler_options);
+
+// Describe a code item as the compiled code sees it: the raw instructions, whose
+// indices are embedded in the generated code, and what these indices refer to.
+void DescribeCodeItem(const DexFile& dex_file,
+                      const DexFile::CodeItem& code_item,
+                      std::string* out);
+
+// Describe the declaration of a class and the bodies of its methods that may be inlined.
+void DescribeClassDeclaration(const DexFile& dex_file,
+                              const DexFile::ClassDef& class_def,
+                              size_t max_inlined_code_units,
+                              std::string* out);
+
+// Add the class that compiled code using `descriptor` depends on, if any, to `references`.
+// Arrays depend on their element class. Primitive types do not depend on anything.
+void AddClassReference(const char* descriptor, std::set<std::string>* references);
+
+// Collect the descriptors of the classes whose declarations the compiled code of
+// `code_item` may depend on: the classes it uses and those declaring the fields and
+// methods it uses.
+void CollectClassReferences(const DexFile& dex_file,
+                            const DexFile::CodeItem& code_item,
+                            std::set<std::string>* references);
+
+// Collect the descriptors of the classes that the declaration of a class and the bodies
+// of its methods that may be inlined use, see DescribeClassDeclaration().
+void CollectDeclarationReferences(const DexFile& dex_file,
+                                  const DexFile::ClassDef& class_def,
+                                  size_t max_inlined_code_units,
+                                  std::set<std::string>* references);
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_CODE_DESCRIPTION_H_
@@ -0,0 +1,515 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compilation_cache.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <set>
+
+#include "base/stringprintf.h"
+#include "base/unix_file/fd_file.h"
+#include "class_linker.h"
+#include "compiled_method.h"
+#include "dex_file-inl.h"
+#include "driver/code_description.h"
+#include "driver/compiler_driver.h"
+#include "driver/compiler_options.h"
+#include "gc/heap.h"
+#include "gc/space/image_space.h"
+#include "oat.h"
+#include "os.h"
+#include "runtime.h"
+#include "utf.h"
+#include "utils.h"
+
+namespace art {
+
+// Entries start with the magic, followed by the key and the compiled method.
+static constexpr uint8_t kEntryMagic[] = { 'c', 'c', 'e', '1' };
+
+// 64-bit FNV-1a hash.
+static uint64_t Hash64(const void* data, size_t size) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+  uint64_t hash = UINT64_C(0xcbf29ce484222325);
+  for (size_t i = 0; i != size; ++i) {
+    hash = (hash ^ bytes[i]) * UINT64_C(0x100000001b3);
+  }
+  return hash;
+}
+
+static uint64_t Hash64(const std::string& data) {
+  return Hash64(data.data(), data.size());
+}
+
+// Identify the code of the compiler itself by the file it was loaded from.
+static void DescribeCompilerBinary(std::string* out) {
+  Dl_info info;
+  struct stat st;
+  if (dladdr(reinterpret_cast<void*>(&CompilationCache::Create), &info) != 0 &&
+      info.dli_fname != nullptr &&
+      stat(info.dli_fname, &st) == 0) {
+    StringAppendF(out, "compiler %s %" PRId64 " %" PRId64 "\n", info.dli_fname,
+                  static_cast<int64_t>(st.st_size), static_cast<int64_t>(st.st_mtime));
+  } else {
+    out->append("compiler <unknown>\n");
+  }
+}
+
+class EntryWriter {
+ public:
+  explicit EntryWriter(std::vector<uint8_t>* data) : data_(data) {}
+
+  void WriteUint32(uint32_t value) {
+    WriteBytes(&value, sizeof(value));
+  }
+
+  void WriteBytes(const void* bytes, size_t size) {
+    const uint8_t* begin = reinterpret_cast<const uint8_t*>(bytes);
+    data_->insert(data_->end(), begin, begin + size);
+  }
+
+  template <typename Vector>
+  void WriteArray(const Vector* array) {
+    if (array == nullptr) {
+      WriteUint32(0u);
+    } else {
+      WriteUint32(array->size());
+      WriteBytes(array->data(), array->size());
+    }
+  }
+
+ private:
+  std::vector<uint8_t>* const data_;
+};
+
+class EntryReader {
+ public:
+  EntryReader(const uint8_t* begin, const uint8_t* end) : ptr_(begin), end_(end) {}
+
+  bool ReadUint32(uint32_t* value) {
+    return ReadBytes(value, sizeof(*value));
+  }
+
+  bool ReadBytes(void* bytes, size_t size) {
+    if (static_cast<size_t>(end_ - ptr_) < size) {
+      return false;
+    }
+    memcpy(bytes, ptr_, size);
+    ptr_ += size;
+    return true;
+  }
+
+  bool ReadArray(ArrayRef<const uint8_t>* array) {
+    uint32_t size;
+    if (!ReadUint32(&size) || static_cast<size_t>(end_ - ptr_) < size) {
+      return false;
+    }
+    *array = ArrayRef<const uint8_t>(ptr_, size);
+    ptr_ += size;
+    return true;
+  }
+
+  bool AtEnd() const {
+    return ptr_ == end_;
+  }
+
+ private:
+  const uint8_t* ptr_;
+  const uint8_t* const end_;
+};
+
+CompilationCache* CompilationCache::Create(
+    const std::string& directory,
+    const std::vector<const DexFile*>& dex_files,
+    const CompilerDriver& driver,
+    const SafeMap<std::string, std::string>& key_value_store,
+    std::string* error_msg) {
+  if (driver.IsImage()) {
+    *error_msg = "Compiled code for the boot image cannot be cached";
+    return nullptr;
+  }
+  if (mkdir(directory.c_str(), 0700) != 0 && errno != EEXIST) {
+    *error_msg = StringPrintf("Failed to create %s: %s", directory.c_str(), strerror(errno));
+    return nullptr;
+  }
+  if (!OS::DirectoryExists(directory.c_str())) {
+    *error_msg = StringPrintf("%s is not a directory", directory.c_str());
+    return nullptr;
+  }
+
+  const CompilerOptions& compiler_options = driver.GetCompilerOptions();
+  std::string fingerprint;
+  DescribeCompilerBinary(&fingerprint);
+  StringAppendF(&fingerprint, "oat %s\n", reinterpret_cast<const char*>(OatHeader::kOatVersion));
+  StringAppendF(&fingerprint, "isa %s %s\n", GetInstructionSetString(driver.GetInstructionSet()),
+                driver.GetInstructionSetFeatures()->GetFeatureString().c_str());
+  StringAppendF(&fingerprint, "compiler %d filter %d\n", driver.GetCompilerKind(),
+                compiler_options.GetCompilerFilter());
+  StringAppendF(&fingerprint, "inline depth %zu\n", compiler_options.GetInlineDepthLimit());
+  StringAppendF(&fingerprint, "implicit checks %d %d %d\n",
+                compiler_options.GetImplicitNullChecks(),
+                compiler_options.GetImplicitStackOverflowChecks(),
+                compiler_options.GetImplicitSuspendChecks());
+  StringAppendF(&fingerprint, "debug info %d %d patch info %d\n",
+                compiler_options.GetGenerateDebugInfo(),
+                compiler_options.GetGenerateMiniDebugInfo(),
+                compiler_options.GetIncludePatchInformation());
+  for (const char* key : CodeGenerationKeys()) {
+    auto it = key_value_store.find(key);
+    StringAppendF(&fingerprint, "%s=%s\n", key,
+                  (it != key_value_store.end()) ? it->second.c_str() : "<none>");
+  }
+  Runtime* runtime = Runtime::Current();
+  gc::space::ImageSpace* image_space = runtime->GetHeap()->GetImageSpace();
+  if (image_space != nullptr) {
+    const ImageHeader& image_header = image_space->GetImageHeader();
+    StringAppendF(&fingerprint, "boot image %x %p %d\n", image_header.GetOatChecksum(),
+                  image_header.GetOatDataBegin(), image_header.GetPatchDelta());
+  }
+  for (const DexFile* dex_file : runtime->GetClassLinker()->GetBootClassPath()) {
+    StringAppendF(&fingerprint, "boot class path %s %x\n", dex_file->GetLocation().c_str(),
+                  dex_file->GetLocationChecksum());
+  }
+
+  std::unique_ptr<CompilationCache> cache(
+      new CompilationCache(directory,
+                           Hash64(fingerprint),
+                           MaxInlinedCodeUnits(compiler_options)));
+  cache->InitClasses(dex_files);
+  return cache.release();
+}
+
+CompilationCache::CompilationCache(const std::string& directory,
+                                   uint64_t fingerprint,
+                                   size_t max_inlined_code_units)
+    : directory_(directory),
+      fingerprint_(fingerprint),
+      max_inlined_code_units_(max_inlined_code_units),
+      num_hits_(0u),
+      num_misses_(0u),
+      num_stores_(0u) {
+}
+
+CompilationCache::~CompilationCache() {
+}
+
+void CompilationCache::InitClasses(const std::vector<const DexFile*>& dex_files) {
+  const std::vector<const DexFile*>& boot_class_path =
+      Runtime::Current()->GetClassLinker()->GetBootClassPath();
+  for (const DexFile* dex_file : dex_files) {
+    for (size_t i = 0; i < dex_file->NumClassDefs(); ++i) {
+      const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
+      const char* descriptor = dex_file->GetClassDescriptor(class_def);
+      if (classes_.find(descriptor) != classes_.end()) {
+        continue;  // Only the first definition is used.
+      }
+      size_t hash = ComputeModifiedUtf8Hash(descriptor);
+      bool in_boot_class_path = false;
+      for (const DexFile* boot_dex_file : boot_class_path) {
+        if (boot_dex_file->FindClassDef(descriptor, hash) != nullptr) {
+          in_boot_class_path = true;
+          break;
+        }
+      }
+      if (in_boot_class_path) {
+        continue;  // Boot classes resolve to the boot class path, part of the fingerprint.
+      }
+
+      std::string declaration;
+      DescribeClassDeclaration(*dex_file, class_def, max_inlined_code_units_, &declaration);
+      std::set<std::string> references;
+      CollectDeclarationReferences(*dex_file, class_def, max_inlined_code_units_, &references);
+      ClassInfo& info = classes_[descriptor];
+      info.hash = Hash64(declaration);
+      info.references.assign(references.begin(), references.end());
+    }
+  }
+}
+
+void CompilationCache::GetKey(const DexFile& dex_file,
+                              uint32_t method_idx,
+                              uint32_t access_flags,
+                              InvokeType invoke_type,
+                              const DexFile::CodeItem& code_item,
+                              std::string* key) const {
+  key->clear();
+  StringAppendF(key, "fingerprint %016" PRIx64 "\n", fingerprint_);
+  StringAppendF(key, "ids %zu %u %zu %zu %zu\n", dex_file.NumStringIds(), dex_file.NumTypeIds(),
+                dex_file.NumProtoIds(), dex_file.NumFieldIds(), dex_file.NumMethodIds());
+  StringAppendF(key, "method %u %s %x %d\n", method_idx,
+                PrettyMethod(method_idx, dex_file).c_str(), access_flags, invoke_type);
+  DescribeCodeItem(dex_file, code_item, key);
+
+  // Add the classes the method depends on, directly or through the classes they depend on.
+  std::set<std::string> dependencies;
+  std::vector<std::string> worklist;
+  {
+    std::set<std::string> references;
+    AddClassReference(dex_file.StringByTypeIdx(dex_file.GetMethodId(method_idx).class_idx_),
+                      &references);
+    CollectClassReferences(dex_file, code_item, &references);
+    worklist.assign(references.begin(), references.end());
+  }
+  while (!worklist.empty()) {
+    std::string descriptor = std::move(worklist.back());
+    worklist.pop_back();
+    auto it = classes_.find(descriptor);
+    if (dependencies.insert(std::move(descriptor)).second && it != classes_.end()) {
+      for (const std::string& reference : it->second.references) {
+        if (dependencies.find(reference) == dependencies.end()) {
+          worklist.push_back(reference);
+        }
+      }
+    }
+  }
+  for (const std::string& descriptor : dependencies) {
+    auto it = classes_.find(descriptor);
+    if (it != classes_.end()) {
+      StringAppendF(key, "%s %016" PRIx64 "\n", descriptor.c_str(), it->second.hash);
+    } else {
+      // Either a boot class, covered by the fingerprint, or unresolved.
+      StringAppendF(key, "%s external\n", descriptor.c_str());
+    }
+  }
+}
+
+std::string CompilationCache::GetEntryPath(const std::string& key) const {
+  return StringPrintf("%s/%016" PRIx64 ".cce", directory_.c_str(), Hash64(key));
+}
+
+CompiledMethod* CompilationCache::Load(CompilerDriver* driver,
+                                       const DexFile& dex_file,
+                                       const std::string& key) const {
+  std::string path = GetEntryPath(key);
+  std::vector<uint8_t> data;
+  {
+    std::unique_ptr<File> file(OS::OpenFileForReading(path.c_str()));
+    if (file == nullptr) {
+      num_misses_.FetchAndAddSequentiallyConsistent(1u);
+      return nullptr;
+    }
+    int64_t length = file->GetLength();
+    if (length > 0) {
+      data.resize(length);
+      if (!file->ReadFully(data.data(), data.size())) {
+        data.clear();
+      }
+    }
+    if (file->Close() != 0) {
+      PLOG(WARNING) << "Failed to close compilation cache entry " << path;
+    }
+  }
+
+  // Check the entry, ignoring it if it is malformed or if its key differs.
+  EntryReader reader(data.data(), data.data() + data.size());
+  uint8_t magic[sizeof(kEntryMagic)];
+  ArrayRef<const uint8_t> entry_key;
+  uint32_t instruction_set;
+  uint32_t frame_size_in_bytes;
+  uint32_t core_spill_mask;
+  uint32_t fp_spill_mask;
+  ArrayRef<const uint8_t> code;
+  ArrayRef<const uint8_t> mapping_table;
+  ArrayRef<const uint8_t> vmap_table;
+  ArrayRef<const uint8_t> gc_map;
+  ArrayRef<const uint8_t> cfi_info;
+  uint32_t num_src_map_elems;
+  bool valid =
+      reader.ReadBytes(magic, sizeof(magic)) &&
+      memcmp(magic, kEntryMagic, sizeof(kEntryMagic)) == 0 &&
+      reader.ReadArray(&entry_key) &&
+      entry_key.size() == key.size() &&
+      memcmp(entry_key.data(), key.data(), key.size()) == 0 &&
+      reader.ReadUint32(&instruction_set) &&
+      reader.ReadUint32(&frame_size_in_bytes) &&
+      reader.ReadUint32(&core_spill_mask) &&
+      reader.ReadUint32(&fp_spill_mask) &&
+      reader.ReadArray(&code) &&
+      reader.ReadArray(&mapping_table) &&
+      reader.ReadArray(&vmap_table) &&
+      reader.ReadArray(&gc_map) &&
+      reader.ReadArray(&cfi_info) &&
+      reader.ReadUint32(&num_src_map_elems);
+  DefaultSrcMap src_map;
+  for (uint32_t i = 0; valid && i != num_src_map_elems; ++i) {
+    SrcMapElem elem;
+    valid = reader.ReadUint32(&elem.from_) &&
+            reader.ReadBytes(&elem.to_, sizeof(elem.to_));
+    src_map.push_back(elem);
+  }
+  uint32_t num_patches = 0u;
+  valid = valid && reader.ReadUint32(&num_patches);
+  std::vector<LinkerPatch> patches;
+  for (uint32_t i = 0; valid && i != num_patches; ++i) {
+    uint32_t type;
+    uint32_t literal_offset;
+    uint32_t target;
+    uint32_t pc_insn_offset;
+    valid = reader.ReadUint32(&type) &&
+            reader.ReadUint32(&literal_offset) &&
+            reader.ReadUint32(&target) &&
+            reader.ReadUint32(&pc_insn_offset) &&
+            literal_offset < code.size();
+    if (!valid) {
+      break;
+    }
+    switch (static_cast<LinkerPatchType>(type)) {
+      case kLinkerPatchMethod:
+        valid = target < dex_file.NumMethodIds();
+        patches.push_back(LinkerPatch::MethodPatch(literal_offset, &dex_file, target));
+        break;
+      case kLinkerPatchCall:
+        valid = target < dex_file.NumMethodIds();
+        patches.push_back(LinkerPatch::CodePatch(literal_offset, &dex_file, target));
+        break;
+      case kLinkerPatchCallRelative:
+        valid = target < dex_file.NumMethodIds();
+        patches.push_back(LinkerPatch::RelativeCodePatch(literal_offset, &dex_file, target));
+        break;
+      case kLinkerPatchType:
+        valid = target < dex_file.NumTypeIds();
+        patches.push_back(LinkerPatch::TypePatch(literal_offset, &dex_file, target));
+        break;
+      case kLinkerPatchDexCacheArray:
+        valid = pc_insn_offset < code.size();
+        patches.push_back(
+            LinkerPatch::DexCacheArrayPatch(literal_offset, &dex_file, pc_insn_offset, target));
+        break;
+      default:
+        valid = false;
+        break;
+    }
+  }
+  if (!valid || !reader.AtEnd() || code.empty()) {
+    if (!data.empty()) {
+      LOG(WARNING) << "Ignoring malformed or colliding compilation cache entry " << path;
+    }
+    num_misses_.FetchAndAddSequentiallyConsistent(1u);
+    return nullptr;
+  }
+
+  CompiledMethod* compiled_method = CompiledMethod::SwapAllocCompiledMethod(
+      driver,
+      static_cast<InstructionSet>(instruction_set),
+      code,
+      frame_size_in_bytes,
+      core_spill_mask,
+      fp_spill_mask,
+      &src_map,
+      mapping_table,
+      vmap_table,
+      gc_map,
+      cfi_info,
+      ArrayRef<const LinkerPatch>(patches));
+  num_hits_.FetchAndAddSequentiallyConsistent(1u);
+  return compiled_method;
+}
+
+void CompilationCache::Store(const DexFile& dex_file,
+                             const std::string& key,
+                             const CompiledMethod& compiled_method) const {
+  for (const LinkerPatch& patch : compiled_method.GetPatches()) {
+    const DexFile* target_dex_file =
+        (patch.Type() == kLinkerPatchType) ? patch.TargetTypeDexFile()
+        : (patch.Type() == kLinkerPatchDexCacheArray) ? patch.TargetDexCacheDexFile()
+        : patch.TargetMethod().dex_file;
+    if (target_dex_file != &dex_file) {
+      return;
+    }
+  }
+
+  std::vector<uint8_t> data;
+  EntryWriter writer(&data);
+  writer.WriteBytes(kEntryMagic, sizeof(kEntryMagic));
+  writer.WriteUint32(key.size());
+  writer.WriteBytes(key.data(), key.size());
+  writer.WriteUint32(compiled_method.GetInstructionSet());
+  writer.WriteUint32(compiled_method.GetFrameSizeInBytes());
+  writer.WriteUint32(compiled_method.GetCoreSpillMask());
+  writer.WriteUint32(compiled_method.GetFpSpillMask());
+  writer.WriteArray(compiled_method.GetQuickCode());
+  writer.WriteArray(compiled_method.GetMappingTable());
+  writer.WriteArray(compiled_method.GetVmapTable());
+  writer.WriteArray(compiled_method.GetGcMap());
+  writer.WriteArray(compiled_method.GetCFIInfo());
+  const SwapSrcMap& src_map = compiled_method.GetSrcMappingTable();
+  writer.WriteUint32(src_map.size());
+  for (const SrcMapElem& elem : src_map) {
+    writer.WriteUint32(elem.from_);
+    writer.WriteBytes(&elem.to_, sizeof(elem.to_));
+  }
+  ArrayRef<const LinkerPatch> patches = compiled_method.GetPatches();
+  writer.WriteUint32(patches.size());
+  for (const LinkerPatch& patch : patches) {
+    writer.WriteUint32(patch.Type());
+    writer.WriteUint32(patch.LiteralOffset());
+    switch (patch.Type()) {
+      case kLinkerPatchType:
+        writer.WriteUint32(patch.TargetTypeIndex());
+        writer.WriteUint32(0u);
+        break;
+      case kLinkerPatchDexCacheArray:
+        writer.WriteUint32(patch.TargetDexCacheElementOffset());
+        writer.WriteUint32(patch.PcInsnOffset());
+        break;
+      default:
+        writer.WriteUint32(patch.TargetMethod().dex_method_index);
+        writer.WriteUint32(0u);
+        break;
+    }
+  }
+
+  // Write to a temporary file and rename it, so that concurrent compilations never
+  // see a partially written entry.
+  std::string path = GetEntryPath(key);
+  std::string temp_path = StringPrintf("%s.%d.%d", path.c_str(), getpid(), GetTid());
+  std::unique_ptr<File> file(OS::CreateEmptyFile(temp_path.c_str()));
+  if (file == nullptr) {
+    PLOG(WARNING) << "Failed to create compilation cache entry " << temp_path;
+    return;
+  }
+  if (!file->WriteFully(data.data(), data.size())) {
+    PLOG(WARNING) << "Failed to write compilation cache entry " << temp_path;
+    file->Erase();
+    unlink(temp_path.c_str());
+    return;
+  }
+  if (file->FlushCloseOrErase() != 0 || rename(temp_path.c_str(), path.c_str()) != 0) {
+    PLOG(WARNING) << "Failed to write compilation cache entry " << path;
+    unlink(temp_path.c_str());
+    return;
+  }
+  num_stores_.FetchAndAddSequentiallyConsistent(1u);
+}
+
+void CompilationCache::DumpStats(std::ostream& os) const {
+  size_t hits = num_hits_.LoadRelaxed();
+  size_t misses = num_misses_.LoadRelaxed();
+  size_t lookups = hits + misses;
+  os << "Compilation cache " << directory_ << ": " << hits << " hits, " << misses << " misses ("
+     << ((lookups != 0u) ? hits * 100u / lookups : 0u) << "% hit rate), "
+     << num_stores_.LoadRelaxed() << " stores";
+}
+
+}  // namespace art
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
+#define ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
+
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "dex_file.h"
+#include "invoke_type.h"
+#include "safe_map.h"
+
+namespace art {
+
+class CompiledMethod;
+class CompilerDriver;
+
+// An on-disk cache of compiled methods shared by compilations, so that the code of a
+// method compiled for one dex file can be reused for the same method in another dex
+// file, or in a later version of the same dex file.
+//
+// Every entry is a file in the cache directory named after a hash of its key. The key
+// describes what the compiled code depends on:
+//  - the compiler, the settings that influence generated code, and the boot image and
+//    boot class path the code was compiled against,
+//  - the method's code item as the compiled code sees it, including the meaning of
+//    the dex file indices it embeds, and the number of ids of its dex file, which
+//    determine the layout of the dex cache arrays,
+//  - the declarations of the classes the method refers to, transitively through their
+//    superclasses, interfaces and the bodies of the methods that may be inlined, as
+//    resolved in the dex files being compiled.
+// The whole key is stored in the entry and compared when loading, so a hash collision
+// gives a miss rather than wrong code.
+//
+// Linker patches are stored relative to the method's dex file, so code with patches
+// into other dex files is not cached. Neither is code for the boot image, which also
+// depends on the image layout.
+class CompilationCache {
+ public:
+  // Returns null and sets `error_msg` if the cache in `directory` cannot be used for
+  // compiling `dex_files` with `driver`. Creates `directory` if it does not exist.
+  static CompilationCache* Create(const std::string& directory,
+                                  const std::vector<const DexFile*>& dex_files,
+                                  const CompilerDriver& driver,
+                                  const SafeMap<std::string, std::string>& key_value_store,
+                                  std::string* error_msg);
+
+  ~CompilationCache();
+
+  // Returns the key of the method's compiled code in `key`. Thread-safe.
+  void GetKey(const DexFile& dex_file,
+              uint32_t method_idx,
+              uint32_t access_flags,
+              InvokeType invoke_type,
+              const DexFile::CodeItem& code_item,
+              std::string* key) const;
+
+  // Returns the cached code for `key`, or null if there is none. Thread-safe.
+  CompiledMethod* Load(CompilerDriver* driver,
+                       const DexFile& dex_file,
+                       const std::string& key) const;
+
+  // Stores the code compiled for `key` after a miss. Thread-safe. Failing to write
+  // the entry is logged but does not fail the compilation.
+  void Store(const DexFile& dex_file,
+             const std::string& key,
+             const CompiledMethod& compiled_method) const;
+
+  const std::string& GetDirectory() const {
+    return directory_;
+  }
+
+  // Print the number of hits, misses and stores.
+  void DumpStats(std::ostream& os) const;
+
+ private:
+  struct ClassInfo {
+    // Hash of the class declaration, see DescribeClassDeclaration().
+    uint64_t hash;
+    // Descriptors of the classes that the declaration and the inlinable method bodies use.
+    std::vector<std::string> references;
+  };
+
+  CompilationCache(const std::string& directory,
+                   uint64_t fingerprint,
+                   size_t max_inlined_code_units);
+
+  // Fills `classes_` with the classes that `dex_files` define and the boot class path does not.
+  void InitClasses(const std::vector<const DexFile*>& dex_files);
+
+  std::string GetEntryPath(const std::string& key) const;
+
+  const std::string directory_;
+
+  // Hash of the compiler, the code generation settings and the boot image.
+  const uint64_t fingerprint_;
+
+  const size_t max_inlined_code_units_;
+
+  // The classes defined by the dex files being compiled, keyed by descriptor.
+  std::unordered_map<std::string, ClassInfo> classes_;
+
+  mutable Atomic<size_t> num_hits_;
+  mutable Atomic<size_t> num_misses_;
+  mutable Atomic<size_t> num_stores_;
+
+  DISALLOW_COPY_AND_ASSIGN(CompilationCache);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_COMPILATION_CACHE_H_
@@ -0,0 +1,317 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "driver/compilation_cache.h"
+
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "arch/instruction_set_features.h"
+#include "common_compiler_test.h"
+#include "compiled_method.h"
+#include "driver/code_description.h"
+#include "driver/compiler_driver.h"
+#include "driver/compiler_options.h"
+#include "oat.h"
+#include "safe_map.h"
+#include "utf.h"
+
+namespace art {
+
+class CompilationCacheTest : public CommonCompilerTest {
+ protected:
+  void SetUp() OVERRIDE {
+    CommonCompilerTest::SetUp();
+    cache_dir_ = android_data_ + "/CompilationCacheTest";
+    ASSERT_EQ(0, mkdir(cache_dir_.c_str(), 0700));
+    // Code for the boot image is not cached, unlike what CommonCompilerTest sets up.
+    compiler_driver_.reset(CreateDriver(compiler_options_.get(),
+                                        kRuntimeISA,
+                                        instruction_set_features_.get()));
+
+    key_value_store_.Put(OatHeader::kPicKey, "false");
+    key_value_store_.Put(OatHeader::kDebuggableKey, "false");
+  }
+
+  void TearDown() OVERRIDE {
+    ClearDirectory(cache_dir_.c_str());
+    ASSERT_EQ(0, rmdir(cache_dir_.c_str()));
+    CommonCompilerTest::TearDown();
+  }
+
+  CompilerDriver* CreateDriver(const CompilerOptions* compiler_options,
+                               InstructionSet instruction_set,
+                               const InstructionSetFeatures* instruction_set_features) {
+    return new CompilerDriver(compiler_options,
+                              verification_results_.get(),
+                              method_inliner_map_.get(),
+                              Compiler::kQuick, instruction_set,
+                              instruction_set_features,
+                              false, nullptr, nullptr, nullptr,
+                              2, true, true, "", timer_.get(), -1, "");
+  }
+
+  CompilationCache* CreateCache(const std::vector<const DexFile*>& dex_files,
+                                const CompilerDriver& driver,
+                                const SafeMap<std::string, std::string>& key_value_store) {
+    std::string error_msg;
+    CompilationCache* cache =
+        CompilationCache::Create(cache_dir_, dex_files, driver, key_value_store, &error_msg);
+    CHECK(cache != nullptr) << error_msg;
+    return cache;
+  }
+
+  // Opens the dex files of the test `name`, which live as long as the test.
+  std::vector<const DexFile*> OpenDexFiles(const char* name) {
+    std::vector<const DexFile*> dex_files;
+    for (std::unique_ptr<const DexFile>& dex_file : OpenTestDexFiles(name)) {
+      dex_files.push_back(dex_file.get());
+      opened_dex_files_.push_back(std::move(dex_file));
+    }
+    return dex_files;
+  }
+
+  // Returns the key of Main.main() of the MultiDex tests, defined in the primary dex file.
+  std::string GetMainKey(const CompilationCache& cache,
+                         const std::vector<const DexFile*>& dex_files) {
+    const DexFile& dex_file = *dex_files[0];
+    const DexFile::ClassDef* class_def =
+        dex_file.FindClassDef("LMain;", ComputeModifiedUtf8Hash("LMain;"));
+    CHECK(class_def != nullptr);
+    const uint8_t* class_data = dex_file.GetClassData(*class_def);
+    CHECK(class_data != nullptr);
+    ClassDataItemIterator it(dex_file, class_data);
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (; it.HasNextDirectMethod(); it.Next()) {
+      const DexFile::MethodId& method_id = dex_file.GetMethodId(it.GetMemberIndex());
+      if (strcmp(dex_file.GetMethodName(method_id), "main") == 0) {
+        std::string key;
+        cache.GetKey(dex_file, it.GetMemberIndex(), it.GetMethodAccessFlags(), kStatic,
+                     *it.GetMethodCodeItem(), &key);
+        return key;
+      }
+    }
+    LOG(FATAL) << "Main.main() not found in " << dex_file.GetLocation();
+    UNREACHABLE();
+  }
+
+  CompiledMethod* CreateCompiledMethod() {
+    static const uint8_t kCode[] = { 0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0 };
+    static const uint8_t kMappingTable[] = { 0x01, 0x02 };
+    return CompiledMethod::SwapAllocCompiledMethod(compiler_driver_.get(),
+                                                   compiler_driver_->GetInstructionSet(),
+                                                   ArrayRef<const uint8_t>(kCode),
+                                                   64u,
+                                                   0x30u,
+                                                   0x0u,
+                                                   nullptr,
+                                                   ArrayRef<const uint8_t>(kMappingTable),
+                                                   ArrayRef<const uint8_t>(),
+                                                   ArrayRef<const uint8_t>(),
+                                                   ArrayRef<const uint8_t>(),
+                                                   ArrayRef<const LinkerPatch>());
+  }
+
+  // Returns the paths of the entries in the cache directory.
+  std::vector<std::string> GetEntries() {
+    std::vector<std::string> entries;
+    DIR* dir = opendir(cache_dir_.c_str());
+    CHECK(dir != nullptr);
+    for (dirent* e = readdir(dir); e != nullptr; e = readdir(dir)) {
+      if (strcmp(e->d_name, ".") != 0 && strcmp(e->d_name, "..") != 0) {
+        entries.push_back(cache_dir_ + "/" + e->d_name);
+      }
+    }
+    closedir(dir);
+    std::sort(entries.begin(), entries.end());
+    return entries;
+  }
+
+  std::string ReadEntry(const std::string& path) {
+    std::ifstream stream(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+  }
+
+  void WriteEntry(const std::string& path, const std::string& data) {
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    stream << data;
+  }
+
+  std::string cache_dir_;
+  SafeMap<std::string, std::string> key_value_store_;
+  std::vector<std::unique_ptr<const DexFile>> opened_dex_files_;
+};
+
+TEST_F(CompilationCacheTest, StoreLoad) {
+  std::vector<const DexFile*> dex_files = OpenDexFiles("MultiDex");
+  std::unique_ptr<CompilationCache> cache(
+      CreateCache(dex_files, *compiler_driver_, key_value_store_));
+  std::string key = GetMainKey(*cache, dex_files);
+  EXPECT_TRUE(cache->Load(compiler_driver_.get(), *dex_files[0], key) == nullptr);
+
+  CompiledMethod* compiled_method = CreateCompiledMethod();
+  cache->Store(*dex_files[0], key, *compiled_method);
+  ASSERT_EQ(1u, GetEntries().size());
+
+  // A later compilation with the same inputs finds the entry.
+  std::unique_ptr<CompilationCache> other_cache(
+      CreateCache(dex_files, *compiler_driver_, key_value_store_));
+  EXPECT_EQ(key, GetMainKey(*other_cache, dex_files));
+  CompiledMethod* loaded = other_cache->Load(compiler_driver_.get(), *dex_files[0], key);
+  ASSERT_TRUE(loaded != nullptr);
+  EXPECT_EQ(compiled_method->GetInstructionSet(), loaded->GetInstructionSet());
+  EXPECT_EQ(*compiled_method->GetQuickCode(), *loaded->GetQuickCode());
+  EXPECT_EQ(compiled_method->GetFrameSizeInBytes(), loaded->GetFrameSizeInBytes());
+  EXPECT_EQ(compiled_method->GetCoreSpillMask(), loaded->GetCoreSpillMask());
+  EXPECT_EQ(compiled_method->GetFpSpillMask(), loaded->GetFpSpillMask());
+  ASSERT_TRUE(loaded->GetMappingTable() != nullptr);
+  EXPECT_EQ(*compiled_method->GetMappingTable(), *loaded->GetMappingTable());
+  EXPECT_TRUE(loaded->GetPatches().empty());
+
+  std::ostringstream oss;
+  other_cache->DumpStats(oss);
+  EXPECT_NE(std::string::npos, oss.str().find(": 1 hits, 0 misses")) << oss.str();
+
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), loaded);
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), compiled_method);
+}
+
+TEST_F(CompilationCacheTest, KeyDependsOnClassHierarchy) {
+  std::vector<const DexFile*> dex_files = OpenDexFiles("MultiDex");
+  std::unique_ptr<CompilationCache> cache(
+      CreateCache(dex_files, *compiler_driver_, key_value_store_));
+
+  // Main.main() is unchanged, but Second, which it instantiates, declares another method.
+  std::vector<const DexFile*> modified_dex_files = OpenDexFiles("MultiDexModifiedSecondary");
+  std::unique_ptr<CompilationCache> modified_cache(
+      CreateCache(modified_dex_files, *compiler_driver_, key_value_store_));
+  EXPECT_NE(GetMainKey(*cache, dex_files), GetMainKey(*modified_cache, modified_dex_files));
+}
+
+TEST_F(CompilationCacheTest, KeyDependsOnCompilerOptions) {
+  std::vector<const DexFile*> dex_files = OpenDexFiles("MultiDex");
+  std::unique_ptr<CompilationCache> cache(
+      CreateCache(dex_files, *compiler_driver_, key_value_store_));
+  std::string key = GetMainKey(*cache, dex_files);
+
+  CompilerOptions space_compiler_options;
+  space_compiler_options.SetCompilerFilter(CompilerOptions::kSpace);
+  std::unique_ptr<CompilerDriver> space_driver(CreateDriver(&space_compiler_options,
+                                                            kRuntimeISA,
+                                                            instruction_set_features_.get()));
+  std::unique_ptr<CompilationCache> space_cache(
+      CreateCache(dex_files, *space_driver, key_value_store_));
+  EXPECT_NE(key, GetMainKey(*space_cache, dex_files));
+
+  SafeMap<std::string, std::string> debuggable_key_value_store(key_value_store_);
+  debuggable_key_value_store.Overwrite(OatHeader::kDebuggableKey, "true");
+  std::unique_ptr<CompilationCache> debuggable_cache(
+      CreateCache(dex_files, *compiler_driver_, debuggable_key_value_store));
+  EXPECT_NE(key, GetMainKey(*debuggable_cache, dex_files));
+}
+
+TEST_F(CompilationCacheTest, KeyDependsOnInstructionSet) {
+  std::vector<const DexFile*> dex_files = OpenDexFiles("MultiDex");
+  std::unique_ptr<CompilationCache> cache(
+      CreateCache(dex_files, *compiler_driver_, key_value_store_));
+
+  InstructionSet other_isa = (kRuntimeISA == kArm64) ? kX86_64 : kArm64;
+  std::string error_msg;
+  std::unique_ptr<const InstructionSetFeatures> other_features(
+      InstructionSetFeatures::FromVariant(other_isa, "default", &error_msg));
+  ASSERT_TRUE(other_features != nullptr) << error_msg;
+  std::unique_ptr<CompilerDriver> other_driver(
+      CreateDriver(compiler_options_.get(), other_isa, other_features.get()));
+  std::unique_ptr<CompilationCache> other_cache(
+      CreateCache(dex_files, *other_driver, key_value_store_));
+  EXPECT_NE(GetMainKey(*cache, dex_files), GetMainKey(*other_cache, dex_files));
+}
+
+TEST_F(CompilationCacheTest, ClassDeclarationDescribesStaticValues) {
+  // Whether a class has static values decides if compiled code may omit its
+  // initialization check.
+  std::vector<const DexFile*> dex_files = OpenDexFiles("Statics");
+  const DexFile::ClassDef* class_def =
+      dex_files[0]->FindClassDef("LStatics;", ComputeModifiedUtf8Hash("LStatics;"));
+  ASSERT_TRUE(class_def != nullptr);
+  std::string description;
+  DescribeClassDeclaration(*dex_files[0], *class_def, 0u, &description);
+  EXPECT_NE(std::string::npos, description.find("static values ")) << description;
+
+  std::vector<const DexFile*> multidex_files = OpenDexFiles("MultiDex");
+  const DexFile::ClassDef* main_class_def =
+      multidex_files[0]->FindClassDef("LMain;", ComputeModifiedUtf8Hash("LMain;"));
+  ASSERT_TRUE(main_class_def != nullptr);
+  std::string main_description;
+  DescribeClassDeclaration(*multidex_files[0], *main_class_def, 0u, &main_description);
+  EXPECT_EQ(std::string::npos, main_description.find("static values ")) << main_description;
+}
+
+TEST_F(CompilationCacheTest, CorruptEntryRejected) {
+  std::vector<const DexFile*> dex_files = OpenDexFiles("MultiDex");
+  std::unique_ptr<CompilationCache> cache(
+      CreateCache(dex_files, *compiler_driver_, key_value_store_));
+  std::string key = GetMainKey(*cache, dex_files);
+  CompiledMethod* compiled_method = CreateCompiledMethod();
+  cache->Store(*dex_files[0], key, *compiled_method);
+  std::vector<std::string> entries = GetEntries();
+  ASSERT_EQ(1u, entries.size());
+  const std::string entry = entries[0];
+  const std::string data = ReadEntry(entry);
+
+  // Truncated.
+  WriteEntry(entry, data.substr(0u, data.size() - 1u));
+  EXPECT_TRUE(cache->Load(compiler_driver_.get(), *dex_files[0], key) == nullptr);
+  // Trailing garbage.
+  WriteEntry(entry, data + '\0');
+  EXPECT_TRUE(cache->Load(compiler_driver_.get(), *dex_files[0], key) == nullptr);
+  // Bad magic.
+  std::string bad_magic = data;
+  bad_magic[0] = 'x';
+  WriteEntry(entry, bad_magic);
+  EXPECT_TRUE(cache->Load(compiler_driver_.get(), *dex_files[0], key) == nullptr);
+
+  // An entry stored for another key, as after a hash collision.
+  std::string other_key = key + "other\n";
+  cache->Store(*dex_files[0], other_key, *compiled_method);
+  entries = GetEntries();
+  ASSERT_EQ(2u, entries.size());
+  const std::string other_entry = (entries[0] != entry) ? entries[0] : entries[1];
+  WriteEntry(entry, ReadEntry(other_entry));
+  EXPECT_TRUE(cache->Load(compiler_driver_.get(), *dex_files[0], key) == nullptr);
+
+  // The intact entry is still accepted.
+  WriteEntry(entry, data);
+  CompiledMethod* loaded = cache->Load(compiler_driver_.get(), *dex_files[0], key);
+  EXPECT_TRUE(loaded != nullptr);
+  if (loaded != nullptr) {
+    CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), loaded);
+  }
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), compiled_method);
+}
+
+}  // namespace art
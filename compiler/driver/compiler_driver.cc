@@ -19,6 +19,8 @@
 #define ATRACE_TAG ATRACE_TAG_DALVIK
 #include <utils/Trace.h>
 
+#include <algorithm>
+#include <limits>
 #include <unordered_set>
 #include <vector>
 #include <unistd.h>
@@ -30,6 +32,7 @@
 #include "art_field-inl.h"
 #include "art_method-inl.h"
 #include "base/stl_util.h"
+#include "base/stringprintf.h"
 #include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "class_linker-inl.h"
@@ -43,7 +46,9 @@
 #include "dex/verified_method.h"
 #include "dex/quick/dex_file_method_inliner.h"
 #include "dex/quick/dex_file_to_method_inliner_map.h"
+#include "driver/compilation_cache.h"
 #include "driver/compiler_options.h"
+#include "driver/previous_compilation.h"
 #include "elf_writer_quick.h"
 #include "jni_internal.h"
 #include "object_lock.h"
@@ -71,6 +76,7 @@
 #include "utils/swap_space.h"
 #include "verifier/method_verifier.h"
 #include "verifier/method_verifier-inl.h"
+#include "verifier/verifier_deps.h"
 
 namespace art {
 
@@ -384,6 +390,10 @@ CompilerDriver::CompilerDriver(const CompilerOptions* compiler_options,
       timings_logger_(timer),
       compiler_context_(nullptr),
       support_boot_image_fixup_(instruction_set != kMips && instruction_set != kMips64),
+      previous_compilation_(nullptr),
+      compilation_cache_(nullptr),
+      verifier_deps_(nullptr),
+      use_previous_verification_(false),
       dedupe_code_("dedupe code", *swap_space_allocator_),
       dedupe_src_mapping_table_("dedupe source mapping table", *swap_space_allocator_),
       dedupe_mapping_table_("dedupe mapping table", *swap_space_allocator_),
@@ -405,6 +415,7 @@ CompilerDriver::CompilerDriver(const CompilerOptions* compiler_options,
     profile_present_ = profile_file_.LoadFile(profile_file);
     if (profile_present_) {
       LOG(INFO) << "Using profile data form file " << profile_file;
+      profile_file_.GetTopKSamples(hot_methods_, compiler_options_->GetTopKProfileThreshold());
     } else {
       LOG(INFO) << "Failed to load profile file " << profile_file;
     }
@@ -1569,6 +1580,15 @@ bool CompilerDriver::IsSafeCast(const DexCompilationUnit* mUnit, uint32_t dex_pc
   return result;
 }
 
+// A unit of work of a parallel phase: the methods of a class with class data ordinals in
+// [method_begin, method_end), and an estimate of the cost of processing them.
+struct ParallelWorkItem {
+  uint16_t class_def_index;
+  uint32_t method_begin;
+  uint32_t method_end;
+  size_t cost;
+};
+
 class ParallelCompilationManager {
  public:
   typedef void Callback(const ParallelCompilationManager* manager, size_t index);
@@ -1585,7 +1605,9 @@ class ParallelCompilationManager {
       compiler_(compiler),
       dex_file_(dex_file),
       dex_files_(dex_files),
-      thread_pool_(thread_pool) {}
+      thread_pool_(thread_pool),
+      work_items_(nullptr),
+      timing_lock_("parallel compilation timing lock") {}
 
   ClassLinker* GetClassLinker() const {
     CHECK(class_linker_ != nullptr);
@@ -1616,6 +1638,10 @@ class ParallelCompilationManager {
     CHECK_GT(work_units, 0U);
 
     index_.StoreRelaxed(begin);
+    {
+      MutexLock mu(self, timing_lock_);
+      timing_ = Timing();
+    }
     for (size_t i = 0; i < work_units; ++i) {
       thread_pool_->AddTask(self, new ForAllClosure(this, end, callback));
     }
@@ -1629,11 +1655,82 @@ class ParallelCompilationManager {
     thread_pool_->Wait(self, true, false);
   }
 
+  // Like ForAll() over the indexes of `work_items`, which are handed out in order of decreasing
+  // cost. The threads that run out of work first then wait for cheap work items only, instead
+  // of one thread still working on an expensive one long after the others have finished.
+  // Records the timing of the phase with the compiler driver under `phase_name`.
+  void ForAllWorkItems(std::vector<ParallelWorkItem>* work_items,
+                       Callback callback,
+                       size_t work_units,
+                       const char* phase_name) {
+    std::stable_sort(work_items->begin(), work_items->end(),
+                     [](const ParallelWorkItem& lhs, const ParallelWorkItem& rhs) {
+                       return lhs.cost > rhs.cost;
+                     });
+    work_items_ = work_items;
+    uint64_t start_ns = NanoTime();
+    ForAll(0, work_items->size(), callback, work_units);
+    uint64_t wall_ns = NanoTime() - start_ns;
+    work_items_ = nullptr;
+
+    Thread* self = Thread::Current();
+    MutexLock mu(self, timing_lock_);
+    std::string longest_work_item;
+    if (timing_.longest_index < work_items->size()) {
+      const ParallelWorkItem& item = (*work_items)[timing_.longest_index];
+      longest_work_item = PrettyDescriptor(
+          dex_file_->GetClassDescriptor(dex_file_->GetClassDef(item.class_def_index)));
+      if (item.method_end != kAllMethods) {
+        longest_work_item += StringPrintf(" methods %u-%u", item.method_begin, item.method_end - 1u);
+      } else if (item.method_begin != 0u) {
+        longest_work_item += StringPrintf(" methods %u-", item.method_begin);
+      }
+    }
+    compiler_->RecordParallelPhaseTiming(phase_name,
+                                         wall_ns,
+                                         timing_.busy_ns,
+                                         wall_ns * work_units,
+                                         timing_.last_finish_ns - timing_.first_finish_ns,
+                                         timing_.longest_ns,
+                                         longest_work_item);
+  }
+
+  const ParallelWorkItem& GetWorkItem(size_t index) const {
+    DCHECK(work_items_ != nullptr);
+    return (*work_items_)[index];
+  }
+
   size_t NextIndex() {
     return index_.FetchAndAddSequentiallyConsistent(1);
   }
 
+  // The `method_end` of a work item covering all remaining methods of its class.
+  static constexpr uint32_t kAllMethods = std::numeric_limits<uint32_t>::max();
+
  private:
+  struct Timing {
+    uint64_t busy_ns = 0u;
+    uint64_t first_finish_ns = std::numeric_limits<uint64_t>::max();
+    uint64_t last_finish_ns = 0u;
+    uint64_t longest_ns = 0u;
+    size_t longest_index = std::numeric_limits<size_t>::max();
+  };
+
+  void RecordWorkerTiming(Thread* self,
+                          uint64_t start_ns,
+                          uint64_t finish_ns,
+                          uint64_t longest_ns,
+                          size_t longest_index) LOCKS_EXCLUDED(timing_lock_) {
+    MutexLock mu(self, timing_lock_);
+    timing_.busy_ns += finish_ns - start_ns;
+    timing_.first_finish_ns = std::min(timing_.first_finish_ns, finish_ns);
+    timing_.last_finish_ns = std::max(timing_.last_finish_ns, finish_ns);
+    if (longest_ns > timing_.longest_ns) {
+      timing_.longest_ns = longest_ns;
+      timing_.longest_index = longest_index;
+    }
+  }
+
   class ForAllClosure : public Task {
    public:
     ForAllClosure(ParallelCompilationManager* manager, size_t end, Callback* callback)
@@ -1642,14 +1739,24 @@ class ParallelCompilationManager {
           callback_(callback) {}
 
     virtual void Run(Thread* self) {
+      uint64_t start_ns = NanoTime();
+      uint64_t longest_ns = 0u;
+      size_t longest_index = end_;
       while (true) {
         const size_t index = manager_->NextIndex();
         if (UNLIKELY(index >= end_)) {
           break;
         }
+        uint64_t index_start_ns = NanoTime();
         callback_(manager_, index);
+        uint64_t index_ns = NanoTime() - index_start_ns;
+        if (index_ns > longest_ns) {
+          longest_ns = index_ns;
+          longest_index = index;
+        }
         self->AssertNoPendingException();
       }
+      manager_->RecordWorkerTiming(self, start_ns, NanoTime(), longest_ns, longest_index);
     }
 
     virtual void Finalize() {
@@ -1669,10 +1776,72 @@ class ParallelCompilationManager {
   const DexFile* const dex_file_;
   const std::vector<const DexFile*>& dex_files_;
   ThreadPool* const thread_pool_;
+  const std::vector<ParallelWorkItem>* work_items_;
+
+  Mutex timing_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  Timing timing_ GUARDED_BY(timing_lock_);
 
   DISALLOW_COPY_AND_ASSIGN(ParallelCompilationManager);
 };
 
+constexpr uint32_t ParallelCompilationManager::kAllMethods;
+
+// The estimated cost of processing a method, in code units.
+static size_t MethodCost(const DexFile::CodeItem* code_item) {
+  // Account for the work that does not depend on the size of the code.
+  static constexpr size_t kMethodOverhead = 16u;
+  return kMethodOverhead + ((code_item != nullptr) ? code_item->insns_size_in_code_units_ : 0u);
+}
+
+// Returns the work items for processing the classes of `dex_file` with `thread_count` threads.
+// If `split_classes`, the methods of classes that are expensive compared to the whole dex file
+// are spread over several work items, so that they can be processed in parallel.
+static std::vector<ParallelWorkItem> CreateWorkItems(const DexFile& dex_file,
+                                                     size_t thread_count,
+                                                     bool split_classes) {
+  // How many work items each thread should get at least, to leave room for balancing.
+  static constexpr size_t kMinWorkItemsPerThread = 4u;
+
+  std::vector<std::vector<size_t>> method_costs(dex_file.NumClassDefs());
+  size_t total_cost = 0u;
+  for (size_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+    const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(i));
+    if (class_data == nullptr) {
+      continue;
+    }
+    ClassDataItemIterator it(dex_file, class_data);
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+      method_costs[i].push_back(MethodCost(it.GetMethodCodeItem()));
+      total_cost += method_costs[i].back();
+    }
+  }
+
+  size_t max_cost = (split_classes && thread_count > 1u)
+      ? std::max<size_t>(total_cost / (thread_count * kMinWorkItemsPerThread), 1u)
+      : std::numeric_limits<size_t>::max();
+  std::vector<ParallelWorkItem> work_items;
+  work_items.reserve(dex_file.NumClassDefs());
+  for (size_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+    ParallelWorkItem item = { static_cast<uint16_t>(i), 0u, ParallelCompilationManager::kAllMethods,
+                              0u };
+    for (size_t method = 0; method != method_costs[i].size(); ++method) {
+      if (item.cost != 0u && item.cost + method_costs[i][method] > max_cost) {
+        item.method_end = method;
+        work_items.push_back(item);
+        item.method_begin = method;
+        item.method_end = ParallelCompilationManager::kAllMethods;
+        item.cost = 0u;
+      }
+      item.cost += method_costs[i][method];
+    }
+    work_items.push_back(item);
+  }
+  return work_items;
+}
+
 // A fast version of SkipClass above if the class pointer is available
 // that avoids the expensive FindInClassPath search.
 static bool SkipClass(jobject class_loader, const DexFile& dex_file, mirror::Class* klass)
@@ -1876,8 +2045,43 @@ void CompilerDriver::SetVerified(jobject class_loader, const std::vector<const D
   }
 }
 
+bool CompilerDriver::CanUsePreviousVerification(jobject class_loader, TimingLogger* timings) {
+  if (previous_compilation_ == nullptr || previous_compilation_->GetVerifierDeps() == nullptr) {
+    return false;
+  }
+  // Compiling a method needs the output of the verifier, only the DEX-to-DEX compiler can do
+  // without.
+  if (compiler_options_->IsCompilationEnabled()) {
+    VLOG(compiler) << "Not reusing verification results: compilation is enabled";
+    return false;
+  }
+  TimingLogger::ScopedTiming t("Validate Verifier Dependencies", timings);
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(class_loader)));
+  std::string error_msg;
+  if (!previous_compilation_->GetVerifierDeps()->Validate(loader, &error_msg)) {
+    LOG(INFO) << "Not reusing verification results from " << previous_compilation_->GetLocation()
+              << ": " << error_msg;
+    return false;
+  }
+  // The classes that are not verified again still depend on the same lookups.
+  if (verifier_deps_ != nullptr) {
+    verifier_deps_->MergeFrom(*previous_compilation_->GetVerifierDeps());
+  }
+  return true;
+}
+
+bool CompilerDriver::IsPreviouslyVerified(const DexFile& dex_file, uint16_t class_def_idx) const {
+  return use_previous_verification_ &&
+      previous_compilation_->GetClassStatus(dex_file, class_def_idx) >=
+          mirror::Class::kStatusVerified;
+}
+
 void CompilerDriver::Verify(jobject class_loader, const std::vector<const DexFile*>& dex_files,
                             ThreadPool* thread_pool, TimingLogger* timings) {
+  use_previous_verification_ = CanUsePreviousVerification(class_loader, timings);
   for (size_t i = 0; i != dex_files.size(); ++i) {
     const DexFile* dex_file = dex_files[i];
     CHECK(dex_file != nullptr);
@@ -1885,6 +2089,50 @@ void CompilerDriver::Verify(jobject class_loader, const std::vector<const DexFil
   }
 }
 
+// Marks a resolved class verified without running the verifier and records its status.
+static void MarkClassVerified(Thread* self,
+                              const ParallelCompilationManager* manager,
+                              size_t class_def_index,
+                              Handle<mirror::Class> klass)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  DCHECK(klass->IsResolved());
+  if (klass->GetStatus() < mirror::Class::kStatusVerified) {
+    ObjectLock<mirror::Class> lock(self, klass);
+    // Set class status to verified.
+    mirror::Class::SetStatus(klass, mirror::Class::kStatusVerified, self);
+    // Mark methods as pre-verified. If we don't do this, the interpreter will run with
+    // access checks.
+    klass->SetPreverifiedFlagOnAllMethods(
+        GetInstructionSetPointerSize(manager->GetCompiler()->GetInstructionSet()));
+    klass->SetPreverified();
+  }
+  // Record the final class status if necessary.
+  ClassReference ref(manager->GetDexFile(), class_def_index);
+  manager->GetCompiler()->RecordClassStatus(ref, klass->GetStatus());
+}
+
+// Registers the methods of a class that verified in a previous compilation as verified, so
+// that the DEX-to-DEX compiler treats them like the methods the verifier has seen.
+static void AddPreviouslyVerifiedMethods(const ParallelCompilationManager* manager,
+                                         size_t class_def_index) {
+  const DexFile& dex_file = *manager->GetDexFile();
+  const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(class_def_index));
+  if (class_data == nullptr) {
+    return;
+  }
+  VerificationResults* verification_results = manager->GetCompiler()->GetVerificationResults();
+  ClassDataItemIterator it(dex_file, class_data);
+  while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+    it.Next();
+  }
+  for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+    if (it.GetMethodCodeItem() != nullptr) {
+      verification_results->AddPreviouslyVerifiedMethod(
+          MethodReference(&dex_file, it.GetMemberIndex()));
+    }
+  }
+}
+
 static void VerifyClass(const ParallelCompilationManager* manager, size_t class_def_index)
     LOCKS_EXCLUDED(Locks::mutator_lock_) {
   ATRACE_CALL();
@@ -1919,6 +2167,11 @@ static void VerifyClass(const ParallelCompilationManager* manager, size_t class_
     }
   } else if (!SkipClass(jclass_loader, dex_file, klass.Get())) {
     CHECK(klass->IsResolved()) << PrettyClass(klass.Get());
+    if (manager->GetCompiler()->IsPreviouslyVerified(dex_file, class_def_index)) {
+      MarkClassVerified(soa.Self(), manager, class_def_index, klass);
+      AddPreviouslyVerifiedMethods(manager, class_def_index);
+      return;
+    }
     class_linker->VerifyClass(soa.Self(), klass);
 
     if (klass->IsErroneous()) {
@@ -1940,6 +2193,11 @@ static void VerifyClass(const ParallelCompilationManager* manager, size_t class_
   soa.Self()->AssertNoPendingException();
 }
 
+static void VerifyWorkItem(const ParallelCompilationManager* manager, size_t work_item_index)
+    LOCKS_EXCLUDED(Locks::mutator_lock_) {
+  VerifyClass(manager, manager->GetWorkItem(work_item_index).class_def_index);
+}
+
 void CompilerDriver::VerifyDexFile(jobject class_loader, const DexFile& dex_file,
                                    const std::vector<const DexFile*>& dex_files,
                                    ThreadPool* thread_pool, TimingLogger* timings) {
@@ -1947,7 +2205,10 @@ void CompilerDriver::VerifyDexFile(jobject class_loader, const DexFile& dex_file
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   ParallelCompilationManager context(class_linker, class_loader, this, &dex_file, dex_files,
                                      thread_pool);
-  context.ForAll(0, dex_file.NumClassDefs(), VerifyClass, thread_count_);
+  // Classes are verified as a whole, so the work items are not split.
+  std::vector<ParallelWorkItem> work_items =
+      CreateWorkItems(dex_file, thread_count_, /* split_classes */ false);
+  context.ForAllWorkItems(&work_items, VerifyWorkItem, thread_count_, "Verify");
 }
 
 static void SetVerifiedClass(const ParallelCompilationManager* manager, size_t class_def_index)
@@ -1969,19 +2230,7 @@ static void SetVerifiedClass(const ParallelCompilationManager* manager, size_t c
     // Only do this if the class is resolved. If even resolution fails, quickening will go very,
     // very wrong.
     if (klass->IsResolved()) {
-      if (klass->GetStatus() < mirror::Class::kStatusVerified) {
-        ObjectLock<mirror::Class> lock(soa.Self(), klass);
-        // Set class status to verified.
-        mirror::Class::SetStatus(klass, mirror::Class::kStatusVerified, soa.Self());
-        // Mark methods as pre-verified. If we don't do this, the interpreter will run with
-        // access checks.
-        klass->SetPreverifiedFlagOnAllMethods(
-            GetInstructionSetPointerSize(manager->GetCompiler()->GetInstructionSet()));
-        klass->SetPreverified();
-      }
-      // Record the final class status if necessary.
-      ClassReference ref(manager->GetDexFile(), class_def_index);
-      manager->GetCompiler()->RecordClassStatus(ref, klass->GetStatus());
+      MarkClassVerified(soa.Self(), manager, class_def_index, klass);
     }
   } else {
     Thread* self = soa.Self();
@@ -2000,7 +2249,11 @@ void CompilerDriver::SetVerifiedDexFile(jobject class_loader, const DexFile& dex
   context.ForAll(0, dex_file.NumClassDefs(), SetVerifiedClass, thread_count_);
 }
 
-static void InitializeClass(const ParallelCompilationManager* manager, size_t class_def_index)
+// Initializes the class if that can be done without running code in a transaction, or if
+// `run_clinit` is true, by running its static initializer in a transaction when that is allowed.
+static void InitializeClass(const ParallelCompilationManager* manager,
+                            size_t class_def_index,
+                            bool run_clinit)
     LOCKS_EXCLUDED(Locks::mutator_lock_) {
   ATRACE_CALL();
   jobject jclass_loader = manager->GetClassLoader();
@@ -2039,15 +2292,14 @@ static void InitializeClass(const ParallelCompilationManager* manager, size_t cl
         if (!klass->IsInitialized()) {
           // We need to initialize static fields, we only do this for image classes that aren't
           // marked with the $NoPreloadHolder (which implies this should not be initialized early).
-          bool can_init_static_fields = manager->GetCompiler()->IsImage() &&
+          bool can_init_static_fields = run_clinit &&
+              manager->GetCompiler()->IsImage() &&
               manager->GetCompiler()->IsImageClass(descriptor) &&
               !StringPiece(descriptor).ends_with("$NoPreloadHolder;");
           if (can_init_static_fields) {
             VLOG(compiler) << "Initializing: " << descriptor;
-            // TODO multithreading support. We should ensure the current compilation thread has
-            // exclusive access to the runtime and the transaction. To achieve this, we could use
-            // a ReaderWriterMutex but we're holding the mutator lock so we fail mutex sanity
-            // checks in Thread::AssertThreadSuspensionIsAllowable.
+            // The runtime has a single active transaction, so this must only run on one thread
+            // at a time. See CompilerDriver::InitializeClasses().
             Runtime* const runtime = Runtime::Current();
             Transaction transaction;
 
@@ -2091,21 +2343,39 @@ static void InitializeClass(const ParallelCompilationManager* manager, size_t cl
   soa.Self()->ClearException();
 }
 
+static void InitializeClassWithoutClinit(const ParallelCompilationManager* manager,
+                                         size_t class_def_index)
+    LOCKS_EXCLUDED(Locks::mutator_lock_) {
+  InitializeClass(manager, class_def_index, false);
+}
+
+static void InitializeClassWithClinit(const ParallelCompilationManager* manager,
+                                      size_t class_def_index)
+    LOCKS_EXCLUDED(Locks::mutator_lock_) {
+  InitializeClass(manager, class_def_index, true);
+}
+
 void CompilerDriver::InitializeClasses(jobject jni_class_loader, const DexFile& dex_file,
                                        const std::vector<const DexFile*>& dex_files,
                                        ThreadPool* thread_pool, TimingLogger* timings) {
-  TimingLogger::ScopedTiming t("InitializeNoClinit", timings);
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   ParallelCompilationManager context(class_linker, jni_class_loader, this, &dex_file, dex_files,
                                      thread_pool);
-  size_t thread_count;
   if (IsImage()) {
-    // TODO: remove this when transactional mode supports multithreading.
-    thread_count = 1U;
+    // Static initializers of image classes run in a transaction, and the runtime supports only
+    // one active transaction, which every other thread would also record its writes into.
+    // Initialize all the classes that need no static initializer in parallel first, then run
+    // the remaining static initializers on a single thread.
+    {
+      TimingLogger::ScopedTiming t("InitializeNoClinit", timings);
+      context.ForAll(0, dex_file.NumClassDefs(), InitializeClassWithoutClinit, thread_count_);
+    }
+    TimingLogger::ScopedTiming t("InitializeClinit", timings);
+    context.ForAll(0, dex_file.NumClassDefs(), InitializeClassWithClinit, 1U);
   } else {
-    thread_count = thread_count_;
+    TimingLogger::ScopedTiming t("InitializeNoClinit", timings);
+    context.ForAll(0, dex_file.NumClassDefs(), InitializeClassWithoutClinit, thread_count_);
   }
-  context.ForAll(0, dex_file.NumClassDefs(), InitializeClass, thread_count);
 }
 
 void CompilerDriver::InitializeClasses(jobject class_loader,
@@ -2128,13 +2398,16 @@ void CompilerDriver::Compile(jobject class_loader, const std::vector<const DexFi
     const DexFile* dex_file = dex_files[i];
     CHECK(dex_file != nullptr);
     CompileDexFile(class_loader, *dex_file, dex_files, thread_pool, timings);
+    ReleaseCompiledDataMemory();
   }
   VLOG(compiler) << "Compile: " << GetMemoryUsageString(false);
 }
 
-void CompilerDriver::CompileClass(const ParallelCompilationManager* manager,
-                                  size_t class_def_index) {
+void CompilerDriver::CompileWorkItem(const ParallelCompilationManager* manager,
+                                     size_t work_item_index) {
   ATRACE_CALL();
+  const ParallelWorkItem& work_item = manager->GetWorkItem(work_item_index);
+  const size_t class_def_index = work_item.class_def_index;
   const DexFile& dex_file = *manager->GetDexFile();
   const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_index);
   ClassLinker* class_linker = manager->GetClassLinker();
@@ -2191,9 +2464,12 @@ void CompilerDriver::CompileClass(const ParallelCompilationManager* manager,
   bool compilation_enabled = driver->IsClassToCompile(
       dex_file.StringByTypeIdx(class_def.class_idx_));
 
+  // Compile the direct and virtual methods with ordinals in [method_begin, method_end). The
+  // methods before method_begin are still iterated to detect the duplicates below.
+  uint32_t method_ordinal = 0u;
   // Compile direct methods
   int64_t previous_direct_method_idx = -1;
-  while (it.HasNextDirectMethod()) {
+  for (; it.HasNextDirectMethod() && method_ordinal < work_item.method_end; ++method_ordinal) {
     uint32_t method_idx = it.GetMemberIndex();
     if (method_idx == previous_direct_method_idx) {
       // smali can create dex files with two encoded_methods sharing the same method_idx
@@ -2202,6 +2478,10 @@ void CompilerDriver::CompileClass(const ParallelCompilationManager* manager,
       continue;
     }
     previous_direct_method_idx = method_idx;
+    if (method_ordinal < work_item.method_begin) {
+      it.Next();
+      continue;
+    }
     driver->CompileMethod(self, it.GetMethodCodeItem(), it.GetMethodAccessFlags(),
                           it.GetMethodInvokeType(class_def), class_def_index,
                           method_idx, jclass_loader, dex_file, dex_to_dex_compilation_level,
@@ -2210,7 +2490,7 @@ void CompilerDriver::CompileClass(const ParallelCompilationManager* manager,
   }
   // Compile virtual methods
   int64_t previous_virtual_method_idx = -1;
-  while (it.HasNextVirtualMethod()) {
+  for (; it.HasNextVirtualMethod() && method_ordinal < work_item.method_end; ++method_ordinal) {
     uint32_t method_idx = it.GetMemberIndex();
     if (method_idx == previous_virtual_method_idx) {
       // smali can create dex files with two encoded_methods sharing the same method_idx
@@ -2219,13 +2499,17 @@ void CompilerDriver::CompileClass(const ParallelCompilationManager* manager,
       continue;
     }
     previous_virtual_method_idx = method_idx;
+    if (method_ordinal < work_item.method_begin) {
+      it.Next();
+      continue;
+    }
     driver->CompileMethod(self, it.GetMethodCodeItem(), it.GetMethodAccessFlags(),
                           it.GetMethodInvokeType(class_def), class_def_index,
                           method_idx, jclass_loader, dex_file, dex_to_dex_compilation_level,
                           compilation_enabled);
     it.Next();
   }
-  DCHECK(!it.HasNext());
+  DCHECK(!it.HasNext() || work_item.method_end != ParallelCompilationManager::kAllMethods);
 }
 
 void CompilerDriver::CompileDexFile(jobject class_loader, const DexFile& dex_file,
@@ -2234,7 +2518,48 @@ void CompilerDriver::CompileDexFile(jobject class_loader, const DexFile& dex_fil
   TimingLogger::ScopedTiming t("Compile Dex File", timings);
   ParallelCompilationManager context(Runtime::Current()->GetClassLinker(), class_loader, this,
                                      &dex_file, dex_files, thread_pool);
-  context.ForAll(0, dex_file.NumClassDefs(), CompilerDriver::CompileClass, thread_count_);
+  std::vector<ParallelWorkItem> work_items =
+      CreateWorkItems(dex_file, thread_count_, /* split_classes */ true);
+  context.ForAllWorkItems(&work_items, CompilerDriver::CompileWorkItem, thread_count_, "Compile");
+}
+
+void CompilerDriver::RecordParallelPhaseTiming(const char* phase_name,
+                                               uint64_t wall_ns,
+                                               uint64_t busy_ns,
+                                               uint64_t capacity_ns,
+                                               uint64_t tail_ns,
+                                               uint64_t longest_work_item_ns,
+                                               const std::string& longest_work_item) {
+  auto it = parallel_phase_timings_.find(phase_name);
+  if (it == parallel_phase_timings_.end()) {
+    it = parallel_phase_timings_.Put(phase_name, ParallelPhaseTiming());
+  }
+  ParallelPhaseTiming& timing = it->second;
+  timing.wall_ns += wall_ns;
+  timing.busy_ns += busy_ns;
+  timing.capacity_ns += capacity_ns;
+  timing.tail_ns += tail_ns;
+  if (longest_work_item_ns > timing.longest_work_item_ns) {
+    timing.longest_work_item_ns = longest_work_item_ns;
+    timing.longest_work_item = longest_work_item;
+  }
+}
+
+void CompilerDriver::DumpParallelPhaseTimings(std::ostream& os) const {
+  for (const auto& entry : parallel_phase_timings_) {
+    const ParallelPhaseTiming& timing = entry.second;
+    size_t utilization =
+        (timing.capacity_ns != 0u) ? (timing.busy_ns * 100u / timing.capacity_ns) : 100u;
+    os << entry.first << ": wall " << PrettyDuration(timing.wall_ns)
+       << ", busy " << PrettyDuration(timing.busy_ns) << " (" << utilization << "% of "
+       << thread_count_ << " threads)"
+       << ", tail " << PrettyDuration(timing.tail_ns);
+    if (!timing.longest_work_item.empty()) {
+      os << ", longest " << timing.longest_work_item
+         << " " << PrettyDuration(timing.longest_work_item_ns);
+    }
+    os << "\n";
+  }
 }
 
 // Does the runtime for the InstructionSet provide an implementation returned by
@@ -2282,10 +2607,23 @@ void CompilerDriver::CompileMethod(Thread* self, const DexFile::CodeItem* code_i
                    has_verified_method &&
                    // Is eligable for compilation by methods-to-compile filter.
                    IsMethodToCompile(method_ref);
-    if (compile) {
+    if (compile && previous_compilation_ != nullptr) {
+      compiled_method = previous_compilation_->FindReusableMethod(
+          this, dex_file, class_def_idx, method_idx, access_flags, code_item);
+    }
+    std::string cache_key;
+    if (compile && compiled_method == nullptr && compilation_cache_ != nullptr) {
+      compilation_cache_->GetKey(dex_file, method_idx, access_flags, invoke_type, *code_item,
+                                 &cache_key);
+      compiled_method = compilation_cache_->Load(this, dex_file, cache_key);
+    }
+    if (compile && compiled_method == nullptr) {
       // NOTE: if compiler declines to compile this method, it will return null.
       compiled_method = compiler_->Compile(code_item, access_flags, invoke_type, class_def_idx,
                                            method_idx, class_loader, dex_file);
+      if (compiled_method != nullptr && !cache_key.empty()) {
+        compilation_cache_->Store(dex_file, cache_key, *compiled_method);
+      }
     }
     if (compiled_method == nullptr && dex_to_dex_compilation_level != kDontDexToDexCompile) {
       // TODO: add a command-line option to disable DEX-to-DEX compilation ?
@@ -2488,6 +2826,16 @@ bool CompilerDriver::SkipCompilation(const std::string& method_name) {
   return !compile;
 }
 
+bool CompilerDriver::IsHotMethod(const DexFile& dex_file, uint32_t method_idx) const {
+  return !hot_methods_.empty() &&
+      hot_methods_.find(PrettyMethod(method_idx, dex_file)) != hot_methods_.end();
+}
+
+bool CompilerDriver::IsHotMethod(ArtMethod* method) const {
+  return !hot_methods_.empty() &&
+      hot_methods_.find(PrettyMethod(method)) != hot_methods_.end();
+}
+
 std::string CompilerDriver::GetMemoryUsageString(bool extended) const {
   std::ostringstream oss;
   Runtime* const runtime = Runtime::Current();
@@ -2506,15 +2854,29 @@ std::string CompilerDriver::GetMemoryUsageString(bool extended) const {
     oss << " swap=" << PrettySize(swap_space_->GetSize());
   }
   if (extended) {
-    oss << "\nCode dedupe: " << dedupe_code_.DumpStats();
-    oss << "\nMapping table dedupe: " << dedupe_mapping_table_.DumpStats();
-    oss << "\nVmap table dedupe: " << dedupe_vmap_table_.DumpStats();
-    oss << "\nGC map dedupe: " << dedupe_gc_map_.DumpStats();
-    oss << "\nCFI info dedupe: " << dedupe_cfi_info_.DumpStats();
+    Thread* self = Thread::Current();
+    oss << "\nCode dedupe: " << dedupe_code_.DumpStats(self);
+    oss << "\nSrc mapping table dedupe: " << dedupe_src_mapping_table_.DumpStats(self);
+    oss << "\nMapping table dedupe: " << dedupe_mapping_table_.DumpStats(self);
+    oss << "\nVmap table dedupe: " << dedupe_vmap_table_.DumpStats(self);
+    oss << "\nGC map dedupe: " << dedupe_gc_map_.DumpStats(self);
+    oss << "\nCFI info dedupe: " << dedupe_cfi_info_.DumpStats(self);
   }
   return oss.str();
 }
 
+void CompilerDriver::SetCompiledDataMemoryLimit(size_t limit) {
+  if (swap_space_.get() != nullptr) {
+    swap_space_->SetResidentLimit(limit);
+  }
+}
+
+void CompilerDriver::ReleaseCompiledDataMemory() const {
+  if (swap_space_.get() != nullptr && swap_space_->GetResidentLimit() != 0u) {
+    swap_space_->ReleaseResidentMemory();
+  }
+}
+
 bool CompilerDriver::IsStringTypeIndex(uint16_t type_index, const DexFile* dex_file) {
   const char* type = dex_file->GetTypeDescriptor(dex_file->GetTypeId(type_index));
   return strcmp(type, "Ljava/lang/String;") == 0;
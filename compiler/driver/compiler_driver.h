@@ -51,8 +51,10 @@ class DexCache;
 
 namespace verifier {
 class MethodVerifier;
+class VerifierDeps;
 }  // namespace verifier
 
+class CompilationCache;
 class CompiledClass;
 class CompiledMethod;
 class CompilerOptions;
@@ -62,6 +64,7 @@ struct InlineIGetIPutData;
 class InstructionSetFeatures;
 class OatWriter;
 class ParallelCompilationManager;
+class PreviousCompilation;
 class ScopedObjectAccess;
 template <class Allocator> class SrcMap;
 class SrcMapElem;
@@ -147,10 +150,20 @@ class CompilerDriver {
     return compiler_.get();
   }
 
+  Compiler::Kind GetCompilerKind() const {
+    return compiler_kind_;
+  }
+
   bool ProfilePresent() const {
     return profile_present_;
   }
 
+  // Returns true if the profile marks the method as hot, i.e. it is one of the most sampled
+  // methods that take the top K percent of the samples. The oat writer and the image writer
+  // place hot code and classes together.
+  bool IsHotMethod(const DexFile& dex_file, uint32_t method_idx) const;
+  bool IsHotMethod(ArtMethod* method) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   // Are we compiling and creating an image file?
   bool IsImage() const {
     return image_;
@@ -428,6 +441,42 @@ class CompilerDriver {
     return timings_logger_;
   }
 
+  // Reuse the code of unchanged methods from a previous compilation, if not null.
+  void SetPreviousCompilation(const PreviousCompilation* previous_compilation) {
+    previous_compilation_ = previous_compilation;
+  }
+
+  // Load the code of methods from and store it to an on-disk cache, if not null.
+  void SetCompilationCache(const CompilationCache* compilation_cache) {
+    compilation_cache_ = compilation_cache;
+  }
+
+  // Where the verifier records the lookups it relies on, written to the oat file if not null.
+  void SetVerifierDeps(verifier::VerifierDeps* verifier_deps) {
+    verifier_deps_ = verifier_deps;
+  }
+  const verifier::VerifierDeps* GetVerifierDeps() const {
+    return verifier_deps_;
+  }
+
+  // Accounts the work of a parallel phase run by a ParallelCompilationManager to `phase_name`.
+  // `capacity_ns` is the wall time multiplied by the number of threads and `tail_ns` the time
+  // between the first and the last thread running out of work.
+  void RecordParallelPhaseTiming(const char* phase_name,
+                                 uint64_t wall_ns,
+                                 uint64_t busy_ns,
+                                 uint64_t capacity_ns,
+                                 uint64_t tail_ns,
+                                 uint64_t longest_work_item_ns,
+                                 const std::string& longest_work_item);
+
+  // Dumps how well the threads of each parallel phase were kept busy.
+  void DumpParallelPhaseTimings(std::ostream& os) const;
+
+  // Returns true if the class does not need to be verified again because it verified
+  // without failures in the previous compilation and nothing it relies on has changed.
+  bool IsPreviouslyVerified(const DexFile& dex_file, uint16_t class_def_idx) const;
+
   void SetDedupeEnabled(bool dedupe_enabled) {
     dedupe_enabled_ = dedupe_enabled;
   }
@@ -466,6 +515,14 @@ class CompilerDriver {
   // Get memory usage during compilation.
   std::string GetMemoryUsageString(bool extended) const;
 
+  // Keep only about `limit` bytes of the compiled code and maps in memory and the rest only in
+  // the swap file. Has no effect without a swap file.
+  void SetCompiledDataMemoryLimit(size_t limit);
+
+  // If the compiled data memory is limited, drop the compiled data from memory until it is
+  // accessed again.
+  void ReleaseCompiledDataMemory() const;
+
   bool IsStringTypeIndex(uint16_t type_index, const DexFile* dex_file);
   bool IsStringInit(uint32_t method_index, const DexFile* dex_file, int32_t* offset);
 
@@ -566,6 +623,8 @@ class CompilerDriver {
 
   void Verify(jobject class_loader, const std::vector<const DexFile*>& dex_files,
               ThreadPool* thread_pool, TimingLogger* timings);
+  bool CanUsePreviousVerification(jobject class_loader, TimingLogger* timings)
+      LOCKS_EXCLUDED(Locks::mutator_lock_);
   void VerifyDexFile(jobject class_loader, const DexFile& dex_file,
                      const std::vector<const DexFile*>& dex_files,
                      ThreadPool* thread_pool, TimingLogger* timings)
@@ -603,7 +662,7 @@ class CompilerDriver {
                      bool compilation_enabled)
       LOCKS_EXCLUDED(compiled_methods_lock_);
 
-  static void CompileClass(const ParallelCompilationManager* context, size_t class_def_index)
+  static void CompileWorkItem(const ParallelCompilationManager* context, size_t work_item_index)
       LOCKS_EXCLUDED(Locks::mutator_lock_);
 
   // Swap pool and allocator used for native allocations. May be file-backed. Needs to be first
@@ -613,6 +672,8 @@ class CompilerDriver {
 
   ProfileFile profile_file_;
   bool profile_present_;
+  // The names of the hot methods of the profile, as by PrettyMethod().
+  std::set<std::string> hot_methods_;
 
   const CompilerOptions* const compiler_options_;
   VerificationResults* const verification_results_;
@@ -687,6 +748,26 @@ class CompilerDriver {
 
   bool support_boot_image_fixup_;
 
+  const PreviousCompilation* previous_compilation_;
+
+  const CompilationCache* compilation_cache_;
+
+  verifier::VerifierDeps* verifier_deps_;
+
+  // Whether the verification results of `previous_compilation_` are used.
+  bool use_previous_verification_;
+
+  struct ParallelPhaseTiming {
+    uint64_t wall_ns = 0u;
+    uint64_t busy_ns = 0u;
+    uint64_t capacity_ns = 0u;
+    uint64_t tail_ns = 0u;
+    uint64_t longest_work_item_ns = 0u;
+    std::string longest_work_item;
+  };
+  // Recorded by the thread driving the compilation, after the workers of a phase finished.
+  SafeMap<std::string, ParallelPhaseTiming> parallel_phase_timings_;
+
   // DeDuplication data structures, these own the corresponding byte arrays.
   template <typename ContentType>
   class DedupeHashFunc {
@@ -762,18 +843,22 @@ class CompilerDriver {
     }
   };
 
-  DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_code_;
-  DedupeSet<ArrayRef<SrcMapElem>,
-            SwapSrcMap, size_t, DedupeHashFunc<SrcMapElem>, 4> dedupe_src_mapping_table_;
-  DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_mapping_table_;
-  DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_vmap_table_;
-  DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_gc_map_;
-  DedupeSet<ArrayRef<const uint8_t>,
-            SwapVector<uint8_t>, size_t, DedupeHashFunc<const uint8_t>, 4> dedupe_cfi_info_;
+  // Number of independently locked shards of each dedupe set. Enough to keep the compiler
+  // threads from contending on the sets.
+  static constexpr size_t kDedupeShards = 16;
+
+  DedupeSet<ArrayRef<const uint8_t>, SwapVector<uint8_t>,
+            size_t, DedupeHashFunc<const uint8_t>, kDedupeShards> dedupe_code_;
+  DedupeSet<ArrayRef<SrcMapElem>, SwapSrcMap,
+            size_t, DedupeHashFunc<SrcMapElem>, kDedupeShards> dedupe_src_mapping_table_;
+  DedupeSet<ArrayRef<const uint8_t>, SwapVector<uint8_t>,
+            size_t, DedupeHashFunc<const uint8_t>, kDedupeShards> dedupe_mapping_table_;
+  DedupeSet<ArrayRef<const uint8_t>, SwapVector<uint8_t>,
+            size_t, DedupeHashFunc<const uint8_t>, kDedupeShards> dedupe_vmap_table_;
+  DedupeSet<ArrayRef<const uint8_t>, SwapVector<uint8_t>,
+            size_t, DedupeHashFunc<const uint8_t>, kDedupeShards> dedupe_gc_map_;
+  DedupeSet<ArrayRef<const uint8_t>, SwapVector<uint8_t>,
+            size_t, DedupeHashFunc<const uint8_t>, kDedupeShards> dedupe_cfi_info_;
 
   DISALLOW_COPY_AND_ASSIGN(CompilerDriver);
 };
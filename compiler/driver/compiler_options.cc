@@ -33,6 +33,7 @@ CompilerOptions::CompilerOptions()
       top_k_profile_threshold_(kDefaultTopKProfileThreshold),
       debuggable_(false),
       generate_debug_info_(kDefaultGenerateDebugInfo),
+      generate_mini_debug_info_(kDefaultGenerateMiniDebugInfo),
       implicit_null_checks_(true),
       implicit_so_checks_(true),
       implicit_suspend_checks_(false),
@@ -60,6 +61,7 @@ CompilerOptions::CompilerOptions(CompilerFilter compiler_filter,
                                  double top_k_profile_threshold,
                                  bool debuggable,
                                  bool generate_debug_info,
+                                 bool generate_mini_debug_info,
                                  bool implicit_null_checks,
                                  bool implicit_so_checks,
                                  bool implicit_suspend_checks,
@@ -81,6 +83,7 @@ CompilerOptions::CompilerOptions(CompilerFilter compiler_filter,
     top_k_profile_threshold_(top_k_profile_threshold),
     debuggable_(debuggable),
     generate_debug_info_(generate_debug_info),
+    generate_mini_debug_info_(generate_mini_debug_info),
     implicit_null_checks_(implicit_null_checks),
     implicit_so_checks_(implicit_so_checks),
     implicit_suspend_checks_(implicit_suspend_checks),
@@ -50,6 +50,7 @@ class CompilerOptions FINAL {
   static const size_t kDefaultNumDexMethodsThreshold = 900;
   static constexpr double kDefaultTopKProfileThreshold = 90.0;
   static const bool kDefaultGenerateDebugInfo = kIsDebugBuild;
+  static const bool kDefaultGenerateMiniDebugInfo = false;
   static const bool kDefaultIncludePatchInformation = false;
   static const size_t kDefaultInlineDepthLimit = 5;
   static const size_t kDefaultInlineMaxCodeUnits = 100;
@@ -73,6 +74,7 @@ class CompilerOptions FINAL {
                   double top_k_profile_threshold,
                   bool debuggable,
                   bool generate_debug_info,
+                  bool generate_mini_debug_info,
                   bool implicit_null_checks,
                   bool implicit_so_checks,
                   bool implicit_suspend_checks,
@@ -165,6 +167,17 @@ class CompilerOptions FINAL {
     return generate_debug_info_;
   }
 
+  // Only stack unwinding information and ELF symbols, which is enough to symbolize
+  // native stack traces.
+  bool GetGenerateMiniDebugInfo() const {
+    return generate_mini_debug_info_;
+  }
+
+  // Should the compilers emit CFI and the oat writer record the code ranges of methods?
+  bool GetGenerateAnyDebugInfo() const {
+    return generate_debug_info_ || generate_mini_debug_info_;
+  }
+
   bool GetImplicitNullChecks() const {
     return implicit_null_checks_;
   }
@@ -225,6 +238,7 @@ class CompilerOptions FINAL {
   const double top_k_profile_threshold_;
   const bool debuggable_;
   const bool generate_debug_info_;
+  const bool generate_mini_debug_info_;
   const bool implicit_null_checks_;
   const bool implicit_so_checks_;
   const bool implicit_suspend_checks_;
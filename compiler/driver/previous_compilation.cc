@@ -0,0 +1,376 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "previous_compilation.h"
+
+#include <string.h>
+
+#include <set>
+
+#include "art_method.h"
+#include "base/stringprintf.h"
+#include "compiled_method.h"
+#include "dex_file-inl.h"
+#include "driver/code_description.h"
+#include "driver/compiler_driver.h"
+#include "driver/compiler_options.h"
+#include "gc/heap.h"
+#include "gc/space/image_space.h"
+#include "gc_map.h"
+#include "leb128.h"
+#include "oat_file-inl.h"
+#include "runtime.h"
+#include "stack_map.h"
+#include "utf.h"
+#include "utils.h"
+#include "verifier/verifier_deps.h"
+
+namespace art {
+
+static size_t MappingTableSize(const uint8_t* mapping_table) {
+  const uint8_t* ptr = mapping_table;
+  uint32_t total_size = DecodeUnsignedLeb128(&ptr);
+  DecodeUnsignedLeb128(&ptr);  // Skip the pc to dex size.
+  for (uint32_t i = 0; i < total_size; ++i) {
+    DecodeUnsignedLeb128(&ptr);  // Native pc offset.
+    DecodeSignedLeb128(&ptr);  // Dex pc delta.
+  }
+  return ptr - mapping_table;
+}
+
+static size_t VmapTableSize(const uint8_t* vmap_table) {
+  const uint8_t* ptr = vmap_table;
+  uint32_t size = DecodeUnsignedLeb128(&ptr);
+  for (uint32_t i = 0; i < size; ++i) {
+    DecodeUnsignedLeb128(&ptr);
+  }
+  return ptr - vmap_table;
+}
+
+PreviousCompilation* PreviousCompilation::Create(
+    const std::string& oat_filename,
+    const std::vector<const DexFile*>& dex_files,
+    const CompilerDriver& driver,
+    const SafeMap<std::string, std::string>& key_value_store,
+    std::string* error_msg) {
+  std::unique_ptr<const OatFile> oat_file(OatFile::Open(oat_filename, oat_filename, nullptr,
+                                                        nullptr, false, nullptr, error_msg));
+  if (oat_file == nullptr) {
+    return nullptr;
+  }
+  const std::vector<const OatDexFile*>& oat_dex_files = oat_file->GetOatDexFiles();
+  if (oat_dex_files.size() != dex_files.size()) {
+    *error_msg = StringPrintf("%s contains %zu dex files, expected %zu",
+                              oat_filename.c_str(), oat_dex_files.size(), dex_files.size());
+    return nullptr;
+  }
+  const uint8_t* verifier_deps_data = oat_file->GetVerifierDeps();
+  size_t verifier_deps_size = oat_file->GetVerifierDepsSize();
+
+  std::unique_ptr<PreviousCompilation> previous(
+      new PreviousCompilation(oat_filename, std::move(oat_file)));
+  std::vector<const DexFile*> previous_dex_files;
+  bool dex_files_unchanged = true;
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    std::unique_ptr<const DexFile> dex_file = oat_dex_files[i]->OpenDexFile(error_msg);
+    if (dex_file == nullptr) {
+      return nullptr;
+    }
+    dex_files_unchanged = dex_files_unchanged &&
+        oat_dex_files[i]->GetDexFileLocationChecksum() == dex_files[i]->GetLocationChecksum() &&
+        dex_file->GetHeader().checksum_ == dex_files[i]->GetHeader().checksum_;
+    previous_dex_files.push_back(dex_file.get());
+    previous->opened_dex_files_.push_back(std::move(dex_file));
+  }
+
+  if (dex_files_unchanged && verifier_deps_size != 0u) {
+    previous->verifier_deps_.reset(
+        verifier::VerifierDeps::Decode(dex_files, verifier_deps_data, verifier_deps_size));
+    if (previous->verifier_deps_ == nullptr) {
+      LOG(WARNING) << "Ignoring malformed verifier dependencies in " << oat_filename;
+    } else {
+      for (size_t i = 0; i != dex_files.size(); ++i) {
+        previous->oat_dex_files_.Put(dex_files[i], oat_dex_files[i]);
+      }
+    }
+  }
+
+  std::string reuse_error_msg;
+  if (previous->InitReusableDexFiles(dex_files, previous_dex_files, driver, key_value_store,
+                                     &reuse_error_msg)) {
+    return previous.release();
+  }
+  if (previous->verifier_deps_ != nullptr) {
+    LOG(WARNING) << "Not reusing compiled code from " << oat_filename << ": " << reuse_error_msg;
+    return previous.release();
+  }
+  *error_msg = reuse_error_msg;
+  return nullptr;
+}
+
+bool PreviousCompilation::InitReusableDexFiles(
+    const std::vector<const DexFile*>& dex_files,
+    const std::vector<const DexFile*>& previous_dex_files,
+    const CompilerDriver& driver,
+    const SafeMap<std::string, std::string>& key_value_store,
+    std::string* error_msg) {
+  const CompilerOptions& compiler_options = driver.GetCompilerOptions();
+  if (driver.IsImage() || compiler_options.GetIncludePatchInformation()) {
+    *error_msg = "Compiled code with linker patches cannot be reused";
+    return false;
+  }
+  if (compiler_options.GetGenerateAnyDebugInfo()) {
+    *error_msg = "The previous oat file does not contain the debug info of compiled code";
+    return false;
+  }
+
+  const OatHeader& oat_header = oat_file_->GetOatHeader();
+  if (oat_header.GetInstructionSet() != driver.GetInstructionSet() ||
+      oat_header.GetInstructionSetFeaturesBitmap() !=
+          driver.GetInstructionSetFeatures()->AsBitmap()) {
+    *error_msg = StringPrintf("%s was compiled for different instruction set features",
+                              location_.c_str());
+    return false;
+  }
+  const ImageHeader& image_header =
+      Runtime::Current()->GetHeap()->GetImageSpace()->GetImageHeader();
+  if (oat_header.GetImageFileLocationOatChecksum() != image_header.GetOatChecksum() ||
+      oat_header.GetImageFileLocationOatDataBegin() !=
+          reinterpret_cast<uintptr_t>(image_header.GetOatDataBegin()) ||
+      oat_header.GetImagePatchDelta() != image_header.GetPatchDelta()) {
+    *error_msg = StringPrintf("%s was compiled against a different boot image",
+                              location_.c_str());
+    return false;
+  }
+  for (const char* key : CodeGenerationKeys()) {
+    const char* previous_value = oat_header.GetStoreValueByKey(key);
+    auto it = key_value_store.find(key);
+    const char* value = (it != key_value_store.end()) ? it->second.c_str() : nullptr;
+    if ((previous_value == nullptr || value == nullptr)
+            ? previous_value != value
+            : strcmp(previous_value, value) != 0) {
+      *error_msg = StringPrintf("%s was compiled with a different %s", location_.c_str(), key);
+      return false;
+    }
+  }
+
+  // Compare the class declarations one by one. Only the first definition of a class is used.
+  size_t max_inlined_code_units = MaxInlinedCodeUnits(compiler_options);
+  std::unordered_map<std::string, std::string> previous_declarations;
+  for (const DexFile* previous_dex_file : previous_dex_files) {
+    for (size_t i = 0; i < previous_dex_file->NumClassDefs(); ++i) {
+      const DexFile::ClassDef& class_def = previous_dex_file->GetClassDef(i);
+      const char* descriptor = previous_dex_file->GetClassDescriptor(class_def);
+      if (previous_declarations.find(descriptor) == previous_declarations.end()) {
+        DescribeClassDeclaration(*previous_dex_file, class_def, max_inlined_code_units,
+                                 &previous_declarations[descriptor]);
+      }
+    }
+  }
+  size_t num_unchanged_classes = 0u;
+  for (const DexFile* dex_file : dex_files) {
+    for (size_t i = 0; i < dex_file->NumClassDefs(); ++i) {
+      const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
+      const char* descriptor = dex_file->GetClassDescriptor(class_def);
+      if (classes_.find(descriptor) != classes_.end()) {
+        continue;
+      }
+      std::string declaration;
+      DescribeClassDeclaration(*dex_file, class_def, max_inlined_code_units, &declaration);
+      auto previous_it = previous_declarations.find(descriptor);
+      bool changed =
+          previous_it == previous_declarations.end() || previous_it->second != declaration;
+      std::set<std::string> references;
+      CollectDeclarationReferences(*dex_file, class_def, max_inlined_code_units, &references);
+      ClassInfo& info = classes_[descriptor];
+      info.changed = changed;
+      info.references.assign(references.begin(), references.end());
+      if (!changed) {
+        ++num_unchanged_classes;
+      }
+    }
+  }
+  // Classes that were removed since may have been used by the previous code.
+  for (const auto& entry : previous_declarations) {
+    if (classes_.find(entry.first) == classes_.end()) {
+      classes_[entry.first].changed = true;
+    }
+  }
+  if (num_unchanged_classes == 0u) {
+    *error_msg = StringPrintf("All classes have changed since %s was compiled",
+                              location_.c_str());
+    return false;
+  }
+
+  const std::vector<const OatDexFile*>& oat_dex_files = oat_file_->GetOatDexFiles();
+  for (size_t i = 0; i != dex_files.size(); ++i) {
+    dex_files_.Put(dex_files[i], PreviousDexFile { previous_dex_files[i], oat_dex_files[i] });
+  }
+  return true;
+}
+
+bool PreviousCompilation::DependenciesUnchanged(const DexFile& dex_file,
+                                                const char* descriptor,
+                                                const DexFile::CodeItem& code_item) const {
+  std::set<std::string> visited;
+  std::vector<std::string> worklist;
+  {
+    std::set<std::string> references;
+    AddClassReference(descriptor, &references);
+    CollectClassReferences(dex_file, code_item, &references);
+    worklist.assign(references.begin(), references.end());
+  }
+  while (!worklist.empty()) {
+    std::string reference = std::move(worklist.back());
+    worklist.pop_back();
+    auto it = classes_.find(reference);
+    if (!visited.insert(std::move(reference)).second || it == classes_.end()) {
+      continue;  // Already checked, or a class path class covered by the oat header checks.
+    }
+    if (it->second.changed) {
+      return false;
+    }
+    for (const std::string& next : it->second.references) {
+      if (visited.find(next) == visited.end()) {
+        worklist.push_back(next);
+      }
+    }
+  }
+  return true;
+}
+
+mirror::Class::Status PreviousCompilation::GetClassStatus(const DexFile& dex_file,
+                                                          uint16_t class_def_idx) const {
+  auto it = oat_dex_files_.find(&dex_file);
+  if (it == oat_dex_files_.end()) {
+    return mirror::Class::kStatusNotReady;
+  }
+  return it->second->GetOatClass(class_def_idx).GetStatus();
+}
+
+PreviousCompilation::PreviousCompilation(const std::string& location,
+                                         std::unique_ptr<const OatFile> oat_file)
+    : location_(location),
+      oat_file_(std::move(oat_file)),
+      num_reused_methods_(0u) {
+}
+
+PreviousCompilation::~PreviousCompilation() {
+}
+
+CompiledMethod* PreviousCompilation::FindReusableMethod(CompilerDriver* driver,
+                                                        const DexFile& dex_file,
+                                                        uint16_t class_def_idx,
+                                                        uint32_t method_idx,
+                                                        uint32_t access_flags,
+                                                        const DexFile::CodeItem* code_item) const {
+  auto it = dex_files_.find(&dex_file);
+  if (it == dex_files_.end() || code_item == nullptr) {
+    return nullptr;
+  }
+  const DexFile& previous_dex_file = *it->second.dex_file;
+  const DexFile::ClassDef& class_def = dex_file.GetClassDef(class_def_idx);
+  const char* descriptor = dex_file.GetClassDescriptor(class_def);
+  if (!DependenciesUnchanged(dex_file, descriptor, *code_item)) {
+    return nullptr;
+  }
+
+  // The class declaration is unchanged, so the previous class declares the same methods
+  // in the same order, although their indices may differ.
+  const DexFile::ClassDef* previous_class_def =
+      previous_dex_file.FindClassDef(descriptor, ComputeModifiedUtf8Hash(descriptor));
+  if (previous_class_def == nullptr) {
+    return nullptr;  // Moved to another dex file.
+  }
+  const uint8_t* class_data = dex_file.GetClassData(class_def);
+  const uint8_t* previous_class_data = previous_dex_file.GetClassData(*previous_class_def);
+  if (class_data == nullptr || previous_class_data == nullptr) {
+    return nullptr;
+  }
+  ClassDataItemIterator class_it(dex_file, class_data);
+  ClassDataItemIterator previous_class_it(previous_dex_file, previous_class_data);
+  while (class_it.HasNextStaticField() || class_it.HasNextInstanceField()) {
+    class_it.Next();
+    previous_class_it.Next();
+  }
+  size_t class_def_method_index = 0u;
+  const DexFile::CodeItem* previous_code_item = nullptr;
+  for (; class_it.HasNextDirectMethod() || class_it.HasNextVirtualMethod(); class_it.Next()) {
+    DCHECK(previous_class_it.HasNextDirectMethod() || previous_class_it.HasNextVirtualMethod());
+    if (class_it.GetMemberIndex() == method_idx) {
+      if (previous_class_it.GetMethodAccessFlags() == access_flags) {
+        previous_code_item = previous_class_it.GetMethodCodeItem();
+      }
+      break;
+    }
+    previous_class_it.Next();
+    ++class_def_method_index;
+  }
+  if (previous_code_item == nullptr) {
+    return nullptr;
+  }
+  std::string previous_code;
+  std::string code;
+  DescribeCodeItem(previous_dex_file, *previous_code_item, &previous_code);
+  DescribeCodeItem(dex_file, *code_item, &code);
+  if (previous_code != code) {
+    return nullptr;
+  }
+
+  const OatFile::OatClass oat_class = it->second.oat_dex_file->GetOatClass(
+      previous_dex_file.GetIndexForClassDef(*previous_class_def));
+  const OatFile::OatMethod oat_method = oat_class.GetOatMethod(class_def_method_index);
+  const uint8_t* quick_code = reinterpret_cast<const uint8_t*>(
+      ArtMethod::EntryPointToCodePointer(oat_method.GetQuickCode()));
+  if (quick_code == nullptr) {
+    return nullptr;
+  }
+  const uint8_t* mapping_table = oat_method.GetMappingTable();
+  const uint8_t* vmap_table = oat_method.GetVmapTable();
+  const uint8_t* gc_map = oat_method.GetGcMap();
+  size_t vmap_table_size = 0u;
+  if (vmap_table != nullptr) {
+    // Like ArtMethod::IsOptimized(), the absence of a GC map tells that the vmap
+    // table holds the stack maps of the optimizing compiler.
+    vmap_table_size = (gc_map == nullptr) ? CodeInfo(vmap_table).GetOverallSize()
+                                          : VmapTableSize(vmap_table);
+  }
+  // The compilers emit ARM code as Thumb2.
+  InstructionSet instruction_set =
+      (driver->GetInstructionSet() == kArm) ? kThumb2 : driver->GetInstructionSet();
+
+  CompiledMethod* compiled_method = CompiledMethod::SwapAllocCompiledMethod(
+      driver,
+      instruction_set,
+      ArrayRef<const uint8_t>(quick_code, oat_method.GetQuickCodeSize()),
+      oat_method.GetFrameSizeInBytes(),
+      oat_method.GetCoreSpillMask(),
+      oat_method.GetFpSpillMask(),
+      nullptr,
+      ArrayRef<const uint8_t>(mapping_table,
+                              (mapping_table != nullptr) ? MappingTableSize(mapping_table) : 0u),
+      ArrayRef<const uint8_t>(vmap_table, vmap_table_size),
+      ArrayRef<const uint8_t>(gc_map,
+                              (gc_map != nullptr)
+                                  ? NativePcOffsetToReferenceMap(gc_map).SizeInBytes()
+                                  : 0u),
+      ArrayRef<const uint8_t>(),
+      ArrayRef<const LinkerPatch>());
+  num_reused_methods_.FetchAndAddSequentiallyConsistent(1u);
+  return compiled_method;
+}
+
+}  // namespace art
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DRIVER_PREVIOUS_COMPILATION_H_
+#define ART_COMPILER_DRIVER_PREVIOUS_COMPILATION_H_
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+#include "dex_file.h"
+#include "mirror/class.h"
+#include "safe_map.h"
+
+namespace art {
+
+class CompiledMethod;
+class CompilerDriver;
+class OatDexFile;
+class OatFile;
+
+namespace verifier {
+class VerifierDeps;
+}  // namespace verifier
+
+// The oat file produced by an earlier compilation of the same dex files, used to
+// reuse the compiled code of methods that have not changed since.
+//
+// Compiled code depends on more than the method's own code item: on the layout of
+// the classes it uses, on the bodies of the methods it inlines and on the meaning
+// of the dex file indices it embeds. Code is therefore only reused when:
+//  - the compilation settings that influence generated code match, as well as the
+//    boot image and class path the code was compiled against,
+//  - the declarations of the method's class and of the classes its code uses,
+//    directly or through the classes they use, are unchanged, including their
+//    static values and the bodies of their inlinable methods, and
+//  - the method's code item is unchanged, including what its indices refer to.
+// Classes are compared one by one, so changing a class only prevents reusing the
+// code that depends on it, even if other ids in its dex file moved.
+// Compiled code does not record its linker patches in the oat file, so reuse is
+// limited to compilations that do not produce any, i.e. non-image compilations
+// without patch information.
+//
+// If none of the dex files has changed, the verification results of the previous
+// compilation can be reused as well, provided that the lookups recorded in its
+// verifier dependencies still give the same results. This does not depend on the
+// boot image, so it also applies after the boot class path was updated.
+class PreviousCompilation {
+ public:
+  // Returns null and sets `error_msg` if neither the code nor the verification
+  // results in `oat_filename` can be reused for compiling `dex_files` with `driver`.
+  static PreviousCompilation* Create(const std::string& oat_filename,
+                                     const std::vector<const DexFile*>& dex_files,
+                                     const CompilerDriver& driver,
+                                     const SafeMap<std::string, std::string>& key_value_store,
+                                     std::string* error_msg);
+
+  ~PreviousCompilation();
+
+  // Returns a copy of the previously compiled code for the method, or null if it
+  // was not compiled or cannot be reused. Thread-safe.
+  CompiledMethod* FindReusableMethod(CompilerDriver* driver,
+                                     const DexFile& dex_file,
+                                     uint16_t class_def_idx,
+                                     uint32_t method_idx,
+                                     uint32_t access_flags,
+                                     const DexFile::CodeItem* code_item) const;
+
+  // Returns the verifier dependencies of the previous compilation, or null if the
+  // dex files have changed since or none were recorded.
+  const verifier::VerifierDeps* GetVerifierDeps() const {
+    return verifier_deps_.get();
+  }
+
+  // Returns the status the class had after the previous compilation. Only known if
+  // GetVerifierDeps() is not null.
+  mirror::Class::Status GetClassStatus(const DexFile& dex_file, uint16_t class_def_idx) const;
+
+  const std::string& GetLocation() const {
+    return location_;
+  }
+
+  size_t GetNumberOfReusedMethods() const {
+    return num_reused_methods_.LoadRelaxed();
+  }
+
+ private:
+  // A previously compiled dex file that may provide code for a current one.
+  struct PreviousDexFile {
+    const DexFile* dex_file;
+    const OatDexFile* oat_dex_file;
+  };
+
+  struct ClassInfo {
+    // Whether the declaration differs from the previous one, see DescribeClassDeclaration().
+    bool changed;
+    // Descriptors of the classes that the declaration and the inlinable method bodies use.
+    std::vector<std::string> references;
+  };
+
+  PreviousCompilation(const std::string& location, std::unique_ptr<const OatFile> oat_file);
+
+  // Fills `dex_files_` and `classes_`. Returns false and sets `error_msg` if no code
+  // can be reused.
+  bool InitReusableDexFiles(const std::vector<const DexFile*>& dex_files,
+                            const std::vector<const DexFile*>& previous_dex_files,
+                            const CompilerDriver& driver,
+                            const SafeMap<std::string, std::string>& key_value_store,
+                            std::string* error_msg);
+
+  // Returns whether the compiled code of `code_item` in class `descriptor` only depends
+  // on classes whose declarations are unchanged.
+  bool DependenciesUnchanged(const DexFile& dex_file,
+                             const char* descriptor,
+                             const DexFile::CodeItem& code_item) const;
+
+  std::string location_;
+  std::unique_ptr<const OatFile> oat_file_;
+  std::vector<std::unique_ptr<const DexFile>> opened_dex_files_;
+
+  // The previous dex files, keyed by the current dex file at the same position.
+  SafeMap<const DexFile*, PreviousDexFile> dex_files_;
+
+  // The classes defined by the current or the previous dex files, keyed by descriptor.
+  std::unordered_map<std::string, ClassInfo> classes_;
+
+  // Set if all dex files are unchanged.
+  std::unique_ptr<const verifier::VerifierDeps> verifier_deps_;
+  SafeMap<const DexFile*, const OatDexFile*> oat_dex_files_;
+
+  mutable Atomic<size_t> num_reused_methods_;
+
+  DISALLOW_COPY_AND_ASSIGN(PreviousCompilation);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DRIVER_PREVIOUS_COMPILATION_H_
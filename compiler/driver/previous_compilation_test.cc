@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "driver/previous_compilation.h"
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common_compiler_test.h"
+#include "compiled_method.h"
+#include "dex/pass_manager.h"
+#include "driver/compiler_driver.h"
+#include "driver/compiler_options.h"
+#include "gc/heap.h"
+#include "gc/space/image_space.h"
+#include "oat.h"
+#include "oat_writer.h"
+#include "safe_map.h"
+#include "scoped_thread_state_change.h"
+#include "utf.h"
+
+namespace art {
+
+class PreviousCompilationTest : public CommonCompilerTest {
+ protected:
+  void SetUp() OVERRIDE {
+    CommonCompilerTest::SetUp();
+    // Compiled code is only reused by compilations without debug info that do not
+    // produce an image, unlike the ones CommonCompilerTest sets up.
+    reuse_compiler_options_.reset(new CompilerOptions(
+        CompilerOptions::kDefaultCompilerFilter,
+        CompilerOptions::kDefaultHugeMethodThreshold,
+        CompilerOptions::kDefaultLargeMethodThreshold,
+        CompilerOptions::kDefaultSmallMethodThreshold,
+        CompilerOptions::kDefaultTinyMethodThreshold,
+        CompilerOptions::kDefaultNumDexMethodsThreshold,
+        CompilerOptions::kDefaultInlineDepthLimit,
+        CompilerOptions::kDefaultInlineMaxCodeUnits,
+        false,
+        CompilerOptions::kDefaultTopKProfileThreshold,
+        false,
+        false,
+        false,
+        true,
+        true,
+        false,
+        false,
+        nullptr,
+        new PassManagerOptions(),
+        nullptr,
+        false));
+    compiler_driver_.reset(new CompilerDriver(reuse_compiler_options_.get(),
+                                              verification_results_.get(),
+                                              method_inliner_map_.get(),
+                                              Compiler::kQuick, kRuntimeISA,
+                                              instruction_set_features_.get(),
+                                              false, nullptr, nullptr, nullptr,
+                                              2, true, true, "", timer_.get(), -1, ""));
+    compiler_driver_->SetSupportBootImageFixup(false);
+
+    key_value_store_.Put(OatHeader::kPicKey, "false");
+    key_value_store_.Put(OatHeader::kDebuggableKey, "false");
+  }
+
+  void TearDown() OVERRIDE {
+    compiler_driver_.reset();
+    reuse_compiler_options_.reset();
+    CommonCompilerTest::TearDown();
+  }
+
+  // Compiles the dex files of the MultiDex test into `oat_file`.
+  void CompileMultiDex(File* oat_file) {
+    jobject class_loader;
+    {
+      ScopedObjectAccess soa(Thread::Current());
+      class_loader = LoadDex("MultiDex");
+    }
+    dex_files_ = GetDexFiles(class_loader);
+    ASSERT_EQ(2u, dex_files_.size());
+
+    TimingLogger timings("PreviousCompilationTest::CompileMultiDex", false, false);
+    compiler_driver_->CompileAll(class_loader, dex_files_, &timings);
+    // The previous code is only reused when compiling against the same boot image.
+    const ImageHeader& image_header =
+        Runtime::Current()->GetHeap()->GetImageSpace()->GetImageHeader();
+    OatWriter oat_writer(dex_files_,
+                         image_header.GetOatChecksum(),
+                         reinterpret_cast<uintptr_t>(image_header.GetOatDataBegin()),
+                         image_header.GetPatchDelta(),
+                         compiler_driver_.get(),
+                         nullptr,
+                         &timings,
+                         &key_value_store_);
+    ASSERT_TRUE(compiler_driver_->WriteElf(GetTestAndroidRoot(),
+                                           !kIsTargetBuild,
+                                           dex_files_,
+                                           &oat_writer,
+                                           oat_file));
+  }
+
+  // Returns the previous code of the direct method `name` of class Main in the primary
+  // dex file of `dex_files`.
+  CompiledMethod* FindReusableMainMethod(const PreviousCompilation& previous,
+                                         const std::vector<const DexFile*>& dex_files,
+                                         const char* name) {
+    const DexFile& dex_file = *dex_files[0];
+    const DexFile::ClassDef* class_def =
+        dex_file.FindClassDef("LMain;", ComputeModifiedUtf8Hash("LMain;"));
+    CHECK(class_def != nullptr);
+    const uint8_t* class_data = dex_file.GetClassData(*class_def);
+    CHECK(class_data != nullptr);
+    ClassDataItemIterator it(dex_file, class_data);
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (; it.HasNextDirectMethod(); it.Next()) {
+      const DexFile::MethodId& method_id = dex_file.GetMethodId(it.GetMemberIndex());
+      if (strcmp(dex_file.GetMethodName(method_id), name) == 0) {
+        return previous.FindReusableMethod(compiler_driver_.get(),
+                                           dex_file,
+                                           dex_file.GetIndexForClassDef(*class_def),
+                                           it.GetMemberIndex(),
+                                           it.GetMethodAccessFlags(),
+                                           it.GetMethodCodeItem());
+      }
+    }
+    LOG(FATAL) << "Main." << name << "() not found in " << dex_file.GetLocation();
+    UNREACHABLE();
+  }
+
+  std::unique_ptr<CompilerOptions> reuse_compiler_options_;
+  SafeMap<std::string, std::string> key_value_store_;
+  std::vector<const DexFile*> dex_files_;
+};
+
+TEST_F(PreviousCompilationTest, ReusedWhenUnchanged) {
+  ScratchFile oat_file;
+  CompileMultiDex(oat_file.GetFile());
+
+  std::string error_msg;
+  std::unique_ptr<PreviousCompilation> previous(PreviousCompilation::Create(
+      oat_file.GetFilename(), dex_files_, *compiler_driver_, key_value_store_, &error_msg));
+  ASSERT_TRUE(previous != nullptr) << error_msg;
+
+  CompiledMethod* compiled_method = FindReusableMainMethod(*previous, dex_files_, "main");
+  ASSERT_TRUE(compiled_method != nullptr);
+  EXPECT_NE(0u, compiled_method->GetQuickCode()->size());
+  EXPECT_EQ(1u, previous->GetNumberOfReusedMethods());
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), compiled_method);
+}
+
+TEST_F(PreviousCompilationTest, RejectedWhenCodeGenerationKeyDiffers) {
+  ScratchFile oat_file;
+  CompileMultiDex(oat_file.GetFile());
+
+  // Debuggable code must not be replaced by code that was compiled otherwise.
+  SafeMap<std::string, std::string> key_value_store(key_value_store_);
+  key_value_store.Overwrite(OatHeader::kDebuggableKey, "true");
+  std::string error_msg;
+  std::unique_ptr<PreviousCompilation> previous(PreviousCompilation::Create(
+      oat_file.GetFilename(), dex_files_, *compiler_driver_, key_value_store, &error_msg));
+  EXPECT_TRUE(previous == nullptr);
+  EXPECT_NE(std::string::npos, error_msg.find(OatHeader::kDebuggableKey)) << error_msg;
+}
+
+TEST_F(PreviousCompilationTest, RejectedWhenUsedClassDiffers) {
+  ScratchFile oat_file;
+  CompileMultiDex(oat_file.GetFile());
+
+  // The secondary dex file declares an additional method in class Second, which adds a
+  // method id. Main.main() itself is unchanged, but it uses Second and may have inlined
+  // its methods, so its code is not reused. The constructor of Main does not use
+  // Second, so its code is.
+  std::vector<std::unique_ptr<const DexFile>> modified_dex_files =
+      OpenTestDexFiles("MultiDexModifiedSecondary");
+  std::vector<const DexFile*> dex_files;
+  for (const std::unique_ptr<const DexFile>& dex_file : modified_dex_files) {
+    dex_files.push_back(dex_file.get());
+  }
+  ASSERT_EQ(dex_files_.size(), dex_files.size());
+  std::string error_msg;
+  std::unique_ptr<PreviousCompilation> previous(PreviousCompilation::Create(
+      oat_file.GetFilename(), dex_files, *compiler_driver_, key_value_store_, &error_msg));
+  ASSERT_TRUE(previous != nullptr) << error_msg;
+
+  EXPECT_TRUE(FindReusableMainMethod(*previous, dex_files, "main") == nullptr);
+  CompiledMethod* compiled_method = FindReusableMainMethod(*previous, dex_files, "<init>");
+  ASSERT_TRUE(compiled_method != nullptr);
+  EXPECT_EQ(1u, previous->GetNumberOfReusedMethods());
+  CompiledMethod::ReleaseSwapAllocatedCompiledMethod(compiler_driver_.get(), compiled_method);
+}
+
+}  // namespace art
@@ -18,6 +18,7 @@
 
 #include <unordered_set>
 
+#include "atomic.h"
 #include "base/casts.h"
 #include "compiled_method.h"
 #include "driver/compiler_driver.h"
@@ -25,6 +26,8 @@
 #include "dwarf/headers.h"
 #include "dwarf/register.h"
 #include "oat_writer.h"
+#include "thread.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 namespace art {
@@ -223,6 +226,197 @@ void WriteCFISection(const CompilerDriver* compiler,
   }
 }
 
+// A compilation unit with the parts of its .debug_info and .debug_line entries that
+// do not depend on the other compilation units, so that they can be built concurrently.
+struct DebugCompilationUnit {
+  std::vector<const OatWriter::DebugInfo*> methods;
+  uint32_t low_pc = 0xFFFFFFFFU;
+  uint32_t high_pc = 0;
+  std::vector<std::string> method_names;
+  std::vector<std::string> directories;
+  std::vector<FileEntry> files;
+  std::unique_ptr<DebugLineOpCodeWriter<>> line_opcodes;
+};
+
+static void PrepareCompilationUnit(InstructionSet isa,
+                                   const std::unordered_set<uint32_t>& deduped_addresses,
+                                   DebugCompilationUnit* compilation_unit) {
+  for (auto method_info : compilation_unit->methods) {
+    compilation_unit->low_pc = std::min(compilation_unit->low_pc, method_info->low_pc_);
+    compilation_unit->high_pc = std::max(compilation_unit->high_pc, method_info->high_pc_);
+    std::string method_name = PrettyMethod(method_info->dex_method_index_,
+                                           *method_info->dex_file_, true);
+    if (deduped_addresses.find(method_info->low_pc_) != deduped_addresses.end()) {
+      method_name += " [DEDUPED]";
+    }
+    compilation_unit->method_names.push_back(std::move(method_name));
+  }
+
+  // Generate the line table.
+  std::vector<FileEntry>& files = compilation_unit->files;
+  std::unordered_map<std::string, size_t> files_map;
+  std::vector<std::string>& directories = compilation_unit->directories;
+  std::unordered_map<std::string, size_t> directories_map;
+  int code_factor_bits_ = 0;
+  int dwarf_isa = -1;
+  switch (isa) {
+    case kArm:  // arm actually means thumb2.
+    case kThumb2:
+      code_factor_bits_ = 1;  // 16-bit instuctions
+      dwarf_isa = 1;  // DW_ISA_ARM_thumb.
+      break;
+    case kArm64:
+    case kMips:
+    case kMips64:
+      code_factor_bits_ = 2;  // 32-bit instructions
+      break;
+    case kNone:
+    case kX86:
+    case kX86_64:
+      break;
+  }
+  compilation_unit->line_opcodes.reset(
+      new DebugLineOpCodeWriter<>(Is64BitInstructionSet(isa), code_factor_bits_));
+  DebugLineOpCodeWriter<>& opcodes = *compilation_unit->line_opcodes;
+  opcodes.SetAddress(compilation_unit->low_pc);
+  if (dwarf_isa != -1) {
+    opcodes.SetISA(dwarf_isa);
+  }
+  for (const OatWriter::DebugInfo* mi : compilation_unit->methods) {
+    struct DebugInfoCallbacks {
+      static bool NewPosition(void* ctx, uint32_t address, uint32_t line) {
+        auto* context = reinterpret_cast<DebugInfoCallbacks*>(ctx);
+        context->dex2line_.push_back({address, static_cast<int32_t>(line)});
+        return false;
+      }
+      DefaultSrcMap dex2line_;
+    } debug_info_callbacks;
+
+    const DexFile* dex = mi->dex_file_;
+    if (mi->code_item_ != nullptr) {
+      dex->DecodeDebugInfo(mi->code_item_,
+                           (mi->access_flags_ & kAccStatic) != 0,
+                           mi->dex_method_index_,
+                           DebugInfoCallbacks::NewPosition,
+                           nullptr,
+                           &debug_info_callbacks);
+    }
+
+    // Get and deduplicate directory and filename.
+    int file_index = 0;  // 0 - primary source file of the compilation.
+    auto& dex_class_def = dex->GetClassDef(mi->class_def_index_);
+    const char* source_file = dex->GetSourceFile(dex_class_def);
+    if (source_file != nullptr) {
+      std::string file_name(source_file);
+      size_t file_name_slash = file_name.find_last_of('/');
+      std::string class_name(dex->GetClassDescriptor(dex_class_def));
+      size_t class_name_slash = class_name.find_last_of('/');
+      std::string full_path(file_name);
+
+      // Guess directory from package name.
+      int directory_index = 0;  // 0 - current directory of the compilation.
+      if (file_name_slash == std::string::npos &&  // Just filename.
+          class_name.front() == 'L' &&  // Type descriptor for a class.
+          class_name_slash != std::string::npos) {  // Has package name.
+        std::string package_name = class_name.substr(1, class_name_slash - 1);
+        auto it = directories_map.find(package_name);
+        if (it == directories_map.end()) {
+          directory_index = 1 + directories.size();
+          directories_map.emplace(package_name, directory_index);
+          directories.push_back(package_name);
+        } else {
+          directory_index = it->second;
+        }
+        full_path = package_name + "/" + file_name;
+      }
+
+      // Add file entry.
+      auto it2 = files_map.find(full_path);
+      if (it2 == files_map.end()) {
+        file_index = 1 + files.size();
+        files_map.emplace(full_path, file_index);
+        files.push_back(FileEntry {
+          file_name,
+          directory_index,
+          0,  // Modification time - NA.
+          0,  // File size - NA.
+        });
+      } else {
+        file_index = it2->second;
+      }
+    }
+    opcodes.SetFile(file_index);
+
+    // Generate mapping opcodes from PC to Java lines.
+    const DefaultSrcMap& dex2line_map = debug_info_callbacks.dex2line_;
+    if (file_index != 0 && !dex2line_map.empty()) {
+      bool first = true;
+      for (SrcMapElem pc2dex : mi->compiled_method_->GetSrcMappingTable()) {
+        uint32_t pc = pc2dex.from_;
+        int dex_pc = pc2dex.to_;
+        auto dex2line = dex2line_map.Find(static_cast<uint32_t>(dex_pc));
+        if (dex2line.first) {
+          int line = dex2line.second;
+          if (first) {
+            first = false;
+            if (pc > 0) {
+              // Assume that any preceding code is prologue.
+              int first_line = dex2line_map.front().to_;
+              // Prologue is not a sensible place for a breakpoint.
+              opcodes.NegateStmt();
+              opcodes.AddRow(mi->low_pc_, first_line);
+              opcodes.NegateStmt();
+              opcodes.SetPrologueEnd();
+            }
+            opcodes.AddRow(mi->low_pc_ + pc, line);
+          } else if (line != opcodes.CurrentLine()) {
+            opcodes.AddRow(mi->low_pc_ + pc, line);
+          }
+        }
+      }
+    } else {
+      // line 0 - instruction cannot be attributed to any source line.
+      opcodes.AddRow(mi->low_pc_, 0);
+    }
+  }
+  opcodes.AdvancePC(compilation_unit->high_pc);
+  opcodes.EndSequence();
+}
+
+// Prepares compilation units handed out through a shared index, so that threads that get
+// small units take more of them.
+class PrepareCompilationUnitsTask FINAL : public Task {
+ public:
+  PrepareCompilationUnitsTask(InstructionSet isa,
+                              const std::unordered_set<uint32_t>* deduped_addresses,
+                              std::vector<DebugCompilationUnit>* compilation_units,
+                              AtomicInteger* next_index)
+      : isa_(isa),
+        deduped_addresses_(deduped_addresses),
+        compilation_units_(compilation_units),
+        next_index_(next_index) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+    while (true) {
+      const size_t index = static_cast<size_t>(next_index_->FetchAndAddSequentiallyConsistent(1));
+      if (index >= compilation_units_->size()) {
+        break;
+      }
+      PrepareCompilationUnit(isa_, *deduped_addresses_, &(*compilation_units_)[index]);
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const InstructionSet isa_;
+  const std::unordered_set<uint32_t>* const deduped_addresses_;
+  std::vector<DebugCompilationUnit>* const compilation_units_;
+  AtomicInteger* const next_index_;
+};
+
 /*
  * @brief Generate the DWARF sections.
  * @param oat_writer The Oat file Writer.
@@ -233,6 +427,7 @@ void WriteCFISection(const CompilerDriver* compiler,
  * @param debug_str Debug strings.
  * @param debug_line Line number table.
  * @param debug_line_patches Address locations to be patched.
+ * @param thread_pool Runs the preparation of the compilation units.
  */
 void WriteDebugSections(const CompilerDriver* compiler,
                         const OatWriter* oat_writer,
@@ -241,7 +436,8 @@ void WriteDebugSections(const CompilerDriver* compiler,
                         std::vector<uint8_t>* debug_abbrev,
                         std::vector<uint8_t>* debug_str,
                         std::vector<uint8_t>* debug_line,
-                        std::vector<uintptr_t>* debug_line_patches) {
+                        std::vector<uintptr_t>* debug_line_patches,
+                        ThreadPool* thread_pool) {
   const std::vector<OatWriter::DebugInfo>& method_infos = oat_writer->GetMethodDebugInfo();
   const InstructionSet isa = compiler->GetInstructionSet();
   const bool is64bit = Is64BitInstructionSet(isa);
@@ -256,7 +452,7 @@ void WriteDebugSections(const CompilerDriver* compiler,
   }
 
   // Group the methods into compilation units based on source file.
-  std::vector<std::vector<const OatWriter::DebugInfo*>> compilation_units;
+  std::vector<DebugCompilationUnit> compilation_units;
   const char* last_source_file = nullptr;
   for (const auto& mi : method_infos) {
     // Attribute given instruction range only to single method.
@@ -265,38 +461,42 @@ void WriteDebugSections(const CompilerDriver* compiler,
       auto& dex_class_def = mi.dex_file_->GetClassDef(mi.class_def_index_);
       const char* source_file = mi.dex_file_->GetSourceFile(dex_class_def);
       if (compilation_units.empty() || source_file != last_source_file) {
-        compilation_units.push_back(std::vector<const OatWriter::DebugInfo*>());
+        compilation_units.push_back(DebugCompilationUnit());
       }
-      compilation_units.back().push_back(&mi);
+      compilation_units.back().methods.push_back(&mi);
       last_source_file = source_file;
     }
   }
 
-  // Write .debug_info section.
-  for (const auto& compilation_unit : compilation_units) {
-    uint32_t cunit_low_pc = 0xFFFFFFFFU;
-    uint32_t cunit_high_pc = 0;
-    for (auto method_info : compilation_unit) {
-      cunit_low_pc = std::min(cunit_low_pc, method_info->low_pc_);
-      cunit_high_pc = std::max(cunit_high_pc, method_info->high_pc_);
-    }
+  // Decoding the line numbers and naming the methods is the bulk of the work. Do it for all
+  // compilation units concurrently, together with the tasks the caller already added.
+  Thread* self = Thread::Current();
+  AtomicInteger next_index(0);
+  for (size_t i = 0, count = thread_pool->GetThreadCount() + 1u; i != count; ++i) {
+    thread_pool->AddTask(self, new PrepareCompilationUnitsTask(isa,
+                                                               &deduped_addresses,
+                                                               &compilation_units,
+                                                               &next_index));
+  }
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, false);
+  thread_pool->StopWorkers(self);
 
+  // Write .debug_info and .debug_line sections. The units' offsets in the sections and
+  // the shared abbreviations and strings make this serial.
+  for (const DebugCompilationUnit& compilation_unit : compilation_units) {
     size_t debug_abbrev_offset = debug_abbrev->size();
     DebugInfoEntryWriter<> info(is64bit, debug_abbrev);
     info.StartTag(DW_TAG_compile_unit, DW_CHILDREN_yes);
     info.WriteStrp(DW_AT_producer, "Android dex2oat", debug_str);
     info.WriteData1(DW_AT_language, DW_LANG_Java);
-    info.WriteAddr(DW_AT_low_pc, cunit_low_pc);
-    info.WriteAddr(DW_AT_high_pc, cunit_high_pc);
+    info.WriteAddr(DW_AT_low_pc, compilation_unit.low_pc);
+    info.WriteAddr(DW_AT_high_pc, compilation_unit.high_pc);
     info.WriteData4(DW_AT_stmt_list, debug_line->size());
-    for (auto method_info : compilation_unit) {
-      std::string method_name = PrettyMethod(method_info->dex_method_index_,
-                                             *method_info->dex_file_, true);
-      if (deduped_addresses.find(method_info->low_pc_) != deduped_addresses.end()) {
-        method_name += " [DEDUPED]";
-      }
+    for (size_t i = 0, size = compilation_unit.methods.size(); i != size; ++i) {
+      const OatWriter::DebugInfo* method_info = compilation_unit.methods[i];
       info.StartTag(DW_TAG_subprogram, DW_CHILDREN_no);
-      info.WriteStrp(DW_AT_name, method_name.data(), debug_str);
+      info.WriteStrp(DW_AT_name, compilation_unit.method_names[i].data(), debug_str);
       info.WriteAddr(DW_AT_low_pc, method_info->low_pc_);
       info.WriteAddr(DW_AT_high_pc, method_info->high_pc_);
       info.EndTag();  // DW_TAG_subprogram
@@ -304,134 +504,11 @@ void WriteDebugSections(const CompilerDriver* compiler,
     info.EndTag();  // DW_TAG_compile_unit
     WriteDebugInfoCU(debug_abbrev_offset, info, debug_info, debug_info_patches);
 
-    // Write .debug_line section.
-    std::vector<FileEntry> files;
-    std::unordered_map<std::string, size_t> files_map;
-    std::vector<std::string> directories;
-    std::unordered_map<std::string, size_t> directories_map;
-    int code_factor_bits_ = 0;
-    int dwarf_isa = -1;
-    switch (isa) {
-      case kArm:  // arm actually means thumb2.
-      case kThumb2:
-        code_factor_bits_ = 1;  // 16-bit instuctions
-        dwarf_isa = 1;  // DW_ISA_ARM_thumb.
-        break;
-      case kArm64:
-      case kMips:
-      case kMips64:
-        code_factor_bits_ = 2;  // 32-bit instructions
-        break;
-      case kNone:
-      case kX86:
-      case kX86_64:
-        break;
-    }
-    DebugLineOpCodeWriter<> opcodes(is64bit, code_factor_bits_);
-    opcodes.SetAddress(cunit_low_pc);
-    if (dwarf_isa != -1) {
-      opcodes.SetISA(dwarf_isa);
-    }
-    for (const OatWriter::DebugInfo* mi : compilation_unit) {
-      struct DebugInfoCallbacks {
-        static bool NewPosition(void* ctx, uint32_t address, uint32_t line) {
-          auto* context = reinterpret_cast<DebugInfoCallbacks*>(ctx);
-          context->dex2line_.push_back({address, static_cast<int32_t>(line)});
-          return false;
-        }
-        DefaultSrcMap dex2line_;
-      } debug_info_callbacks;
-
-      const DexFile* dex = mi->dex_file_;
-      if (mi->code_item_ != nullptr) {
-        dex->DecodeDebugInfo(mi->code_item_,
-                             (mi->access_flags_ & kAccStatic) != 0,
-                             mi->dex_method_index_,
-                             DebugInfoCallbacks::NewPosition,
-                             nullptr,
-                             &debug_info_callbacks);
-      }
-
-      // Get and deduplicate directory and filename.
-      int file_index = 0;  // 0 - primary source file of the compilation.
-      auto& dex_class_def = dex->GetClassDef(mi->class_def_index_);
-      const char* source_file = dex->GetSourceFile(dex_class_def);
-      if (source_file != nullptr) {
-        std::string file_name(source_file);
-        size_t file_name_slash = file_name.find_last_of('/');
-        std::string class_name(dex->GetClassDescriptor(dex_class_def));
-        size_t class_name_slash = class_name.find_last_of('/');
-        std::string full_path(file_name);
-
-        // Guess directory from package name.
-        int directory_index = 0;  // 0 - current directory of the compilation.
-        if (file_name_slash == std::string::npos &&  // Just filename.
-            class_name.front() == 'L' &&  // Type descriptor for a class.
-            class_name_slash != std::string::npos) {  // Has package name.
-          std::string package_name = class_name.substr(1, class_name_slash - 1);
-          auto it = directories_map.find(package_name);
-          if (it == directories_map.end()) {
-            directory_index = 1 + directories.size();
-            directories_map.emplace(package_name, directory_index);
-            directories.push_back(package_name);
-          } else {
-            directory_index = it->second;
-          }
-          full_path = package_name + "/" + file_name;
-        }
-
-        // Add file entry.
-        auto it2 = files_map.find(full_path);
-        if (it2 == files_map.end()) {
-          file_index = 1 + files.size();
-          files_map.emplace(full_path, file_index);
-          files.push_back(FileEntry {
-            file_name,
-            directory_index,
-            0,  // Modification time - NA.
-            0,  // File size - NA.
-          });
-        } else {
-          file_index = it2->second;
-        }
-      }
-      opcodes.SetFile(file_index);
-
-      // Generate mapping opcodes from PC to Java lines.
-      const DefaultSrcMap& dex2line_map = debug_info_callbacks.dex2line_;
-      if (file_index != 0 && !dex2line_map.empty()) {
-        bool first = true;
-        for (SrcMapElem pc2dex : mi->compiled_method_->GetSrcMappingTable()) {
-          uint32_t pc = pc2dex.from_;
-          int dex_pc = pc2dex.to_;
-          auto dex2line = dex2line_map.Find(static_cast<uint32_t>(dex_pc));
-          if (dex2line.first) {
-            int line = dex2line.second;
-            if (first) {
-              first = false;
-              if (pc > 0) {
-                // Assume that any preceding code is prologue.
-                int first_line = dex2line_map.front().to_;
-                // Prologue is not a sensible place for a breakpoint.
-                opcodes.NegateStmt();
-                opcodes.AddRow(mi->low_pc_, first_line);
-                opcodes.NegateStmt();
-                opcodes.SetPrologueEnd();
-              }
-              opcodes.AddRow(mi->low_pc_ + pc, line);
-            } else if (line != opcodes.CurrentLine()) {
-              opcodes.AddRow(mi->low_pc_ + pc, line);
-            }
-          }
-        }
-      } else {
-        // line 0 - instruction cannot be attributed to any source line.
-        opcodes.AddRow(mi->low_pc_, 0);
-      }
-    }
-    opcodes.AdvancePC(cunit_high_pc);
-    opcodes.EndSequence();
-    WriteDebugLineTable(directories, files, opcodes, debug_line, debug_line_patches);
+    WriteDebugLineTable(compilation_unit.directories,
+                        compilation_unit.files,
+                        *compilation_unit.line_opcodes,
+                        debug_line,
+                        debug_line_patches);
   }
 }
 
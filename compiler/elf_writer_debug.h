@@ -23,6 +23,9 @@
 #include "oat_writer.h"
 
 namespace art {
+
+class ThreadPool;
+
 namespace dwarf {
 
 void WriteCFISection(const CompilerDriver* compiler,
@@ -34,6 +37,8 @@ void WriteCFISection(const CompilerDriver* compiler,
                      std::vector<uint8_t>* eh_frame_hdr,
                      std::vector<uintptr_t>* eh_frame_hdr_patches);
 
+// Runs the workers of `thread_pool` until all of its tasks, including those added before the
+// call, are done.
 void WriteDebugSections(const CompilerDriver* compiler,
                         const OatWriter* oat_writer,
                         std::vector<uint8_t>* debug_info,
@@ -41,7 +46,8 @@ void WriteDebugSections(const CompilerDriver* compiler,
                         std::vector<uint8_t>* debug_abbrev,
                         std::vector<uint8_t>* debug_str,
                         std::vector<uint8_t>* debug_line,
-                        std::vector<uintptr_t>* debug_line_patches);
+                        std::vector<uintptr_t>* debug_line_patches,
+                        ThreadPool* thread_pool);
 
 }  // namespace dwarf
 }  // namespace art
@@ -34,6 +34,8 @@
 #include "leb128.h"
 #include "oat.h"
 #include "oat_writer.h"
+#include "thread.h"
+#include "thread_pool.h"
 #include "utils.h"
 
 namespace art {
@@ -67,7 +69,32 @@ bool ElfWriterQuick<ElfTypes>::Create(File* elf_file,
 }
 
 template <typename ElfTypes>
-static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder, OatWriter* oat_writer);
+static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder,
+                              OatWriter* oat_writer,
+                              bool mini_debug_info);
+
+// Runs a function, typically a lambda, on a thread pool.
+template <typename Function>
+class FunctionTask FINAL : public Task {
+ public:
+  explicit FunctionTask(const Function& function) : function_(function) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+    function_();
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  Function function_;
+};
+
+template <typename Function>
+static void AddFunctionTask(Thread* self, ThreadPool* thread_pool, const Function& function) {
+  thread_pool->AddTask(self, new FunctionTask<Function>(function));
+}
 
 // Encode patch locations as LEB128 list of deltas between consecutive addresses.
 template <typename ElfTypes>
@@ -190,38 +217,61 @@ bool ElfWriterQuick<ElfTypes>::Write(
       Patch<Elf_Addr, uint32_t, kAbsoluteAddress>, text));
   std::unique_ptr<RawSection> debug_line_oat_patches(new RawSection(
       ".debug_line.oat_patches", SHT_OAT_PATCH));
-  if (!oat_writer->GetMethodDebugInfo().empty()) {
-    if (compiler_driver_->GetCompilerOptions().GetGenerateDebugInfo()) {
-      // Generate CFI (stack unwinding information).
-      if (kCFIFormat == dwarf::DW_EH_FRAME_FORMAT) {
+  const CompilerOptions& compiler_options = compiler_driver_->GetCompilerOptions();
+  if (!oat_writer->GetMethodDebugInfo().empty() && compiler_options.GetGenerateAnyDebugInfo()) {
+    const bool mini_debug_info = !compiler_options.GetGenerateDebugInfo();
+    // The CFI, the symbols and the DWARF sections do not depend on each other,
+    // so generate them concurrently. The calling thread takes part as well.
+    Thread* self = Thread::Current();
+    ThreadPool thread_pool("ELF writer thread pool", compiler_driver_->GetThreadCount() - 1u);
+    // Generate CFI (stack unwinding information).
+    if (kCFIFormat == dwarf::DW_EH_FRAME_FORMAT) {
+      AddFunctionTask(self, &thread_pool, [&]() {
         dwarf::WriteCFISection(
             compiler_driver_, oat_writer,
             dwarf::DW_EH_PE_pcrel, kCFIFormat,
             eh_frame->GetBuffer(), eh_frame->GetPatchLocations(),
             eh_frame_hdr->GetBuffer(), eh_frame_hdr->GetPatchLocations());
-        builder->RegisterSection(eh_frame.get());
-        builder->RegisterSection(eh_frame_hdr.get());
-      } else {
-        DCHECK(kCFIFormat == dwarf::DW_DEBUG_FRAME_FORMAT);
+      });
+    } else {
+      DCHECK(kCFIFormat == dwarf::DW_DEBUG_FRAME_FORMAT);
+      AddFunctionTask(self, &thread_pool, [&]() {
         dwarf::WriteCFISection(
             compiler_driver_, oat_writer,
             dwarf::DW_EH_PE_absptr, kCFIFormat,
             debug_frame->GetBuffer(), debug_frame->GetPatchLocations(),
             nullptr, nullptr);
-        builder->RegisterSection(debug_frame.get());
-        EncodeOatPatches(*debug_frame->GetPatchLocations(),
-                         debug_frame_oat_patches->GetBuffer());
-        builder->RegisterSection(debug_frame_oat_patches.get());
-      }
-      // Add methods to .symtab.
-      WriteDebugSymbols(builder.get(), oat_writer);
-      // Generate DWARF .debug_* sections.
+      });
+    }
+    // Add methods to .symtab.
+    AddFunctionTask(self, &thread_pool, [&]() {
+      WriteDebugSymbols(builder.get(), oat_writer, mini_debug_info);
+    });
+    if (!mini_debug_info) {
+      // Generate DWARF .debug_* sections, running the tasks above along the way.
       dwarf::WriteDebugSections(
           compiler_driver_, oat_writer,
           debug_info->GetBuffer(), debug_info->GetPatchLocations(),
           debug_abbrev->GetBuffer(),
           debug_str->GetBuffer(),
-          debug_line->GetBuffer(), debug_line->GetPatchLocations());
+          debug_line->GetBuffer(), debug_line->GetPatchLocations(),
+          &thread_pool);
+    } else {
+      thread_pool.StartWorkers(self);
+      thread_pool.Wait(self, true, false);
+      thread_pool.StopWorkers(self);
+    }
+
+    if (kCFIFormat == dwarf::DW_EH_FRAME_FORMAT) {
+      builder->RegisterSection(eh_frame.get());
+      builder->RegisterSection(eh_frame_hdr.get());
+    } else {
+      builder->RegisterSection(debug_frame.get());
+      EncodeOatPatches(*debug_frame->GetPatchLocations(),
+                       debug_frame_oat_patches->GetBuffer());
+      builder->RegisterSection(debug_frame_oat_patches.get());
+    }
+    if (!mini_debug_info) {
       builder->RegisterSection(debug_info.get());
       EncodeOatPatches(*debug_info->GetPatchLocations(),
                        debug_info_oat_patches->GetBuffer());
@@ -249,8 +299,12 @@ bool ElfWriterQuick<ElfTypes>::Write(
   return builder->Write(elf_file_);
 }
 
+// With `mini_debug_info`, the symbols are method names without signatures, which keeps
+// .strtab small while still allowing stack traces to be symbolized.
 template <typename ElfTypes>
-static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder, OatWriter* oat_writer) {
+static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder,
+                              OatWriter* oat_writer,
+                              bool mini_debug_info) {
   const std::vector<OatWriter::DebugInfo>& method_info = oat_writer->GetMethodDebugInfo();
   bool generated_mapping_symbol = false;
 
@@ -268,8 +322,8 @@ static void WriteDebugSymbols(ElfBuilder<ElfTypes>* builder, OatWriter* oat_writ
     if (it->deduped_) {
       continue;  // Add symbol only for the first instance.
     }
-    std::string name = PrettyMethod(it->dex_method_index_, *it->dex_file_, true);
-    if (deduped_addresses.find(it->low_pc_) != deduped_addresses.end()) {
+    std::string name = PrettyMethod(it->dex_method_index_, *it->dex_file_, !mini_debug_info);
+    if (!mini_debug_info && deduped_addresses.find(it->low_pc_) != deduped_addresses.end()) {
       name += " [DEDUPED]";
     }
 
@@ -18,12 +18,14 @@
 
 #include <sys/stat.h>
 
+#include <algorithm>
 #include <memory>
 #include <numeric>
 #include <vector>
 
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "atomic.h"
 #include "base/logging.h"
 #include "base/unix_file/fd_file.h"
 #include "class_linker-inl.h"
@@ -57,6 +59,7 @@
 #include "oat_file.h"
 #include "runtime.h"
 #include "scoped_thread_state_change.h"
+#include "thread_pool.h"
 #include "handle_scope-inl.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 
@@ -176,9 +179,15 @@ bool ImageWriter::Write(const std::string& image_filename,
   CopyAndFixupNativeData();
   // TODO: heap validation can't handle these fix up passes.
   Runtime::Current()->GetHeap()->DisableObjectValidation();
-  CopyAndFixupObjects();
   Thread::Current()->TransitionFromRunnableToSuspended(kNative);
 
+  {
+    // The calling thread copies objects too.
+    size_t thread_count = compiler_driver_.GetThreadCount();
+    ThreadPool thread_pool("Image writer thread pool", thread_count - 1u);
+    CopyAndFixupObjects(&thread_pool);
+  }
+
   SetOatChecksumFromElfFile(oat_file.get());
 
   if (oat_file->FlushCloseOrErase() != 0) {
@@ -808,63 +817,120 @@ void ImageWriter::WalkFieldsInOrder(mirror::Object* obj) {
     Handle<mirror::Class> klass(hs.NewHandle(obj->GetClass()));
     // visit the object itself.
     CalculateObjectBinSlots(h_obj.Get());
-    WalkInstanceFields(h_obj.Get(), klass.Get());
-    // Walk static fields of a Class.
+    WalkReferences(h_obj.Get(), klass.Get());
     if (h_obj->IsClass()) {
-      size_t num_reference_static_fields = klass->NumReferenceStaticFields();
-      MemberOffset field_offset = klass->GetFirstReferenceStaticFieldOffset(target_ptr_size_);
-      for (size_t i = 0; i < num_reference_static_fields; ++i) {
-        mirror::Object* value = h_obj->GetFieldObject<mirror::Object>(field_offset);
-        if (value != nullptr) {
-          WalkFieldsInOrder(value);
-        }
-        field_offset = MemberOffset(field_offset.Uint32Value() +
-                                    sizeof(mirror::HeapReference<mirror::Object>));
-      }
-      // Visit and assign offsets for fields.
-      auto* as_klass = h_obj->AsClass();
-      ArtField* fields[] = { as_klass->GetSFields(), as_klass->GetIFields() };
-      size_t num_fields[] = { as_klass->NumStaticFields(), as_klass->NumInstanceFields() };
-      for (size_t i = 0; i < 2; ++i) {
-        for (size_t j = 0; j < num_fields[i]; ++j) {
-          auto* field = fields[i] + j;
-          auto it = native_object_reloc_.find(field);
-          CHECK(it == native_object_reloc_.end()) << "Field at index " << i << ":" << j
-              << " already assigned " << PrettyField(field);
-          native_object_reloc_.emplace(
-              field, NativeObjectReloc { bin_slot_sizes_[kBinArtField], kBinArtField });
-          bin_slot_sizes_[kBinArtField] += sizeof(ArtField);
-        }
+      AssignClassMemberOffsets(h_obj->AsClass());
+    }
+  }
+}
+
+// Walk the objects referenced by an object that has a bin slot.
+void ImageWriter::WalkReferences(mirror::Object* obj, mirror::Class* klass) {
+  StackHandleScope<2> hs(Thread::Current());
+  Handle<mirror::Object> h_obj(hs.NewHandle(obj));
+  Handle<mirror::Class> h_class(hs.NewHandle(klass));
+  WalkInstanceFields(h_obj.Get(), h_class.Get());
+  // Walk static fields of a Class.
+  if (h_obj->IsClass()) {
+    size_t num_reference_static_fields = h_class->NumReferenceStaticFields();
+    MemberOffset field_offset = h_class->GetFirstReferenceStaticFieldOffset(target_ptr_size_);
+    for (size_t i = 0; i < num_reference_static_fields; ++i) {
+      mirror::Object* value = h_obj->GetFieldObject<mirror::Object>(field_offset);
+      if (value != nullptr) {
+        WalkFieldsInOrder(value);
       }
-      // Visit and assign offsets for methods.
-      IterationRange<StrideIterator<ArtMethod>> method_arrays[] = {
-          as_klass->GetDirectMethods(target_ptr_size_),
-          as_klass->GetVirtualMethods(target_ptr_size_)
-      };
-      for (auto& array : method_arrays) {
-        bool any_dirty = false;
-        size_t count = 0;
-        for (auto& m : array) {
-          any_dirty = any_dirty || WillMethodBeDirty(&m);
-          ++count;
-        }
-        for (auto& m : array) {
-          AssignMethodOffset(&m, any_dirty ? kBinArtMethodDirty : kBinArtMethodClean);
-        }
-        (any_dirty ? dirty_methods_ : clean_methods_) += count;
+      field_offset = MemberOffset(field_offset.Uint32Value() +
+                                  sizeof(mirror::HeapReference<mirror::Object>));
+    }
+  } else if (h_obj->IsObjectArray()) {
+    // Walk elements of an object array.
+    int32_t length = h_obj->AsObjectArray<mirror::Object>()->GetLength();
+    for (int32_t i = 0; i < length; i++) {
+      mirror::ObjectArray<mirror::Object>* obj_array = h_obj->AsObjectArray<mirror::Object>();
+      mirror::Object* value = obj_array->Get(i);
+      if (value != nullptr) {
+        WalkFieldsInOrder(value);
       }
-    } else if (h_obj->IsObjectArray()) {
-      // Walk elements of an object array.
-      int32_t length = h_obj->AsObjectArray<mirror::Object>()->GetLength();
-      for (int32_t i = 0; i < length; i++) {
-        mirror::ObjectArray<mirror::Object>* obj_array = h_obj->AsObjectArray<mirror::Object>();
-        mirror::Object* value = obj_array->Get(i);
-        if (value != nullptr) {
-          WalkFieldsInOrder(value);
+    }
+  }
+}
+
+// Visit and assign offsets for the ArtFields and ArtMethods of a class.
+void ImageWriter::AssignClassMemberOffsets(mirror::Class* klass) {
+  ArtField* fields[] = { klass->GetSFields(), klass->GetIFields() };
+  size_t num_fields[] = { klass->NumStaticFields(), klass->NumInstanceFields() };
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t j = 0; j < num_fields[i]; ++j) {
+      auto* field = fields[i] + j;
+      auto it = native_object_reloc_.find(field);
+      CHECK(it == native_object_reloc_.end()) << "Field at index " << i << ":" << j
+          << " already assigned " << PrettyField(field);
+      native_object_reloc_.emplace(
+          field, NativeObjectReloc { bin_slot_sizes_[kBinArtField], kBinArtField });
+      bin_slot_sizes_[kBinArtField] += sizeof(ArtField);
+    }
+  }
+  IterationRange<StrideIterator<ArtMethod>> method_arrays[] = {
+      klass->GetDirectMethods(target_ptr_size_),
+      klass->GetVirtualMethods(target_ptr_size_)
+  };
+  for (auto& array : method_arrays) {
+    bool any_dirty = false;
+    size_t count = 0;
+    for (auto& m : array) {
+      any_dirty = any_dirty || WillMethodBeDirty(&m);
+      ++count;
+    }
+    for (auto& m : array) {
+      AssignMethodOffset(&m, any_dirty ? kBinArtMethodDirty : kBinArtMethodClean);
+    }
+    (any_dirty ? dirty_methods_ : clean_methods_) += count;
+  }
+}
+
+bool ImageWriter::HasHotMethod(mirror::Class* klass) const {
+  for (auto& m : klass->GetDirectMethods(target_ptr_size_)) {
+    if (compiler_driver_.IsHotMethod(&m)) {
+      return true;
+    }
+  }
+  for (auto& m : klass->GetVirtualMethods(target_ptr_size_)) {
+    if (compiler_driver_.IsHotMethod(&m)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Assign bin slots to the classes with methods that the profile marks as hot before all other
+// objects, so that these classes and their ArtFields and ArtMethods are at the start of their
+// bins rather than spread over the image. The classes are placed before walking anything they
+// reference, otherwise the first one would pull in its whole dex cache.
+void ImageWriter::WalkHotClasses() {
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  std::vector<mirror::Class*> hot_classes;
+  {
+    ReaderMutexLock mu(Thread::Current(), *class_linker->DexLock());
+    for (size_t idx = 0, count = class_linker->GetDexCacheCount(); idx != count; ++idx) {
+      mirror::DexCache* dex_cache = class_linker->GetDexCache(idx);
+      const DexFile* dex_file = dex_cache->GetDexFile();
+      for (size_t i = 0, num_class_defs = dex_file->NumClassDefs(); i != num_class_defs; ++i) {
+        mirror::Class* klass = dex_cache->GetResolvedType(dex_file->GetClassDef(i).class_idx_);
+        if (klass != nullptr && klass->GetDexCache() == dex_cache && HasHotMethod(klass)) {
+          hot_classes.push_back(klass);
         }
       }
     }
   }
+  for (mirror::Class* klass : hot_classes) {
+    DCHECK(!IsImageBinSlotAssigned(klass));
+    CalculateObjectBinSlots(klass);
+    AssignClassMemberOffsets(klass);
+  }
+  for (mirror::Class* klass : hot_classes) {
+    WalkReferences(klass, klass->GetClass());
+  }
+  VLOG(compiler) << "Placed " << hot_classes.size() << " classes with hot methods first";
 }
 
 void ImageWriter::AssignMethodOffset(ArtMethod* method, Bin bin) {
@@ -915,6 +981,10 @@ void ImageWriter::CalculateNewObjectOffsets() {
   image_objects_offset_begin_ = image_end_;
   // Prepare bin slots for dex cache arrays.
   PrepareDexCacheArraySlots();
+  // Place the classes with hot methods together.
+  if (compiler_driver_.ProfilePresent()) {
+    WalkHotClasses();
+  }
   // Clear any pre-existing monitors which may have been in the monitor words, assign bin slots.
   heap->VisitObjects(WalkFieldsCallback, this);
   // Write the image runtime methods.
@@ -1108,9 +1178,59 @@ void ImageWriter::CopyAndFixupNativeData() {
   CHECK_EQ(intern_table_bytes, intern_table_bytes_);
 }
 
-void ImageWriter::CopyAndFixupObjects() {
-  gc::Heap* heap = Runtime::Current()->GetHeap();
-  heap->VisitObjects(CopyAndFixupObjectsCallback, this);
+// Copies and fixes up chunks of ImageWriter::CopyAndFixupObjects()'s objects, handed out through
+// a shared index so that threads that get cheap chunks take more of them.
+class CopyAndFixupObjectsTask FINAL : public Task {
+ public:
+  CopyAndFixupObjectsTask(ImageWriter* image_writer,
+                          const std::vector<mirror::Object*>* objects,
+                          AtomicInteger* next_chunk)
+      : image_writer_(image_writer), objects_(objects), next_chunk_(next_chunk) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    const size_t num_objects = objects_->size();
+    while (true) {
+      const size_t begin = static_cast<size_t>(next_chunk_->FetchAndAddSequentiallyConsistent(1)) *
+          kChunkSize;
+      if (begin >= num_objects) {
+        break;
+      }
+      const size_t end = std::min(begin + kChunkSize, num_objects);
+      for (size_t i = begin; i != end; ++i) {
+        image_writer_->CopyAndFixupObject((*objects_)[i]);
+      }
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  static constexpr size_t kChunkSize = 1024;
+
+  ImageWriter* const image_writer_;
+  const std::vector<mirror::Object*>* const objects_;
+  AtomicInteger* const next_chunk_;
+};
+
+void ImageWriter::CopyAndFixupObjects(ThreadPool* thread_pool) {
+  Thread* const self = Thread::Current();
+  std::vector<mirror::Object*> objects;
+  {
+    ScopedObjectAccess soa(self);
+    Runtime::Current()->GetHeap()->VisitObjects(CollectObjectsCallback, &objects);
+  }
+  AtomicInteger next_chunk(0);
+  for (size_t i = 0, count = thread_pool->GetThreadCount() + 1u; i != count; ++i) {
+    thread_pool->AddTask(self, new CopyAndFixupObjectsTask(this, &objects, &next_chunk));
+  }
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, false);
+  thread_pool->StopWorkers(self);
+
+  ScopedObjectAccess soa(self);
   // Fix up the object previously had hash codes.
   for (const auto& hash_pair : saved_hashcode_map_) {
     Object* const obj = hash_pair.first;
@@ -1120,10 +1240,10 @@ void ImageWriter::CopyAndFixupObjects() {
   saved_hashcode_map_.clear();
 }
 
-void ImageWriter::CopyAndFixupObjectsCallback(Object* obj, void* arg) {
+void ImageWriter::CollectObjectsCallback(Object* obj, void* arg) {
   DCHECK(obj != nullptr);
   DCHECK(arg != nullptr);
-  reinterpret_cast<ImageWriter*>(arg)->CopyAndFixupObject(obj);
+  reinterpret_cast<std::vector<mirror::Object*>*>(arg)->push_back(obj);
 }
 
 void ImageWriter::FixupPointerArray(mirror::Object* dst, mirror::PointerArray* arr,
@@ -1165,7 +1285,8 @@ void ImageWriter::CopyAndFixupObject(Object* obj) {
   DCHECK_LT(offset, image_end_);
   const auto* src = reinterpret_cast<const uint8_t*>(obj);
 
-  image_bitmap_->Set(dst);  // Mark the obj as live.
+  // Mark the obj as live. Other threads set bits in the same words.
+  image_bitmap_->AtomicTestAndSet(dst);
 
   const size_t n = obj->SizeOf();
   DCHECK_LE(offset + n, image_->Size());
@@ -1295,9 +1416,9 @@ void ImageWriter::FixupObject(Object* orig, Object* copy) {
     // Is this a native dex cache array?
     auto it = pointer_arrays_.find(down_cast<mirror::PointerArray*>(orig));
     if (it != pointer_arrays_.end()) {
-      // Should only need to fixup every pointer array exactly once.
+      // Every object, and so every pointer array, is fixed up exactly once. Don't erase the
+      // entry, other threads may be looking up theirs.
       FixupPointerArray(copy, down_cast<mirror::PointerArray*>(orig), klass, it->second);
-      pointer_arrays_.erase(it);
       return;
     }
     CHECK(dex_cache_array_indexes_.find(orig) == dex_cache_array_indexes_.end())
@@ -41,6 +41,8 @@
 namespace art {
 
 // Write a Space built during compilation for use during execution.
+class ThreadPool;
+
 class ImageWriter FINAL {
  public:
   ImageWriter(const CompilerDriver& compiler_driver, uintptr_t image_begin,
@@ -251,6 +253,14 @@ class ImageWriter FINAL {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void WalkFieldsInOrder(mirror::Object* obj)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void WalkReferences(mirror::Object* obj, mirror::Class* klass)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void AssignClassMemberOffsets(mirror::Class* klass)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  bool HasHotMethod(mirror::Class* klass) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void WalkHotClasses()
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static void WalkFieldsCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   static void UnbinObjectsIntoOffsetCallback(mirror::Object* obj, void* arg)
@@ -258,8 +268,10 @@ class ImageWriter FINAL {
 
   // Creates the contiguous image in memory and adjusts pointers.
   void CopyAndFixupNativeData() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  void CopyAndFixupObjects() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  static void CopyAndFixupObjectsCallback(mirror::Object* obj, void* arg)
+  // Copies the objects on the threads of `thread_pool` and the calling thread. Objects are copied
+  // to disjoint ranges of the image, so the copies don't need to synchronize.
+  void CopyAndFixupObjects(ThreadPool* thread_pool) LOCKS_EXCLUDED(Locks::mutator_lock_);
+  static void CollectObjectsCallback(mirror::Object* obj, void* arg)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void CopyAndFixupObject(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void CopyAndFixupMethod(ArtMethod* orig, ArtMethod* copy)
@@ -373,6 +385,7 @@ class ImageWriter FINAL {
   uint64_t dirty_methods_;
   uint64_t clean_methods_;
 
+  friend class CopyAndFixupObjectsTask;
   friend class FixupClassVisitor;
   friend class FixupRootVisitor;
   friend class FixupVisitor;
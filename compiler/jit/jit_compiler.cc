@@ -78,6 +78,7 @@ JitCompiler::JitCompiler() : total_time_(0) {
       CompilerOptions::kDefaultTopKProfileThreshold,
       false,  // TODO: Think about debuggability of JIT-compiled code.
       CompilerOptions::kDefaultGenerateDebugInfo,
+      CompilerOptions::kDefaultGenerateMiniDebugInfo,
       false,
       false,
       false,
@@ -16,6 +16,7 @@
 
 #include "oat_writer.h"
 
+#include <algorithm>
 #include <zlib.h>
 
 #include "arch/arm64/instruction_set_features_arm64.h"
@@ -25,8 +26,10 @@
 #include "base/stl_util.h"
 #include "base/unix_file/fd_file.h"
 #include "class_linker.h"
+#include "class_lookup_table.h"
 #include "compiled_class.h"
 #include "compiled_method.h"
+#include "compressed_section.h"
 #include "dex_file-inl.h"
 #include "dex/verification_results.h"
 #include "driver/compiler_driver.h"
@@ -44,6 +47,7 @@
 #include "scoped_thread_state_change.h"
 #include "handle_scope-inl.h"
 #include "verifier/method_verifier.h"
+#include "verifier/verifier_deps.h"
 
 namespace art {
 
@@ -79,6 +83,10 @@ OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
     size_oat_header_(0),
     size_oat_header_key_value_store_(0),
     size_dex_file_(0),
+    size_verifier_deps_(0),
+    size_verifier_deps_alignment_(0),
+    size_lookup_table_alignment_(0),
+    size_lookup_table_(0),
     size_interpreter_to_interpreter_bridge_(0),
     size_interpreter_to_compiled_code_bridge_(0),
     size_jni_dlsym_lookup_(0),
@@ -99,11 +107,13 @@ OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
     size_oat_dex_file_location_data_(0),
     size_oat_dex_file_location_checksum_(0),
     size_oat_dex_file_offset_(0),
+    size_oat_dex_file_lookup_table_offset_(0),
     size_oat_dex_file_methods_offsets_(0),
     size_oat_class_type_(0),
     size_oat_class_status_(0),
     size_oat_class_method_bitmaps_(0),
     size_oat_class_method_offsets_(0),
+    size_hot_code_(0),
     method_offset_map_() {
   CHECK(key_value_store != nullptr);
 
@@ -125,6 +135,14 @@ OatWriter::OatWriter(const std::vector<const DexFile*>& dex_files,
     TimingLogger::ScopedTiming split("InitDexFiles", timings);
     offset = InitDexFiles(offset);
   }
+  {
+    TimingLogger::ScopedTiming split("InitLookupTables", timings);
+    offset = InitLookupTables(offset);
+  }
+  {
+    TimingLogger::ScopedTiming split("InitVerifierDeps", timings);
+    offset = InitVerifierDeps(offset);
+  }
   {
     TimingLogger::ScopedTiming split("InitOatClasses", timings);
     offset = InitOatClasses(offset);
@@ -271,7 +289,14 @@ class OatWriter::OatDexMethodVisitor : public DexMethodVisitor {
   OatDexMethodVisitor(OatWriter* writer, size_t offset)
     : DexMethodVisitor(writer, offset),
       oat_class_index_(0u),
-      method_offsets_index_(0u) {
+      method_offsets_index_(0u),
+      code_layout_group_(kCodeLayoutGroupOther) {
+  }
+
+  // Restarts the visit of all classes to process the methods of the given code layout group.
+  void StartCodeLayoutGroup(CodeLayoutGroup code_layout_group) {
+    oat_class_index_ = 0u;
+    code_layout_group_ = code_layout_group;
   }
 
   bool StartClass(const DexFile* dex_file, size_t class_def_index) {
@@ -287,8 +312,20 @@ class OatWriter::OatDexMethodVisitor : public DexMethodVisitor {
   }
 
  protected:
+  bool IsInCodeLayoutGroup(const ClassDataItemIterator& it) const {
+    return writer_->GetCodeLayoutGroup(MethodReference(dex_file_, it.GetMemberIndex())) ==
+        code_layout_group_;
+  }
+
+  // Whether the last class of the last code layout group has been visited.
+  bool IsCodeLayoutEnd() const {
+    return oat_class_index_ == writer_->oat_classes_.size() &&
+        code_layout_group_ == kCodeLayoutGroupOther;
+  }
+
   size_t oat_class_index_;
   size_t method_offsets_index_;
+  CodeLayoutGroup code_layout_group_;
 };
 
 class OatWriter::InitOatClassesMethodVisitor : public DexMethodVisitor {
@@ -318,6 +355,10 @@ class OatWriter::InitOatClassesMethodVisitor : public DexMethodVisitor {
     compiled_methods_.push_back(compiled_method);
     if (compiled_method != nullptr) {
         ++num_non_null_compiled_methods_;
+        if (writer_->compiler_driver_->ProfilePresent() &&
+            writer_->compiler_driver_->IsHotMethod(*dex_file_, method_idx)) {
+          writer_->hot_methods_.insert(MethodReference(dex_file_, method_idx));
+        }
     }
     return true;
   }
@@ -358,7 +399,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
 
   bool EndClass() {
     OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
+    if (IsCodeLayoutEnd()) {
       offset_ = writer_->relative_patcher_->ReserveSpaceEnd(offset_);
     }
     return true;
@@ -369,7 +410,10 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
     OatClass* oat_class = writer_->oat_classes_[oat_class_index_];
     CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
 
-    if (compiled_method != nullptr) {
+    if (compiled_method != nullptr && !IsInCodeLayoutGroup(it)) {
+      // Laid out with another group.
+      ++method_offsets_index_;
+    } else if (compiled_method != nullptr) {
       // Derived from CompiledMethod.
       uint32_t quick_code_offset = 0;
 
@@ -449,7 +493,7 @@ class OatWriter::InitCodeMethodVisitor : public OatDexMethodVisitor {
         }
       }
 
-      if (writer_->compiler_driver_->GetCompilerOptions().GetGenerateDebugInfo()) {
+      if (writer_->compiler_driver_->GetCompilerOptions().GetGenerateAnyDebugInfo()) {
         // Record debug information for this function if we are doing that.
         const uint32_t quick_code_start = quick_code_offset -
             writer_->oat_header_->GetExecutableOffset() - thumb_offset;
@@ -661,6 +705,10 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     OatDexMethodVisitor::StartClass(dex_file, class_def_index);
     if (dex_cache_ == nullptr || dex_cache_->GetDexFile() != dex_file) {
+      if (dex_cache_ != nullptr) {
+        // The code of the previous dex file is written, it does not need to stay in memory.
+        writer_->compiler_driver_->ReleaseCompiledDataMemory();
+      }
       dex_cache_ = class_linker_->FindDexCache(*dex_file);
     }
     return true;
@@ -668,7 +716,7 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
 
   bool EndClass() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     bool result = OatDexMethodVisitor::EndClass();
-    if (oat_class_index_ == writer_->oat_classes_.size()) {
+    if (IsCodeLayoutEnd()) {
       DCHECK(result);  // OatDexMethodVisitor::EndClass() never fails.
       offset_ = writer_->relative_patcher_->WriteThunks(out_, offset_);
       if (UNLIKELY(offset_ == 0u)) {
@@ -684,7 +732,10 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
     OatClass* oat_class = writer_->oat_classes_[oat_class_index_];
     const CompiledMethod* compiled_method = oat_class->GetCompiledMethod(class_def_method_index);
 
-    if (compiled_method != nullptr) {  // ie. not an abstract method
+    if (compiled_method != nullptr && !IsInCodeLayoutGroup(it)) {
+      // Written with another group.
+      ++method_offsets_index_;
+    } else if (compiled_method != nullptr) {  // ie. not an abstract method
       size_t file_offset = file_offset_;
       OutputStream* out = out_;
 
@@ -764,6 +815,9 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
             return false;
           }
           writer_->size_code_ += code_size;
+          if (code_layout_group_ == kCodeLayoutGroupHot) {
+            writer_->size_hot_code_ += code_size;
+          }
           offset_ += code_size;
         }
         DCHECK_OFFSET_();
@@ -984,6 +1038,26 @@ bool OatWriter::VisitDexMethods(DexMethodVisitor* visitor) {
   return true;
 }
 
+OatWriter::CodeLayoutGroup OatWriter::GetCodeLayoutGroup(const MethodReference& method_ref) const {
+  return (hot_methods_.find(method_ref) != hot_methods_.end())
+      ? kCodeLayoutGroupHot
+      : kCodeLayoutGroupOther;
+}
+
+bool OatWriter::VisitDexMethodsInCodeLayoutOrder(OatDexMethodVisitor* visitor) {
+  for (size_t i = 0; i != kCodeLayoutGroupCount; ++i) {
+    CodeLayoutGroup group = static_cast<CodeLayoutGroup>(i);
+    if (group == kCodeLayoutGroupHot && hot_methods_.empty()) {
+      continue;
+    }
+    visitor->StartCodeLayoutGroup(group);
+    if (UNLIKELY(!VisitDexMethods(visitor))) {
+      return false;
+    }
+  }
+  return true;
+}
+
 size_t OatWriter::InitOatHeader() {
   oat_header_ = OatHeader::Create(compiler_driver_->GetInstructionSet(),
                                   compiler_driver_->GetInstructionSetFeatures(),
@@ -1019,8 +1093,55 @@ size_t OatWriter::InitDexFiles(size_t offset) {
     oat_dex_files_[i]->dex_file_offset_ = offset;
 
     const DexFile* dex_file = (*dex_files_)[i];
-    offset += dex_file->GetHeader().file_size_;
+    if (oat_header_->IsDexCompressed()) {
+      // Keep the dex file header uncompressed, so that the runtime can check the dex file
+      // without decompressing it, and follow it with the compressed dex file.
+      compressed_dex_files_.emplace_back();
+      CompressedSection::Compress(dex_file->Begin(),
+                                  dex_file->Size(),
+                                  CompressedSection::kDefaultBlockSize,
+                                  &compressed_dex_files_.back());
+      offset += sizeof(DexFile::Header) + compressed_dex_files_.back().size();
+    } else {
+      offset += dex_file->GetHeader().file_size_;
+    }
+  }
+  return offset;
+}
+
+size_t OatWriter::InitLookupTables(size_t offset) {
+  for (size_t i = 0; i != dex_files_->size(); ++i) {
+    const DexFile* dex_file = (*dex_files_)[i];
+    lookup_tables_.emplace_back();
+    if (dex_file->NumClassDefs() == 0u) {
+      continue;  // Leave the lookup table offset at 0.
+    }
+    // Lookup tables are read as uint32_t and must be 4 byte aligned.
+    size_t original_offset = offset;
+    offset = RoundUp(offset, 4);
+    size_lookup_table_alignment_ += offset - original_offset;
+
+    oat_dex_files_[i]->lookup_table_offset_ = offset;
+    ClassLookupTable::Create(*dex_file, &lookup_tables_.back());
+    offset += lookup_tables_.back().size();
+  }
+  return offset;
+}
+
+size_t OatWriter::InitVerifierDeps(size_t offset) {
+  const verifier::VerifierDeps* verifier_deps = compiler_driver_->GetVerifierDeps();
+  if (verifier_deps == nullptr) {
+    return offset;
   }
+  verifier_deps->Encode(&verifier_deps_);
+  oat_header_->SetVerifierDeps(offset, verifier_deps_.size());
+  oat_header_->UpdateChecksum(verifier_deps_.data(), verifier_deps_.size());
+  offset += verifier_deps_.size();
+
+  // The oat classes that follow are 4 byte aligned.
+  size_t original_offset = offset;
+  offset = RoundUp(offset, 4);
+  size_verifier_deps_alignment_ = offset - original_offset;
   return offset;
 }
 
@@ -1114,7 +1235,19 @@ size_t OatWriter::InitOatCodeDexFiles(size_t offset) {
       offset = visitor.GetOffset();                   \
     } while (false)
 
-  VISIT(InitCodeMethodVisitor);
+  {
+    InitCodeMethodVisitor visitor(this, offset);
+    bool success = VisitDexMethodsInCodeLayoutOrder(&visitor);
+    DCHECK(success);
+    offset = visitor.GetOffset();
+  }
+  if (!hot_methods_.empty()) {
+    // The debug info writer expects the methods in address order.
+    std::stable_sort(method_info_.begin(), method_info_.end(),
+                     [](const DebugInfo& lhs, const DebugInfo& rhs) {
+                       return lhs.low_pc_ < rhs.low_pc_;
+                     });
+  }
   if (compiler_driver_->IsImage()) {
     VISIT(InitImageMethodVisitor);
   }
@@ -1209,6 +1342,10 @@ bool OatWriter::WriteCode(OutputStream* out) {
     DO_STAT(size_oat_header_);
     DO_STAT(size_oat_header_key_value_store_);
     DO_STAT(size_dex_file_);
+    DO_STAT(size_verifier_deps_);
+    DO_STAT(size_verifier_deps_alignment_);
+    DO_STAT(size_lookup_table_alignment_);
+    DO_STAT(size_lookup_table_);
     DO_STAT(size_interpreter_to_interpreter_bridge_);
     DO_STAT(size_interpreter_to_compiled_code_bridge_);
     DO_STAT(size_jni_dlsym_lookup_);
@@ -1229,6 +1366,7 @@ bool OatWriter::WriteCode(OutputStream* out) {
     DO_STAT(size_oat_dex_file_location_data_);
     DO_STAT(size_oat_dex_file_location_checksum_);
     DO_STAT(size_oat_dex_file_offset_);
+    DO_STAT(size_oat_dex_file_lookup_table_offset_);
     DO_STAT(size_oat_dex_file_methods_offsets_);
     DO_STAT(size_oat_class_type_);
     DO_STAT(size_oat_class_status_);
@@ -1237,6 +1375,8 @@ bool OatWriter::WriteCode(OutputStream* out) {
     #undef DO_STAT
 
     VLOG(compiler) << "size_total=" << PrettySize(size_total) << " (" << size_total << "B)"; \
+    VLOG(compiler) << "size_hot_code_=" << PrettySize(size_hot_code_)
+        << " (" << size_hot_code_ << "B, part of size_code_)";
     CHECK_EQ(file_offset + size_total, static_cast<size_t>(oat_end_file_offset));
     CHECK_EQ(size_, size_total);
   }
@@ -1280,6 +1420,17 @@ bool OatWriter::WriteTables(OutputStream* out, const size_t file_offset) {
       return false;
     }
     const DexFile* dex_file = (*dex_files_)[i];
+    if (!compressed_dex_files_.empty()) {
+      const std::vector<uint8_t>& compressed_dex_file = compressed_dex_files_[i];
+      if (!out->WriteFully(&dex_file->GetHeader(), sizeof(DexFile::Header)) ||
+          !out->WriteFully(compressed_dex_file.data(), compressed_dex_file.size())) {
+        PLOG(ERROR) << "Failed to write compressed dex file " << dex_file->GetLocation()
+                    << " to " << out->GetLocation();
+        return false;
+      }
+      size_dex_file_ += sizeof(DexFile::Header) + compressed_dex_file.size();
+      continue;
+    }
     if (!out->WriteFully(&dex_file->GetHeader(), dex_file->GetHeader().file_size_)) {
       PLOG(ERROR) << "Failed to write dex file " << dex_file->GetLocation()
                   << " to " << out->GetLocation();
@@ -1287,6 +1438,42 @@ bool OatWriter::WriteTables(OutputStream* out, const size_t file_offset) {
     }
     size_dex_file_ += dex_file->GetHeader().file_size_;
   }
+  for (size_t i = 0; i != oat_dex_files_.size(); ++i) {
+    const std::vector<uint8_t>& lookup_table = lookup_tables_[i];
+    if (lookup_table.empty()) {
+      continue;
+    }
+    uint32_t expected_offset = file_offset + oat_dex_files_[i]->lookup_table_offset_;
+    off_t actual_offset = out->Seek(expected_offset, kSeekSet);
+    if (static_cast<uint32_t>(actual_offset) != expected_offset) {
+      PLOG(ERROR) << "Failed to seek to class lookup table section. Actual: " << actual_offset
+                  << " Expected: " << expected_offset;
+      return false;
+    }
+    if (!out->WriteFully(lookup_table.data(), lookup_table.size())) {
+      PLOG(ERROR) << "Failed to write class lookup table for " << (*dex_files_)[i]->GetLocation()
+                  << " to " << out->GetLocation();
+      return false;
+    }
+    size_lookup_table_ += lookup_table.size();
+  }
+  if (!verifier_deps_.empty()) {
+    static const uint8_t kPadding[] = { 0u, 0u, 0u };
+    DCHECK_LE(size_verifier_deps_alignment_, sizeof(kPadding));
+    uint32_t expected_offset = file_offset + oat_header_->GetVerifierDepsOffset();
+    off_t actual_offset = out->Seek(expected_offset, kSeekSet);
+    if (static_cast<uint32_t>(actual_offset) != expected_offset) {
+      PLOG(ERROR) << "Failed to seek to verifier dependencies section. Actual: " << actual_offset
+                  << " Expected: " << expected_offset;
+      return false;
+    }
+    if (!out->WriteFully(verifier_deps_.data(), verifier_deps_.size()) ||
+        !out->WriteFully(kPadding, size_verifier_deps_alignment_)) {
+      PLOG(ERROR) << "Failed to write verifier dependencies to " << out->GetLocation();
+      return false;
+    }
+    size_verifier_deps_ += verifier_deps_.size();
+  }
   for (size_t i = 0; i != oat_classes_.size(); ++i) {
     if (!oat_classes_[i]->Write(this, out, file_offset)) {
       PLOG(ERROR) << "Failed to write oat methods information to " << out->GetLocation();
@@ -1304,6 +1491,7 @@ size_t OatWriter::WriteMaps(OutputStream* out, const size_t file_offset, size_t
         return 0;                                                         \
       }                                                                   \
       relative_offset = visitor.GetOffset();                              \
+      compiler_driver_->ReleaseCompiledDataMemory();                      \
     } while (false)
 
   size_t gc_maps_offset = relative_offset;
@@ -1357,18 +1545,11 @@ size_t OatWriter::WriteCode(OutputStream* out, const size_t file_offset, size_t
 size_t OatWriter::WriteCodeDexFiles(OutputStream* out,
                                     const size_t file_offset,
                                     size_t relative_offset) {
-  #define VISIT(VisitorType)                                              \
-    do {                                                                  \
-      VisitorType visitor(this, out, file_offset, relative_offset);       \
-      if (UNLIKELY(!VisitDexMethods(&visitor))) {                         \
-        return 0;                                                         \
-      }                                                                   \
-      relative_offset = visitor.GetOffset();                              \
-    } while (false)
-
-  VISIT(WriteCodeMethodVisitor);
-
-  #undef VISIT
+  WriteCodeMethodVisitor visitor(this, out, file_offset, relative_offset);
+  if (UNLIKELY(!VisitDexMethodsInCodeLayoutOrder(&visitor))) {
+    return 0;
+  }
+  relative_offset = visitor.GetOffset();
 
   size_code_alignment_ += relative_patcher_->CodeAlignmentSize();
   size_relative_call_thunks_ += relative_patcher_->RelativeCallThunksSize();
@@ -1405,6 +1586,7 @@ OatWriter::OatDexFile::OatDexFile(size_t offset, const DexFile& dex_file) {
   dex_file_location_data_ = reinterpret_cast<const uint8_t*>(location.data());
   dex_file_location_checksum_ = dex_file.GetLocationChecksum();
   dex_file_offset_ = 0;
+  lookup_table_offset_ = 0;
   methods_offsets_.resize(dex_file.NumClassDefs());
 }
 
@@ -1413,6 +1595,7 @@ size_t OatWriter::OatDexFile::SizeOf() const {
           + dex_file_location_size_
           + sizeof(dex_file_location_checksum_)
           + sizeof(dex_file_offset_)
+          + sizeof(lookup_table_offset_)
           + (sizeof(methods_offsets_[0]) * methods_offsets_.size());
 }
 
@@ -1421,6 +1604,7 @@ void OatWriter::OatDexFile::UpdateChecksum(OatHeader* oat_header) const {
   oat_header->UpdateChecksum(dex_file_location_data_, dex_file_location_size_);
   oat_header->UpdateChecksum(&dex_file_location_checksum_, sizeof(dex_file_location_checksum_));
   oat_header->UpdateChecksum(&dex_file_offset_, sizeof(dex_file_offset_));
+  oat_header->UpdateChecksum(&lookup_table_offset_, sizeof(lookup_table_offset_));
   oat_header->UpdateChecksum(&methods_offsets_[0],
                             sizeof(methods_offsets_[0]) * methods_offsets_.size());
 }
@@ -1449,6 +1633,11 @@ bool OatWriter::OatDexFile::Write(OatWriter* oat_writer,
     return false;
   }
   oat_writer->size_oat_dex_file_offset_ += sizeof(dex_file_offset_);
+  if (!out->WriteFully(&lookup_table_offset_, sizeof(lookup_table_offset_))) {
+    PLOG(ERROR) << "Failed to write class lookup table offset to " << out->GetLocation();
+    return false;
+  }
+  oat_writer->size_oat_dex_file_lookup_table_offset_ += sizeof(lookup_table_offset_);
   if (!out->WriteFully(&methods_offsets_[0],
                       sizeof(methods_offsets_[0]) * methods_offsets_.size())) {
     PLOG(ERROR) << "Failed to write methods offsets to " << out->GetLocation();
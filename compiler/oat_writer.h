@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include <cstddef>
 #include <memory>
+#include <set>
 
 #include "linker/relative_patcher.h"  // For linker::RelativePatcherTargetProvider.
 #include "mem_map.h"
@@ -159,9 +160,26 @@ class OatWriter {
   // with a given DexMethodVisitor.
   bool VisitDexMethods(DexMethodVisitor* visitor);
 
+  // The compiled code is laid out in groups, each in the definition order of the methods.
+  // The code of the methods that the profile marks as hot comes first, so that it is packed
+  // into as few pages as possible instead of being spread among rarely executed code.
+  enum CodeLayoutGroup {
+    kCodeLayoutGroupHot,
+    kCodeLayoutGroupOther,
+    kCodeLayoutGroupCount
+  };
+
+  CodeLayoutGroup GetCodeLayoutGroup(const MethodReference& method_ref) const;
+
+  // Visit all the methods with a given OatDexMethodVisitor once for each code layout group.
+  // The visitor processes only the compiled methods of the current group.
+  bool VisitDexMethodsInCodeLayoutOrder(OatDexMethodVisitor* visitor);
+
   size_t InitOatHeader();
   size_t InitOatDexFiles(size_t offset);
   size_t InitDexFiles(size_t offset);
+  size_t InitLookupTables(size_t offset);
+  size_t InitVerifierDeps(size_t offset);
   size_t InitOatClasses(size_t offset);
   size_t InitOatMaps(size_t offset);
   size_t InitOatCode(size_t offset)
@@ -192,6 +210,7 @@ class OatWriter {
     const uint8_t* dex_file_location_data_;
     uint32_t dex_file_location_checksum_;
     uint32_t dex_file_offset_;
+    uint32_t lookup_table_offset_;
     std::vector<uint32_t> methods_offsets_;
 
    private:
@@ -285,6 +304,11 @@ class OatWriter {
   OatHeader* oat_header_;
   std::vector<OatDexFile*> oat_dex_files_;
   std::vector<OatClass*> oat_classes_;
+  std::vector<uint8_t> verifier_deps_;
+  // The compressed dex files, if the oat header asks for compressed dex files.
+  std::vector<std::vector<uint8_t>> compressed_dex_files_;
+  // The class lookup tables of the dex files, empty for dex files without classes.
+  std::vector<std::vector<uint8_t>> lookup_tables_;
   std::unique_ptr<const std::vector<uint8_t>> interpreter_to_interpreter_bridge_;
   std::unique_ptr<const std::vector<uint8_t>> interpreter_to_compiled_code_bridge_;
   std::unique_ptr<const std::vector<uint8_t>> jni_dlsym_lookup_;
@@ -299,6 +323,10 @@ class OatWriter {
   uint32_t size_oat_header_;
   uint32_t size_oat_header_key_value_store_;
   uint32_t size_dex_file_;
+  uint32_t size_verifier_deps_;
+  uint32_t size_verifier_deps_alignment_;
+  uint32_t size_lookup_table_alignment_;
+  uint32_t size_lookup_table_;
   uint32_t size_interpreter_to_interpreter_bridge_;
   uint32_t size_interpreter_to_compiled_code_bridge_;
   uint32_t size_jni_dlsym_lookup_;
@@ -319,11 +347,16 @@ class OatWriter {
   uint32_t size_oat_dex_file_location_data_;
   uint32_t size_oat_dex_file_location_checksum_;
   uint32_t size_oat_dex_file_offset_;
+  uint32_t size_oat_dex_file_lookup_table_offset_;
   uint32_t size_oat_dex_file_methods_offsets_;
   uint32_t size_oat_class_type_;
   uint32_t size_oat_class_status_;
   uint32_t size_oat_class_method_bitmaps_;
   uint32_t size_oat_class_method_offsets_;
+  uint32_t size_hot_code_;  // Part of size_code_.
+
+  // The compiled methods laid out in kCodeLayoutGroupHot.
+  std::set<MethodReference, MethodReferenceComparator> hot_methods_;
 
   std::unique_ptr<linker::RelativePatcher> relative_patcher_;
 
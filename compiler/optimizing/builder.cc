@@ -732,10 +732,19 @@ bool HGraphBuilder::BuildInvoke(const Instruction& instruction,
       }
     }
 
+    // A direct code of -1 means the callee is compiled in the oat file being written and
+    // can be called with a PC-relative call patched by the linker. Only use it within the
+    // same dex file, whose dex cache we use to pass the callee's ArtMethod.
+    HInvokeStaticOrDirect::CodePtrLocation code_ptr_location =
+        (direct_code == static_cast<uintptr_t>(-1) && !is_string_init &&
+         target_method.dex_file == dex_file_)
+            ? HInvokeStaticOrDirect::CodePtrLocation::kCallPCRelative
+            : HInvokeStaticOrDirect::CodePtrLocation::kCallArtMethod;
+
     invoke = new (arena_) HInvokeStaticOrDirect(
         arena_, number_of_arguments, return_type, dex_pc, target_method.dex_method_index,
         is_recursive, string_init_offset, invoke_type, optimized_invoke_type,
-        clinit_check_requirement);
+        clinit_check_requirement, code_ptr_location);
   }
 
   size_t start_index = 0;
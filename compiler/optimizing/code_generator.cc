@@ -32,6 +32,7 @@
 #include "mirror/object_reference.h"
 #include "ssa_liveness_analysis.h"
 #include "utils/assembler.h"
+#include "utils/dex_cache_arrays_layout-inl.h"
 #include "verifier/dex_gc_map.h"
 #include "vmap_table.h"
 
@@ -115,11 +116,75 @@ size_t CodeGenerator::GetCacheOffset(uint32_t index) {
   return mirror::ObjectArray<mirror::Object>::OffsetOfElement(index).SizeValue();
 }
 
+bool CodeGenerator::CanAllocateInline(HNewInstance* new_instance) {
+  // Access checks and non-instantiable classes are left to the runtime. Read barriers need the
+  // read barrier state of new objects initialized, which the inline path does not do.
+  return !kUseReadBarrier && !kPoisonHeapReferences &&
+      new_instance->GetEntrypoint() == kQuickAllocObject;
+}
+
+bool CodeGenerator::CanAllocateInline(HNewArray* new_array, size_t* component_size_shift) const {
+  if (kUseReadBarrier || kPoisonHeapReferences ||
+      new_array->GetEntrypoint() != kQuickAllocArray) {
+    return false;
+  }
+  // The component type is statically known from the descriptor, even if the array class is not
+  // resolved yet.
+  const char* descriptor = GetGraph()->GetDexFile().StringByTypeIdx(new_array->GetTypeIndex());
+  DCHECK_EQ(descriptor[0], '[');
+  *component_size_shift = Primitive::ComponentSizeShift(Primitive::GetType(descriptor[1]));
+  return true;
+}
+
 size_t CodeGenerator::GetCachePointerOffset(uint32_t index) {
   auto pointer_size = InstructionSetPointerSize(GetInstructionSet());
   return mirror::Array::DataOffset(pointer_size).Uint32Value() + pointer_size * index;
 }
 
+bool CodeGenerator::CanUsePcRelativeDexCacheArrayLoads() const {
+  return dex_cache_arrays_layout_ != nullptr && dex_cache_arrays_layout_->Valid();
+}
+
+size_t CodeGenerator::GetDexCacheStringOffset(uint32_t string_index) const {
+  DCHECK(CanUsePcRelativeDexCacheArrayLoads());
+  return dex_cache_arrays_layout_->StringOffset(string_index);
+}
+
+size_t CodeGenerator::GetDexCacheTypeOffset(uint32_t type_index) const {
+  DCHECK(CanUsePcRelativeDexCacheArrayLoads());
+  return dex_cache_arrays_layout_->TypeOffset(type_index);
+}
+
+size_t CodeGenerator::GetDexCacheMethodOffset(uint32_t method_index) const {
+  DCHECK(CanUsePcRelativeDexCacheArrayLoads());
+  return dex_cache_arrays_layout_->MethodOffset(method_index);
+}
+
+void CodeGenerator::RecordDexCacheArrayPatch(uint32_t literal_offset,
+                                             uint32_t pc_insn_offset,
+                                             size_t element_offset) {
+  DCHECK(CanUsePcRelativeDexCacheArrayLoads());
+  // The inliner does not cross dex files, so all references are to the graph's dex file.
+  linker_patches_.Add(LinkerPatch::DexCacheArrayPatch(
+      literal_offset, &GetGraph()->GetDexFile(), pc_insn_offset, element_offset));
+}
+
+void CodeGenerator::RecordRelativeCallPatch(uint32_t literal_offset, uint32_t method_index) {
+  linker_patches_.Add(LinkerPatch::RelativeCodePatch(
+      literal_offset, &GetGraph()->GetDexFile(), method_index));
+}
+
+void CodeGenerator::EmitLinkerPatches(std::vector<LinkerPatch>* linker_patches) const {
+  DCHECK(linker_patches->empty());
+  linker_patches->reserve(linker_patches_.Size());
+  for (size_t i = 0, e = linker_patches_.Size(); i < e; ++i) {
+    // Patches are recorded as the code is emitted and are therefore sorted by literal offset.
+    DCHECK(i == 0u || linker_patches_.Get(i - 1u).LiteralOffset() <
+                      linker_patches_.Get(i).LiteralOffset());
+    linker_patches->push_back(linker_patches_.Get(i));
+  }
+}
+
 void CodeGenerator::CompileBaseline(CodeAllocator* allocator, bool is_leaf) {
   Initialize();
   if (!is_leaf) {
@@ -20,6 +20,7 @@
 #include "arch/instruction_set.h"
 #include "arch/instruction_set_features.h"
 #include "base/bit_field.h"
+#include "compiled_method.h"
 #include "driver/compiler_options.h"
 #include "globals.h"
 #include "locations.h"
@@ -39,8 +40,13 @@ static int32_t constexpr kPrimIntMax = 0x7fffffff;
 // Maximum value for a primitive long.
 static int64_t constexpr kPrimLongMax = 0x7fffffffffffffff;
 
+// Largest array, in bytes, that compiled code tries to allocate inline from the thread-local
+// allocation buffer. Bigger primitive arrays may belong in the large object space.
+static constexpr size_t kMaxInlineAllocatedArraySize = 2 * KB;
+
 class Assembler;
 class CodeGenerator;
+class DexCacheArraysLayout;
 class DexCompilationUnit;
 class ParallelMoveResolver;
 class SrcMapElem;
@@ -235,6 +241,29 @@ class CodeGenerator {
     return is_baseline_;
   }
 
+  // Sets the layout of the dex cache arrays of the compiled dex file. The layout is only
+  // valid when the dex cache arrays are at a known place relative to the code, i.e. when
+  // compiling the boot image; elements can then be loaded with a PC-relative address.
+  void SetDexCacheArraysLayout(const DexCacheArraysLayout* layout) {
+    dex_cache_arrays_layout_ = layout;
+  }
+  bool CanUsePcRelativeDexCacheArrayLoads() const;
+  // Offsets of dex cache array elements, relative to the start of the dex cache arrays.
+  size_t GetDexCacheStringOffset(uint32_t string_index) const;
+  size_t GetDexCacheTypeOffset(uint32_t type_index) const;
+  size_t GetDexCacheMethodOffset(uint32_t method_index) const;
+
+  // Records a PC-relative reference to the dex cache array element at `element_offset`.
+  // `literal_offset` is the offset of the instruction or literal to patch and
+  // `pc_insn_offset` the offset of the instruction providing the PC base.
+  void RecordDexCacheArrayPatch(uint32_t literal_offset,
+                                uint32_t pc_insn_offset,
+                                size_t element_offset);
+  // Records a PC-relative call, at `literal_offset`, to the compiled code of the method
+  // `method_index` of the compiled dex file.
+  void RecordRelativeCallPatch(uint32_t literal_offset, uint32_t method_index);
+  void EmitLinkerPatches(std::vector<LinkerPatch>* linker_patches) const;
+
   bool IsLeafMethod() const {
     return is_leaf_;
   }
@@ -269,6 +298,14 @@ class CodeGenerator {
   // Pointer variant for ArtMethod and ArtField arrays.
   size_t GetCachePointerOffset(uint32_t index);
 
+  // Whether the object can be bump-allocated inline from the thread-local allocation buffer,
+  // falling back to the allocation entrypoint when the class is not resolved and initialized,
+  // is finalizable, or the buffer is exhausted (or absent, as with non-TLAB allocators).
+  static bool CanAllocateInline(HNewInstance* new_instance);
+  // Same for arrays of up to `kMaxInlineAllocatedArraySize` bytes. On success, sets the
+  // log2 of the component size of the array type.
+  bool CanAllocateInline(HNewArray* new_array, size_t* component_size_shift) const;
+
   void EmitParallelMoves(Location from1,
                          Location to1,
                          Primitive::Type type1,
@@ -356,6 +393,8 @@ class CodeGenerator {
         compiler_options_(compiler_options),
         pc_infos_(graph->GetArena(), 32),
         slow_paths_(graph->GetArena(), 8),
+        dex_cache_arrays_layout_(nullptr),
+        linker_patches_(graph->GetArena(), 0),
         block_order_(nullptr),
         current_block_index_(0),
         is_leaf_(true),
@@ -445,6 +484,9 @@ class CodeGenerator {
   GrowableArray<PcInfo> pc_infos_;
   GrowableArray<SlowPathCode*> slow_paths_;
 
+  const DexCacheArraysLayout* dex_cache_arrays_layout_;
+  GrowableArray<LinkerPatch> linker_patches_;
+
   // The order to use for code generation.
   const GrowableArray<HBasicBlock*>* block_order_;
 
@@ -22,8 +22,11 @@
 #include "gc/accounting/card_table.h"
 #include "intrinsics.h"
 #include "intrinsics_arm.h"
+#include "lock_word.h"
 #include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
+#include "mirror/iftable.h"
+#include "read_barrier.h"
 #include "thread.h"
 #include "utils/arm/assembler_arm.h"
 #include "utils/arm/managed_register_arm.h"
@@ -293,6 +296,39 @@ class TypeCheckSlowPathARM : public SlowPathCodeARM {
   DISALLOW_COPY_AND_ASSIGN(TypeCheckSlowPathARM);
 };
 
+// Slow path marking the reference in `ref` loaded by a read barrier, replacing it
+// with the to-space reference.
+class ReadBarrierMarkSlowPathARM : public SlowPathCodeARM {
+ public:
+  ReadBarrierMarkSlowPathARM(HInstruction* instruction, Location ref)
+      : instruction_(instruction), ref_(ref) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(locations->OnlyCallsOnSlowPath());
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(ref_.reg()));
+
+    CodeGeneratorARM* arm_codegen = down_cast<CodeGeneratorARM*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    arm_codegen->Move32(Location::RegisterLocation(calling_convention.GetRegisterAt(0)), ref_);
+    arm_codegen->InvokeRuntime(
+        QUICK_ENTRY_POINT(pReadBarrierMark), instruction_, instruction_->GetDexPc(), this);
+    arm_codegen->Move32(ref_, Location::RegisterLocation(R0));
+
+    RestoreLiveRegisters(codegen, locations);
+    __ b(GetExitLabel());
+  }
+
+ private:
+  HInstruction* const instruction_;
+  const Location ref_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadBarrierMarkSlowPathARM);
+};
+
 class DeoptimizationSlowPathARM : public SlowPathCodeARM {
  public:
   explicit DeoptimizationSlowPathARM(HInstruction* instruction)
@@ -1258,6 +1294,88 @@ void CodeGeneratorARM::LoadCurrentMethod(Register reg) {
   __ LoadFromOffset(kLoadWord, reg, SP, kCurrentMethodStackOffset);
 }
 
+void CodeGeneratorARM::LoadDexCacheArrayElement(Register out, size_t element_offset) {
+  // The address is built in IP, a high register for which MOVW always has the 32-bit
+  // encoding expected by the linker. The linker replaces the MOVW/MOVT placeholders
+  // with the distance from the PC read by the ADD to the element.
+  uint32_t movw_offset = GetAssembler()->CodeSize();
+  __ movw(IP, 0u);
+  uint32_t movt_offset = GetAssembler()->CodeSize();
+  __ movt(IP, 0u);
+  uint32_t add_pc_offset = GetAssembler()->CodeSize();
+  __ add(IP, IP, ShifterOperand(PC));
+  RecordDexCacheArrayPatch(movw_offset, add_pc_offset, element_offset);
+  RecordDexCacheArrayPatch(movt_offset, add_pc_offset, element_offset);
+  __ LoadFromOffset(kLoadWord, out, IP, 0);
+}
+
+void CodeGeneratorARM::GenerateReferenceLoad(HInstruction* instruction,
+                                             Register out,
+                                             Register obj,
+                                             uint32_t offset,
+                                             Location index,
+                                             Location temp,
+                                             bool needs_null_check) {
+  Label* slow_path_entry = nullptr;
+  Label* slow_path_exit = nullptr;
+  Register lock_word = kNoRegister;
+  if (kEmitCompilerReadBarrier) {
+    // Baker's read barrier: the reference must be marked if `obj` is gray. The lock word
+    // is loaded first, and the address of the reference is made to depend on it, so
+    // that the reference is not read before the read barrier state.
+    lock_word = temp.AsRegister<Register>();
+    __ LoadFromOffset(kLoadWord, lock_word, obj, mirror::Object::MonitorOffset().Int32Value());
+    if (needs_null_check) {
+      MaybeRecordImplicitNullCheck(instruction);
+      needs_null_check = false;
+    }
+    // `obj` is unchanged: a right shift by 32 is 0.
+    __ add(obj, obj, ShifterOperand(lock_word, LSR, 32));
+    SlowPathCodeARM* slow_path = new (GetGraph()->GetArena())
+        ReadBarrierMarkSlowPathARM(instruction, Location::RegisterLocation(out));
+    AddSlowPath(slow_path);
+    slow_path_entry = slow_path->GetEntryLabel();
+    slow_path_exit = slow_path->GetExitLabel();
+  }
+  if (index.IsRegister()) {
+    __ add(IP, obj, ShifterOperand(index.AsRegister<Register>(), LSL, TIMES_4));
+    __ LoadFromOffset(kLoadWord, out, IP, offset);
+  } else {
+    DCHECK(!index.IsValid());
+    __ LoadFromOffset(kLoadWord, out, obj, offset);
+  }
+  if (needs_null_check) {
+    MaybeRecordImplicitNullCheck(instruction);
+  }
+  if (kEmitCompilerReadBarrier) {
+    static_assert(ReadBarrier::gray_ptr_ == 1u, "Gray is not a single bit");
+    __ tst(lock_word, ShifterOperand(1u << LockWord::kReadBarrierStateShift));
+    __ b(slow_path_entry, NE);
+    __ Bind(slow_path_exit);
+  }
+}
+
+void CodeGeneratorARM::GenerateGcRootLoad(HInstruction* instruction,
+                                          Register out,
+                                          Register base,
+                                          uint32_t offset) {
+  __ LoadFromOffset(kLoadWord, out, base, offset);
+  GenerateGcRootReadBarrier(instruction, out);
+}
+
+void CodeGeneratorARM::GenerateGcRootReadBarrier(HInstruction* instruction, Register root) {
+  if (kEmitCompilerReadBarrier) {
+    // GC roots have no read barrier state, mark them whenever the GC is marking.
+    SlowPathCodeARM* slow_path = new (GetGraph()->GetArena())
+        ReadBarrierMarkSlowPathARM(instruction, Location::RegisterLocation(root));
+    AddSlowPath(slow_path);
+    __ LoadFromOffset(
+        kLoadWord, IP, TR, Thread::IsGcMarkingOffset<kArmWordSize>().Int32Value());
+    __ CompareAndBranchIfNonZero(IP, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 static bool TryGenerateIntrinsicCode(HInvoke* invoke, CodeGeneratorARM* codegen) {
   if (invoke->GetLocations()->Intrinsified()) {
     IntrinsicCodeGeneratorARM intrinsic(codegen);
@@ -1318,6 +1436,8 @@ void InstructionCodeGeneratorARM::VisitInvokeVirtual(HInvokeVirtual* invoke) {
   Location receiver = locations->InAt(0);
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
   // temp = object->GetClass();
+  // No read barrier is needed: a from-space class has the same embedded tables as its
+  // to-space copy, and the class is only used to find the method to call.
   if (receiver.IsStackSlot()) {
     __ LoadFromOffset(kLoadWord, temp, SP, receiver.GetStackIndex());
     __ LoadFromOffset(kLoadWord, temp, temp, class_offset);
@@ -2976,8 +3096,13 @@ void InstructionCodeGeneratorARM::HandleFieldSet(HInstruction* instruction,
 
 void LocationsBuilderARM::HandleFieldGet(HInstruction* instruction, const FieldInfo& field_info) {
   DCHECK(instruction->IsInstanceFieldGet() || instruction->IsStaticFieldGet());
+  bool object_field_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (field_info.GetFieldType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_field_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
 
   bool volatile_for_double = field_info.IsVolatile()
@@ -3001,6 +3126,10 @@ void LocationsBuilderARM::HandleFieldGet(HInstruction* instruction, const FieldI
     locations->AddTemp(Location::RequiresRegister());
     locations->AddTemp(Location::RequiresRegister());
   }
+  if (object_field_get_with_read_barrier) {
+    // The lock word of the holder, for the read barrier.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::HandleFieldGet(HInstruction* instruction,
@@ -3036,12 +3165,23 @@ void InstructionCodeGeneratorARM::HandleFieldGet(HInstruction* instruction,
       break;
     }
 
-    case Primitive::kPrimInt:
-    case Primitive::kPrimNot: {
+    case Primitive::kPrimInt: {
       __ LoadFromOffset(kLoadWord, out.AsRegister<Register>(), base, offset);
       break;
     }
 
+    case Primitive::kPrimNot: {
+      codegen_->GenerateReferenceLoad(instruction,
+                                      out.AsRegister<Register>(),
+                                      base,
+                                      offset,
+                                      Location::NoLocation(),
+                                      kEmitCompilerReadBarrier ? locations->GetTemp(0)
+                                                               : Location::NoLocation(),
+                                      true);
+      break;
+    }
+
     case Primitive::kPrimLong: {
       if (is_volatile && !atomic_ldrd_strd) {
         GenerateWideAtomicLoad(base, offset,
@@ -3078,8 +3218,8 @@ void InstructionCodeGeneratorARM::HandleFieldGet(HInstruction* instruction,
       UNREACHABLE();
   }
 
-  // Doubles are handled in the switch.
-  if (field_type != Primitive::kPrimDouble) {
+  // Doubles and references are handled in the switch.
+  if (field_type != Primitive::kPrimDouble && field_type != Primitive::kPrimNot) {
     codegen_->MaybeRecordImplicitNullCheck(instruction);
   }
 
@@ -3159,8 +3299,13 @@ void InstructionCodeGeneratorARM::VisitNullCheck(HNullCheck* instruction) {
 }
 
 void LocationsBuilderARM::VisitArrayGet(HArrayGet* instruction) {
+  bool object_array_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (instruction->GetType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_array_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RegisterOrConstant(instruction->InputAt(1)));
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
@@ -3168,6 +3313,10 @@ void LocationsBuilderARM::VisitArrayGet(HArrayGet* instruction) {
   } else {
     locations->SetOut(Location::RequiresRegister(), Location::kNoOutputOverlap);
   }
+  if (object_array_get_with_read_barrier) {
+    // The lock word of the array, for the read barrier.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitArrayGet(HArrayGet* instruction) {
@@ -3232,9 +3381,7 @@ void InstructionCodeGeneratorARM::VisitArrayGet(HArrayGet* instruction) {
       break;
     }
 
-    case Primitive::kPrimInt:
-    case Primitive::kPrimNot: {
-      DCHECK_EQ(sizeof(mirror::HeapReference<mirror::Object>), sizeof(int32_t));
+    case Primitive::kPrimInt: {
       uint32_t data_offset = mirror::Array::DataOffset(sizeof(int32_t)).Uint32Value();
       Register out = locations->Out().AsRegister<Register>();
       if (index.IsConstant()) {
@@ -3248,6 +3395,23 @@ void InstructionCodeGeneratorARM::VisitArrayGet(HArrayGet* instruction) {
       break;
     }
 
+    case Primitive::kPrimNot: {
+      DCHECK_EQ(sizeof(mirror::HeapReference<mirror::Object>), sizeof(int32_t));
+      uint32_t data_offset =
+          mirror::Array::DataOffset(sizeof(mirror::HeapReference<mirror::Object>)).Uint32Value();
+      Register out = locations->Out().AsRegister<Register>();
+      Location temp = kEmitCompilerReadBarrier ? locations->GetTemp(0) : Location::NoLocation();
+      if (index.IsConstant()) {
+        size_t offset =
+            (index.GetConstant()->AsIntConstant()->GetValue() << TIMES_4) + data_offset;
+        codegen_->GenerateReferenceLoad(
+            instruction, out, obj, offset, Location::NoLocation(), temp, true);
+      } else {
+        codegen_->GenerateReferenceLoad(instruction, out, obj, data_offset, index, temp, true);
+      }
+      break;
+    }
+
     case Primitive::kPrimLong: {
       uint32_t data_offset = mirror::Array::DataOffset(sizeof(int64_t)).Uint32Value();
       Location out = locations->Out();
@@ -3294,7 +3458,10 @@ void InstructionCodeGeneratorARM::VisitArrayGet(HArrayGet* instruction) {
       LOG(FATAL) << "Unreachable type " << instruction->GetType();
       UNREACHABLE();
   }
-  codegen_->MaybeRecordImplicitNullCheck(instruction);
+  // References are handled in the switch.
+  if (instruction->GetType() != Primitive::kPrimNot) {
+    codegen_->MaybeRecordImplicitNullCheck(instruction);
+  }
 }
 
 void LocationsBuilderARM::VisitArraySet(HArraySet* instruction) {
@@ -3784,12 +3951,16 @@ void ParallelMoveResolverARM::RestoreScratch(int reg) {
 }
 
 void LocationsBuilderARM::VisitLoadClass(HLoadClass* cls) {
-  LocationSummary::CallKind call_kind = cls->CanCallRuntime()
+  LocationSummary::CallKind call_kind = (cls->CanCallRuntime() || kEmitCompilerReadBarrier)
       ? LocationSummary::kCallOnSlowPath
       : LocationSummary::kNoCall;
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(cls, call_kind);
   locations->SetOut(Location::RequiresRegister());
+  if (kEmitCompilerReadBarrier) {
+    // The lock word of the resolved types array, for the read barrier.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitLoadClass(HLoadClass* cls) {
@@ -3798,13 +3969,27 @@ void InstructionCodeGeneratorARM::VisitLoadClass(HLoadClass* cls) {
     DCHECK(!cls->CanCallRuntime());
     DCHECK(!cls->MustGenerateClinitCheck());
     codegen_->LoadCurrentMethod(out);
-    __ LoadFromOffset(kLoadWord, out, out, ArtMethod::DeclaringClassOffset().Int32Value());
+    codegen_->GenerateGcRootLoad(
+        cls, out, out, ArtMethod::DeclaringClassOffset().Int32Value());
   } else {
     DCHECK(cls->CanCallRuntime());
-    codegen_->LoadCurrentMethod(out);
-    __ LoadFromOffset(
-        kLoadWord, out, out, ArtMethod::DexCacheResolvedTypesOffset().Int32Value());
-    __ LoadFromOffset(kLoadWord, out, out, CodeGenerator::GetCacheOffset(cls->GetTypeIndex()));
+    if (codegen_->CanUsePcRelativeDexCacheArrayLoads()) {
+      codegen_->LoadDexCacheArrayElement(
+          out, codegen_->GetDexCacheTypeOffset(cls->GetTypeIndex()));
+      codegen_->GenerateGcRootReadBarrier(cls, out);
+    } else {
+      codegen_->LoadCurrentMethod(out);
+      codegen_->GenerateGcRootLoad(
+          cls, out, out, ArtMethod::DexCacheResolvedTypesOffset().Int32Value());
+      codegen_->GenerateReferenceLoad(
+          cls,
+          out,
+          out,
+          CodeGenerator::GetCacheOffset(cls->GetTypeIndex()),
+          Location::NoLocation(),
+          kEmitCompilerReadBarrier ? cls->GetLocations()->GetTemp(0) : Location::NoLocation(),
+          false);
+    }
 
     SlowPathCodeARM* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathARM(
         cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
@@ -3852,6 +4037,10 @@ void LocationsBuilderARM::VisitLoadString(HLoadString* load) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(load, LocationSummary::kCallOnSlowPath);
   locations->SetOut(Location::RequiresRegister());
+  if (kEmitCompilerReadBarrier) {
+    // The lock words of the declaring class and its strings array, for the read barriers.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitLoadString(HLoadString* load) {
@@ -3859,10 +4048,31 @@ void InstructionCodeGeneratorARM::VisitLoadString(HLoadString* load) {
   codegen_->AddSlowPath(slow_path);
 
   Register out = load->GetLocations()->Out().AsRegister<Register>();
-  codegen_->LoadCurrentMethod(out);
-  __ LoadFromOffset(kLoadWord, out, out, ArtMethod::DeclaringClassOffset().Int32Value());
-  __ LoadFromOffset(kLoadWord, out, out, mirror::Class::DexCacheStringsOffset().Int32Value());
-  __ LoadFromOffset(kLoadWord, out, out, CodeGenerator::GetCacheOffset(load->GetStringIndex()));
+  if (codegen_->CanUsePcRelativeDexCacheArrayLoads()) {
+    codegen_->LoadDexCacheArrayElement(
+        out, codegen_->GetDexCacheStringOffset(load->GetStringIndex()));
+    codegen_->GenerateGcRootReadBarrier(load, out);
+  } else {
+    Location temp =
+        kEmitCompilerReadBarrier ? load->GetLocations()->GetTemp(0) : Location::NoLocation();
+    codegen_->LoadCurrentMethod(out);
+    codegen_->GenerateGcRootLoad(
+        load, out, out, ArtMethod::DeclaringClassOffset().Int32Value());
+    codegen_->GenerateReferenceLoad(load,
+                                    out,
+                                    out,
+                                    mirror::Class::DexCacheStringsOffset().Int32Value(),
+                                    Location::NoLocation(),
+                                    temp,
+                                    false);
+    codegen_->GenerateReferenceLoad(load,
+                                    out,
+                                    out,
+                                    CodeGenerator::GetCacheOffset(load->GetStringIndex()),
+                                    Location::NoLocation(),
+                                    temp,
+                                    false);
+  }
   __ cmp(out, ShifterOperand(0));
   __ b(slow_path->GetEntryLabel(), EQ);
   __ Bind(slow_path->GetExitLabel());
@@ -3894,15 +4104,94 @@ void InstructionCodeGeneratorARM::VisitThrow(HThrow* instruction) {
       QUICK_ENTRY_POINT(pDeliverException), instruction, instruction->GetDexPc(), nullptr);
 }
 
+// Temporaries needed by `GenerateTypeCheckWalk`.
+static void AddTypeCheckWalkTemps(LocationSummary* locations, TypeCheckKind kind) {
+  if (kind == TypeCheckKind::kClassHierarchyCheck ||
+      kind == TypeCheckKind::kArrayObjectCheck ||
+      kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+  if (kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+}
+
+void InstructionCodeGeneratorARM::GenerateTypeCheckWalk(TypeCheckKind kind,
+                                                        Register obj_class,
+                                                        Register cls,
+                                                        Location temp1_loc,
+                                                        Location temp2_loc,
+                                                        Label* success,
+                                                        Label* failure) {
+  Register temp = temp1_loc.AsRegister<Register>();
+  switch (kind) {
+    case TypeCheckKind::kClassHierarchyCheck: {
+      // Walk the super class chain until `cls` or null is found.
+      Label loop;
+      __ mov(temp, ShifterOperand(obj_class));
+      __ Bind(&loop);
+      __ LoadFromOffset(kLoadWord, temp, temp, mirror::Class::SuperClassOffset().Int32Value());
+      __ CompareAndBranchIfZero(temp, failure);
+      __ cmp(temp, ShifterOperand(cls));
+      __ b(&loop, NE);
+      __ b(success);
+      break;
+    }
+    case TypeCheckKind::kArrayObjectCheck: {
+      // `obj_class` must be an array class whose component type is not primitive.
+      __ LoadFromOffset(
+          kLoadWord, temp, obj_class, mirror::Class::ComponentTypeOffset().Int32Value());
+      __ CompareAndBranchIfZero(temp, failure);
+      static_assert(Primitive::kPrimNot == 0, "Expected 0 for kPrimNot");
+      __ LoadFromOffset(
+          kLoadUnsignedHalfword, temp, temp, mirror::Class::PrimitiveTypeOffset().Int32Value());
+      __ CompareAndBranchIfNonZero(temp, failure);
+      __ b(success);
+      break;
+    }
+    case TypeCheckKind::kInterfaceCheck: {
+      // Scan the (interface, method array) pairs of the interface table.
+      Register count = temp2_loc.AsRegister<Register>();
+      uint32_t data_offset =
+          mirror::Array::DataOffset(sizeof(mirror::HeapReference<mirror::Object>)).Uint32Value();
+      Label loop;
+      __ LoadFromOffset(kLoadWord, temp, obj_class, mirror::Class::IfTableOffset().Int32Value());
+      // Classes that implement no interface have no interface table.
+      __ CompareAndBranchIfZero(temp, failure);
+      __ LoadFromOffset(kLoadWord, count, temp, mirror::Array::LengthOffset().Int32Value());
+      __ Bind(&loop);
+      __ CompareAndBranchIfZero(count, failure);
+      __ LoadFromOffset(kLoadWord, IP, temp, data_offset);
+      __ cmp(IP, ShifterOperand(cls));
+      __ b(success, EQ);
+      __ AddConstant(
+          temp, temp, mirror::IfTable::kMax * sizeof(mirror::HeapReference<mirror::Object>));
+      __ AddConstant(count, count, -mirror::IfTable::kMax);
+      __ b(&loop);
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unexpected type check kind " << static_cast<int>(kind);
+      UNREACHABLE();
+  }
+}
+
 void LocationsBuilderARM::VisitInstanceOf(HInstanceOf* instruction) {
-  LocationSummary::CallKind call_kind = instruction->IsClassFinal()
-      ? LocationSummary::kNoCall
-      : LocationSummary::kCallOnSlowPath;
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
+  LocationSummary::CallKind call_kind = (kind == TypeCheckKind::kUnknownCheck ||
+                                         kEmitCompilerReadBarrier)
+      ? LocationSummary::kCallOnSlowPath
+      : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction, call_kind);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
   // The out register is used as a temporary, so it overlaps with the inputs.
   locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+  AddTypeCheckWalkTemps(locations, kind);
+  if (kEmitCompilerReadBarrier) {
+    // The lock word of `obj`, for the read barrier.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitInstanceOf(HInstanceOf* instruction) {
@@ -3911,6 +4200,7 @@ void InstructionCodeGeneratorARM::VisitInstanceOf(HInstanceOf* instruction) {
   Register cls = locations->InAt(1).AsRegister<Register>();
   Register out = locations->Out().AsRegister<Register>();
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
   Label done, zero;
   SlowPathCodeARM* slow_path = nullptr;
 
@@ -3921,14 +4211,22 @@ void InstructionCodeGeneratorARM::VisitInstanceOf(HInstanceOf* instruction) {
     __ b(&zero, EQ);
   }
   // Compare the class of `obj` with `cls`.
-  __ LoadFromOffset(kLoadWord, out, obj, class_offset);
+  codegen_->GenerateReferenceLoad(instruction,
+                                  out,
+                                  obj,
+                                  class_offset,
+                                  Location::NoLocation(),
+                                  kEmitCompilerReadBarrier
+                                      ? locations->GetTemp(locations->GetTempCount() - 1)
+                                      : Location::NoLocation(),
+                                  false);
   __ cmp(out, ShifterOperand(cls));
-  if (instruction->IsClassFinal()) {
+  if (kind == TypeCheckKind::kExactCheck) {
     // Classes must be equal for the instanceof to succeed.
     __ b(&zero, NE);
     __ LoadImmediate(out, 1);
     __ b(&done);
-  } else {
+  } else if (kind == TypeCheckKind::kUnknownCheck) {
     // If the classes are not equal, we go into a slow path.
     DCHECK(locations->OnlyCallsOnSlowPath());
     slow_path = new (GetGraph()->GetArena()) TypeCheckSlowPathARM(
@@ -3937,9 +4235,24 @@ void InstructionCodeGeneratorARM::VisitInstanceOf(HInstanceOf* instruction) {
     __ b(slow_path->GetEntryLabel(), NE);
     __ LoadImmediate(out, 1);
     __ b(&done);
+  } else {
+    // The inline walk gives a definite answer, no need for the runtime.
+    Label one;
+    __ b(&one, EQ);
+    GenerateTypeCheckWalk(kind,
+                          out,
+                          cls,
+                          locations->GetTemp(0),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(1)
+                                                                 : Location::NoLocation(),
+                          &one,
+                          &zero);
+    __ Bind(&one);
+    __ LoadImmediate(out, 1);
+    __ b(&done);
   }
 
-  if (instruction->MustDoNullCheck() || instruction->IsClassFinal()) {
+  if (instruction->MustDoNullCheck() || kind != TypeCheckKind::kUnknownCheck) {
     __ Bind(&zero);
     __ LoadImmediate(out, 0);
   }
@@ -3956,6 +4269,11 @@ void LocationsBuilderARM::VisitCheckCast(HCheckCast* instruction) {
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  AddTypeCheckWalkTemps(locations, instruction->GetTypeCheckKind());
+  if (kEmitCompilerReadBarrier) {
+    // The lock word of `obj`, for the read barrier.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitCheckCast(HCheckCast* instruction) {
@@ -3964,6 +4282,7 @@ void InstructionCodeGeneratorARM::VisitCheckCast(HCheckCast* instruction) {
   Register cls = locations->InAt(1).AsRegister<Register>();
   Register temp = locations->GetTemp(0).AsRegister<Register>();
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
 
   SlowPathCodeARM* slow_path = new (GetGraph()->GetArena()) TypeCheckSlowPathARM(
       instruction, locations->InAt(1), locations->GetTemp(0), instruction->GetDexPc());
@@ -3975,9 +4294,30 @@ void InstructionCodeGeneratorARM::VisitCheckCast(HCheckCast* instruction) {
     __ b(slow_path->GetExitLabel(), EQ);
   }
   // Compare the class of `obj` with `cls`.
-  __ LoadFromOffset(kLoadWord, temp, obj, class_offset);
+  codegen_->GenerateReferenceLoad(instruction,
+                                  temp,
+                                  obj,
+                                  class_offset,
+                                  Location::NoLocation(),
+                                  kEmitCompilerReadBarrier
+                                      ? locations->GetTemp(locations->GetTempCount() - 1)
+                                      : Location::NoLocation(),
+                                  false);
   __ cmp(temp, ShifterOperand(cls));
-  __ b(slow_path->GetEntryLabel(), NE);
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    __ b(slow_path->GetEntryLabel(), NE);
+  } else {
+    // The slow path is only taken to throw the ClassCastException.
+    __ b(slow_path->GetExitLabel(), EQ);
+    GenerateTypeCheckWalk(kind,
+                          temp,
+                          cls,
+                          locations->GetTemp(1),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(2)
+                                                                 : Location::NoLocation(),
+                          slow_path->GetExitLabel(),
+                          slow_path->GetEntryLabel());
+  }
   __ Bind(slow_path->GetExitLabel());
 }
 
@@ -3986,14 +4326,87 @@ void LocationsBuilderARM::VisitMonitorOperation(HMonitorOperation* instruction)
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
   locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  // Lock word, thread id and lock word address of the thin lock fast path.
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(2)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(3)));
+}
+
+void InstructionCodeGeneratorARM::GenerateThinLockFastPath(HMonitorOperation* instruction,
+                                                           Label* slow_path,
+                                                           Label* done) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register obj = locations->InAt(0).AsRegister<Register>();
+  Register lock_word = locations->GetTemp(0).AsRegister<Register>();
+  Register thread_id = locations->GetTemp(1).AsRegister<Register>();
+  Register address = locations->GetTemp(2).AsRegister<Register>();
+  static_assert(LockWord::kThinLockOwnerShift == 0 && LockWord::kThinLockOwnerSize == 16,
+                "Unexpected thin lock owner layout");
+
+  __ CompareAndBranchIfZero(obj, slow_path);
+  __ AddConstant(address, obj, mirror::Object::MonitorOffset().Int32Value());
+  __ LoadFromOffset(
+      kLoadWord, thread_id, TR, Thread::ThinLockIdOffset<kArmWordSize>().Int32Value());
+  if (instruction->IsEnter()) {
+    Label retry, not_unlocked;
+    __ Bind(&retry);
+    __ ldrex(lock_word, address);
+    __ CompareAndBranchIfNonZero(lock_word, &not_unlocked);
+    // Unlocked: install this thread as the owner, with a recursion count of 0.
+    __ strex(IP, thread_id, address);
+    __ CompareAndBranchIfNonZero(IP, &retry);
+    __ dmb(ISH);
+    __ b(done);
+    __ Bind(&not_unlocked);
+    // Thin lock held by this thread: increment the recursion count, unless it overflows.
+    // Only the owner updates a thin lock word, so a plain store is enough. Contention is
+    // left to the runtime.
+    __ eor(IP, lock_word, ShifterOperand(thread_id));
+    __ Lsl(IP, IP, 32 - LockWord::kThinLockOwnerSize, true);  // Owner bits.
+    __ b(slow_path, NE);
+    __ tst(lock_word, ShifterOperand(LockWord::kStateMaskShifted));
+    __ b(slow_path, NE);
+    __ AddConstant(lock_word, lock_word, LockWord::kThinLockCountOne);
+    __ tst(lock_word, ShifterOperand(LockWord::kStateMaskShifted |
+                                     LockWord::kReadBarrierStateMaskShifted));
+    __ b(slow_path, NE);
+    __ str(lock_word, Address(address));
+    __ b(done);
+  } else {
+    Label recursive;
+    __ ldr(lock_word, Address(address));
+    __ eor(IP, lock_word, ShifterOperand(thread_id));
+    __ Lsl(IP, IP, 32 - LockWord::kThinLockOwnerSize, true);  // Owner bits.
+    __ b(slow_path, NE);
+    __ tst(lock_word, ShifterOperand(LockWord::kStateMaskShifted));
+    __ b(slow_path, NE);
+    __ cmp(lock_word, ShifterOperand(LockWord::kThinLockCountOne));
+    __ b(&recursive, HS);
+    __ dmb(ISH);
+    __ LoadImmediate(lock_word, 0);
+    __ str(lock_word, Address(address));
+    __ b(done);
+    __ Bind(&recursive);
+    __ AddConstant(lock_word, lock_word, -LockWord::kThinLockCountOne);
+    __ str(lock_word, Address(address));
+    __ b(done);
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitMonitorOperation(HMonitorOperation* instruction) {
+  Label slow_path;
+  Label done;
+  // The fast path does not preserve the read barrier bits of the lock word.
+  if (!kUseReadBarrier) {
+    GenerateThinLockFastPath(instruction, &slow_path, &done);
+    __ Bind(&slow_path);
+  }
   codegen_->InvokeRuntime(instruction->IsEnter()
         ? QUICK_ENTRY_POINT(pLockObject) : QUICK_ENTRY_POINT(pUnlockObject),
       instruction,
       instruction->GetDexPc(),
       nullptr);
+  __ Bind(&done);
 }
 
 void LocationsBuilderARM::VisitAnd(HAnd* instruction) { HandleBitwiseOperation(instruction); }
@@ -4087,23 +4500,36 @@ void CodeGeneratorARM::GenerateStaticOrDirectCall(HInvokeStaticOrDirect* invoke,
                           kArmWordSize).Int32Value());
     // LR()
     __ blx(LR);
-  } else {
+  } else if (invoke->IsRecursive()) {
     // temp = method;
     LoadCurrentMethod(temp);
-    if (!invoke->IsRecursive()) {
+    __ bl(GetFrameEntryLabel());
+  } else {
+    if (CanUsePcRelativeDexCacheArrayLoads()) {
+      // temp = dex_cache_resolved_methods_[index_in_cache], addressed PC-relatively
+      LoadDexCacheArrayElement(temp, GetDexCacheMethodOffset(invoke->GetDexMethodIndex()));
+    } else {
+      // temp = method;
+      LoadCurrentMethod(temp);
       // temp = temp->dex_cache_resolved_methods_;
       __ LoadFromOffset(
           kLoadWord, temp, temp, ArtMethod::DexCacheResolvedMethodsOffset().Int32Value());
       // temp = temp[index_in_cache]
       __ LoadFromOffset(
           kLoadWord, temp, temp, CodeGenerator::GetCacheOffset(invoke->GetDexMethodIndex()));
+    }
+    if (invoke->GetCodePtrLocation() ==
+        HInvokeStaticOrDirect::CodePtrLocation::kCallPCRelative) {
+      // The BL is a placeholder: the linker redirects it to the callee's code, going
+      // through a thunk if the callee is out of range.
+      RecordRelativeCallPatch(GetAssembler()->CodeSize(), invoke->GetDexMethodIndex());
+      __ bl(GetFrameEntryLabel());
+    } else {
       // LR = temp[offset_of_quick_compiled_code]
       __ LoadFromOffset(kLoadWord, LR, temp, ArtMethod::EntryPointFromQuickCompiledCodeOffset(
           kArmWordSize).Int32Value());
       // LR()
       __ blx(LR);
-    } else {
-      __ bl(GetFrameEntryLabel());
     }
   }
 
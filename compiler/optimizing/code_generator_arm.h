@@ -175,6 +175,18 @@ class InstructionCodeGeneratorARM : public HGraphVisitor {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* check, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCodeARM* slow_path, Register class_reg);
+  // Thin lock acquire or release for `instruction`. Branches to `done` on success, or to
+  // `slow_path` if the runtime is needed.
+  void GenerateThinLockFastPath(HMonitorOperation* instruction, Label* slow_path, Label* done);
+  // Inline part of a type check of kind `kind`, after `obj_class` was found to differ
+  // from `cls`. Branches to `success` or `failure`, preserving `obj_class`.
+  void GenerateTypeCheckWalk(TypeCheckKind kind,
+                             Register obj_class,
+                             Register cls,
+                             Location temp1,
+                             Location temp2,
+                             Label* success,
+                             Label* failure);
   void HandleBitwiseOperation(HBinaryOperation* operation);
   void HandleShift(HBinaryOperation* operation);
   void GenerateMemoryBarrier(MemBarrierKind kind);
@@ -268,6 +280,31 @@ class CodeGeneratorARM : public CodeGenerator {
   // Load current method into `reg`.
   void LoadCurrentMethod(Register reg);
 
+  // Load the entry at `element_offset` in the dex cache arrays with a PC-relative
+  // address patched by the linker. Only valid if CanUsePcRelativeDexCacheArrayLoads().
+  // Clobbers IP.
+  void LoadDexCacheArrayElement(Register out, size_t element_offset);
+
+  // Load the heap reference at `offset` in `obj`, scaled `index` words further if `index`
+  // is a register, into `out` with a read barrier if the compiler emits them. The read
+  // barrier needs the core register `temp`. Records the implicit null check of
+  // `instruction` on the first access to `obj` if `needs_null_check`. Clobbers IP.
+  void GenerateReferenceLoad(HInstruction* instruction,
+                             Register out,
+                             Register obj,
+                             uint32_t offset,
+                             Location index,
+                             Location temp,
+                             bool needs_null_check);
+
+  // Load the GC root at `offset` in `base`, which is not a heap object, into `out` with
+  // a read barrier if the compiler emits them. Clobbers IP.
+  void GenerateGcRootLoad(HInstruction* instruction, Register out, Register base, uint32_t offset);
+
+  // Emit the read barrier for the GC root just loaded into `root`, if the compiler emits
+  // them. Clobbers IP.
+  void GenerateGcRootReadBarrier(HInstruction* instruction, Register root);
+
   // Generate code to invoke a runtime entry point.
   void InvokeRuntime(
       int32_t offset, HInstruction* instruction, uint32_t dex_pc, SlowPathCode* slow_path);
@@ -24,9 +24,12 @@
 #include "gc/accounting/card_table.h"
 #include "intrinsics.h"
 #include "intrinsics_arm64.h"
+#include "lock_word.h"
 #include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
+#include "mirror/iftable.h"
 #include "offsets.h"
+#include "read_barrier.h"
 #include "thread.h"
 #include "utils/arm64/assembler_arm64.h"
 #include "utils/assembler.h"
@@ -353,6 +356,42 @@ class TypeCheckSlowPathARM64 : public SlowPathCodeARM64 {
   DISALLOW_COPY_AND_ASSIGN(TypeCheckSlowPathARM64);
 };
 
+// Slow path marking the reference in `ref` loaded by a read barrier, replacing it
+// with the to-space reference.
+class ReadBarrierMarkSlowPathARM64 : public SlowPathCodeARM64 {
+ public:
+  ReadBarrierMarkSlowPathARM64(HInstruction* instruction, Location ref)
+      : instruction_(instruction), ref_(ref) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(locations->OnlyCallsOnSlowPath());
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(ref_.reg()));
+    CodeGeneratorARM64* arm64_codegen = down_cast<CodeGeneratorARM64*>(codegen);
+
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    arm64_codegen->MoveLocation(
+        LocationFrom(calling_convention.GetRegisterAt(0)), ref_, Primitive::kPrimNot);
+    arm64_codegen->InvokeRuntime(
+        QUICK_ENTRY_POINT(pReadBarrierMark), instruction_, instruction_->GetDexPc(), this);
+    arm64_codegen->MoveLocation(
+        ref_, calling_convention.GetReturnLocation(Primitive::kPrimNot), Primitive::kPrimNot);
+    CheckEntrypointTypes<kQuickReadBarrierMark, mirror::Object*, mirror::Object*>();
+
+    RestoreLiveRegisters(codegen, locations);
+    __ B(GetExitLabel());
+  }
+
+ private:
+  HInstruction* const instruction_;
+  const Location ref_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadBarrierMarkSlowPathARM64);
+};
+
 class DeoptimizationSlowPathARM64 : public SlowPathCodeARM64 {
  public:
   explicit DeoptimizationSlowPathARM64(HInstruction* instruction)
@@ -971,6 +1010,77 @@ void CodeGeneratorARM64::LoadCurrentMethod(vixl::Register current_method) {
   __ Ldr(current_method, MemOperand(sp, kCurrentMethodStackOffset));
 }
 
+void CodeGeneratorARM64::LoadDexCacheArrayElement(vixl::Register out, size_t element_offset) {
+  // The linker needs the exact ADRP and LDR instructions, keep pools out of the way.
+  BlockPoolsScope block_pools(GetVIXLAssembler());
+  // The immediates are placeholders, the linker fills in the page of the element
+  // relative to the page of the ADRP, and the offset of the element within that page.
+  uint32_t adrp_offset = GetAssembler()->CodeSize();
+  __ adrp(out.X(), 0);
+  RecordDexCacheArrayPatch(adrp_offset, adrp_offset, element_offset);
+  uint32_t ldr_offset = GetAssembler()->CodeSize();
+  __ ldr(out, MemOperand(out.X(), 0));
+  RecordDexCacheArrayPatch(ldr_offset, adrp_offset, element_offset);
+}
+
+void CodeGeneratorARM64::GenerateReferenceLoad(HInstruction* instruction,
+                                               vixl::Register out,
+                                               vixl::Register obj,
+                                               const vixl::MemOperand& src,
+                                               bool needs_null_check) {
+  BlockPoolsScope block_pools(GetVIXLAssembler());
+  if (!kEmitCompilerReadBarrier) {
+    Load(Primitive::kPrimNot, out, src);
+    if (needs_null_check) {
+      MaybeRecordImplicitNullCheck(instruction);
+    }
+    return;
+  }
+  // Baker's read barrier: the reference must be marked if `obj` is gray. The lock word
+  // is loaded first, and the address of the reference is made to depend on it, so that
+  // the reference is not read before the read barrier state.
+  DCHECK(src.IsImmediateOffset());
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  Register lock_word = temps.AcquireW();
+  __ Ldr(lock_word, HeapOperand(obj, mirror::Object::MonitorOffset()));
+  if (needs_null_check) {
+    MaybeRecordImplicitNullCheck(instruction);
+  }
+  // The base of `src` is unchanged: the lock word is zero-extended, so shifting it right
+  // by 32 gives 0.
+  __ Add(src.base(), src.base(), Operand(lock_word.X(), LSR, 32));
+  Load(Primitive::kPrimNot, out, src);
+  SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena())
+      ReadBarrierMarkSlowPathARM64(instruction, LocationFrom(out));
+  AddSlowPath(slow_path);
+  static_assert(ReadBarrier::gray_ptr_ == 1u, "Gray is not a single bit");
+  __ Tbnz(lock_word, LockWord::kReadBarrierStateShift, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void CodeGeneratorARM64::GenerateGcRootLoad(HInstruction* instruction,
+                                            vixl::Register out,
+                                            const vixl::MemOperand& src) {
+  __ Ldr(out, src);
+  GenerateGcRootReadBarrier(instruction, out);
+}
+
+void CodeGeneratorARM64::GenerateGcRootReadBarrier(HInstruction* instruction,
+                                                   vixl::Register root) {
+  if (kEmitCompilerReadBarrier) {
+    // GC roots have no read barrier state, mark them whenever the GC is marking.
+    SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena())
+        ReadBarrierMarkSlowPathARM64(instruction, LocationFrom(root));
+    AddSlowPath(slow_path);
+    UseScratchRegisterScope temps(GetVIXLAssembler());
+    Register is_gc_marking = temps.AcquireW();
+    __ Ldr(is_gc_marking,
+           MemOperand(tr, Thread::IsGcMarkingOffset<kArm64WordSize>().Int32Value()));
+    __ Cbnz(is_gc_marking, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 void CodeGeneratorARM64::InvokeRuntime(int32_t entry_point_offset,
                                        HInstruction* instruction,
                                        uint32_t dex_pc,
@@ -1051,6 +1161,20 @@ void InstructionCodeGeneratorARM64::GenerateSuspendCheck(HSuspendCheck* instruct
   }
 
   UseScratchRegisterScope temps(codegen_->GetVIXLAssembler());
+  if (successor != nullptr && codegen_->GetCompilerOptions().GetImplicitSuspendChecks()) {
+    // Load through the thread's suspend trigger. The trigger is cleared when a suspension
+    // is requested, so the second load faults and SuspensionHandler resumes execution at
+    // the branch to the slow path. The exact sequence is matched by the fault handler.
+    Register trigger = temps.AcquireX();
+    BlockPoolsScope block_pools(GetVIXLAssembler());
+    __ ldr(trigger,
+           MemOperand(tr, Thread::ThreadSuspendTriggerOffset<kArm64WordSize>().Int32Value()));
+    __ ldr(wzr, MemOperand(trigger, 0));
+    codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+    __ B(codegen_->GetLabelOf(successor));
+    __ B(slow_path->GetEntryLabel());
+    return;
+  }
   Register temp = temps.AcquireW();
 
   __ Ldrh(temp, MemOperand(tr, Thread::ThreadFlagsOffset<kArm64WordSize>().SizeValue()));
@@ -1123,8 +1247,13 @@ void LocationsBuilderARM64::HandleBinaryOp(HBinaryOperation* instr) {
 }
 
 void LocationsBuilderARM64::HandleFieldGet(HInstruction* instruction) {
+  bool object_field_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (instruction->GetType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_field_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
     locations->SetOut(Location::RequiresFpuRegister());
@@ -1141,7 +1270,15 @@ void InstructionCodeGeneratorARM64::HandleFieldGet(HInstruction* instruction,
   MemOperand field = HeapOperand(InputRegisterAt(instruction, 0), field_info.GetFieldOffset());
   bool use_acquire_release = codegen_->GetInstructionSetFeatures().PreferAcquireRelease();
 
-  if (field_info.IsVolatile()) {
+  if (kEmitCompilerReadBarrier && field_info.GetFieldType() == Primitive::kPrimNot) {
+    // The implicit null check is taken by the lock word load of the read barrier, so
+    // volatile references use a plain load followed by a barrier rather than LoadAcquire.
+    codegen_->GenerateReferenceLoad(
+        instruction, OutputRegister(instruction), InputRegisterAt(instruction, 0), field, true);
+    if (field_info.IsVolatile()) {
+      GenerateMemoryBarrier(MemBarrierKind::kAnyAny);
+    }
+  } else if (field_info.IsVolatile()) {
     if (use_acquire_release) {
       // NB: LoadAcquire will record the pc info if needed.
       codegen_->LoadAcquire(instruction, OutputCPURegister(instruction), field);
@@ -1315,8 +1452,13 @@ void InstructionCodeGeneratorARM64::VisitAnd(HAnd* instruction) {
 }
 
 void LocationsBuilderARM64::VisitArrayGet(HArrayGet* instruction) {
+  bool object_array_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (instruction->GetType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_array_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RegisterOrConstant(instruction->InputAt(1)));
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
@@ -1347,8 +1489,12 @@ void InstructionCodeGeneratorARM64::VisitArrayGet(HArrayGet* instruction) {
     source = HeapOperand(temp, offset);
   }
 
-  codegen_->Load(type, OutputCPURegister(instruction), source);
-  codegen_->MaybeRecordImplicitNullCheck(instruction);
+  if (type == Primitive::kPrimNot) {
+    codegen_->GenerateReferenceLoad(instruction, OutputRegister(instruction), obj, source, true);
+  } else {
+    codegen_->Load(type, OutputCPURegister(instruction), source);
+    codegen_->MaybeRecordImplicitNullCheck(instruction);
+  }
 }
 
 void LocationsBuilderARM64::VisitArrayLength(HArrayLength* instruction) {
@@ -1446,12 +1592,84 @@ void InstructionCodeGeneratorARM64::VisitBoundsCheck(HBoundsCheck* instruction)
   __ B(slow_path->GetEntryLabel(), hs);
 }
 
+// Temporaries needed by `GenerateTypeCheckWalk`.
+static void AddTypeCheckWalkTemps(LocationSummary* locations, TypeCheckKind kind) {
+  if (kind == TypeCheckKind::kClassHierarchyCheck ||
+      kind == TypeCheckKind::kArrayObjectCheck ||
+      kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+  if (kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+}
+
+void InstructionCodeGeneratorARM64::GenerateTypeCheckWalk(TypeCheckKind kind,
+                                                          Register obj_class,
+                                                          Register cls,
+                                                          Location temp1_loc,
+                                                          Location temp2_loc,
+                                                          vixl::Label* success,
+                                                          vixl::Label* failure) {
+  Register temp = WRegisterFrom(temp1_loc);
+  switch (kind) {
+    case TypeCheckKind::kClassHierarchyCheck: {
+      // Walk the super class chain until `cls` or null is found.
+      vixl::Label loop;
+      __ Mov(temp, obj_class);
+      __ Bind(&loop);
+      __ Ldr(temp, HeapOperand(temp, mirror::Class::SuperClassOffset()));
+      __ Cbz(temp, failure);
+      __ Cmp(temp, cls);
+      __ B(ne, &loop);
+      __ B(success);
+      break;
+    }
+    case TypeCheckKind::kArrayObjectCheck: {
+      // `obj_class` must be an array class whose component type is not primitive.
+      __ Ldr(temp, HeapOperand(obj_class, mirror::Class::ComponentTypeOffset()));
+      __ Cbz(temp, failure);
+      static_assert(Primitive::kPrimNot == 0, "Expected 0 for kPrimNot");
+      __ Ldrh(temp, HeapOperand(temp, mirror::Class::PrimitiveTypeOffset()));
+      __ Cbnz(temp, failure);
+      __ B(success);
+      break;
+    }
+    case TypeCheckKind::kInterfaceCheck: {
+      // Scan the (interface, method array) pairs of the interface table.
+      Register count = WRegisterFrom(temp2_loc);
+      UseScratchRegisterScope temps(GetVIXLAssembler());
+      Register interface = temps.AcquireW();
+      uint32_t data_offset =
+          mirror::Array::DataOffset(sizeof(mirror::HeapReference<mirror::Object>)).Uint32Value();
+      vixl::Label loop;
+      __ Ldr(temp, HeapOperand(obj_class, mirror::Class::IfTableOffset()));
+      // Classes that implement no interface have no interface table.
+      __ Cbz(temp, failure);
+      __ Ldr(count, HeapOperand(temp, mirror::Array::LengthOffset()));
+      __ Bind(&loop);
+      __ Cbz(count, failure);
+      __ Ldr(interface, HeapOperand(temp, data_offset));
+      __ Cmp(interface, cls);
+      __ B(eq, success);
+      __ Add(temp, temp, mirror::IfTable::kMax * sizeof(mirror::HeapReference<mirror::Object>));
+      __ Sub(count, count, mirror::IfTable::kMax);
+      __ B(&loop);
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unexpected type check kind " << static_cast<int>(kind);
+      UNREACHABLE();
+  }
+}
+
 void LocationsBuilderARM64::VisitCheckCast(HCheckCast* instruction) {
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(
       instruction, LocationSummary::kCallOnSlowPath);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  AddTypeCheckWalkTemps(locations, instruction->GetTypeCheckKind());
 }
 
 void InstructionCodeGeneratorARM64::VisitCheckCast(HCheckCast* instruction) {
@@ -1459,6 +1677,7 @@ void InstructionCodeGeneratorARM64::VisitCheckCast(HCheckCast* instruction) {
   Register obj = InputRegisterAt(instruction, 0);;
   Register cls = InputRegisterAt(instruction, 1);;
   Register obj_cls = WRegisterFrom(instruction->GetLocations()->GetTemp(0));
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
 
   SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) TypeCheckSlowPathARM64(
       instruction, locations->InAt(1), LocationFrom(obj_cls), instruction->GetDexPc());
@@ -1469,9 +1688,23 @@ void InstructionCodeGeneratorARM64::VisitCheckCast(HCheckCast* instruction) {
     __ Cbz(obj, slow_path->GetExitLabel());
   }
   // Compare the class of `obj` with `cls`.
-  __ Ldr(obj_cls, HeapOperand(obj, mirror::Object::ClassOffset()));
+  codegen_->GenerateReferenceLoad(
+      instruction, obj_cls, obj, HeapOperand(obj, mirror::Object::ClassOffset()), false);
   __ Cmp(obj_cls, cls);
-  __ B(ne, slow_path->GetEntryLabel());
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    __ B(ne, slow_path->GetEntryLabel());
+  } else {
+    // The slow path is only taken to throw the ClassCastException.
+    __ B(eq, slow_path->GetExitLabel());
+    GenerateTypeCheckWalk(kind,
+                          obj_cls,
+                          cls,
+                          locations->GetTemp(1),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(2)
+                                                                 : Location::NoLocation(),
+                          slow_path->GetExitLabel(),
+                          slow_path->GetEntryLabel());
+  }
   __ Bind(slow_path->GetExitLabel());
 }
 
@@ -1851,13 +2084,17 @@ void InstructionCodeGeneratorARM64::VisitInstanceFieldSet(HInstanceFieldSet* ins
 }
 
 void LocationsBuilderARM64::VisitInstanceOf(HInstanceOf* instruction) {
-  LocationSummary::CallKind call_kind =
-      instruction->IsClassFinal() ? LocationSummary::kNoCall : LocationSummary::kCallOnSlowPath;
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
+  LocationSummary::CallKind call_kind = (kind == TypeCheckKind::kUnknownCheck ||
+                                         kEmitCompilerReadBarrier)
+      ? LocationSummary::kCallOnSlowPath
+      : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction, call_kind);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RequiresRegister());
   // The output does overlap inputs.
   locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+  AddTypeCheckWalkTemps(locations, kind);
 }
 
 void InstructionCodeGeneratorARM64::VisitInstanceOf(HInstanceOf* instruction) {
@@ -1865,6 +2102,7 @@ void InstructionCodeGeneratorARM64::VisitInstanceOf(HInstanceOf* instruction) {
   Register obj = InputRegisterAt(instruction, 0);;
   Register cls = InputRegisterAt(instruction, 1);;
   Register out = OutputRegister(instruction);
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
 
   vixl::Label done;
 
@@ -1876,12 +2114,13 @@ void InstructionCodeGeneratorARM64::VisitInstanceOf(HInstanceOf* instruction) {
   }
 
   // Compare the class of `obj` with `cls`.
-  __ Ldr(out, HeapOperand(obj, mirror::Object::ClassOffset()));
+  codegen_->GenerateReferenceLoad(
+      instruction, out, obj, HeapOperand(obj, mirror::Object::ClassOffset()), false);
   __ Cmp(out, cls);
-  if (instruction->IsClassFinal()) {
+  if (kind == TypeCheckKind::kExactCheck) {
     // Classes must be equal for the instanceof to succeed.
     __ Cset(out, eq);
-  } else {
+  } else if (kind == TypeCheckKind::kUnknownCheck) {
     // If the classes are not equal, we go into a slow path.
     DCHECK(locations->OnlyCallsOnSlowPath());
     SlowPathCodeARM64* slow_path =
@@ -1891,6 +2130,23 @@ void InstructionCodeGeneratorARM64::VisitInstanceOf(HInstanceOf* instruction) {
     __ B(ne, slow_path->GetEntryLabel());
     __ Mov(out, 1);
     __ Bind(slow_path->GetExitLabel());
+  } else {
+    // The inline walk gives a definite answer, no need for the runtime.
+    vixl::Label one, zero;
+    __ B(eq, &one);
+    GenerateTypeCheckWalk(kind,
+                          out,
+                          cls,
+                          locations->GetTemp(0),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(1)
+                                                                 : Location::NoLocation(),
+                          &one,
+                          &zero);
+    __ Bind(&zero);
+    __ Mov(out, 0);
+    __ B(&done);
+    __ Bind(&one);
+    __ Mov(out, 1);
   }
 
   __ Bind(&done);
@@ -1973,7 +2229,8 @@ void InstructionCodeGeneratorARM64::VisitInvokeInterface(HInvokeInterface* invok
 }
 
 void LocationsBuilderARM64::VisitInvokeVirtual(HInvokeVirtual* invoke) {
-  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena());
+  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena(),
+                                           codegen_->GetInstructionSetFeatures());
   if (intrinsic.TryDispatch(invoke)) {
     return;
   }
@@ -1986,7 +2243,8 @@ void LocationsBuilderARM64::VisitInvokeStaticOrDirect(HInvokeStaticOrDirect* inv
   // invokes must have been pruned by art::PrepareForRegisterAllocation.
   DCHECK(codegen_->IsBaseline() || !invoke->IsStaticWithExplicitClinitCheck());
 
-  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena());
+  IntrinsicLocationsBuilderARM64 intrinsic(GetGraph()->GetArena(),
+                                           codegen_->GetInstructionSetFeatures());
   if (intrinsic.TryDispatch(invoke)) {
     return;
   }
@@ -2023,22 +2281,36 @@ void CodeGeneratorARM64::GenerateStaticOrDirectCall(HInvokeStaticOrDirect* invok
         temp, ArtMethod::EntryPointFromQuickCompiledCodeOffset(kArm64WordSize).Int32Value()));
     // lr()
     __ Blr(lr);
-  } else {
+  } else if (invoke->IsRecursive()) {
     // temp = method;
     LoadCurrentMethod(temp.X());
-    if (!invoke->IsRecursive()) {
+    __ Bl(&frame_entry_label_);
+  } else {
+    if (CanUsePcRelativeDexCacheArrayLoads()) {
+      // temp = dex_cache_resolved_methods_[index_in_cache], addressed PC-relatively;
+      LoadDexCacheArrayElement(temp.X(), GetDexCacheMethodOffset(invoke->GetDexMethodIndex()));
+    } else {
+      // temp = method;
+      LoadCurrentMethod(temp.X());
       // temp = temp->dex_cache_resolved_methods_;
       __ Ldr(temp.W(), MemOperand(temp.X(),
                                   ArtMethod::DexCacheResolvedMethodsOffset().Int32Value()));
       // temp = temp[index_in_cache];
       __ Ldr(temp.X(), MemOperand(temp, index_in_cache));
+    }
+    if (invoke->GetCodePtrLocation() ==
+        HInvokeStaticOrDirect::CodePtrLocation::kCallPCRelative) {
+      // The BL is a placeholder: the linker redirects it to the callee's code, going
+      // through a thunk if the callee is out of range.
+      BlockPoolsScope block_pools(GetVIXLAssembler());
+      RecordRelativeCallPatch(GetAssembler()->CodeSize(), invoke->GetDexMethodIndex());
+      __ Bl(&frame_entry_label_);
+    } else {
       // lr = temp->entry_point_from_quick_compiled_code_;
       __ Ldr(lr, MemOperand(temp.X(), ArtMethod::EntryPointFromQuickCompiledCodeOffset(
           kArm64WordSize).Int32Value()));
       // lr();
       __ Blr(lr);
-    } else {
-      __ Bl(&frame_entry_label_);
     }
   }
 
@@ -2076,6 +2348,8 @@ void InstructionCodeGeneratorARM64::VisitInvokeVirtual(HInvokeVirtual* invoke) {
   BlockPoolsScope block_pools(GetVIXLAssembler());
 
   // temp = object->GetClass();
+  // No read barrier is needed: a from-space class has the same embedded tables as its
+  // to-space copy, and the class is only used to find the method to call.
   if (receiver.IsStackSlot()) {
     __ Ldr(temp.W(), MemOperand(sp, receiver.GetStackIndex()));
     __ Ldr(temp.W(), HeapOperand(temp.W(), class_offset));
@@ -2095,8 +2369,9 @@ void InstructionCodeGeneratorARM64::VisitInvokeVirtual(HInvokeVirtual* invoke) {
 }
 
 void LocationsBuilderARM64::VisitLoadClass(HLoadClass* cls) {
-  LocationSummary::CallKind call_kind = cls->CanCallRuntime() ? LocationSummary::kCallOnSlowPath
-                                                              : LocationSummary::kNoCall;
+  LocationSummary::CallKind call_kind = (cls->CanCallRuntime() || kEmitCompilerReadBarrier)
+      ? LocationSummary::kCallOnSlowPath
+      : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(cls, call_kind);
   locations->SetOut(Location::RequiresRegister());
 }
@@ -2107,12 +2382,21 @@ void InstructionCodeGeneratorARM64::VisitLoadClass(HLoadClass* cls) {
     DCHECK(!cls->CanCallRuntime());
     DCHECK(!cls->MustGenerateClinitCheck());
     codegen_->LoadCurrentMethod(out.X());
-    __ Ldr(out, MemOperand(out.X(), ArtMethod::DeclaringClassOffset().Int32Value()));
+    codegen_->GenerateGcRootLoad(
+        cls, out, MemOperand(out.X(), ArtMethod::DeclaringClassOffset().Int32Value()));
   } else {
     DCHECK(cls->CanCallRuntime());
-    codegen_->LoadCurrentMethod(out.X());
-    __ Ldr(out, MemOperand(out.X(), ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
-    __ Ldr(out, HeapOperand(out, CodeGenerator::GetCacheOffset(cls->GetTypeIndex())));
+    if (codegen_->CanUsePcRelativeDexCacheArrayLoads()) {
+      codegen_->LoadDexCacheArrayElement(
+          out, codegen_->GetDexCacheTypeOffset(cls->GetTypeIndex()));
+      codegen_->GenerateGcRootReadBarrier(cls, out);
+    } else {
+      codegen_->LoadCurrentMethod(out.X());
+      codegen_->GenerateGcRootLoad(
+          cls, out, MemOperand(out.X(), ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+      MemOperand type = HeapOperand(out, CodeGenerator::GetCacheOffset(cls->GetTypeIndex()));
+      codegen_->GenerateReferenceLoad(cls, out, out, type, false);
+    }
 
     SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathARM64(
         cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
@@ -2158,10 +2442,19 @@ void InstructionCodeGeneratorARM64::VisitLoadString(HLoadString* load) {
   codegen_->AddSlowPath(slow_path);
 
   Register out = OutputRegister(load);
-  codegen_->LoadCurrentMethod(out.X());
-  __ Ldr(out, MemOperand(out.X(), ArtMethod::DeclaringClassOffset().Int32Value()));
-  __ Ldr(out, HeapOperand(out, mirror::Class::DexCacheStringsOffset()));
-  __ Ldr(out, HeapOperand(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())));
+  if (codegen_->CanUsePcRelativeDexCacheArrayLoads()) {
+    codegen_->LoadDexCacheArrayElement(
+        out, codegen_->GetDexCacheStringOffset(load->GetStringIndex()));
+    codegen_->GenerateGcRootReadBarrier(load, out);
+  } else {
+    codegen_->LoadCurrentMethod(out.X());
+    codegen_->GenerateGcRootLoad(
+        load, out, MemOperand(out.X(), ArtMethod::DeclaringClassOffset().Int32Value()));
+    codegen_->GenerateReferenceLoad(
+        load, out, out, HeapOperand(out, mirror::Class::DexCacheStringsOffset()), false);
+    MemOperand string = HeapOperand(out, CodeGenerator::GetCacheOffset(load->GetStringIndex()));
+    codegen_->GenerateReferenceLoad(load, out, out, string, false);
+  }
   __ Cbz(out, slow_path->GetEntryLabel());
   __ Bind(slow_path->GetExitLabel());
 }
@@ -2189,15 +2482,84 @@ void LocationsBuilderARM64::VisitMonitorOperation(HMonitorOperation* instruction
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
   locations->SetInAt(0, LocationFrom(calling_convention.GetRegisterAt(0)));
+  // Lock word, thread id and lock word address of the thin lock fast path.
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(1)));
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(2)));
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(3)));
+}
+
+void InstructionCodeGeneratorARM64::GenerateThinLockFastPath(HMonitorOperation* instruction,
+                                                             vixl::Label* slow_path,
+                                                             vixl::Label* done) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register obj = InputRegisterAt(instruction, 0);
+  Register lock_word = WRegisterFrom(locations->GetTemp(0));
+  Register thread_id = WRegisterFrom(locations->GetTemp(1));
+  Register address = XRegisterFrom(locations->GetTemp(2));
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  Register temp = temps.AcquireW();
+  // Both the owner and the state must match for a thin lock held by this thread.
+  uint32_t owner_and_state_mask =
+      static_cast<uint32_t>(LockWord::kStateMaskShifted | LockWord::kThinLockOwnerMask);
+
+  __ Cbz(obj, slow_path);
+  __ Add(address, obj.X(), mirror::Object::MonitorOffset().Int32Value());
+  __ Ldr(thread_id, MemOperand(tr, Thread::ThinLockIdOffset<kArm64WordSize>().Int32Value()));
+  if (instruction->IsEnter()) {
+    vixl::Label retry, not_unlocked;
+    __ Bind(&retry);
+    __ Ldaxr(lock_word, MemOperand(address));
+    __ Cbnz(lock_word, &not_unlocked);
+    // Unlocked: install this thread as the owner, with a recursion count of 0.
+    __ Stxr(temp, thread_id, MemOperand(address));
+    __ Cbnz(temp, &retry);
+    __ B(done);
+    __ Bind(&not_unlocked);
+    // Thin lock held by this thread: increment the recursion count, unless it overflows.
+    // Only the owner updates a thin lock word, so a plain store is enough. Contention is
+    // left to the runtime.
+    __ Clrex();
+    __ Eor(temp, lock_word, thread_id);
+    __ Tst(temp, owner_and_state_mask);
+    __ B(ne, slow_path);
+    __ Add(lock_word, lock_word, LockWord::kThinLockCountOne);
+    __ Tst(lock_word, static_cast<uint32_t>(LockWord::kStateMaskShifted |
+                                            LockWord::kReadBarrierStateMaskShifted));
+    __ B(ne, slow_path);
+    __ Str(lock_word, MemOperand(address));
+    __ B(done);
+  } else {
+    vixl::Label recursive;
+    __ Ldr(lock_word, MemOperand(address));
+    __ Eor(temp, lock_word, thread_id);
+    __ Tst(temp, owner_and_state_mask);
+    __ B(ne, slow_path);
+    __ Cmp(lock_word, LockWord::kThinLockCountOne);
+    __ B(hs, &recursive);
+    __ Stlr(wzr, MemOperand(address));
+    __ B(done);
+    __ Bind(&recursive);
+    __ Sub(lock_word, lock_word, LockWord::kThinLockCountOne);
+    __ Str(lock_word, MemOperand(address));
+    __ B(done);
+  }
 }
 
 void InstructionCodeGeneratorARM64::VisitMonitorOperation(HMonitorOperation* instruction) {
+  vixl::Label slow_path;
+  vixl::Label done;
+  // The fast path does not preserve the read barrier bits of the lock word.
+  if (!kUseReadBarrier) {
+    GenerateThinLockFastPath(instruction, &slow_path, &done);
+    __ Bind(&slow_path);
+  }
   codegen_->InvokeRuntime(instruction->IsEnter()
         ? QUICK_ENTRY_POINT(pLockObject) : QUICK_ENTRY_POINT(pUnlockObject),
       instruction,
       instruction->GetDexPc(),
       nullptr);
   CheckEntrypointTypes<kQuickLockObject, void, mirror::Object*>();
+  __ Bind(&done);
 }
 
 void LocationsBuilderARM64::VisitMul(HMul* mul) {
@@ -2278,12 +2640,32 @@ void InstructionCodeGeneratorARM64::VisitNeg(HNeg* neg) {
   }
 }
 
+void InstructionCodeGeneratorARM64::GenerateThreadLocalAllocation(Register out,
+                                                                  Register size,
+                                                                  vixl::Label* slow_path) {
+  UseScratchRegisterScope temps(GetVIXLAssembler());
+  Register temp = temps.AcquireX();
+  // Threads without a thread-local buffer have pos == end == 0 and always take the slow path.
+  __ Ldr(out, MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64WordSize>().Int32Value()));
+  __ Ldr(temp, MemOperand(tr, Thread::ThreadLocalEndOffset<kArm64WordSize>().Int32Value()));
+  __ Add(size, size, out);
+  __ Cmp(size, temp);
+  __ B(hi, slow_path);
+  __ Str(size, MemOperand(tr, Thread::ThreadLocalPosOffset<kArm64WordSize>().Int32Value()));
+  __ Ldr(temp, MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64WordSize>().Int32Value()));
+  __ Add(temp, temp, 1);
+  __ Str(temp, MemOperand(tr, Thread::ThreadLocalObjectsOffset<kArm64WordSize>().Int32Value()));
+}
+
 void LocationsBuilderARM64::VisitNewArray(HNewArray* instruction) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
   locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(0)));
   locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(2)));
+  // Class and array size on the inline allocation path.
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(3)));
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(4)));
   locations->SetOut(LocationFrom(x0));
   locations->SetInAt(0, LocationFrom(calling_convention.GetRegisterAt(1)));
   CheckEntrypointTypes<kQuickAllocArrayWithAccessCheck,
@@ -2298,6 +2680,38 @@ void InstructionCodeGeneratorARM64::VisitNewArray(HNewArray* instruction) {
   Register current_method = RegisterFrom(locations->GetTemp(1), Primitive::kPrimLong);
   DCHECK(current_method.Is(x2));
   codegen_->LoadCurrentMethod(current_method.X());
+
+  vixl::Label slow_path;
+  vixl::Label done;
+  size_t component_size_shift;
+  bool allocate_inline = codegen_->CanAllocateInline(instruction, &component_size_shift);
+  if (allocate_inline) {
+    // The length must be preserved for the runtime call.
+    Register length = InputRegisterAt(instruction, 0);
+    Register klass = RegisterFrom(locations->GetTemp(2), Primitive::kPrimNot);
+    Register size = XRegisterFrom(locations->GetTemp(3));
+    Register out = OutputRegister(instruction);
+    uint32_t data_offset = mirror::Array::DataOffset(1 << component_size_shift).Uint32Value();
+    // Array classes are always initialized and never finalizable.
+    __ Ldr(klass, MemOperand(current_method.X(),
+                             ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ Ldr(klass, HeapOperand(klass, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ Cbz(klass, &slow_path);
+    // Unsigned comparison, so that negative lengths are left to the runtime.
+    __ Cmp(length, (kMaxInlineAllocatedArraySize - data_offset) >> component_size_shift);
+    __ B(hi, &slow_path);
+    __ Mov(size, data_offset + kObjectAlignment - 1);
+    __ Add(size, size, Operand(length, vixl::UXTW, component_size_shift));
+    __ And(size, size, ~static_cast<uint64_t>(kObjectAlignment - 1));
+    GenerateThreadLocalAllocation(out.X(), size, &slow_path);
+    __ Str(klass, HeapOperand(out, mirror::Object::ClassOffset()));
+    __ Str(length, HeapOperand(out, mirror::Array::LengthOffset()));
+    // Make the header visible before the reference can be published to other threads.
+    __ Dmb(InnerShareable, BarrierWrites);
+    __ B(&done);
+    __ Bind(&slow_path);
+  }
+
   __ Mov(type_index, instruction->GetTypeIndex());
   codegen_->InvokeRuntime(
       GetThreadOffset<kArm64WordSize>(instruction->GetEntrypoint()).Int32Value(),
@@ -2305,6 +2719,9 @@ void InstructionCodeGeneratorARM64::VisitNewArray(HNewArray* instruction) {
       instruction->GetDexPc(),
       nullptr);
   CheckEntrypointTypes<kQuickAllocArrayWithAccessCheck, void*, uint32_t, int32_t, ArtMethod*>();
+  if (allocate_inline) {
+    __ Bind(&done);
+  }
 }
 
 void LocationsBuilderARM64::VisitNewInstance(HNewInstance* instruction) {
@@ -2313,6 +2730,9 @@ void LocationsBuilderARM64::VisitNewInstance(HNewInstance* instruction) {
   InvokeRuntimeCallingConvention calling_convention;
   locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(0)));
   locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(1)));
+  // Class and object size on the inline allocation path.
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(2)));
+  locations->AddTemp(LocationFrom(calling_convention.GetRegisterAt(3)));
   locations->SetOut(calling_convention.GetReturnLocation(Primitive::kPrimNot));
   CheckEntrypointTypes<kQuickAllocObjectWithAccessCheck, void*, uint32_t, ArtMethod*>();
 }
@@ -2324,6 +2744,48 @@ void InstructionCodeGeneratorARM64::VisitNewInstance(HNewInstance* instruction)
   Register current_method = RegisterFrom(locations->GetTemp(1), Primitive::kPrimNot);
   DCHECK(current_method.Is(w1));
   codegen_->LoadCurrentMethod(current_method.X());
+
+  vixl::Label slow_path;
+  vixl::Label done;
+  bool allocate_inline = CodeGenerator::CanAllocateInline(instruction);
+  if (allocate_inline) {
+    Register klass = RegisterFrom(locations->GetTemp(2), Primitive::kPrimNot);
+    Register size = XRegisterFrom(locations->GetTemp(3));
+    Register out = OutputRegister(instruction);
+    __ Ldr(klass, MemOperand(current_method.X(),
+                             ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ Ldr(klass, HeapOperand(klass, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ Cbz(klass, &slow_path);
+    {
+      UseScratchRegisterScope temps(GetVIXLAssembler());
+      Register temp = temps.AcquireW();
+      size_t status_offset = mirror::Class::StatusOffset().SizeValue();
+      // Same ordering requirements as for an explicit class initialization check.
+      if (codegen_->GetInstructionSetFeatures().PreferAcquireRelease()) {
+        __ Add(temp, klass, status_offset);
+        __ Ldar(temp, HeapOperand(temp));
+        __ Cmp(temp, mirror::Class::kStatusInitialized);
+        __ B(lt, &slow_path);
+      } else {
+        __ Ldr(temp, HeapOperand(klass, status_offset));
+        __ Cmp(temp, mirror::Class::kStatusInitialized);
+        __ B(lt, &slow_path);
+        __ Dmb(InnerShareable, BarrierReads);
+      }
+    }
+    __ Ldr(size.W(), HeapOperand(klass, mirror::Class::AccessFlagsOffset()));
+    __ Tbnz(size.W(), CTZ(kAccClassIsFinalizable), &slow_path);
+    __ Ldr(size.W(), HeapOperand(klass, mirror::Class::ObjectSizeOffset()));
+    __ Add(size, size, kObjectAlignment - 1);
+    __ And(size, size, ~static_cast<uint64_t>(kObjectAlignment - 1));
+    GenerateThreadLocalAllocation(out.X(), size, &slow_path);
+    __ Str(klass, HeapOperand(out, mirror::Object::ClassOffset()));
+    // Make the header visible before the reference can be published to other threads.
+    __ Dmb(InnerShareable, BarrierWrites);
+    __ B(&done);
+    __ Bind(&slow_path);
+  }
+
   __ Mov(type_index, instruction->GetTypeIndex());
   codegen_->InvokeRuntime(
       GetThreadOffset<kArm64WordSize>(instruction->GetEntrypoint()).Int32Value(),
@@ -2331,6 +2793,9 @@ void InstructionCodeGeneratorARM64::VisitNewInstance(HNewInstance* instruction)
       instruction->GetDexPc(),
       nullptr);
   CheckEntrypointTypes<kQuickAllocObjectWithAccessCheck, void*, uint32_t, ArtMethod*>();
+  if (allocate_inline) {
+    __ Bind(&done);
+  }
 }
 
 void LocationsBuilderARM64::VisitNot(HNot* instruction) {
@@ -153,6 +153,26 @@ class InstructionCodeGeneratorARM64 : public HGraphVisitor {
 
  private:
   void GenerateClassInitializationCheck(SlowPathCodeARM64* slow_path, vixl::Register class_reg);
+  // Inline part of a type check of kind `kind`, after `obj_class` was found to differ
+  // from `cls`. Branches to `success` or `failure`, preserving `obj_class`.
+  void GenerateTypeCheckWalk(TypeCheckKind kind,
+                             vixl::Register obj_class,
+                             vixl::Register cls,
+                             Location temp1,
+                             Location temp2,
+                             vixl::Label* success,
+                             vixl::Label* failure);
+  // Bump-allocate `size` bytes (a multiple of kObjectAlignment) from the thread-local
+  // allocation buffer into `out`, or branch to `slow_path` if the buffer is too small.
+  // Clobbers `size`.
+  void GenerateThreadLocalAllocation(vixl::Register out,
+                                     vixl::Register size,
+                                     vixl::Label* slow_path);
+  // Thin lock acquire or release for `instruction`. Branches to `done` on success, or to
+  // `slow_path` if the runtime is needed.
+  void GenerateThinLockFastPath(HMonitorOperation* instruction,
+                                vixl::Label* slow_path,
+                                vixl::Label* done);
   void GenerateMemoryBarrier(MemBarrierKind kind);
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
   void HandleBinaryOp(HBinaryOperation* instr);
@@ -325,6 +345,25 @@ class CodeGeneratorARM64 : public CodeGenerator {
   void Load(Primitive::Type type, vixl::CPURegister dst, const vixl::MemOperand& src);
   void Store(Primitive::Type type, vixl::CPURegister rt, const vixl::MemOperand& dst);
   void LoadCurrentMethod(vixl::Register current_method);
+  // Load the entry at `element_offset` in the dex cache arrays, a reference for a W
+  // register or an ArtMethod* for an X register, with an ADRP+LDR pair patched by the
+  // linker. Only valid if CanUsePcRelativeDexCacheArrayLoads().
+  void LoadDexCacheArrayElement(vixl::Register out, size_t element_offset);
+  // Load the heap reference at `src`, a field or element of `obj`, into `out` with a read
+  // barrier if the compiler emits them. Records the implicit null check of `instruction`
+  // on the first access to `obj` if `needs_null_check`. Uses a scratch register.
+  void GenerateReferenceLoad(HInstruction* instruction,
+                             vixl::Register out,
+                             vixl::Register obj,
+                             const vixl::MemOperand& src,
+                             bool needs_null_check);
+  // Load the GC root at `src`, which is not in a heap object, into `out` with a read
+  // barrier if the compiler emits them.
+  void GenerateGcRootLoad(HInstruction* instruction,
+                          vixl::Register out,
+                          const vixl::MemOperand& src);
+  // Emit the read barrier for the GC root just loaded into `root`, if the compiler emits them.
+  void GenerateGcRootReadBarrier(HInstruction* instruction, vixl::Register root);
   void LoadAcquire(HInstruction* instruction, vixl::CPURegister dst, const vixl::MemOperand& src);
   void StoreRelease(Primitive::Type type, vixl::CPURegister rt, const vixl::MemOperand& dst);
 
@@ -23,8 +23,11 @@
 #include "gc/accounting/card_table.h"
 #include "intrinsics.h"
 #include "intrinsics_x86.h"
+#include "lock_word.h"
 #include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
+#include "mirror/iftable.h"
+#include "read_barrier.h"
 #include "thread.h"
 #include "utils/assembler.h"
 #include "utils/stack_checks.h"
@@ -301,6 +304,39 @@ class TypeCheckSlowPathX86 : public SlowPathCodeX86 {
   DISALLOW_COPY_AND_ASSIGN(TypeCheckSlowPathX86);
 };
 
+// Slow path marking the reference in `ref` loaded by a read barrier, replacing it
+// with the to-space reference.
+class ReadBarrierMarkSlowPathX86 : public SlowPathCodeX86 {
+ public:
+  ReadBarrierMarkSlowPathX86(HInstruction* instruction, Location ref)
+      : instruction_(instruction), ref_(ref) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(locations->OnlyCallsOnSlowPath());
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(ref_.reg()));
+
+    CodeGeneratorX86* x86_codegen = down_cast<CodeGeneratorX86*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    x86_codegen->Move32(Location::RegisterLocation(calling_convention.GetRegisterAt(0)), ref_);
+    __ fs()->call(Address::Absolute(QUICK_ENTRYPOINT_OFFSET(kX86WordSize, pReadBarrierMark)));
+    RecordPcInfo(codegen, instruction_, instruction_->GetDexPc());
+    x86_codegen->Move32(ref_, Location::RegisterLocation(EAX));
+
+    RestoreLiveRegisters(codegen, locations);
+    __ jmp(GetExitLabel());
+  }
+
+ private:
+  HInstruction* const instruction_;
+  const Location ref_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadBarrierMarkSlowPathX86);
+};
+
 class DeoptimizationSlowPathX86 : public SlowPathCodeX86 {
  public:
   explicit DeoptimizationSlowPathX86(HInstruction* instruction)
@@ -531,6 +567,55 @@ void CodeGeneratorX86::LoadCurrentMethod(Register reg) {
   __ movl(reg, Address(ESP, kCurrentMethodStackOffset));
 }
 
+void CodeGeneratorX86::GenerateReferenceLoad(HInstruction* instruction,
+                                             Register out,
+                                             Register obj,
+                                             const Address& src,
+                                             bool needs_null_check) {
+  if (!kEmitCompilerReadBarrier) {
+    __ movl(out, src);
+    if (needs_null_check) {
+      MaybeRecordImplicitNullCheck(instruction);
+    }
+    return;
+  }
+  // Baker's read barrier: the reference must be marked if `obj` is gray. Loads are not
+  // reordered with other loads on x86, so the reference is read after the read barrier
+  // state without a fence.
+  constexpr uint32_t gray_byte_position = LockWord::kReadBarrierStateShift / kBitsPerByte;
+  constexpr uint32_t gray_bit_position = LockWord::kReadBarrierStateShift % kBitsPerByte;
+  constexpr int32_t test_value = ReadBarrier::gray_ptr_ << gray_bit_position;
+  static_assert(test_value > 0 && test_value <= 0xff, "Gray bit not in a byte");
+  uint32_t monitor_offset = mirror::Object::MonitorOffset().Uint32Value();
+  __ testb(Address(obj, monitor_offset + gray_byte_position), Immediate(test_value));
+  if (needs_null_check) {
+    MaybeRecordImplicitNullCheck(instruction);
+  }
+  // `movl` leaves the flags of the test unchanged.
+  __ movl(out, src);
+  SlowPathCodeX86* slow_path = new (GetGraph()->GetArena())
+      ReadBarrierMarkSlowPathX86(instruction, Location::RegisterLocation(out));
+  AddSlowPath(slow_path);
+  __ j(kNotZero, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void CodeGeneratorX86::GenerateGcRootLoad(HInstruction* instruction,
+                                          Register out,
+                                          const Address& src) {
+  __ movl(out, src);
+  if (kEmitCompilerReadBarrier) {
+    // GC roots have no read barrier state, mark them whenever the GC is marking.
+    SlowPathCodeX86* slow_path = new (GetGraph()->GetArena())
+        ReadBarrierMarkSlowPathX86(instruction, Location::RegisterLocation(out));
+    AddSlowPath(slow_path);
+    __ fs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86WordSize>().Int32Value()),
+                  Immediate(0));
+    __ j(kNotEqual, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 Location CodeGeneratorX86::GetStackLocation(HLoadLocal* load) const {
   switch (load->GetType()) {
     case Primitive::kPrimLong:
@@ -1281,6 +1366,8 @@ void InstructionCodeGeneratorX86::VisitInvokeVirtual(HInvokeVirtual* invoke) {
   Location receiver = locations->InAt(0);
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
   // temp = object->GetClass();
+  // No read barrier is needed: a from-space class has the same embedded tables as its
+  // to-space copy, and the class is only used to find the method to call.
   if (receiver.IsStackSlot()) {
     __ movl(temp, Address(ESP, receiver.GetStackIndex()));
     __ movl(temp, Address(temp, class_offset));
@@ -3242,8 +3329,13 @@ void CodeGeneratorX86::MarkGCCard(Register temp, Register card, Register object,
 
 void LocationsBuilderX86::HandleFieldGet(HInstruction* instruction, const FieldInfo& field_info) {
   DCHECK(instruction->IsInstanceFieldGet() || instruction->IsStaticFieldGet());
+  bool object_field_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (instruction->GetType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_field_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
 
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
@@ -3296,12 +3388,17 @@ void InstructionCodeGeneratorX86::HandleFieldGet(HInstruction* instruction,
       break;
     }
 
-    case Primitive::kPrimInt:
-    case Primitive::kPrimNot: {
+    case Primitive::kPrimInt: {
       __ movl(out.AsRegister<Register>(), Address(base, offset));
       break;
     }
 
+    case Primitive::kPrimNot: {
+      codegen_->GenerateReferenceLoad(
+          instruction, out.AsRegister<Register>(), base, Address(base, offset), true);
+      break;
+    }
+
     case Primitive::kPrimLong: {
       if (is_volatile) {
         XmmRegister temp = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
@@ -3334,8 +3431,8 @@ void InstructionCodeGeneratorX86::HandleFieldGet(HInstruction* instruction,
       UNREACHABLE();
   }
 
-  // Longs are handled in the switch.
-  if (field_type != Primitive::kPrimLong) {
+  // Longs and references are handled in the switch.
+  if (field_type != Primitive::kPrimLong && field_type != Primitive::kPrimNot) {
     codegen_->MaybeRecordImplicitNullCheck(instruction);
   }
 
@@ -3547,8 +3644,13 @@ void InstructionCodeGeneratorX86::VisitNullCheck(HNullCheck* instruction) {
 }
 
 void LocationsBuilderX86::VisitArrayGet(HArrayGet* instruction) {
+  bool object_array_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (instruction->GetType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_array_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RegisterOrConstant(instruction->InputAt(1)));
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
@@ -3617,8 +3719,7 @@ void InstructionCodeGeneratorX86::VisitArrayGet(HArrayGet* instruction) {
       break;
     }
 
-    case Primitive::kPrimInt:
-    case Primitive::kPrimNot: {
+    case Primitive::kPrimInt: {
       uint32_t data_offset = mirror::Array::DataOffset(sizeof(int32_t)).Uint32Value();
       Register out = locations->Out().AsRegister<Register>();
       if (index.IsConstant()) {
@@ -3630,6 +3731,18 @@ void InstructionCodeGeneratorX86::VisitArrayGet(HArrayGet* instruction) {
       break;
     }
 
+    case Primitive::kPrimNot: {
+      uint32_t data_offset =
+          mirror::Array::DataOffset(sizeof(mirror::HeapReference<mirror::Object>)).Uint32Value();
+      Register out = locations->Out().AsRegister<Register>();
+      Address src = index.IsConstant()
+          ? Address(obj,
+                    (index.GetConstant()->AsIntConstant()->GetValue() << TIMES_4) + data_offset)
+          : Address(obj, index.AsRegister<Register>(), TIMES_4, data_offset);
+      codegen_->GenerateReferenceLoad(instruction, out, obj, src, true);
+      break;
+    }
+
     case Primitive::kPrimLong: {
       uint32_t data_offset = mirror::Array::DataOffset(sizeof(int64_t)).Uint32Value();
       Location out = locations->Out();
@@ -3678,7 +3791,8 @@ void InstructionCodeGeneratorX86::VisitArrayGet(HArrayGet* instruction) {
       UNREACHABLE();
   }
 
-  if (type != Primitive::kPrimLong) {
+  // Longs and references are handled in the switch.
+  if (type != Primitive::kPrimLong && type != Primitive::kPrimNot) {
     codegen_->MaybeRecordImplicitNullCheck(instruction);
   }
 }
@@ -4265,7 +4379,7 @@ void ParallelMoveResolverX86::RestoreScratch(int reg) {
 }
 
 void LocationsBuilderX86::VisitLoadClass(HLoadClass* cls) {
-  LocationSummary::CallKind call_kind = cls->CanCallRuntime()
+  LocationSummary::CallKind call_kind = (cls->CanCallRuntime() || kEmitCompilerReadBarrier)
       ? LocationSummary::kCallOnSlowPath
       : LocationSummary::kNoCall;
   LocationSummary* locations =
@@ -4279,12 +4393,15 @@ void InstructionCodeGeneratorX86::VisitLoadClass(HLoadClass* cls) {
     DCHECK(!cls->CanCallRuntime());
     DCHECK(!cls->MustGenerateClinitCheck());
     codegen_->LoadCurrentMethod(out);
-    __ movl(out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
+    codegen_->GenerateGcRootLoad(
+        cls, out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
   } else {
     DCHECK(cls->CanCallRuntime());
     codegen_->LoadCurrentMethod(out);
-    __ movl(out, Address(out, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
-    __ movl(out, Address(out, CodeGenerator::GetCacheOffset(cls->GetTypeIndex())));
+    codegen_->GenerateGcRootLoad(
+        cls, out, Address(out, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    codegen_->GenerateReferenceLoad(
+        cls, out, out, Address(out, CodeGenerator::GetCacheOffset(cls->GetTypeIndex())), false);
 
     SlowPathCodeX86* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathX86(
         cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
@@ -4338,9 +4455,12 @@ void InstructionCodeGeneratorX86::VisitLoadString(HLoadString* load) {
 
   Register out = load->GetLocations()->Out().AsRegister<Register>();
   codegen_->LoadCurrentMethod(out);
-  __ movl(out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
-  __ movl(out, Address(out, mirror::Class::DexCacheStringsOffset().Int32Value()));
-  __ movl(out, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())));
+  codegen_->GenerateGcRootLoad(
+      load, out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
+  codegen_->GenerateReferenceLoad(
+      load, out, out, Address(out, mirror::Class::DexCacheStringsOffset().Int32Value()), false);
+  codegen_->GenerateReferenceLoad(
+      load, out, out, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())), false);
   __ testl(out, out);
   __ j(kEqual, slow_path->GetEntryLabel());
   __ Bind(slow_path->GetExitLabel());
@@ -4370,14 +4490,95 @@ void InstructionCodeGeneratorX86::VisitThrow(HThrow* instruction) {
   codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
 }
 
+// Temporaries needed by `GenerateTypeCheckWalk`.
+static void AddTypeCheckWalkTemps(LocationSummary* locations, TypeCheckKind kind) {
+  if (kind == TypeCheckKind::kClassHierarchyCheck ||
+      kind == TypeCheckKind::kArrayObjectCheck ||
+      kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+  if (kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+}
+
+void InstructionCodeGeneratorX86::GenerateTypeCheckWalk(TypeCheckKind kind,
+                                                        Register obj_class,
+                                                        Register cls,
+                                                        Location temp1_loc,
+                                                        Location temp2_loc,
+                                                        Label* success,
+                                                        Label* failure) {
+  Register temp = temp1_loc.AsRegister<Register>();
+  switch (kind) {
+    case TypeCheckKind::kClassHierarchyCheck: {
+      // Walk the super class chain until `cls` or null is found.
+      Label loop;
+      __ movl(temp, obj_class);
+      __ Bind(&loop);
+      __ movl(temp, Address(temp, mirror::Class::SuperClassOffset().Int32Value()));
+      __ testl(temp, temp);
+      __ j(kEqual, failure);
+      __ cmpl(temp, cls);
+      __ j(kNotEqual, &loop);
+      __ jmp(success);
+      break;
+    }
+    case TypeCheckKind::kArrayObjectCheck: {
+      // `obj_class` must be an array class whose component type is not primitive.
+      __ movl(temp, Address(obj_class, mirror::Class::ComponentTypeOffset().Int32Value()));
+      __ testl(temp, temp);
+      __ j(kEqual, failure);
+      static_assert(Primitive::kPrimNot == 0, "Expected 0 for kPrimNot");
+      __ movzxw(temp, Address(temp, mirror::Class::PrimitiveTypeOffset().Int32Value()));
+      __ testl(temp, temp);
+      __ j(kNotEqual, failure);
+      __ jmp(success);
+      break;
+    }
+    case TypeCheckKind::kInterfaceCheck: {
+      // Scan the (interface, method array) pairs of the interface table.
+      Register count = temp2_loc.AsRegister<Register>();
+      uint32_t data_offset =
+          mirror::Array::DataOffset(sizeof(mirror::HeapReference<mirror::Object>)).Uint32Value();
+      Label loop;
+      __ movl(temp, Address(obj_class, mirror::Class::IfTableOffset().Int32Value()));
+      // Classes that implement no interface have no interface table.
+      __ testl(temp, temp);
+      __ j(kEqual, failure);
+      __ movl(count, Address(temp, mirror::Array::LengthOffset().Int32Value()));
+      __ Bind(&loop);
+      __ testl(count, count);
+      __ j(kEqual, failure);
+      __ cmpl(cls, Address(temp, data_offset));
+      __ j(kEqual, success);
+      __ addl(temp,
+              Immediate(mirror::IfTable::kMax * sizeof(mirror::HeapReference<mirror::Object>)));
+      __ subl(count, Immediate(mirror::IfTable::kMax));
+      __ jmp(&loop);
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unexpected type check kind " << static_cast<int>(kind);
+      UNREACHABLE();
+  }
+}
+
 void LocationsBuilderX86::VisitInstanceOf(HInstanceOf* instruction) {
-  LocationSummary::CallKind call_kind = instruction->IsClassFinal()
-      ? LocationSummary::kNoCall
-      : LocationSummary::kCallOnSlowPath;
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
+  LocationSummary::CallKind call_kind = (kind == TypeCheckKind::kUnknownCheck ||
+                                         kEmitCompilerReadBarrier)
+      ? LocationSummary::kCallOnSlowPath
+      : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction, call_kind);
   locations->SetInAt(0, Location::RequiresRegister());
-  locations->SetInAt(1, Location::Any());
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    locations->SetInAt(1, Location::Any());
+  } else {
+    locations->SetInAt(1, Location::RequiresRegister());
+  }
   locations->SetOut(Location::RequiresRegister());
+  AddTypeCheckWalkTemps(locations, kind);
 }
 
 void InstructionCodeGeneratorX86::VisitInstanceOf(HInstanceOf* instruction) {
@@ -4386,6 +4587,7 @@ void InstructionCodeGeneratorX86::VisitInstanceOf(HInstanceOf* instruction) {
   Location cls = locations->InAt(1);
   Register out = locations->Out().AsRegister<Register>();
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
   Label done, zero;
   SlowPathCodeX86* slow_path = nullptr;
 
@@ -4395,21 +4597,20 @@ void InstructionCodeGeneratorX86::VisitInstanceOf(HInstanceOf* instruction) {
     __ testl(obj, obj);
     __ j(kEqual, &zero);
   }
-  __ movl(out, Address(obj, class_offset));
   // Compare the class of `obj` with `cls`.
+  codegen_->GenerateReferenceLoad(instruction, out, obj, Address(obj, class_offset), false);
   if (cls.IsRegister()) {
     __ cmpl(out, cls.AsRegister<Register>());
   } else {
     DCHECK(cls.IsStackSlot()) << cls;
     __ cmpl(out, Address(ESP, cls.GetStackIndex()));
   }
-
-  if (instruction->IsClassFinal()) {
+  if (kind == TypeCheckKind::kExactCheck) {
     // Classes must be equal for the instanceof to succeed.
     __ j(kNotEqual, &zero);
     __ movl(out, Immediate(1));
     __ jmp(&done);
-  } else {
+  } else if (kind == TypeCheckKind::kUnknownCheck) {
     // If the classes are not equal, we go into a slow path.
     DCHECK(locations->OnlyCallsOnSlowPath());
     slow_path = new (GetGraph()->GetArena()) TypeCheckSlowPathX86(
@@ -4418,9 +4619,24 @@ void InstructionCodeGeneratorX86::VisitInstanceOf(HInstanceOf* instruction) {
     __ j(kNotEqual, slow_path->GetEntryLabel());
     __ movl(out, Immediate(1));
     __ jmp(&done);
+  } else {
+    // The inline walk gives a definite answer, no need for the runtime.
+    Label one;
+    __ j(kEqual, &one);
+    GenerateTypeCheckWalk(kind,
+                          out,
+                          cls.AsRegister<Register>(),
+                          locations->GetTemp(0),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(1)
+                                                                 : Location::NoLocation(),
+                          &one,
+                          &zero);
+    __ Bind(&one);
+    __ movl(out, Immediate(1));
+    __ jmp(&done);
   }
 
-  if (instruction->MustDoNullCheck() || instruction->IsClassFinal()) {
+  if (instruction->MustDoNullCheck() || kind != TypeCheckKind::kUnknownCheck) {
     __ Bind(&zero);
     __ movl(out, Immediate(0));
   }
@@ -4432,11 +4648,17 @@ void InstructionCodeGeneratorX86::VisitInstanceOf(HInstanceOf* instruction) {
 }
 
 void LocationsBuilderX86::VisitCheckCast(HCheckCast* instruction) {
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(
       instruction, LocationSummary::kCallOnSlowPath);
   locations->SetInAt(0, Location::RequiresRegister());
-  locations->SetInAt(1, Location::Any());
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    locations->SetInAt(1, Location::Any());
+  } else {
+    locations->SetInAt(1, Location::RequiresRegister());
+  }
   locations->AddTemp(Location::RequiresRegister());
+  AddTypeCheckWalkTemps(locations, kind);
 }
 
 void InstructionCodeGeneratorX86::VisitCheckCast(HCheckCast* instruction) {
@@ -4445,6 +4667,7 @@ void InstructionCodeGeneratorX86::VisitCheckCast(HCheckCast* instruction) {
   Location cls = locations->InAt(1);
   Register temp = locations->GetTemp(0).AsRegister<Register>();
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
   SlowPathCodeX86* slow_path = new (GetGraph()->GetArena()) TypeCheckSlowPathX86(
       instruction, locations->InAt(1), locations->GetTemp(0), instruction->GetDexPc());
   codegen_->AddSlowPath(slow_path);
@@ -4454,17 +4677,29 @@ void InstructionCodeGeneratorX86::VisitCheckCast(HCheckCast* instruction) {
     __ testl(obj, obj);
     __ j(kEqual, slow_path->GetExitLabel());
   }
-
-  __ movl(temp, Address(obj, class_offset));
   // Compare the class of `obj` with `cls`.
+  codegen_->GenerateReferenceLoad(instruction, temp, obj, Address(obj, class_offset), false);
   if (cls.IsRegister()) {
     __ cmpl(temp, cls.AsRegister<Register>());
   } else {
     DCHECK(cls.IsStackSlot()) << cls;
     __ cmpl(temp, Address(ESP, cls.GetStackIndex()));
   }
-
-  __ j(kNotEqual, slow_path->GetEntryLabel());
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    // Classes must be equal for the checkcast to succeed.
+    __ j(kNotEqual, slow_path->GetEntryLabel());
+  } else {
+    // The slow path is only taken to throw the ClassCastException.
+    __ j(kEqual, slow_path->GetExitLabel());
+    GenerateTypeCheckWalk(kind,
+                          temp,
+                          cls.AsRegister<Register>(),
+                          locations->GetTemp(1),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(2)
+                                                                 : Location::NoLocation(),
+                          slow_path->GetExitLabel(),
+                          slow_path->GetEntryLabel());
+  }
   __ Bind(slow_path->GetExitLabel());
 }
 
@@ -4473,13 +4708,87 @@ void LocationsBuilderX86::VisitMonitorOperation(HMonitorOperation* instruction)
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
   locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  // Lock word, thread id and scratch register of the thin lock fast path.
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(2)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(3)));
+}
+
+void InstructionCodeGeneratorX86::GenerateThinLockFastPath(HMonitorOperation* instruction,
+                                                           Label* slow_path,
+                                                           Label* done) {
+  LocationSummary* locations = instruction->GetLocations();
+  Register obj = locations->InAt(0).AsRegister<Register>();
+  Register lock_word = locations->GetTemp(0).AsRegister<Register>();
+  Register thread_id = locations->GetTemp(1).AsRegister<Register>();
+  Register temp = locations->GetTemp(2).AsRegister<Register>();
+  // cmpxchg compares with EAX, which also holds the object for the runtime call.
+  DCHECK_EQ(obj, EAX);
+  uint32_t monitor_offset = mirror::Object::MonitorOffset().Int32Value();
+  // Both the owner and the state must match for a thin lock held by this thread.
+  int32_t owner_and_state_mask =
+      static_cast<int32_t>(LockWord::kStateMaskShifted | LockWord::kThinLockOwnerMask);
+
+  __ testl(obj, obj);
+  __ j(kEqual, slow_path);
+  __ movl(lock_word, Address(obj, monitor_offset));
+  __ fs()->movl(thread_id, Address::Absolute(Thread::ThinLockIdOffset<kX86WordSize>()));
+  if (instruction->IsEnter()) {
+    Label not_unlocked;
+    __ testl(lock_word, lock_word);
+    __ j(kNotEqual, &not_unlocked);
+    // Unlocked: install this thread as the owner, with a recursion count of 0. Leave
+    // contention to the runtime.
+    __ movl(temp, obj);
+    __ xorl(EAX, EAX);
+    __ LockCmpxchgl(Address(temp, monitor_offset), thread_id);
+    __ movl(obj, temp);
+    __ j(kEqual, done);
+    __ jmp(slow_path);
+    __ Bind(&not_unlocked);
+    // Thin lock held by this thread: increment the recursion count, unless it overflows.
+    // Only the owner updates a thin lock word, so a plain store is enough.
+    __ movl(temp, lock_word);
+    __ xorl(temp, thread_id);
+    __ testl(temp, Immediate(owner_and_state_mask));
+    __ j(kNotEqual, slow_path);
+    __ addl(lock_word, Immediate(LockWord::kThinLockCountOne));
+    __ testl(lock_word, Immediate(static_cast<int32_t>(LockWord::kStateMaskShifted |
+                                                       LockWord::kReadBarrierStateMaskShifted)));
+    __ j(kNotEqual, slow_path);
+    __ movl(Address(obj, monitor_offset), lock_word);
+    __ jmp(done);
+  } else {
+    Label recursive;
+    __ movl(temp, lock_word);
+    __ xorl(temp, thread_id);
+    __ testl(temp, Immediate(owner_and_state_mask));
+    __ j(kNotEqual, slow_path);
+    __ cmpl(lock_word, Immediate(LockWord::kThinLockCountOne));
+    __ j(kAboveEqual, &recursive);
+    // Release the lock. Stores have release semantics on x86.
+    __ movl(Address(obj, monitor_offset), Immediate(0));
+    __ jmp(done);
+    __ Bind(&recursive);
+    __ subl(lock_word, Immediate(LockWord::kThinLockCountOne));
+    __ movl(Address(obj, monitor_offset), lock_word);
+    __ jmp(done);
+  }
 }
 
 void InstructionCodeGeneratorX86::VisitMonitorOperation(HMonitorOperation* instruction) {
+  Label slow_path;
+  Label done;
+  // The fast path does not preserve the read barrier bits of the lock word.
+  if (!kUseReadBarrier) {
+    GenerateThinLockFastPath(instruction, &slow_path, &done);
+    __ Bind(&slow_path);
+  }
   __ fs()->call(Address::Absolute(instruction->IsEnter()
         ? QUICK_ENTRYPOINT_OFFSET(kX86WordSize, pLockObject)
         : QUICK_ENTRYPOINT_OFFSET(kX86WordSize, pUnlockObject)));
   codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+  __ Bind(&done);
 }
 
 void LocationsBuilderX86::VisitAnd(HAnd* instruction) { HandleBitwiseOperation(instruction); }
@@ -158,6 +158,18 @@ class InstructionCodeGeneratorX86 : public HGraphVisitor {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* check, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCodeX86* slow_path, Register class_reg);
+  // Thin lock acquire or release for `instruction`. Jumps to `done` on success, or to
+  // `slow_path` if the runtime is needed.
+  void GenerateThinLockFastPath(HMonitorOperation* instruction, Label* slow_path, Label* done);
+  // Inline part of a type check of kind `kind`, after `obj_class` was found to differ
+  // from `cls`. Jumps to `success` or `failure`, preserving `obj_class`.
+  void GenerateTypeCheckWalk(TypeCheckKind kind,
+                             Register obj_class,
+                             Register cls,
+                             Location temp1,
+                             Location temp2,
+                             Label* success,
+                             Label* failure);
   void HandleBitwiseOperation(HBinaryOperation* instruction);
   void GenerateDivRemIntegral(HBinaryOperation* instruction);
   void DivRemOneOrMinusOne(HBinaryOperation* instruction);
@@ -266,6 +278,19 @@ class CodeGeneratorX86 : public CodeGenerator {
 
   void LoadCurrentMethod(Register reg);
 
+  // Load the heap reference at `src`, a field or element of `obj`, into `out` with a read
+  // barrier if the compiler emits them. Records the implicit null check of `instruction`
+  // on the first access to `obj` if `needs_null_check`.
+  void GenerateReferenceLoad(HInstruction* instruction,
+                             Register out,
+                             Register obj,
+                             const Address& src,
+                             bool needs_null_check);
+
+  // Load the GC root at `src`, which is not in a heap object, into `out` with a read
+  // barrier if the compiler emits them.
+  void GenerateGcRootLoad(HInstruction* instruction, Register out, const Address& src);
+
   Label* GetLabelOf(HBasicBlock* block) const {
     return CommonGetLabelOf<Label>(block_labels_.GetRawStorage(), block);
   }
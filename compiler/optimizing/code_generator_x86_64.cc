@@ -22,9 +22,12 @@
 #include "gc/accounting/card_table.h"
 #include "intrinsics.h"
 #include "intrinsics_x86_64.h"
+#include "lock_word.h"
 #include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
+#include "mirror/iftable.h"
 #include "mirror/object_reference.h"
+#include "read_barrier.h"
 #include "thread.h"
 #include "utils/assembler.h"
 #include "utils/stack_checks.h"
@@ -321,6 +324,40 @@ class TypeCheckSlowPathX86_64 : public SlowPathCodeX86_64 {
   DISALLOW_COPY_AND_ASSIGN(TypeCheckSlowPathX86_64);
 };
 
+// Slow path marking the reference in `ref` loaded by a read barrier, replacing it
+// with the to-space reference.
+class ReadBarrierMarkSlowPathX86_64 : public SlowPathCodeX86_64 {
+ public:
+  ReadBarrierMarkSlowPathX86_64(HInstruction* instruction, Location ref)
+      : instruction_(instruction), ref_(ref) {}
+
+  void EmitNativeCode(CodeGenerator* codegen) OVERRIDE {
+    LocationSummary* locations = instruction_->GetLocations();
+    DCHECK(locations->OnlyCallsOnSlowPath());
+    DCHECK(!locations->GetLiveRegisters()->ContainsCoreRegister(ref_.reg()));
+
+    CodeGeneratorX86_64* x64_codegen = down_cast<CodeGeneratorX86_64*>(codegen);
+    __ Bind(GetEntryLabel());
+    SaveLiveRegisters(codegen, locations);
+
+    InvokeRuntimeCallingConvention calling_convention;
+    x64_codegen->Move(Location::RegisterLocation(calling_convention.GetRegisterAt(0)), ref_);
+    __ gs()->call(Address::Absolute(
+        QUICK_ENTRYPOINT_OFFSET(kX86_64WordSize, pReadBarrierMark), true));
+    RecordPcInfo(codegen, instruction_, instruction_->GetDexPc());
+    x64_codegen->Move(ref_, Location::RegisterLocation(RAX));
+
+    RestoreLiveRegisters(codegen, locations);
+    __ jmp(GetExitLabel());
+  }
+
+ private:
+  HInstruction* const instruction_;
+  const Location ref_;
+
+  DISALLOW_COPY_AND_ASSIGN(ReadBarrierMarkSlowPathX86_64);
+};
+
 class DeoptimizationSlowPathX86_64 : public SlowPathCodeX86_64 {
  public:
   explicit DeoptimizationSlowPathX86_64(HInstruction* instruction)
@@ -376,20 +413,34 @@ void CodeGeneratorX86_64::GenerateStaticOrDirectCall(HInvokeStaticOrDirect* invo
     // (temp + offset_of_quick_compiled_code)()
     __ call(Address(temp, ArtMethod::EntryPointFromQuickCompiledCodeOffset(
         kX86_64WordSize).SizeValue()));
-  } else {
+  } else if (invoke->IsRecursive()) {
     // temp = method;
     LoadCurrentMethod(temp);
-    if (!invoke->IsRecursive()) {
+    __ call(&frame_entry_label_);
+  } else {
+    if (CanUsePcRelativeDexCacheArrayLoads()) {
+      // temp = dex_cache_resolved_methods_[index_in_cache], addressed RIP-relatively
+      LoadDexCacheArrayElement(
+          temp, GetDexCacheMethodOffset(invoke->GetDexMethodIndex()), /* is_64bit */ true);
+    } else {
+      // temp = method;
+      LoadCurrentMethod(temp);
       // temp = temp->dex_cache_resolved_methods_;
       __ movl(temp, Address(temp, ArtMethod::DexCacheResolvedMethodsOffset().SizeValue()));
       // temp = temp[index_in_cache]
       __ movq(temp, Address(
           temp, CodeGenerator::GetCachePointerOffset(invoke->GetDexMethodIndex())));
+    }
+    if (invoke->GetCodePtrLocation() ==
+        HInvokeStaticOrDirect::CodePtrLocation::kCallPCRelative) {
+      // The call is a placeholder: the linker redirects it to the callee's code.
+      __ call(&frame_entry_label_);
+      // The displacement is the last 4 bytes of the instruction.
+      RecordRelativeCallPatch(GetAssembler()->CodeSize() - 4u, invoke->GetDexMethodIndex());
+    } else {
       // (temp + offset_of_quick_compiled_code)()
       __ call(Address(temp, ArtMethod::EntryPointFromQuickCompiledCodeOffset(
           kX86_64WordSize).SizeValue()));
-    } else {
-      __ call(&frame_entry_label_);
     }
   }
 
@@ -589,6 +640,76 @@ void CodeGeneratorX86_64::LoadCurrentMethod(CpuRegister reg) {
   __ movq(reg, Address(CpuRegister(RSP), kCurrentMethodStackOffset));
 }
 
+void CodeGeneratorX86_64::LoadDexCacheArrayElement(CpuRegister out,
+                                                   size_t element_offset,
+                                                   bool is_64bit) {
+  size_t insn_offset = GetAssembler()->CodeSize();
+  // The displacement is a placeholder, the linker fills in the distance from the end of
+  // the instruction to the dex cache array element.
+  Address address = Address::Absolute(0, /* no_rip */ false);
+  if (is_64bit) {
+    __ movq(out, address);
+  } else {
+    __ movl(out, address);
+  }
+  // The displacement is the last 4 bytes of the instruction.
+  RecordDexCacheArrayPatch(GetAssembler()->CodeSize() - 4u, insn_offset, element_offset);
+}
+
+void CodeGeneratorX86_64::GenerateReferenceLoad(HInstruction* instruction,
+                                                CpuRegister out,
+                                                CpuRegister obj,
+                                                const Address& src,
+                                                bool needs_null_check) {
+  if (!kEmitCompilerReadBarrier) {
+    __ movl(out, src);
+    if (needs_null_check) {
+      MaybeRecordImplicitNullCheck(instruction);
+    }
+    return;
+  }
+  // Baker's read barrier: the reference must be marked if `obj` is gray. Loads are not
+  // reordered with other loads on x86-64, so the reference is read after the read barrier
+  // state without a fence.
+  constexpr uint32_t gray_byte_position = LockWord::kReadBarrierStateShift / kBitsPerByte;
+  constexpr uint32_t gray_bit_position = LockWord::kReadBarrierStateShift % kBitsPerByte;
+  constexpr int32_t test_value = ReadBarrier::gray_ptr_ << gray_bit_position;
+  static_assert(test_value > 0 && test_value <= 0xff, "Gray bit not in a byte");
+  uint32_t monitor_offset = mirror::Object::MonitorOffset().Uint32Value();
+  __ testb(Address(obj, monitor_offset + gray_byte_position), Immediate(test_value));
+  if (needs_null_check) {
+    MaybeRecordImplicitNullCheck(instruction);
+  }
+  // `movl` leaves the flags of the test unchanged.
+  __ movl(out, src);
+  SlowPathCodeX86_64* slow_path = new (GetGraph()->GetArena())
+      ReadBarrierMarkSlowPathX86_64(instruction, Location::RegisterLocation(out.AsRegister()));
+  AddSlowPath(slow_path);
+  __ j(kNotZero, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
+void CodeGeneratorX86_64::GenerateGcRootLoad(HInstruction* instruction,
+                                             CpuRegister out,
+                                             const Address& src) {
+  __ movl(out, src);
+  GenerateGcRootReadBarrier(instruction, out);
+}
+
+void CodeGeneratorX86_64::GenerateGcRootReadBarrier(HInstruction* instruction, CpuRegister root) {
+  if (kEmitCompilerReadBarrier) {
+    // GC roots have no read barrier state, mark them whenever the GC is marking.
+    SlowPathCodeX86_64* slow_path = new (GetGraph()->GetArena())
+        ReadBarrierMarkSlowPathX86_64(instruction, Location::RegisterLocation(root.AsRegister()));
+    AddSlowPath(slow_path);
+    __ gs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86_64WordSize>().Int32Value(),
+                                    true),
+                  Immediate(0));
+    __ j(kNotEqual, slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+  }
+}
+
 Location CodeGeneratorX86_64::GetStackLocation(HLoadLocal* load) const {
   switch (load->GetType()) {
     case Primitive::kPrimLong:
@@ -1390,6 +1511,8 @@ void InstructionCodeGeneratorX86_64::VisitInvokeVirtual(HInvokeVirtual* invoke)
   Location receiver = locations->InAt(0);
   size_t class_offset = mirror::Object::ClassOffset().SizeValue();
   // temp = object->GetClass();
+  // No read barrier is needed: a from-space class has the same embedded tables as its
+  // to-space copy, and the class is only used to find the method to call.
   if (receiver.IsStackSlot()) {
     __ movl(temp, Address(CpuRegister(RSP), receiver.GetStackIndex()));
     __ movl(temp, Address(temp, class_offset));
@@ -3011,25 +3134,75 @@ void InstructionCodeGeneratorX86_64::VisitUShr(HUShr* ushr) {
   HandleShift(ushr);
 }
 
+void InstructionCodeGeneratorX86_64::GenerateThreadLocalAllocation(CpuRegister out,
+                                                                   CpuRegister size,
+                                                                   Label* slow_path) {
+  // Threads without a thread-local buffer have pos == end == 0 and always take the slow path.
+  __ gs()->movq(out, Address::Absolute(Thread::ThreadLocalPosOffset<kX86_64WordSize>(), true));
+  __ addq(size, out);
+  __ gs()->cmpq(size, Address::Absolute(Thread::ThreadLocalEndOffset<kX86_64WordSize>(), true));
+  __ j(kAbove, slow_path);
+  __ gs()->movq(Address::Absolute(Thread::ThreadLocalPosOffset<kX86_64WordSize>(), true), size);
+  __ gs()->movq(size,
+                Address::Absolute(Thread::ThreadLocalObjectsOffset<kX86_64WordSize>(), true));
+  __ addq(size, Immediate(1));
+  __ gs()->movq(Address::Absolute(Thread::ThreadLocalObjectsOffset<kX86_64WordSize>(), true),
+                size);
+}
+
 void LocationsBuilderX86_64::VisitNewInstance(HNewInstance* instruction) {
   LocationSummary* locations =
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
   locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
   locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
+  // Holds the class on the inline allocation path.
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(2)));
   locations->SetOut(Location::RegisterLocation(RAX));
 }
 
 void InstructionCodeGeneratorX86_64::VisitNewInstance(HNewInstance* instruction) {
   InvokeRuntimeCallingConvention calling_convention;
-  codegen_->LoadCurrentMethod(CpuRegister(calling_convention.GetRegisterAt(1)));
-  codegen_->Load64BitValue(CpuRegister(calling_convention.GetRegisterAt(0)),
-                           instruction->GetTypeIndex());
+  CpuRegister type_index(calling_convention.GetRegisterAt(0));
+  CpuRegister current_method(calling_convention.GetRegisterAt(1));
+  codegen_->LoadCurrentMethod(current_method);
+
+  Label slow_path;
+  Label done;
+  bool allocate_inline = CodeGenerator::CanAllocateInline(instruction);
+  if (allocate_inline) {
+    // `type_index` is only needed by the runtime call; use it for the object size meanwhile.
+    CpuRegister size = type_index;
+    CpuRegister klass(calling_convention.GetRegisterAt(2));
+    CpuRegister out = instruction->GetLocations()->Out().AsRegister<CpuRegister>();
+    __ movl(klass, Address(current_method, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ movl(klass, Address(klass, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ testl(klass, klass);
+    __ j(kEqual, &slow_path);
+    __ cmpl(Address(klass, mirror::Class::StatusOffset().Int32Value()),
+            Immediate(mirror::Class::kStatusInitialized));
+    __ j(kLess, &slow_path);
+    __ movl(size, Address(klass, mirror::Class::AccessFlagsOffset().Int32Value()));
+    __ testl(size, Immediate(static_cast<int32_t>(kAccClassIsFinalizable)));
+    __ j(kNotZero, &slow_path);
+    __ movl(size, Address(klass, mirror::Class::ObjectSizeOffset().Int32Value()));
+    __ addq(size, Immediate(kObjectAlignment - 1));
+    __ andq(size, Immediate(~static_cast<int32_t>(kObjectAlignment - 1)));
+    GenerateThreadLocalAllocation(out, size, &slow_path);
+    __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), klass);
+    __ jmp(&done);
+    __ Bind(&slow_path);
+  }
+
+  codegen_->Load64BitValue(type_index, instruction->GetTypeIndex());
   __ gs()->call(
       Address::Absolute(GetThreadOffset<kX86_64WordSize>(instruction->GetEntrypoint()), true));
 
   DCHECK(!codegen_->IsLeafMethod());
   codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+  if (allocate_inline) {
+    __ Bind(&done);
+  }
 }
 
 void LocationsBuilderX86_64::VisitNewArray(HNewArray* instruction) {
@@ -3038,21 +3211,60 @@ void LocationsBuilderX86_64::VisitNewArray(HNewArray* instruction) {
   InvokeRuntimeCallingConvention calling_convention;
   locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
   locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(2)));
+  // Holds the class on the inline allocation path.
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(3)));
   locations->SetOut(Location::RegisterLocation(RAX));
   locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
 }
 
 void InstructionCodeGeneratorX86_64::VisitNewArray(HNewArray* instruction) {
   InvokeRuntimeCallingConvention calling_convention;
-  codegen_->LoadCurrentMethod(CpuRegister(calling_convention.GetRegisterAt(2)));
-  codegen_->Load64BitValue(CpuRegister(calling_convention.GetRegisterAt(0)),
-                           instruction->GetTypeIndex());
+  CpuRegister type_index(calling_convention.GetRegisterAt(0));
+  CpuRegister current_method(calling_convention.GetRegisterAt(2));
+  codegen_->LoadCurrentMethod(current_method);
+
+  Label slow_path;
+  Label done;
+  size_t component_size_shift;
+  bool allocate_inline = codegen_->CanAllocateInline(instruction, &component_size_shift);
+  if (allocate_inline) {
+    // The length must be preserved for the runtime call. `type_index` holds the array size.
+    CpuRegister length(calling_convention.GetRegisterAt(1));
+    CpuRegister size = type_index;
+    CpuRegister klass(calling_convention.GetRegisterAt(3));
+    CpuRegister out = instruction->GetLocations()->Out().AsRegister<CpuRegister>();
+    uint32_t data_offset = mirror::Array::DataOffset(1 << component_size_shift).Uint32Value();
+    // Array classes are always initialized and never finalizable.
+    __ movl(klass, Address(current_method, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+    __ movl(klass, Address(klass, CodeGenerator::GetCacheOffset(instruction->GetTypeIndex())));
+    __ testl(klass, klass);
+    __ j(kEqual, &slow_path);
+    // Unsigned comparison, so that negative lengths are left to the runtime.
+    __ cmpl(length,
+            Immediate((kMaxInlineAllocatedArraySize - data_offset) >> component_size_shift));
+    __ j(kAbove, &slow_path);
+    __ movl(size, length);
+    if (component_size_shift != 0) {
+      __ shlq(size, Immediate(component_size_shift));
+    }
+    __ addq(size, Immediate(data_offset + kObjectAlignment - 1));
+    __ andq(size, Immediate(~static_cast<int32_t>(kObjectAlignment - 1)));
+    GenerateThreadLocalAllocation(out, size, &slow_path);
+    __ movl(Address(out, mirror::Object::ClassOffset().Int32Value()), klass);
+    __ movl(Address(out, mirror::Array::LengthOffset().Int32Value()), length);
+    __ jmp(&done);
+    __ Bind(&slow_path);
+  }
 
+  codegen_->Load64BitValue(type_index, instruction->GetTypeIndex());
   __ gs()->call(
       Address::Absolute(GetThreadOffset<kX86_64WordSize>(instruction->GetEntrypoint()), true));
 
   DCHECK(!codegen_->IsLeafMethod());
   codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+  if (allocate_inline) {
+    __ Bind(&done);
+  }
 }
 
 void LocationsBuilderX86_64::VisitParameterValue(HParameterValue* instruction) {
@@ -3152,8 +3364,13 @@ void InstructionCodeGeneratorX86_64::GenerateMemoryBarrier(MemBarrierKind kind)
 void LocationsBuilderX86_64::HandleFieldGet(HInstruction* instruction) {
   DCHECK(instruction->IsInstanceFieldGet() || instruction->IsStaticFieldGet());
 
+  bool object_field_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (instruction->GetType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_field_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
     locations->SetOut(Location::RequiresFpuRegister());
@@ -3194,12 +3411,17 @@ void InstructionCodeGeneratorX86_64::HandleFieldGet(HInstruction* instruction,
       break;
     }
 
-    case Primitive::kPrimInt:
-    case Primitive::kPrimNot: {
+    case Primitive::kPrimInt: {
       __ movl(out.AsRegister<CpuRegister>(), Address(base, offset));
       break;
     }
 
+    case Primitive::kPrimNot: {
+      codegen_->GenerateReferenceLoad(
+          instruction, out.AsRegister<CpuRegister>(), base, Address(base, offset), true);
+      break;
+    }
+
     case Primitive::kPrimLong: {
       __ movq(out.AsRegister<CpuRegister>(), Address(base, offset));
       break;
@@ -3220,7 +3442,10 @@ void InstructionCodeGeneratorX86_64::HandleFieldGet(HInstruction* instruction,
       UNREACHABLE();
   }
 
-  codegen_->MaybeRecordImplicitNullCheck(instruction);
+  // References are handled in the switch.
+  if (field_type != Primitive::kPrimNot) {
+    codegen_->MaybeRecordImplicitNullCheck(instruction);
+  }
 
   if (is_volatile) {
     GenerateMemoryBarrier(MemBarrierKind::kLoadAny);
@@ -3422,8 +3647,13 @@ void InstructionCodeGeneratorX86_64::VisitNullCheck(HNullCheck* instruction) {
 }
 
 void LocationsBuilderX86_64::VisitArrayGet(HArrayGet* instruction) {
+  bool object_array_get_with_read_barrier =
+      kEmitCompilerReadBarrier && (instruction->GetType() == Primitive::kPrimNot);
   LocationSummary* locations =
-      new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kNoCall);
+      new (GetGraph()->GetArena()) LocationSummary(instruction,
+                                                   object_array_get_with_read_barrier
+                                                       ? LocationSummary::kCallOnSlowPath
+                                                       : LocationSummary::kNoCall);
   locations->SetInAt(0, Location::RequiresRegister());
   locations->SetInAt(1, Location::RegisterOrConstant(instruction->InputAt(1)));
   if (Primitive::IsFloatingPointType(instruction->GetType())) {
@@ -3487,9 +3717,7 @@ void InstructionCodeGeneratorX86_64::VisitArrayGet(HArrayGet* instruction) {
       break;
     }
 
-    case Primitive::kPrimInt:
-    case Primitive::kPrimNot: {
-      DCHECK_EQ(sizeof(mirror::HeapReference<mirror::Object>), sizeof(int32_t));
+    case Primitive::kPrimInt: {
       uint32_t data_offset = mirror::Array::DataOffset(sizeof(int32_t)).Uint32Value();
       CpuRegister out = locations->Out().AsRegister<CpuRegister>();
       if (index.IsConstant()) {
@@ -3501,6 +3729,18 @@ void InstructionCodeGeneratorX86_64::VisitArrayGet(HArrayGet* instruction) {
       break;
     }
 
+    case Primitive::kPrimNot: {
+      DCHECK_EQ(sizeof(mirror::HeapReference<mirror::Object>), sizeof(int32_t));
+      uint32_t data_offset = mirror::Array::DataOffset(sizeof(int32_t)).Uint32Value();
+      CpuRegister out = locations->Out().AsRegister<CpuRegister>();
+      Address src = index.IsConstant()
+          ? Address(obj,
+                    (index.GetConstant()->AsIntConstant()->GetValue() << TIMES_4) + data_offset)
+          : Address(obj, index.AsRegister<CpuRegister>(), TIMES_4, data_offset);
+      codegen_->GenerateReferenceLoad(instruction, out, obj, src, true);
+      break;
+    }
+
     case Primitive::kPrimLong: {
       uint32_t data_offset = mirror::Array::DataOffset(sizeof(int64_t)).Uint32Value();
       CpuRegister out = locations->Out().AsRegister<CpuRegister>();
@@ -3541,7 +3781,10 @@ void InstructionCodeGeneratorX86_64::VisitArrayGet(HArrayGet* instruction) {
       LOG(FATAL) << "Unreachable type " << instruction->GetType();
       UNREACHABLE();
   }
-  codegen_->MaybeRecordImplicitNullCheck(instruction);
+  // References are handled in the switch.
+  if (instruction->GetType() != Primitive::kPrimNot) {
+    codegen_->MaybeRecordImplicitNullCheck(instruction);
+  }
 }
 
 void LocationsBuilderX86_64::VisitArraySet(HArraySet* instruction) {
@@ -3881,6 +4124,20 @@ void InstructionCodeGeneratorX86_64::GenerateSuspendCheck(HSuspendCheck* instruc
     DCHECK_EQ(slow_path->GetSuccessor(), successor);
   }
 
+  if (successor != nullptr && codegen_->GetCompilerOptions().GetImplicitSuspendChecks()) {
+    // Load through the thread's suspend trigger. The trigger is cleared when a suspension
+    // is requested, so the test faults and SuspensionHandler resumes execution at the jump
+    // to the slow path. The exact sequence is matched by the fault handler.
+    CpuRegister trigger(TMP);
+    __ gs()->movq(trigger, Address::Absolute(
+        Thread::ThreadSuspendTriggerOffset<kX86_64WordSize>().Int32Value(), true));
+    __ testl(trigger, Address(trigger, 0));
+    codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+    __ jmp(codegen_->GetLabelOf(successor));
+    __ jmp(slow_path->GetEntryLabel());
+    return;
+  }
+
   __ gs()->cmpw(Address::Absolute(
       Thread::ThreadFlagsOffset<kX86_64WordSize>().Int32Value(), true), Immediate(0));
   if (successor == nullptr) {
@@ -4112,7 +4369,7 @@ void InstructionCodeGeneratorX86_64::GenerateClassInitializationCheck(
 }
 
 void LocationsBuilderX86_64::VisitLoadClass(HLoadClass* cls) {
-  LocationSummary::CallKind call_kind = cls->CanCallRuntime()
+  LocationSummary::CallKind call_kind = (cls->CanCallRuntime() || kEmitCompilerReadBarrier)
       ? LocationSummary::kCallOnSlowPath
       : LocationSummary::kNoCall;
   LocationSummary* locations =
@@ -4126,12 +4383,22 @@ void InstructionCodeGeneratorX86_64::VisitLoadClass(HLoadClass* cls) {
     DCHECK(!cls->CanCallRuntime());
     DCHECK(!cls->MustGenerateClinitCheck());
     codegen_->LoadCurrentMethod(out);
-    __ movl(out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
+    codegen_->GenerateGcRootLoad(
+        cls, out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
   } else {
     DCHECK(cls->CanCallRuntime());
-    codegen_->LoadCurrentMethod(out);
-    __ movl(out, Address(out, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
-    __ movl(out, Address(out, CodeGenerator::GetCacheOffset(cls->GetTypeIndex())));
+    if (codegen_->CanUsePcRelativeDexCacheArrayLoads()) {
+      codegen_->LoadDexCacheArrayElement(
+          out, codegen_->GetDexCacheTypeOffset(cls->GetTypeIndex()));
+      // The element is loaded without its array, treat it as a GC root.
+      codegen_->GenerateGcRootReadBarrier(cls, out);
+    } else {
+      codegen_->LoadCurrentMethod(out);
+      codegen_->GenerateGcRootLoad(
+          cls, out, Address(out, ArtMethod::DexCacheResolvedTypesOffset().Int32Value()));
+      codegen_->GenerateReferenceLoad(
+          cls, out, out, Address(out, CodeGenerator::GetCacheOffset(cls->GetTypeIndex())), false);
+    }
     SlowPathCodeX86_64* slow_path = new (GetGraph()->GetArena()) LoadClassSlowPathX86_64(
         cls, cls, cls->GetDexPc(), cls->MustGenerateClinitCheck());
     codegen_->AddSlowPath(slow_path);
@@ -4174,10 +4441,20 @@ void InstructionCodeGeneratorX86_64::VisitLoadString(HLoadString* load) {
   codegen_->AddSlowPath(slow_path);
 
   CpuRegister out = load->GetLocations()->Out().AsRegister<CpuRegister>();
-  codegen_->LoadCurrentMethod(CpuRegister(out));
-  __ movl(out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
-  __ movl(out, Address(out, mirror::Class::DexCacheStringsOffset().Int32Value()));
-  __ movl(out, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())));
+  if (codegen_->CanUsePcRelativeDexCacheArrayLoads()) {
+    codegen_->LoadDexCacheArrayElement(
+        out, codegen_->GetDexCacheStringOffset(load->GetStringIndex()));
+    // The element is loaded without its array, treat it as a GC root.
+    codegen_->GenerateGcRootReadBarrier(load, out);
+  } else {
+    codegen_->LoadCurrentMethod(CpuRegister(out));
+    codegen_->GenerateGcRootLoad(
+        load, out, Address(out, ArtMethod::DeclaringClassOffset().Int32Value()));
+    codegen_->GenerateReferenceLoad(
+        load, out, out, Address(out, mirror::Class::DexCacheStringsOffset().Int32Value()), false);
+    codegen_->GenerateReferenceLoad(
+        load, out, out, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())), false);
+  }
   __ testl(out, out);
   __ j(kEqual, slow_path->GetEntryLabel());
   __ Bind(slow_path->GetExitLabel());
@@ -4209,14 +4486,95 @@ void InstructionCodeGeneratorX86_64::VisitThrow(HThrow* instruction) {
   codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
 }
 
+// Temporaries needed by `GenerateTypeCheckWalk`.
+static void AddTypeCheckWalkTemps(LocationSummary* locations, TypeCheckKind kind) {
+  if (kind == TypeCheckKind::kClassHierarchyCheck ||
+      kind == TypeCheckKind::kArrayObjectCheck ||
+      kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+  if (kind == TypeCheckKind::kInterfaceCheck) {
+    locations->AddTemp(Location::RequiresRegister());
+  }
+}
+
+void InstructionCodeGeneratorX86_64::GenerateTypeCheckWalk(TypeCheckKind kind,
+                                                           CpuRegister obj_class,
+                                                           CpuRegister cls,
+                                                           Location temp1_loc,
+                                                           Location temp2_loc,
+                                                           Label* success,
+                                                           Label* failure) {
+  CpuRegister temp = temp1_loc.AsRegister<CpuRegister>();
+  switch (kind) {
+    case TypeCheckKind::kClassHierarchyCheck: {
+      // Walk the super class chain until `cls` or null is found.
+      Label loop;
+      __ movl(temp, obj_class);
+      __ Bind(&loop);
+      __ movl(temp, Address(temp, mirror::Class::SuperClassOffset().Int32Value()));
+      __ testl(temp, temp);
+      __ j(kEqual, failure);
+      __ cmpl(temp, cls);
+      __ j(kNotEqual, &loop);
+      __ jmp(success);
+      break;
+    }
+    case TypeCheckKind::kArrayObjectCheck: {
+      // `obj_class` must be an array class whose component type is not primitive.
+      __ movl(temp, Address(obj_class, mirror::Class::ComponentTypeOffset().Int32Value()));
+      __ testl(temp, temp);
+      __ j(kEqual, failure);
+      static_assert(Primitive::kPrimNot == 0, "Expected 0 for kPrimNot");
+      __ movzxw(temp, Address(temp, mirror::Class::PrimitiveTypeOffset().Int32Value()));
+      __ testl(temp, temp);
+      __ j(kNotEqual, failure);
+      __ jmp(success);
+      break;
+    }
+    case TypeCheckKind::kInterfaceCheck: {
+      // Scan the (interface, method array) pairs of the interface table.
+      CpuRegister count = temp2_loc.AsRegister<CpuRegister>();
+      uint32_t data_offset =
+          mirror::Array::DataOffset(sizeof(mirror::HeapReference<mirror::Object>)).Uint32Value();
+      Label loop;
+      __ movl(temp, Address(obj_class, mirror::Class::IfTableOffset().Int32Value()));
+      // Classes that implement no interface have no interface table.
+      __ testl(temp, temp);
+      __ j(kEqual, failure);
+      __ movl(count, Address(temp, mirror::Array::LengthOffset().Int32Value()));
+      __ Bind(&loop);
+      __ testl(count, count);
+      __ j(kEqual, failure);
+      __ cmpl(cls, Address(temp, data_offset));
+      __ j(kEqual, success);
+      __ addq(temp,
+              Immediate(mirror::IfTable::kMax * sizeof(mirror::HeapReference<mirror::Object>)));
+      __ subl(count, Immediate(mirror::IfTable::kMax));
+      __ jmp(&loop);
+      break;
+    }
+    default:
+      LOG(FATAL) << "Unexpected type check kind " << static_cast<int>(kind);
+      UNREACHABLE();
+  }
+}
+
 void LocationsBuilderX86_64::VisitInstanceOf(HInstanceOf* instruction) {
-  LocationSummary::CallKind call_kind = instruction->IsClassFinal()
-      ? LocationSummary::kNoCall
-      : LocationSummary::kCallOnSlowPath;
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
+  LocationSummary::CallKind call_kind = (kind == TypeCheckKind::kUnknownCheck ||
+                                         kEmitCompilerReadBarrier)
+      ? LocationSummary::kCallOnSlowPath
+      : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(instruction, call_kind);
   locations->SetInAt(0, Location::RequiresRegister());
-  locations->SetInAt(1, Location::Any());
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    locations->SetInAt(1, Location::Any());
+  } else {
+    locations->SetInAt(1, Location::RequiresRegister());
+  }
   locations->SetOut(Location::RequiresRegister());
+  AddTypeCheckWalkTemps(locations, kind);
 }
 
 void InstructionCodeGeneratorX86_64::VisitInstanceOf(HInstanceOf* instruction) {
@@ -4225,6 +4583,7 @@ void InstructionCodeGeneratorX86_64::VisitInstanceOf(HInstanceOf* instruction) {
   Location cls = locations->InAt(1);
   CpuRegister out = locations->Out().AsRegister<CpuRegister>();
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
   Label done, zero;
   SlowPathCodeX86_64* slow_path = nullptr;
 
@@ -4235,19 +4594,19 @@ void InstructionCodeGeneratorX86_64::VisitInstanceOf(HInstanceOf* instruction) {
     __ j(kEqual, &zero);
   }
   // Compare the class of `obj` with `cls`.
-  __ movl(out, Address(obj, class_offset));
+  codegen_->GenerateReferenceLoad(instruction, out, obj, Address(obj, class_offset), false);
   if (cls.IsRegister()) {
     __ cmpl(out, cls.AsRegister<CpuRegister>());
   } else {
     DCHECK(cls.IsStackSlot()) << cls;
     __ cmpl(out, Address(CpuRegister(RSP), cls.GetStackIndex()));
   }
-  if (instruction->IsClassFinal()) {
+  if (kind == TypeCheckKind::kExactCheck) {
     // Classes must be equal for the instanceof to succeed.
     __ j(kNotEqual, &zero);
     __ movl(out, Immediate(1));
     __ jmp(&done);
-  } else {
+  } else if (kind == TypeCheckKind::kUnknownCheck) {
     // If the classes are not equal, we go into a slow path.
     DCHECK(locations->OnlyCallsOnSlowPath());
     slow_path = new (GetGraph()->GetArena()) TypeCheckSlowPathX86_64(
@@ -4256,9 +4615,24 @@ void InstructionCodeGeneratorX86_64::VisitInstanceOf(HInstanceOf* instruction) {
     __ j(kNotEqual, slow_path->GetEntryLabel());
     __ movl(out, Immediate(1));
     __ jmp(&done);
+  } else {
+    // The inline walk gives a definite answer, no need for the runtime.
+    Label one;
+    __ j(kEqual, &one);
+    GenerateTypeCheckWalk(kind,
+                          out,
+                          cls.AsRegister<CpuRegister>(),
+                          locations->GetTemp(0),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(1)
+                                                                 : Location::NoLocation(),
+                          &one,
+                          &zero);
+    __ Bind(&one);
+    __ movl(out, Immediate(1));
+    __ jmp(&done);
   }
 
-  if (instruction->MustDoNullCheck() || instruction->IsClassFinal()) {
+  if (instruction->MustDoNullCheck() || kind != TypeCheckKind::kUnknownCheck) {
     __ Bind(&zero);
     __ movl(out, Immediate(0));
   }
@@ -4270,11 +4644,17 @@ void InstructionCodeGeneratorX86_64::VisitInstanceOf(HInstanceOf* instruction) {
 }
 
 void LocationsBuilderX86_64::VisitCheckCast(HCheckCast* instruction) {
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(
       instruction, LocationSummary::kCallOnSlowPath);
   locations->SetInAt(0, Location::RequiresRegister());
-  locations->SetInAt(1, Location::Any());
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    locations->SetInAt(1, Location::Any());
+  } else {
+    locations->SetInAt(1, Location::RequiresRegister());
+  }
   locations->AddTemp(Location::RequiresRegister());
+  AddTypeCheckWalkTemps(locations, kind);
 }
 
 void InstructionCodeGeneratorX86_64::VisitCheckCast(HCheckCast* instruction) {
@@ -4283,6 +4663,7 @@ void InstructionCodeGeneratorX86_64::VisitCheckCast(HCheckCast* instruction) {
   Location cls = locations->InAt(1);
   CpuRegister temp = locations->GetTemp(0).AsRegister<CpuRegister>();
   uint32_t class_offset = mirror::Object::ClassOffset().Int32Value();
+  TypeCheckKind kind = instruction->GetTypeCheckKind();
   SlowPathCodeX86_64* slow_path = new (GetGraph()->GetArena()) TypeCheckSlowPathX86_64(
       instruction, locations->InAt(1), locations->GetTemp(0), instruction->GetDexPc());
   codegen_->AddSlowPath(slow_path);
@@ -4293,15 +4674,28 @@ void InstructionCodeGeneratorX86_64::VisitCheckCast(HCheckCast* instruction) {
     __ j(kEqual, slow_path->GetExitLabel());
   }
   // Compare the class of `obj` with `cls`.
-  __ movl(temp, Address(obj, class_offset));
+  codegen_->GenerateReferenceLoad(instruction, temp, obj, Address(obj, class_offset), false);
   if (cls.IsRegister()) {
     __ cmpl(temp, cls.AsRegister<CpuRegister>());
   } else {
     DCHECK(cls.IsStackSlot()) << cls;
     __ cmpl(temp, Address(CpuRegister(RSP), cls.GetStackIndex()));
   }
-  // Classes must be equal for the checkcast to succeed.
-  __ j(kNotEqual, slow_path->GetEntryLabel());
+  if (kind == TypeCheckKind::kExactCheck || kind == TypeCheckKind::kUnknownCheck) {
+    // Classes must be equal for the checkcast to succeed.
+    __ j(kNotEqual, slow_path->GetEntryLabel());
+  } else {
+    // The slow path is only taken to throw the ClassCastException.
+    __ j(kEqual, slow_path->GetExitLabel());
+    GenerateTypeCheckWalk(kind,
+                          temp,
+                          cls.AsRegister<CpuRegister>(),
+                          locations->GetTemp(1),
+                          kind == TypeCheckKind::kInterfaceCheck ? locations->GetTemp(2)
+                                                                 : Location::NoLocation(),
+                          slow_path->GetExitLabel(),
+                          slow_path->GetEntryLabel());
+  }
   __ Bind(slow_path->GetExitLabel());
 }
 
@@ -4310,14 +4704,84 @@ void LocationsBuilderX86_64::VisitMonitorOperation(HMonitorOperation* instructio
       new (GetGraph()->GetArena()) LocationSummary(instruction, LocationSummary::kCall);
   InvokeRuntimeCallingConvention calling_convention;
   locations->SetInAt(0, Location::RegisterLocation(calling_convention.GetRegisterAt(0)));
+  // Lock word, thread id and compare-and-exchange value of the thin lock fast path.
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(1)));
+  locations->AddTemp(Location::RegisterLocation(calling_convention.GetRegisterAt(2)));
+  locations->AddTemp(Location::RegisterLocation(RAX));
+}
+
+void InstructionCodeGeneratorX86_64::GenerateThinLockFastPath(HMonitorOperation* instruction,
+                                                              Label* slow_path,
+                                                              Label* done) {
+  LocationSummary* locations = instruction->GetLocations();
+  CpuRegister obj = locations->InAt(0).AsRegister<CpuRegister>();
+  CpuRegister lock_word = locations->GetTemp(0).AsRegister<CpuRegister>();
+  CpuRegister thread_id = locations->GetTemp(1).AsRegister<CpuRegister>();
+  CpuRegister temp = locations->GetTemp(2).AsRegister<CpuRegister>();
+  DCHECK_EQ(temp.AsRegister(), RAX);
+  Address monitor(obj, mirror::Object::MonitorOffset().Int32Value());
+  // Both the owner and the state must match for a thin lock held by this thread.
+  int32_t owner_and_state_mask =
+      static_cast<int32_t>(LockWord::kStateMaskShifted | LockWord::kThinLockOwnerMask);
+
+  __ testl(obj, obj);
+  __ j(kEqual, slow_path);
+  __ movl(lock_word, monitor);
+  __ gs()->movl(thread_id,
+                Address::Absolute(Thread::ThinLockIdOffset<kX86_64WordSize>(), true));
+  __ movl(temp, lock_word);
+  __ xorl(temp, thread_id);
+  if (instruction->IsEnter()) {
+    Label not_unlocked;
+    __ testl(lock_word, lock_word);
+    __ j(kNotEqual, &not_unlocked);
+    // Unlocked: install this thread as the owner, with a recursion count of 0. Leave
+    // contention to the runtime.
+    __ xorl(temp, temp);
+    __ LockCmpxchgl(monitor, thread_id);
+    __ j(kEqual, done);
+    __ jmp(slow_path);
+    __ Bind(&not_unlocked);
+    // Thin lock held by this thread: increment the recursion count, unless it overflows.
+    // Only the owner updates a thin lock word, so a plain store is enough.
+    __ testl(temp, Immediate(owner_and_state_mask));
+    __ j(kNotEqual, slow_path);
+    __ addl(lock_word, Immediate(LockWord::kThinLockCountOne));
+    __ testl(lock_word, Immediate(static_cast<int32_t>(LockWord::kStateMaskShifted |
+                                                       LockWord::kReadBarrierStateMaskShifted)));
+    __ j(kNotEqual, slow_path);
+    __ movl(monitor, lock_word);
+    __ jmp(done);
+  } else {
+    Label recursive;
+    __ testl(temp, Immediate(owner_and_state_mask));
+    __ j(kNotEqual, slow_path);
+    __ cmpl(lock_word, Immediate(LockWord::kThinLockCountOne));
+    __ j(kAboveEqual, &recursive);
+    // Release the lock. Stores have release semantics on x86.
+    __ movl(monitor, Immediate(0));
+    __ jmp(done);
+    __ Bind(&recursive);
+    __ subl(lock_word, Immediate(LockWord::kThinLockCountOne));
+    __ movl(monitor, lock_word);
+    __ jmp(done);
+  }
 }
 
 void InstructionCodeGeneratorX86_64::VisitMonitorOperation(HMonitorOperation* instruction) {
+  Label slow_path;
+  Label done;
+  // The fast path does not preserve the read barrier bits of the lock word.
+  if (!kUseReadBarrier) {
+    GenerateThinLockFastPath(instruction, &slow_path, &done);
+    __ Bind(&slow_path);
+  }
   __ gs()->call(Address::Absolute(instruction->IsEnter()
         ? QUICK_ENTRYPOINT_OFFSET(kX86_64WordSize, pLockObject)
         : QUICK_ENTRYPOINT_OFFSET(kX86_64WordSize, pUnlockObject),
       true));
   codegen_->RecordPcInfo(instruction, instruction->GetDexPc());
+  __ Bind(&done);
 }
 
 void LocationsBuilderX86_64::VisitAnd(HAnd* instruction) { HandleBitwiseOperation(instruction); }
@@ -168,6 +168,22 @@ class InstructionCodeGeneratorX86_64 : public HGraphVisitor {
   // the suspend call.
   void GenerateSuspendCheck(HSuspendCheck* instruction, HBasicBlock* successor);
   void GenerateClassInitializationCheck(SlowPathCodeX86_64* slow_path, CpuRegister class_reg);
+  // Inline part of a type check of kind `kind`, after `obj_class` was found to differ
+  // from `cls`. Jumps to `success` or `failure`, preserving `obj_class`.
+  void GenerateTypeCheckWalk(TypeCheckKind kind,
+                             CpuRegister obj_class,
+                             CpuRegister cls,
+                             Location temp1,
+                             Location temp2,
+                             Label* success,
+                             Label* failure);
+  // Thin lock acquire or release for `instruction`. Jumps to `done` on success, or to
+  // `slow_path` if the runtime is needed.
+  void GenerateThinLockFastPath(HMonitorOperation* instruction, Label* slow_path, Label* done);
+  // Bump-allocate `size` bytes (a multiple of kObjectAlignment) from the thread-local
+  // allocation buffer into `out`, or jump to `slow_path` if the buffer is too small.
+  // Clobbers `size`.
+  void GenerateThreadLocalAllocation(CpuRegister out, CpuRegister size, Label* slow_path);
   void HandleBitwiseOperation(HBinaryOperation* operation);
   void GenerateRemFP(HRem *rem);
   void DivRemOneOrMinusOne(HBinaryOperation* instruction);
@@ -257,6 +273,27 @@ class CodeGeneratorX86_64 : public CodeGenerator {
 
   void LoadCurrentMethod(CpuRegister reg);
 
+  // Load the entry at `element_offset` in the dex cache arrays, a reference or (if `is_64bit`)
+  // an ArtMethod*, with a RIP-relative address patched by the linker. Only valid if
+  // CanUsePcRelativeDexCacheArrayLoads().
+  void LoadDexCacheArrayElement(CpuRegister out, size_t element_offset, bool is_64bit = false);
+
+  // Load the heap reference at `src`, a field or element of `obj`, into `out` with a read
+  // barrier if the compiler emits them. Records the implicit null check of `instruction`
+  // on the first access to `obj` if `needs_null_check`.
+  void GenerateReferenceLoad(HInstruction* instruction,
+                             CpuRegister out,
+                             CpuRegister obj,
+                             const Address& src,
+                             bool needs_null_check);
+
+  // Load the GC root at `src`, which is not in a heap object, into `out` with a read
+  // barrier if the compiler emits them.
+  void GenerateGcRootLoad(HInstruction* instruction, CpuRegister out, const Address& src);
+
+  // Emit the read barrier for the GC root just loaded into `root`, if the compiler emits them.
+  void GenerateGcRootReadBarrier(HInstruction* instruction, CpuRegister root);
+
   Label* GetLabelOf(HBasicBlock* block) const {
     return CommonGetLabelOf<Label>(block_labels_.GetRawStorage(), block);
   }
@@ -146,6 +146,11 @@ static Intrinsics GetIntrinsic(InlineMethod method) {
     case kIntrinsicSystemArrayCopyCharArray:
       return Intrinsics::kSystemArrayCopyChar;
 
+    // java.util.zip.CRC32.
+    case kIntrinsicCRC32Update:
+      return ((method.d.data & kIntrinsicFlagIsByteArray) == 0) ?
+          Intrinsics::kCRC32UpdateByte : Intrinsics::kCRC32UpdateBytes;
+
     // Thread.currentThread.
     case kIntrinsicCurrentThread:
       return  Intrinsics::kThreadCurrentThread;
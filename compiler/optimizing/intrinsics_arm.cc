@@ -532,9 +532,16 @@ void IntrinsicLocationsBuilderARM::VisitUnsafeGetLongVolatile(HInvoke* invoke) {
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 void IntrinsicLocationsBuilderARM::VisitUnsafeGetObject(HInvoke* invoke) {
+  // The intrinsic does not emit read barriers, leave the load to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 void IntrinsicLocationsBuilderARM::VisitUnsafeGetObjectVolatile(HInvoke* invoke) {
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 
@@ -762,6 +769,11 @@ void IntrinsicLocationsBuilderARM::VisitUnsafeCASInt(HInvoke* invoke) {
   CreateIntIntIntIntIntToIntPlusTemps(arena_, invoke);
 }
 void IntrinsicLocationsBuilderARM::VisitUnsafeCASObject(HInvoke* invoke) {
+  // The intrinsic would compare the expected value with a field that may still hold
+  // a from-space reference, leave it to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntIntIntToIntPlusTemps(arena_, invoke);
 }
 void IntrinsicCodeGeneratorARM::VisitUnsafeCASInt(HInvoke* invoke) {
@@ -1040,6 +1052,8 @@ UNIMPLEMENTED_INTRINSIC(MathRoundFloat)    // Could be done by changing rounding
 UNIMPLEMENTED_INTRINSIC(UnsafeCASLong)     // High register pressure.
 UNIMPLEMENTED_INTRINSIC(SystemArrayCopyChar)
 UNIMPLEMENTED_INTRINSIC(ReferenceGetReferent)
+UNIMPLEMENTED_INTRINSIC(CRC32UpdateByte)
+UNIMPLEMENTED_INTRINSIC(CRC32UpdateBytes)
 UNIMPLEMENTED_INTRINSIC(StringGetCharsNoCheck)
 
 }  // namespace arm
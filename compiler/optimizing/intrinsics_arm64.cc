@@ -705,9 +705,16 @@ void IntrinsicLocationsBuilderARM64::VisitUnsafeGetLongVolatile(HInvoke* invoke)
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 void IntrinsicLocationsBuilderARM64::VisitUnsafeGetObject(HInvoke* invoke) {
+  // The intrinsic does not emit read barriers, leave the load to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 void IntrinsicLocationsBuilderARM64::VisitUnsafeGetObjectVolatile(HInvoke* invoke) {
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 
@@ -901,6 +908,11 @@ void IntrinsicLocationsBuilderARM64::VisitUnsafeCASLong(HInvoke* invoke) {
   CreateIntIntIntIntIntToInt(arena_, invoke);
 }
 void IntrinsicLocationsBuilderARM64::VisitUnsafeCASObject(HInvoke* invoke) {
+  // The intrinsic would compare the expected value with a field that may still hold
+  // a from-space reference, leave it to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntIntIntToInt(arena_, invoke);
 }
 
@@ -1156,6 +1168,109 @@ void IntrinsicCodeGeneratorARM64::VisitStringNewStringFromString(HInvoke* invoke
   __ Bind(slow_path->GetExitLabel());
 }
 
+// Buffers larger than this are checksummed by the native implementation, so that a huge
+// update does not delay a pending suspend request for the whole length of the loop below.
+static constexpr int32_t kCRC32UpdateBytesInlineThreshold = 64 * KB;
+
+// The CRC32 instructions compute the raw (reflected) CRC, while zlib's crc32(), whose semantics
+// the native java.util.zip.CRC32 methods follow, inverts the value before and after the update.
+void IntrinsicLocationsBuilderARM64::VisitCRC32UpdateByte(HInvoke* invoke) {
+  if (!features_.HasCRC()) {
+    return;
+  }
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kNoCall,
+                                                            kIntrinsified);
+  locations->SetInAt(0, Location::NoLocation());        // Unused receiver.
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetInAt(2, Location::RequiresRegister());
+  locations->SetOut(Location::RequiresRegister(), Location::kNoOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitCRC32UpdateByte(HInvoke* invoke) {
+  vixl::MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  Register value = WRegisterFrom(locations->InAt(1));
+  Register crc = WRegisterFrom(locations->InAt(2));   // Only the low 32 bits of the long are used.
+  Register out = WRegisterFrom(locations->Out());     // Writing W zero-extends the long result.
+
+  __ Mvn(out, crc);
+  __ Crc32b(out, out, value);
+  __ Mvn(out, out);
+}
+
+void IntrinsicLocationsBuilderARM64::VisitCRC32UpdateBytes(HInvoke* invoke) {
+  if (!features_.HasCRC()) {
+    return;
+  }
+  LocationSummary* locations = new (arena_) LocationSummary(invoke,
+                                                            LocationSummary::kCallOnSlowPath,
+                                                            kIntrinsified);
+  // The receiver is only needed by the slow path, which calls the native implementation.
+  locations->SetInAt(0, Location::RequiresRegister());
+  locations->SetInAt(1, Location::RequiresRegister());
+  locations->SetInAt(2, Location::RequiresRegister());
+  locations->SetInAt(3, Location::RequiresRegister());
+  locations->SetInAt(4, Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresRegister());
+  // The inputs are still needed when the output is first written.
+  locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
+}
+
+void IntrinsicCodeGeneratorARM64::VisitCRC32UpdateBytes(HInvoke* invoke) {
+  vixl::MacroAssembler* masm = GetVIXLAssembler();
+  LocationSummary* locations = invoke->GetLocations();
+
+  // The bounds of the region have been checked by the caller, CRC32.update(byte[], int, int).
+  Register array = XRegisterFrom(locations->InAt(1));
+  Register offset = WRegisterFrom(locations->InAt(2));
+  Register length = WRegisterFrom(locations->InAt(3));
+  Register crc = WRegisterFrom(locations->InAt(4));
+  Register out = WRegisterFrom(locations->Out());
+  Register ptr = XRegisterFrom(locations->GetTemp(0));
+  Register remaining = WRegisterFrom(locations->GetTemp(1));
+
+  UseScratchRegisterScope temps(masm);
+  Register data = temps.AcquireX();
+
+  SlowPathCodeARM64* slow_path = new (GetAllocator()) IntrinsicSlowPathARM64(invoke);
+  codegen_->AddSlowPath(slow_path);
+  __ Cmp(length, kCRC32UpdateBytesInlineThreshold);
+  __ B(hi, slow_path->GetEntryLabel());
+
+  const int32_t data_offset = mirror::Array::DataOffset(sizeof(int8_t)).Int32Value();
+  __ Add(ptr, array, Operand(offset, UXTW));
+  __ Add(ptr, ptr, data_offset);
+  __ Mov(remaining, length);
+  __ Mvn(out, crc);
+
+  vixl::Label loop_8, tail, loop_1, done;
+  // Eight bytes at a time. Unaligned loads are fine on heap memory.
+  __ Subs(remaining, remaining, 8);
+  __ B(lt, &tail);
+  __ Bind(&loop_8);
+  __ Ldr(data, MemOperand(ptr, 8, PostIndex));
+  __ Crc32x(out, out, data);
+  __ Subs(remaining, remaining, 8);
+  __ B(ge, &loop_8);
+
+  // Remaining zero to seven bytes.
+  __ Bind(&tail);
+  __ Adds(remaining, remaining, 8);
+  __ B(eq, &done);
+  __ Bind(&loop_1);
+  __ Ldrb(data.W(), MemOperand(ptr, 1, PostIndex));
+  __ Crc32b(out, out, data.W());
+  __ Subs(remaining, remaining, 1);
+  __ B(ne, &loop_1);
+
+  __ Bind(&done);
+  __ Mvn(out, out);
+  __ Bind(slow_path->GetExitLabel());
+}
+
 // Unimplemented intrinsics.
 
 #define UNIMPLEMENTED_INTRINSIC(Name)                                                  \
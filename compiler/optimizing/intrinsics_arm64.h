@@ -28,6 +28,7 @@ class MacroAssembler;
 namespace art {
 
 class ArenaAllocator;
+class Arm64InstructionSetFeatures;
 class HInvokeStaticOrDirect;
 class HInvokeVirtual;
 
@@ -37,7 +38,8 @@ class CodeGeneratorARM64;
 
 class IntrinsicLocationsBuilderARM64 FINAL : public IntrinsicVisitor {
  public:
-  explicit IntrinsicLocationsBuilderARM64(ArenaAllocator* arena) : arena_(arena) {}
+  IntrinsicLocationsBuilderARM64(ArenaAllocator* arena, const Arm64InstructionSetFeatures& features)
+      : arena_(arena), features_(features) {}
 
   // Define visitor methods.
 
@@ -56,6 +58,8 @@ INTRINSICS_LIST(OPTIMIZING_INTRINSICS)
  private:
   ArenaAllocator* arena_;
 
+  const Arm64InstructionSetFeatures& features_;
+
   DISALLOW_COPY_AND_ASSIGN(IntrinsicLocationsBuilderARM64);
 };
 
@@ -49,6 +49,8 @@
   V(MathRoundDouble, kStatic) \
   V(MathRoundFloat, kStatic) \
   V(SystemArrayCopyChar, kStatic) \
+  V(CRC32UpdateByte, kDirect) \
+  V(CRC32UpdateBytes, kDirect) \
   V(ThreadCurrentThread, kStatic) \
   V(MemoryPeekByte, kStatic) \
   V(MemoryPeekIntNative, kStatic) \
@@ -1392,9 +1392,16 @@ void IntrinsicLocationsBuilderX86::VisitUnsafeGetLongVolatile(HInvoke* invoke) {
   CreateIntIntIntToIntLocations(arena_, invoke, true, true);
 }
 void IntrinsicLocationsBuilderX86::VisitUnsafeGetObject(HInvoke* invoke) {
+  // The intrinsic does not emit read barriers, leave the load to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke, false, false);
 }
 void IntrinsicLocationsBuilderX86::VisitUnsafeGetObjectVolatile(HInvoke* invoke) {
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke, false, true);
 }
 
@@ -1577,6 +1584,11 @@ void IntrinsicLocationsBuilderX86::VisitUnsafeCASLong(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86::VisitUnsafeCASObject(HInvoke* invoke) {
+  // The intrinsic would compare the expected value with a field that may still hold
+  // a from-space reference, leave it to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntIntIntToInt(arena_, Primitive::kPrimNot, invoke);
 }
 
@@ -1725,6 +1737,8 @@ UNIMPLEMENTED_INTRINSIC(MathRoundDouble)
 UNIMPLEMENTED_INTRINSIC(StringGetCharsNoCheck)
 UNIMPLEMENTED_INTRINSIC(SystemArrayCopyChar)
 UNIMPLEMENTED_INTRINSIC(ReferenceGetReferent)
+UNIMPLEMENTED_INTRINSIC(CRC32UpdateByte)
+UNIMPLEMENTED_INTRINSIC(CRC32UpdateBytes)
 
 }  // namespace x86
 }  // namespace art
@@ -1288,9 +1288,16 @@ void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetLongVolatile(HInvoke* invoke
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetObject(HInvoke* invoke) {
+  // The intrinsic does not emit read barriers, leave the load to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 void IntrinsicLocationsBuilderX86_64::VisitUnsafeGetObjectVolatile(HInvoke* invoke) {
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntToIntLocations(arena_, invoke);
 }
 
@@ -1444,6 +1451,11 @@ void IntrinsicLocationsBuilderX86_64::VisitUnsafeCASLong(HInvoke* invoke) {
 }
 
 void IntrinsicLocationsBuilderX86_64::VisitUnsafeCASObject(HInvoke* invoke) {
+  // The intrinsic would compare the expected value with a field that may still hold
+  // a from-space reference, leave it to the runtime.
+  if (kEmitCompilerReadBarrier) {
+    return;
+  }
   CreateIntIntIntIntIntToInt(arena_, Primitive::kPrimNot, invoke);
 }
 
@@ -1595,6 +1607,8 @@ void IntrinsicCodeGeneratorX86_64::Visit ## Name(HInvoke* invoke ATTRIBUTE_UNUSE
 UNIMPLEMENTED_INTRINSIC(StringGetCharsNoCheck)
 UNIMPLEMENTED_INTRINSIC(SystemArrayCopyChar)
 UNIMPLEMENTED_INTRINSIC(ReferenceGetReferent)
+UNIMPLEMENTED_INTRINSIC(CRC32UpdateByte)
+UNIMPLEMENTED_INTRINSIC(CRC32UpdateBytes)
 
 }  // namespace x86_64
 }  // namespace art
@@ -2451,6 +2451,12 @@ class HInvokeStaticOrDirect : public HInvoke {
     kImplicit,  // Static call implicitly requiring a clinit check.
   };
 
+  // How the code of the callee is reached.
+  enum class CodePtrLocation {
+    kCallArtMethod,   // Load the entrypoint from the callee's ArtMethod.
+    kCallPCRelative,  // Callee compiled in the same oat file, use a call patched by the linker.
+  };
+
   HInvokeStaticOrDirect(ArenaAllocator* arena,
                         uint32_t number_of_arguments,
                         Primitive::Type return_type,
@@ -2460,7 +2466,8 @@ class HInvokeStaticOrDirect : public HInvoke {
                         int32_t string_init_offset,
                         InvokeType original_invoke_type,
                         InvokeType invoke_type,
-                        ClinitCheckRequirement clinit_check_requirement)
+                        ClinitCheckRequirement clinit_check_requirement,
+                        CodePtrLocation code_ptr_location)
       : HInvoke(arena,
                 number_of_arguments,
                 clinit_check_requirement == ClinitCheckRequirement::kExplicit ? 1u : 0u,
@@ -2471,6 +2478,7 @@ class HInvokeStaticOrDirect : public HInvoke {
         invoke_type_(invoke_type),
         is_recursive_(is_recursive),
         clinit_check_requirement_(clinit_check_requirement),
+        code_ptr_location_(code_ptr_location),
         string_init_offset_(string_init_offset) {}
 
   bool CanDoImplicitNullCheckOn(HInstruction* obj) const OVERRIDE {
@@ -2486,6 +2494,7 @@ class HInvokeStaticOrDirect : public HInvoke {
   bool NeedsDexCache() const OVERRIDE { return !IsRecursive(); }
   bool IsStringInit() const { return string_init_offset_ != 0; }
   int32_t GetStringInitOffset() const { return string_init_offset_; }
+  CodePtrLocation GetCodePtrLocation() const { return code_ptr_location_; }
 
   // Is this instruction a call to a static method?
   bool IsStatic() const {
@@ -2542,6 +2551,7 @@ class HInvokeStaticOrDirect : public HInvoke {
   const InvokeType invoke_type_;
   const bool is_recursive_;
   ClinitCheckRequirement clinit_check_requirement_;
+  const CodePtrLocation code_ptr_location_;
   // Thread entrypoint offset for string init method if this is a string init invoke.
   // Note that there are multiple string init methods, each having its own offset.
   int32_t string_init_offset_;
@@ -3657,6 +3667,16 @@ class HThrow : public HTemplateInstruction<1> {
   DISALLOW_COPY_AND_ASSIGN(HThrow);
 };
 
+// How HInstanceOf and HCheckCast compare the class of the object against the loaded class.
+// Set from the resolved class by reference type propagation.
+enum class TypeCheckKind {
+  kUnknownCheck,         // Compare the classes, then call the runtime.
+  kExactCheck,           // The classes must be equal.
+  kClassHierarchyCheck,  // Walk the super class chain.
+  kArrayObjectCheck,     // The object must be an array of references.
+  kInterfaceCheck,       // Scan the interface table.
+};
+
 class HInstanceOf : public HExpression<2> {
  public:
   HInstanceOf(HInstruction* object,
@@ -3664,7 +3684,8 @@ class HInstanceOf : public HExpression<2> {
               bool class_is_final,
               uint32_t dex_pc)
       : HExpression(Primitive::kPrimBoolean, SideEffects::None()),
-        class_is_final_(class_is_final),
+        type_check_kind_(class_is_final ? TypeCheckKind::kExactCheck
+                                        : TypeCheckKind::kUnknownCheck),
         must_do_null_check_(true),
         dex_pc_(dex_pc) {
     SetRawInputAt(0, object);
@@ -3683,7 +3704,10 @@ class HInstanceOf : public HExpression<2> {
 
   uint32_t GetDexPc() const OVERRIDE { return dex_pc_; }
 
-  bool IsClassFinal() const { return class_is_final_; }
+  bool IsClassFinal() const { return type_check_kind_ == TypeCheckKind::kExactCheck; }
+
+  TypeCheckKind GetTypeCheckKind() const { return type_check_kind_; }
+  void SetTypeCheckKind(TypeCheckKind kind) { type_check_kind_ = kind; }
 
   // Used only in code generation.
   bool MustDoNullCheck() const { return must_do_null_check_; }
@@ -3692,7 +3716,7 @@ class HInstanceOf : public HExpression<2> {
   DECLARE_INSTRUCTION(InstanceOf);
 
  private:
-  const bool class_is_final_;
+  TypeCheckKind type_check_kind_;
   bool must_do_null_check_;
   const uint32_t dex_pc_;
 
@@ -3733,7 +3757,8 @@ class HCheckCast : public HTemplateInstruction<2> {
              bool class_is_final,
              uint32_t dex_pc)
       : HTemplateInstruction(SideEffects::None()),
-        class_is_final_(class_is_final),
+        type_check_kind_(class_is_final ? TypeCheckKind::kExactCheck
+                                        : TypeCheckKind::kUnknownCheck),
         must_do_null_check_(true),
         dex_pc_(dex_pc) {
     SetRawInputAt(0, object);
@@ -3758,12 +3783,15 @@ class HCheckCast : public HTemplateInstruction<2> {
 
   uint32_t GetDexPc() const OVERRIDE { return dex_pc_; }
 
-  bool IsClassFinal() const { return class_is_final_; }
+  bool IsClassFinal() const { return type_check_kind_ == TypeCheckKind::kExactCheck; }
+
+  TypeCheckKind GetTypeCheckKind() const { return type_check_kind_; }
+  void SetTypeCheckKind(TypeCheckKind kind) { type_check_kind_ = kind; }
 
   DECLARE_INSTRUCTION(CheckCast);
 
  private:
-  const bool class_is_final_;
+  TypeCheckKind type_check_kind_;
   bool must_do_null_check_;
   const uint32_t dex_pc_;
 
@@ -54,6 +54,7 @@
 #include "ssa_phi_elimination.h"
 #include "ssa_liveness_analysis.h"
 #include "utils/assembler.h"
+#include "utils/dex_cache_arrays_layout-inl.h"
 
 namespace art {
 
@@ -289,6 +290,14 @@ bool OptimizingCompiler::CanCompileMethod(uint32_t method_idx ATTRIBUTE_UNUSED,
 }
 
 static bool IsInstructionSetSupported(InstructionSet instruction_set) {
+  if (kUseReadBarrier) {
+    // Only the ARM, ARM64, x86 and x86-64 code generators emit read barriers, and only Baker's.
+    return kEmitCompilerReadBarrier &&
+        (instruction_set == kArm64
+         || (instruction_set == kThumb2 && !kArm32QuickCodeUseSoftFloat)
+         || instruction_set == kX86
+         || instruction_set == kX86_64);
+  }
   return instruction_set == kArm64
       || (instruction_set == kThumb2 && !kArm32QuickCodeUseSoftFloat)
       || instruction_set == kMips64
@@ -417,6 +426,9 @@ CompiledMethod* OptimizingCompiler::CompileOptimized(HGraph* graph,
   std::vector<uint8_t> stack_map;
   codegen->BuildStackMaps(&stack_map);
 
+  std::vector<LinkerPatch> linker_patches;
+  codegen->EmitLinkerPatches(&linker_patches);
+
   MaybeRecordStat(MethodCompilationStat::kCompiledOptimized);
 
   return CompiledMethod::SwapAllocCompiledMethod(
@@ -434,7 +446,7 @@ CompiledMethod* OptimizingCompiler::CompileOptimized(HGraph* graph,
       ArrayRef<const uint8_t>(stack_map),
       ArrayRef<const uint8_t>(),  // native_gc_map.
       ArrayRef<const uint8_t>(*codegen->GetAssembler()->cfi().data()),
-      ArrayRef<const LinkerPatch>());
+      ArrayRef<const LinkerPatch>(linker_patches));
 }
 
 CompiledMethod* OptimizingCompiler::CompileBaseline(
@@ -454,6 +466,8 @@ CompiledMethod* OptimizingCompiler::CompileBaseline(
   codegen->BuildVMapTable(&vmap_table);
   std::vector<uint8_t> gc_map;
   codegen->BuildNativeGCMap(&gc_map, dex_compilation_unit);
+  std::vector<LinkerPatch> linker_patches;
+  codegen->EmitLinkerPatches(&linker_patches);
 
   MaybeRecordStat(MethodCompilationStat::kCompiledBaseline);
   return CompiledMethod::SwapAllocCompiledMethod(
@@ -471,7 +485,7 @@ CompiledMethod* OptimizingCompiler::CompileBaseline(
       AlignVectorSize(vmap_table),
       AlignVectorSize(gc_map),
       ArrayRef<const uint8_t>(*codegen->GetAssembler()->cfi().data()),
-      ArrayRef<const LinkerPatch>());
+      ArrayRef<const LinkerPatch>(linker_patches));
 }
 
 CompiledMethod* OptimizingCompiler::TryCompile(const DexFile::CodeItem* code_item,
@@ -549,7 +563,10 @@ CompiledMethod* OptimizingCompiler::TryCompile(const DexFile::CodeItem* code_ite
     return nullptr;
   }
   codegen->GetAssembler()->cfi().SetEnabled(
-      compiler_driver->GetCompilerOptions().GetGenerateDebugInfo());
+      compiler_driver->GetCompilerOptions().GetGenerateAnyDebugInfo());
+  DexCacheArraysLayout dex_cache_arrays_layout =
+      compiler_driver->GetDexCacheArraysLayout(&dex_file);
+  codegen->SetDexCacheArraysLayout(&dex_cache_arrays_layout);
 
   PassInfoPrinter pass_info_printer(graph,
                                     method_name.c_str(),
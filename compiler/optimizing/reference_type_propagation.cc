@@ -44,6 +44,8 @@ void ReferenceTypePropagation::VisitBasicBlock(HBasicBlock* block) {
       VisitNewInstance(instr->AsNewInstance());
     } else if (instr->IsLoadClass()) {
       VisitLoadClass(instr->AsLoadClass());
+    } else if (instr->IsInstanceOf() || instr->IsCheckCast()) {
+      VisitTypeCheck(instr);
     }
   }
 
@@ -199,6 +201,46 @@ void ReferenceTypePropagation::VisitLoadClass(HLoadClass* instr) {
   instr->SetReferenceTypeInfo(ReferenceTypeInfo::Create(class_handle, /* is_exact */ true));
 }
 
+static TypeCheckKind ComputeTypeCheckKind(mirror::Class* klass)
+    SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+  if (klass->IsInterface()) {
+    return TypeCheckKind::kInterfaceCheck;
+  } else if (klass->IsArrayClass()) {
+    return klass->GetComponentType()->IsObjectClass()
+        ? TypeCheckKind::kArrayObjectCheck
+        : TypeCheckKind::kUnknownCheck;
+  } else {
+    return TypeCheckKind::kClassHierarchyCheck;
+  }
+}
+
+void ReferenceTypePropagation::VisitTypeCheck(HInstruction* type_check) {
+  if (kEmitCompilerReadBarrier) {
+    // The inline walks of the class hierarchy load classes without read barriers.
+    return;
+  }
+  // The loaded class dominates the type check, so it has already been visited.
+  HLoadClass* load_class = type_check->InputAt(1)->AsLoadClass();
+  if (!load_class->IsResolved()) {
+    return;
+  }
+  if (type_check->IsInstanceOf()) {
+    HInstanceOf* instance_of = type_check->AsInstanceOf();
+    if (instance_of->GetTypeCheckKind() == TypeCheckKind::kUnknownCheck) {
+      ScopedObjectAccess soa(Thread::Current());
+      instance_of->SetTypeCheckKind(
+          ComputeTypeCheckKind(load_class->GetLoadedClassRTI().GetTypeHandle().Get()));
+    }
+  } else {
+    HCheckCast* check_cast = type_check->AsCheckCast();
+    if (check_cast->GetTypeCheckKind() == TypeCheckKind::kUnknownCheck) {
+      ScopedObjectAccess soa(Thread::Current());
+      check_cast->SetTypeCheckKind(
+          ComputeTypeCheckKind(load_class->GetLoadedClassRTI().GetTypeHandle().Get()));
+    }
+  }
+}
+
 void ReferenceTypePropagation::VisitPhi(HPhi* phi) {
   if (phi->GetType() != Primitive::kPrimNot) {
     return;
@@ -47,6 +47,7 @@ class ReferenceTypePropagation : public HOptimization {
  private:
   void VisitNewInstance(HNewInstance* new_instance);
   void VisitLoadClass(HLoadClass* load_class);
+  void VisitTypeCheck(HInstruction* type_check);
   void VisitPhi(HPhi* phi);
   void VisitBasicBlock(HBasicBlock* block);
 
@@ -106,8 +106,9 @@ uint32_t ShifterOperand::encodingArm() const {
         }
         // Shifted immediate or register.
         if (rs_ == kNoRegister) {
-          // Immediate shift.
-          return immed_ << kShiftImmShift |
+          // Immediate shift. LSR and ASR by 32 are encoded with a shift of 0.
+          uint32_t shift_imm = immed_ & 31U;
+          return shift_imm << kShiftImmShift |
                           shift_type << kShiftShift |
                           static_cast<uint32_t>(rm_);
         } else {
@@ -140,8 +141,10 @@ uint32_t ShifterOperand::encodingThumb() const {
             // RRX is encoded as an ROR with imm 0.
             return ROR << 4 | static_cast<uint32_t>(rm_);
           } else {
-            uint32_t imm3 = immed_ >> 2;
-            uint32_t imm2 = immed_ & 3U /* 0b11 */;
+            // LSR and ASR by 32 are encoded with a shift of 0.
+            uint32_t shift_imm = immed_ & 31U;
+            uint32_t imm3 = shift_imm >> 2;
+            uint32_t imm2 = shift_imm & 3U /* 0b11 */;
 
             return imm3 << 12 | imm2 << 6 | shift_ << 4 |
                 static_cast<uint32_t>(rm_);
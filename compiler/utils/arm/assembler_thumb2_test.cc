@@ -247,6 +247,18 @@ TEST_F(AssemblerThumb2Test, add) {
   DriverStr(expected, "add");
 }
 
+TEST_F(AssemblerThumb2Test, AddShiftedRegister) {
+  __ add(arm::R1, arm::R0, arm::ShifterOperand(arm::R2, arm::LSL, 2));
+  __ add(arm::R1, arm::R0, arm::ShifterOperand(arm::R2, arm::LSR, 32));
+  __ add(arm::R1, arm::R0, arm::ShifterOperand(arm::R2, arm::ASR, 32));
+
+  const char* expected =
+      "add.w r1, r0, r2, lsl #2\n"
+      "add.w r1, r0, r2, lsr #32\n"
+      "add.w r1, r0, r2, asr #32\n";
+  DriverStr(expected, "AddShiftedRegister");
+}
+
 TEST_F(AssemblerThumb2Test, StoreWordToThumbOffset) {
   arm::StoreOperandType type = arm::kStoreWord;
   int32_t offset = 4092;
@@ -20,9 +20,10 @@
 #include <algorithm>
 #include <inttypes.h>
 #include <memory>
-#include <set>
 #include <string>
+#include <vector>
 
+#include "base/hash_set.h"
 #include "base/mutex.h"
 #include "base/stl_util.h"
 #include "base/stringprintf.h"
@@ -32,44 +33,63 @@
 namespace art {
 
 // A set of Keys that support a HashFunc returning HashType. Used to find duplicates of Key in the
-// Add method. The data-structure is thread-safe through the use of internal locks, it also
-// supports the lock being sharded.
+// Add method. The data-structure is thread-safe: the keys are striped over kShard shards by
+// their hash, each shard being a hash set with its own lock, so that concurrent Add() calls
+// rarely wait for each other. The contents of two keys are only compared if their hashes match.
 template <typename InKey, typename StoreKey, typename HashType, typename HashFunc,
           HashType kShard = 1>
 class DedupeSet {
-  typedef std::pair<HashType, const InKey*> HashedInKey;
   struct HashedKey {
     StoreKey* store_ptr;
-    union {
-      HashType store_hash;        // Valid if store_ptr != null.
-      const HashedInKey* in_key;  // Valid if store_ptr == null.
-    };
+    HashType hash;
   };
 
-  class Comparator {
+  // A key to look up: the hash and the contents to add.
+  struct LookupKey {
+    HashType hash;
+    const InKey* in_key;
+  };
+
+  class ShardEmptyFn {
    public:
-    bool operator()(const HashedKey& a, const HashedKey& b) const {
-      HashType a_hash = (a.store_ptr != nullptr) ? a.store_hash : a.in_key->first;
-      HashType b_hash = (b.store_ptr != nullptr) ? b.store_hash : b.in_key->first;
-      if (a_hash != b_hash) {
-        return a_hash < b_hash;
-      }
-      if (a.store_ptr != nullptr && b.store_ptr != nullptr) {
-        return std::lexicographical_compare(a.store_ptr->begin(), a.store_ptr->end(),
-                                            b.store_ptr->begin(), b.store_ptr->end());
-      } else if (a.store_ptr != nullptr && b.store_ptr == nullptr) {
-        return std::lexicographical_compare(a.store_ptr->begin(), a.store_ptr->end(),
-                                            b.in_key->second->begin(), b.in_key->second->end());
-      } else if (a.store_ptr == nullptr && b.store_ptr != nullptr) {
-        return std::lexicographical_compare(a.in_key->second->begin(), a.in_key->second->end(),
-                                            b.store_ptr->begin(), b.store_ptr->end());
-      } else {
-        return std::lexicographical_compare(a.in_key->second->begin(), a.in_key->second->end(),
-                                            b.in_key->second->begin(), b.in_key->second->end());
-      }
+    void MakeEmpty(HashedKey& item) const {
+      item.store_ptr = nullptr;
+    }
+    bool IsEmpty(const HashedKey& item) const {
+      return item.store_ptr == nullptr;
+    }
+  };
+
+  class ShardHashFn {
+   public:
+    size_t operator()(const HashedKey& key) const {
+      return key.hash;
+    }
+    size_t operator()(const LookupKey& key) const {
+      return key.hash;
     }
   };
 
+  class ShardPred {
+   public:
+    bool operator()(const HashedKey& lhs, const LookupKey& rhs) const {
+      return lhs.hash == rhs.hash &&
+          lhs.store_ptr->size() == rhs.in_key->size() &&
+          std::equal(rhs.in_key->begin(), rhs.in_key->end(), lhs.store_ptr->begin());
+    }
+    bool operator()(const HashedKey& lhs, const HashedKey& rhs) const {
+      return lhs.store_ptr == rhs.store_ptr;
+    }
+  };
+
+  struct Shard {
+    std::unique_ptr<Mutex> lock;
+    HashSet<HashedKey, ShardEmptyFn, ShardHashFn, ShardPred> keys;
+    size_t adds;         // Calls to Add() for this shard.
+    size_t hits;         // Calls to Add() that found a duplicate.
+    size_t hit_bytes;    // The size of the duplicates found.
+  };
+
  public:
   StoreKey* Add(Thread* self, const InKey& key) {
     uint64_t hash_start;
@@ -83,19 +103,19 @@ class DedupeSet {
     }
     HashType shard_hash = raw_hash / kShard;
     HashType shard_bin = raw_hash % kShard;
-    HashedInKey hashed_in_key(shard_hash, &key);
-    HashedKey hashed_key;
-    hashed_key.store_ptr = nullptr;
-    hashed_key.in_key = &hashed_in_key;
-    MutexLock lock(self, *lock_[shard_bin]);
-    auto it = keys_[shard_bin].find(hashed_key);
-    if (it != keys_[shard_bin].end()) {
+    LookupKey lookup_key = { shard_hash, &key };
+    Shard& shard = shards_[shard_bin];
+    MutexLock lock(self, *shard.lock);
+    ++shard.adds;
+    auto it = shard.keys.FindWithHash(lookup_key, shard_hash);
+    if (it != shard.keys.end()) {
       DCHECK(it->store_ptr != nullptr);
+      ++shard.hits;
+      shard.hit_bytes += key.size() * sizeof(typename InKey::value_type);
       return it->store_ptr;
     }
-    hashed_key.store_ptr = CreateStoreKey(key);
-    hashed_key.store_hash = shard_hash;
-    keys_[shard_bin].insert(hashed_key);
+    HashedKey hashed_key = { CreateStoreKey(key), shard_hash };
+    shard.keys.InsertWithHash(hashed_key, shard_hash);
     return hashed_key.store_ptr;
   }
 
@@ -105,29 +125,45 @@ class DedupeSet {
       std::ostringstream oss;
       oss << set_name << " lock " << i;
       lock_name_[i] = oss.str();
-      lock_[i].reset(new Mutex(lock_name_[i].c_str()));
+      shards_[i].lock.reset(new Mutex(lock_name_[i].c_str()));
+      shards_[i].adds = 0u;
+      shards_[i].hits = 0u;
+      shards_[i].hit_bytes = 0u;
     }
   }
 
   ~DedupeSet() {
     // Have to manually free all pointers.
-    for (auto& shard : keys_) {
-      for (const auto& hashed_key : shard) {
+    for (auto& shard : shards_) {
+      for (const auto& hashed_key : shard.keys) {
         DCHECK(hashed_key.store_ptr != nullptr);
         DeleteStoreKey(hashed_key.store_ptr);
       }
     }
   }
 
-  std::string DumpStats() const {
+  std::string DumpStats(Thread* self) const {
     size_t collision_sum = 0;
     size_t collision_max = 0;
-    for (HashType shard = 0; shard < kShard; ++shard) {
-      HashType last_hash = 0;
-      size_t collision_cur_max = 0;
-      for (const HashedKey& key : keys_[shard]) {
+    size_t adds = 0;
+    size_t hits = 0;
+    size_t hit_bytes = 0;
+    for (const Shard& shard : shards_) {
+      MutexLock lock(self, *shard.lock);
+      adds += shard.adds;
+      hits += shard.hits;
+      hit_bytes += shard.hit_bytes;
+      // Different keys with the same hash.
+      std::vector<HashType> hashes;
+      hashes.reserve(shard.keys.Size());
+      for (const HashedKey& key : shard.keys) {
         DCHECK(key.store_ptr != nullptr);
-        if (key.store_hash == last_hash) {
+        hashes.push_back(key.hash);
+      }
+      std::sort(hashes.begin(), hashes.end());
+      size_t collision_cur_max = 0;
+      for (size_t i = 0; i != hashes.size(); ++i) {
+        if (i != 0u && hashes[i] == hashes[i - 1u]) {
           collision_cur_max++;
           if (collision_cur_max > 1) {
             collision_sum++;
@@ -137,11 +173,13 @@ class DedupeSet {
           }
         } else {
           collision_cur_max = 1;
-          last_hash = key.store_hash;
         }
       }
     }
-    return StringPrintf("%zu collisions, %zu max bucket size, %" PRIu64 " ns hash time",
+    size_t hit_percent = (adds != 0u) ? hits * 100u / adds : 0u;
+    return StringPrintf("%zu adds, %zu hits (%zu%%), %zu bytes deduplicated, "
+                        "%zu collisions, %zu max bucket size, %" PRIu64 " ns hash time",
+                        adds, hits, hit_percent, hit_bytes,
                         collision_sum, collision_max, hash_time_);
   }
 
@@ -159,8 +197,7 @@ class DedupeSet {
   }
 
   std::string lock_name_[kShard];
-  std::unique_ptr<Mutex> lock_[kShard];
-  std::set<HashedKey, Comparator> keys_[kShard];
+  Shard shards_[kShard];
   SwapAllocator<StoreKey> allocator_;
   uint64_t hash_time_;
 
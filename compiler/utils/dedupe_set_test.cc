@@ -77,6 +77,9 @@ TEST(DedupeSetTest, Test) {
     ASSERT_NE(array3, nullptr);
     ASSERT_TRUE(std::equal(test1.begin(), test1.end(), array3->begin()));
   }
+
+  std::string stats = deduplicator.DumpStats(self);
+  EXPECT_EQ(0u, stats.find("3 adds, 1 hits (33%), 4 bytes deduplicated")) << stats;
 }
 
 }  // namespace art
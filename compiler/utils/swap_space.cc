@@ -17,7 +17,10 @@
 #include "swap_space.h"
 
 #include <algorithm>
+#include <fcntl.h>
 #include <numeric>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #include "base/logging.h"
 #include "base/macros.h"
@@ -66,6 +69,8 @@ static void InsertChunk(FreeByStartSet* free_by_start,
 SwapSpace::SwapSpace(int fd, size_t initial_size)
     : fd_(fd),
       size_(0),
+      resident_limit_(0u),
+      allocated_since_release_(0u),
       lock_("SwapSpace lock", static_cast<LockLevel>(LockLevel::kDefaultMutexLevel - 1)) {
   // Assume that the file is unlinked.
 
@@ -102,32 +107,91 @@ static size_t CollectFree(const FreeByStartSet& free_by_start, const FreeBySizeS
 }
 
 void* SwapSpace::Alloc(size_t size) {
-  MutexLock lock(Thread::Current(), lock_);
-  size = RoundUp(size, 8U);
+  std::vector<SpaceChunk> chunks_to_release;
+  void* ret;
+  {
+    MutexLock lock(Thread::Current(), lock_);
+    size = RoundUp(size, 8U);
+
+    // Check the free list for something that fits.
+    // TODO: Smarter implementation. Global biggest chunk, ...
+    SpaceChunk old_chunk;
+    auto it = free_by_start_.empty()
+        ? free_by_size_.end()
+        : free_by_size_.lower_bound(FreeBySizeEntry { size, free_by_start_.begin() });
+    if (it != free_by_size_.end()) {
+      old_chunk = *it->second;
+      RemoveChunk(&free_by_start_, &free_by_size_, it);
+    } else {
+      // Not a big enough free chunk, need to increase file size.
+      old_chunk = NewFileChunk(size);
+    }
+
+    ret = old_chunk.ptr;
+
+    if (old_chunk.size != size) {
+      // Insert the remainder.
+      SpaceChunk new_chunk = { old_chunk.ptr + size, old_chunk.size - size };
+      InsertChunk(&free_by_start_, &free_by_size_, new_chunk);
+    }
 
-  // Check the free list for something that fits.
-  // TODO: Smarter implementation. Global biggest chunk, ...
-  SpaceChunk old_chunk;
-  auto it = free_by_start_.empty()
-      ? free_by_size_.end()
-      : free_by_size_.lower_bound(FreeBySizeEntry { size, free_by_start_.begin() });
-  if (it != free_by_size_.end()) {
-    old_chunk = *it->second;
-    RemoveChunk(&free_by_start_, &free_by_size_, it);
-  } else {
-    // Not a big enough free chunk, need to increase file size.
-    old_chunk = NewFileChunk(size);
+    allocated_since_release_ += size;
+    if (resident_limit_ != 0u && allocated_since_release_ > resident_limit_) {
+      chunks_to_release = TakeChunksToReleaseLocked();
+    }
   }
+  if (!chunks_to_release.empty()) {
+    ReleaseChunks(chunks_to_release);
+  }
+  return ret;
+}
+
+void SwapSpace::SetResidentLimit(size_t resident_limit) {
+  MutexLock lock(Thread::Current(), lock_);
+  resident_limit_ = resident_limit;
+}
 
-  void* ret = old_chunk.ptr;
+size_t SwapSpace::GetResidentLimit() {
+  MutexLock lock(Thread::Current(), lock_);
+  return resident_limit_;
+}
 
-  if (old_chunk.size != size) {
-    // Insert the remainder.
-    SpaceChunk new_chunk = { old_chunk.ptr + size, old_chunk.size - size };
-    InsertChunk(&free_by_start_, &free_by_size_, new_chunk);
+void SwapSpace::ReleaseResidentMemory() {
+  std::vector<SpaceChunk> chunks_to_release;
+  {
+    MutexLock lock(Thread::Current(), lock_);
+    chunks_to_release = TakeChunksToReleaseLocked();
   }
+  ReleaseChunks(chunks_to_release);
+}
 
-  return ret;
+std::vector<SpaceChunk> SwapSpace::TakeChunksToReleaseLocked() {
+  allocated_since_release_ = 0u;
+  // The chunks are only unmapped by the destructor, so they can be released without the lock.
+  return std::vector<SpaceChunk>(maps_.begin(), maps_.end());
+}
+
+void SwapSpace::ReleaseChunks(const std::vector<SpaceChunk>& chunks) {
+#if !defined(__APPLE__)
+  // The write back can take long, so it runs without the lock and the other threads keep
+  // allocating meanwhile. Only clean pages can be dropped from the page cache, so write the data
+  // back first.
+  if (TEMP_FAILURE_RETRY(fdatasync(fd_)) != 0) {
+    PLOG(WARNING) << "Unable to write back swap file.";
+    return;
+  }
+  for (const SpaceChunk& chunk : chunks) {
+    // The mapping is shared, so this only unmaps the pages. It does not discard any data, not
+    // even data written by other threads since the write back.
+    if (madvise(chunk.ptr, chunk.size, MADV_DONTNEED) != 0) {
+      PLOG(WARNING) << "Unable to release swap file chunk.";
+    }
+  }
+  // Pages dirtied since the write back are skipped.
+  posix_fadvise(fd_, 0, 0, POSIX_FADV_DONTNEED);
+#else
+  UNUSED(chunks);
+#endif
 }
 
 SpaceChunk SwapSpace::NewFileChunk(size_t min_size) {
@@ -22,6 +22,7 @@
 #include <set>
 #include <stdint.h>
 #include <stddef.h>
+#include <vector>
 
 #include "base/debug_stack.h"
 #include "base/logging.h"
@@ -67,13 +68,29 @@ class SwapSpace {
     return size_;
   }
 
+  // Limits how much of the allocated data is kept in memory: once `resident_limit` bytes have
+  // been allocated since the last release, the data is released as by ReleaseResidentMemory().
+  // Zero means no limit.
+  void SetResidentLimit(size_t resident_limit) LOCKS_EXCLUDED(lock_);
+  size_t GetResidentLimit() LOCKS_EXCLUDED(lock_);
+
+  // Writes the data back to the file and drops it from memory. The data remains valid and is
+  // read back from the file when it is accessed again.
+  void ReleaseResidentMemory() LOCKS_EXCLUDED(lock_);
+
  private:
   SpaceChunk NewFileChunk(size_t min_size);
+  // Resets the bytes allocated since the last release and returns the chunks to release.
+  std::vector<SpaceChunk> TakeChunksToReleaseLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void ReleaseChunks(const std::vector<SpaceChunk>& chunks) LOCKS_EXCLUDED(lock_);
 
   int fd_;
   size_t size_;
   std::list<SpaceChunk> maps_;
 
+  size_t resident_limit_ GUARDED_BY(lock_);
+  size_t allocated_since_release_ GUARDED_BY(lock_);
+
   // NOTE: Boost.Bimap would be useful for the two following members.
 
   // Map start of a free chunk to its size.
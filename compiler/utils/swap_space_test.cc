@@ -31,12 +31,13 @@ namespace art {
 class SwapSpaceTest : public CommonRuntimeTest {
 };
 
-static void SwapTest(bool use_file) {
+static void SwapTest(bool use_file, size_t resident_limit = 0u) {
   ScratchFile scratch;
   int fd = scratch.GetFd();
   unlink(scratch.GetFilename().c_str());
 
   SwapSpace pool(fd, 1 * MB);
+  pool.SetResidentLimit(resident_limit);
   SwapAllocator<void> alloc(use_file ? &pool : nullptr);
 
   SwapVector<int32_t> v(alloc);
@@ -67,6 +68,16 @@ static void SwapTest(bool use_file) {
     EXPECT_EQ(i, v3[i]);
   }
 
+  // The contents are read back after they are dropped from memory.
+  if (use_file) {
+    pool.ReleaseResidentMemory();
+    for (int32_t i = 0; i < 1000000; ++i) {
+      EXPECT_EQ(i, v[i]);
+      EXPECT_EQ(i, v2[i]);
+      EXPECT_EQ(i, v3[i]);
+    }
+  }
+
   scratch.Close();
 }
 
@@ -78,4 +89,8 @@ TEST_F(SwapSpaceTest, Swap) {
   SwapTest(true);
 }
 
+TEST_F(SwapSpaceTest, SwapWithResidentLimit) {
+  SwapTest(true, 1 * MB);
+}
+
 }  // namespace art
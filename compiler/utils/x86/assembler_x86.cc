@@ -1047,6 +1047,15 @@ void X86Assembler::testl(Register reg, const Immediate& immediate) {
 }
 
 
+void X86Assembler::testb(const Address& dst, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  CHECK(imm.is_uint8());
+  EmitUint8(0xF6);
+  EmitOperand(EAX, dst);
+  EmitUint8(imm.value() & 0xFF);
+}
+
+
 void X86Assembler::andl(Register dst, Register src) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   EmitUint8(0x23);
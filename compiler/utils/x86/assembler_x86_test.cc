@@ -190,6 +190,15 @@ TEST_F(AssemblerX86Test, FPUIntegerStore) {
   DriverStr(expected, "FPUIntegerStore");
 }
 
+TEST_F(AssemblerX86Test, TestbAddrImm) {
+  GetAssembler()->testb(x86::Address(x86::Register(x86::EDI), 3), x86::Immediate(1));
+  GetAssembler()->testb(x86::Address(x86::Register(x86::ESP), 7), x86::Immediate(0x10));
+  const char* expected =
+      "testb $1, 3(%EDI)\n"
+      "testb $0x10, 7(%ESP)\n";
+  DriverStr(expected, "TestbAddrImm");
+}
+
 TEST_F(AssemblerX86Test, Repnescasw) {
   GetAssembler()->repne_scasw();
   const char* expected = "repne scasw\n";
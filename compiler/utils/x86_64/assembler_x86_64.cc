@@ -1348,6 +1348,16 @@ void X86_64Assembler::testq(CpuRegister reg, const Address& address) {
 }
 
 
+void X86_64Assembler::testb(const Address& address, const Immediate& imm) {
+  AssemblerBuffer::EnsureCapacity ensured(&buffer_);
+  CHECK(imm.is_uint8());
+  EmitOptionalRex32(address);
+  EmitUint8(0xF6);
+  EmitOperand(0, address);
+  EmitUint8(imm.value() & 0xFF);
+}
+
+
 void X86_64Assembler::andl(CpuRegister dst, CpuRegister src) {
   AssemblerBuffer::EnsureCapacity ensured(&buffer_);
   EmitOptionalRex32(dst, src);
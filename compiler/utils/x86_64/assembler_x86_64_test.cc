@@ -719,6 +719,17 @@ TEST_F(AssemblerX86_64Test, TestqAddr) {
   DriverStr(expected, "testq");
 }
 
+TEST_F(AssemblerX86_64Test, TestbAddrImm) {
+  GetAssembler()->testb(x86_64::Address(x86_64::CpuRegister(x86_64::RDI), 3),
+                        x86_64::Immediate(1));
+  GetAssembler()->testb(x86_64::Address(x86_64::CpuRegister(x86_64::R9), 7),
+                        x86_64::Immediate(0x10));
+  const char* expected =
+      "testb $1, 3(%RDI)\n"
+      "testb $0x10, 7(%R9)\n";
+  DriverStr(expected, "testb");
+}
+
 TEST_F(AssemblerX86_64Test, AddqAddr) {
   GetAssembler()->addq(x86_64::CpuRegister(x86_64::R12),
                         x86_64::Address(x86_64::CpuRegister(x86_64::R9), 0));
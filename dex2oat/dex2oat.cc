@@ -22,6 +22,8 @@
 
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <set>
 #include <sstream>
 #include <string>
 #include <unordered_set>
@@ -53,8 +55,10 @@
 #include "dex/verification_results.h"
 #include "dex/quick_compiler_callbacks.h"
 #include "dex/quick/dex_file_to_method_inliner_map.h"
+#include "driver/compilation_cache.h"
 #include "driver/compiler_driver.h"
 #include "driver/compiler_options.h"
+#include "driver/previous_compilation.h"
 #include "elf_file.h"
 #include "elf_writer.h"
 #include "gc/space/image_space.h"
@@ -73,6 +77,7 @@
 #include "scoped_thread_state_change.h"
 #include "utils.h"
 #include "vector_output_stream.h"
+#include "verifier/verifier_deps.h"
 #include "well_known_classes.h"
 #include "zip_archive.h"
 
@@ -209,6 +214,12 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --image-classes=<classname-file>: specifies classes to include in an image.");
   UsageError("      Example: --image=frameworks/base/preloaded-classes");
   UsageError("");
+  UsageError("  --boot-class-path-extension=<file.jar>[:<file.jar>...]: specifies the boot class");
+  UsageError("      path entries that follow the dex files of the image but are not compiled into");
+  UsageError("      it. They are recorded in the image, so that runtimes and compilers using the");
+  UsageError("      image without an explicit -Xbootclasspath load them with their own oat files.");
+  UsageError("      Example: --boot-class-path-extension=/system/framework/framework.jar");
+  UsageError("");
   UsageError("  --base=<hex-address>: specifies the base address when creating a boot image.");
   UsageError("      Example: --base=0x50000000");
   UsageError("");
@@ -232,6 +243,10 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --compile-pic: Force indirect use of code, methods, and classes");
   UsageError("      Default: disabled");
   UsageError("");
+  UsageError("  --compress-dex: store the dex files in the oat file compressed. They are");
+  UsageError("      decompressed into memory when the runtime opens them.");
+  UsageError("      Default: disabled");
+  UsageError("");
   UsageError("  --compiler-backend=(Quick|Optimizing): select compiler backend");
   UsageError("      set.");
   UsageError("      Example: --compiler-backend=Optimizing");
@@ -302,6 +317,10 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("");
   UsageError("  --no-include-patch-information: Do not include patching information.");
   UsageError("");
+  UsageError("  --implicit-suspend-checks: emit loop back edge suspend checks as a load from");
+  UsageError("      the thread's suspend trigger, which faults when a suspension is requested.");
+  UsageError("      arm64 and x86_64 only (Quick and Optimizing).");
+  UsageError("");
   UsageError("  -g");
   UsageError("  --generate-debug-info: Generate debug information for native debugging,");
   UsageError("      such as stack unwinding information, ELF symbols and DWARF sections.");
@@ -311,12 +330,20 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("");
   UsageError("  --no-generate-debug-info: Do not generate debug information for native debugging.");
   UsageError("");
+  UsageError("  --generate-mini-debug-info: Generate only stack unwinding information and ELF");
+  UsageError("      symbols without method signatures, enough to symbolize native stack traces.");
+  UsageError("      Ignored if --generate-debug-info is also given. (disabled by default)");
+  UsageError("");
+  UsageError("  --no-generate-mini-debug-info: Do not generate minimal debug information.");
+  UsageError("");
   UsageError("  --runtime-arg <argument>: used to specify various arguments for the runtime,");
   UsageError("      such as initial heap size, maximum heap size, and verbose output.");
   UsageError("      Use a separate --runtime-arg switch for each argument.");
   UsageError("      Example: --runtime-arg -Xms256m");
   UsageError("");
   UsageError("  --profile-file=<filename>: specify profiler output file to use for compilation.");
+  UsageError("      The code of the hot methods in the profile is placed together in the oat file");
+  UsageError("      and their classes and ArtMethods together in the image.");
   UsageError("");
   UsageError("  --print-pass-names: print a list of pass names");
   UsageError("");
@@ -338,6 +365,27 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --swap-fd=<file-descriptor>:  specifies a file to use for swap (by descriptor).");
   UsageError("      Example: --swap-fd=10");
   UsageError("");
+  UsageError("  --compiled-code-memory-limit=<megabytes>: keep compiled code in memory only up");
+  UsageError("      to about this size. Swap is used if the compiled code is expected to be");
+  UsageError("      larger, and the code is written back to the swap file and dropped from");
+  UsageError("      memory as it is compiled and written out. Without --swap-file and");
+  UsageError("      --swap-fd, the swap file is created next to the --oat-file.");
+  UsageError("      Example: --compiled-code-memory-limit=256");
+  UsageError("");
+  UsageError("  --reuse-oat-file=<file.oat>: reuse the compiled code of methods that are unchanged");
+  UsageError("      since <file.oat> was compiled from a previous version of the dex files.");
+  UsageError("      If the dex files are unchanged and compilation is disabled by the compiler");
+  UsageError("      filter, also reuse the verification results if the classes they depend on");
+  UsageError("      are unchanged.");
+  UsageError("      Example: --reuse-oat-file=/data/dalvik-cache/arm/app.oat");
+  UsageError("");
+  UsageError("  --compilation-cache-dir=<directory>: load the compiled code of methods from and");
+  UsageError("      store it to a cache in <directory>, shared by all compilations that use it.");
+  UsageError("      Code is reused for methods whose code and dependencies are unchanged, for");
+  UsageError("      example across builds of applications that share libraries. The cache is");
+  UsageError("      not used for the boot image. --dump-timing reports the cache hit rate.");
+  UsageError("      Example: --compilation-cache-dir=/tmp/dex2oat-cache");
+  UsageError("");
   std::cerr << "See log for usage error information\n";
   exit(EXIT_FAILURE);
 }
@@ -482,11 +530,24 @@ static void ParseDouble(const std::string& option, char after_char, double min,
 static constexpr size_t kMinDexFilesForSwap = 2;
 static constexpr size_t kMinDexFileCumulativeSizeForSwap = 20 * MB;
 
-static bool UseSwap(bool is_image, std::vector<const DexFile*>& dex_files) {
+// The compiled code and maps are usually a few times as large as the dex files.
+static constexpr size_t kEstimatedCompiledBytesPerDexByte = 4;
+
+static bool UseSwap(bool is_image,
+                    std::vector<const DexFile*>& dex_files,
+                    size_t compiled_code_memory_limit) {
   if (is_image) {
     // Don't use swap, we know generation should succeed, and we don't want to slow it down.
     return false;
   }
+  if (compiled_code_memory_limit != 0u) {
+    // Use swap if the compiled code is not expected to fit in the limit.
+    size_t dex_files_size = 0;
+    for (const auto* dex_file : dex_files) {
+      dex_files_size += dex_file->GetHeader().file_size_;
+    }
+    return dex_files_size * kEstimatedCompiledBytesPerDexByte > compiled_code_memory_limit;
+  }
   if (dex_files.size() < kMinDexFilesForSwap) {
     // If there are less dex files than the threshold, assume it's gonna be fine.
     return false;
@@ -526,6 +587,7 @@ class Dex2Oat FINAL {
       dump_timing_(false),
       dump_slow_timing_(kIsDebugBuild),
       swap_fd_(-1),
+      compiled_code_memory_limit_(0u),
       timings_(timings) {}
 
   ~Dex2Oat() {
@@ -580,8 +642,11 @@ class Dex2Oat FINAL {
     double top_k_profile_threshold = CompilerOptions::kDefaultTopKProfileThreshold;
 
     bool debuggable = false;
+    bool compress_dex = false;
     bool include_patch_information = CompilerOptions::kDefaultIncludePatchInformation;
+    bool requested_implicit_suspend_checks = false;
     bool generate_debug_info = kIsDebugBuild;
+    bool generate_mini_debug_info = CompilerOptions::kDefaultGenerateMiniDebugInfo;
     bool watch_dog_enabled = true;
     bool abort_on_hard_verifier_error = false;
     bool requested_specific_compiler = false;
@@ -635,6 +700,9 @@ class Dex2Oat FINAL {
         oat_location_ = option.substr(strlen("--oat-location=")).data();
       } else if (option.starts_with("--image=")) {
         image_filename_ = option.substr(strlen("--image=")).data();
+      } else if (option.starts_with("--boot-class-path-extension=")) {
+        Split(option.substr(strlen("--boot-class-path-extension=")).ToString(), ':',
+              &boot_class_path_extension_);
       } else if (option.starts_with("--image-classes=")) {
         image_classes_filename_ = option.substr(strlen("--image-classes=")).data();
       } else if (option.starts_with("--image-classes-zip=")) {
@@ -783,9 +851,17 @@ class Dex2Oat FINAL {
         generate_debug_info = true;
       } else if (option == "--no-generate-debug-info") {
         generate_debug_info = false;
+      } else if (option == "--generate-mini-debug-info") {
+        generate_mini_debug_info = true;
+      } else if (option == "--no-generate-mini-debug-info") {
+        generate_mini_debug_info = false;
       } else if (option == "--debuggable") {
         debuggable = true;
         generate_debug_info = true;
+      } else if (option == "--compress-dex") {
+        compress_dex = true;
+      } else if (option == "--no-compress-dex") {
+        compress_dex = false;
       } else if (option.starts_with("--profile-file=")) {
         profile_file_ = option.substr(strlen("--profile-file=")).data();
         VLOG(compiler) << "dex2oat: profile file is " << profile_file_;
@@ -815,6 +891,8 @@ class Dex2Oat FINAL {
         include_patch_information = true;
       } else if (option == "--no-include-patch-information") {
         include_patch_information = false;
+      } else if (option == "--implicit-suspend-checks") {
+        requested_implicit_suspend_checks = true;
       } else if (option.starts_with("--verbose-methods=")) {
         // TODO: rather than switch off compiler logging, make all VLOG(compiler) messages
         //       conditional on having verbost methods.
@@ -832,6 +910,20 @@ class Dex2Oat FINAL {
         }
       } else if (option.starts_with("--swap-file=")) {
         swap_file_name_ = option.substr(strlen("--swap-file=")).data();
+      } else if (option.starts_with("--compiled-code-memory-limit=")) {
+        const char* limit_str = option.substr(strlen("--compiled-code-memory-limit=")).data();
+        size_t limit_mb;
+        if (!ParseUint(limit_str, &limit_mb)) {
+          Usage("Failed to parse --compiled-code-memory-limit '%s' as an integer", limit_str);
+        }
+        if (limit_mb > std::numeric_limits<size_t>::max() / MB) {
+          Usage("--compiled-code-memory-limit '%s' is too large", limit_str);
+        }
+        compiled_code_memory_limit_ = limit_mb * MB;
+      } else if (option.starts_with("--reuse-oat-file=")) {
+        reuse_oat_filename_ = option.substr(strlen("--reuse-oat-file=")).data();
+      } else if (option.starts_with("--compilation-cache-dir=")) {
+        compilation_cache_dir_ = option.substr(strlen("--compilation-cache-dir=")).data();
       } else if (option.starts_with("--swap-fd=")) {
         const char* swap_fd_str = option.substr(strlen("--swap-fd=")).data();
         if (!ParseInt(swap_fd_str, &swap_fd_)) {
@@ -851,7 +943,8 @@ class Dex2Oat FINAL {
     if (!requested_specific_compiler && !kUseOptimizingCompiler) {
       // If no specific compiler is requested, the current behavior is
       // to compile the boot image with Quick, and the rest with Optimizing.
-      compiler_kind_ = image_ ? Compiler::kQuick : Compiler::kOptimizing;
+      // Quick does not emit read barriers, so read barrier builds use Optimizing for both.
+      compiler_kind_ = (image_ && !kUseReadBarrier) ? Compiler::kQuick : Compiler::kOptimizing;
     }
 
     if (compiler_kind_ == Compiler::kOptimizing) {
@@ -896,6 +989,10 @@ class Dex2Oat FINAL {
       boot_image_option_ += boot_image_filename;
     }
 
+    if (!boot_class_path_extension_.empty() && !image_) {
+      Usage("--boot-class-path-extension should only be used with --image");
+    }
+
     if (image_classes_filename_ != nullptr && !image_) {
       Usage("--image-classes should only be used with --image");
     }
@@ -1027,11 +1124,16 @@ class Dex2Oat FINAL {
     bool implicit_suspend_checks = false;
     // Set the compilation target's implicit checks options.
     switch (instruction_set_) {
+      case kArm64:
+      case kX86_64:
+        implicit_null_checks = true;
+        implicit_so_checks = true;
+        // The runtime installs a suspension handler for these architectures.
+        implicit_suspend_checks = requested_implicit_suspend_checks;
+        break;
       case kArm:
       case kThumb2:
-      case kArm64:
       case kX86:
-      case kX86_64:
       case kMips:
       case kMips64:
         implicit_null_checks = true;
@@ -1042,6 +1144,9 @@ class Dex2Oat FINAL {
         // Defaults are correct.
         break;
     }
+    if (requested_implicit_suspend_checks && !implicit_suspend_checks) {
+      LOG(WARNING) << "--implicit-suspend-checks is ignored for " << instruction_set_;
+    }
 
     compiler_options_.reset(new CompilerOptions(compiler_filter,
                                                 huge_method_threshold,
@@ -1055,6 +1160,7 @@ class Dex2Oat FINAL {
                                                 top_k_profile_threshold,
                                                 debuggable,
                                                 generate_debug_info,
+                                                generate_mini_debug_info,
                                                 implicit_null_checks,
                                                 implicit_so_checks,
                                                 implicit_suspend_checks,
@@ -1091,6 +1197,17 @@ class Dex2Oat FINAL {
                             compile_pic ? OatHeader::kTrueValue : OatHeader::kFalseValue);
       key_value_store_->Put(OatHeader::kDebuggableKey,
                             debuggable ? OatHeader::kTrueValue : OatHeader::kFalseValue);
+      key_value_store_->Put(OatHeader::kInlineMaxCodeUnitsKey,
+                            std::to_string(compiler_options_->GetInlineMaxCodeUnits()));
+      key_value_store_->Put(OatHeader::kCompressedDexKey,
+                            compress_dex ? OatHeader::kTrueValue : OatHeader::kFalseValue);
+      if (!boot_class_path_extension_.empty()) {
+        std::vector<std::string> boot_class_path(dex_locations_.begin(), dex_locations_.end());
+        boot_class_path.insert(boot_class_path.end(),
+                               boot_class_path_extension_.begin(),
+                               boot_class_path_extension_.end());
+        key_value_store_->Put(OatHeader::kBootClassPathKey, Join(boot_class_path, ':'));
+      }
     }
   }
 
@@ -1131,6 +1248,15 @@ class Dex2Oat FINAL {
     //
     // If the swap fd is -1 and we have a swap-file string, open the given file as a swap file. We
     // will immediately unlink to satisfy the swap fd assumption.
+    //
+    // If the compiled code memory is limited, we need a swap file even if none was specified.
+    if (swap_fd_ == -1 && swap_file_name_.empty() && compiled_code_memory_limit_ != 0u) {
+      if (!oat_filename_.empty()) {
+        swap_file_name_ = oat_filename_ + ".swap";
+      } else {
+        LOG(WARNING) << "No swap file for --compiled-code-memory-limit, memory is not limited.";
+      }
+    }
     if (swap_fd_ == -1 && !swap_file_name_.empty()) {
       std::unique_ptr<File> swap_file(OS::CreateEmptyFile(swap_file_name_.c_str()));
       if (swap_file.get() == nullptr) {
@@ -1153,6 +1279,23 @@ class Dex2Oat FINAL {
     oat_file_.reset();
   }
 
+  // Puts the boot class path entries that the boot image does not contain on the boot class path,
+  // so that the code compiled against them can be linked. The entries being compiled are left
+  // out, their classes must be loaded from the dex files to compile. The boot class path lists
+  // filenames, or locations if it was recorded in the boot image, so both are excluded.
+  void AppendBootClassPathExtension(Thread* self) {
+    Runtime* runtime = Runtime::Current();
+    std::vector<std::string> dex_filenames;
+    Split(runtime->GetBootClassPathString(), ':', &dex_filenames);
+    std::set<std::string> excluded_locations(dex_filenames_.begin(), dex_filenames_.end());
+    excluded_locations.insert(dex_locations_.begin(), dex_locations_.end());
+    ScopedObjectAccess soa(self);
+    runtime->GetClassLinker()->AppendBootClassPathExtension(dex_filenames,
+                                                            dex_filenames,
+                                                            excluded_locations,
+                                                            false);
+  }
+
   // Set up the environment for compilation. Includes starting the runtime and loading/opening the
   // boot class path.
   bool Setup() {
@@ -1205,6 +1348,10 @@ class Dex2Oat FINAL {
     // Whilst we're in native take the opportunity to initialize well known classes.
     WellKnownClasses::Init(self->GetJniEnv());
 
+    if (!boot_image_option_.empty()) {
+      AppendBootClassPathExtension(self);
+    }
+
     // If --image-classes was specified, calculate the full list of classes to include in the image
     if (image_classes_filename_ != nullptr) {
       std::string error_msg;
@@ -1326,7 +1473,7 @@ class Dex2Oat FINAL {
 
     // If we use a swap file, ensure we are above the threshold to make it necessary.
     if (swap_fd_ != -1) {
-      if (!UseSwap(image_, dex_files_)) {
+      if (!UseSwap(image_, dex_files_, compiled_code_memory_limit_)) {
         close(swap_fd_);
         swap_fd_ = -1;
         VLOG(compiler) << "Decided to run without swap.";
@@ -1381,12 +1528,29 @@ class Dex2Oat FINAL {
       key_value_store_->Put(OatHeader::kClassPathKey,
                             OatFile::EncodeDexFileDependencies(class_path_files));
 
+      // The code depends on the boot class path entries outside the boot image as much as on
+      // the class path. Record their checksums so that the oat file is found out of date when
+      // one of them changes, see OatFileAssistant::GivenOatFileIsOutOfDate().
+      const std::vector<const DexFile*>& boot_class_path_extension =
+          class_linker->GetBootClassPathExtension();
+      if (!boot_class_path_extension.empty()) {
+        key_value_store_->Put(OatHeader::kBootClassPathChecksumsKey,
+                              OatFile::EncodeDexFileDependencies(boot_class_path_extension));
+      }
+
       // Then the dex files we'll compile. Thus we'll resolve the class-path first.
       class_path_files.insert(class_path_files.end(), dex_files_.begin(), dex_files_.end());
 
       class_loader = class_linker->CreatePathClassLoader(self, class_path_files);
     }
 
+    if (!image_) {
+      // Record what the verification of the dex files depends on, so that a later compilation
+      // can reuse the verification results, see --reuse-oat-file.
+      verifier_deps_.reset(new verifier::VerifierDeps(dex_files_));
+      callbacks_->SetVerifierDeps(verifier_deps_.get());
+    }
+
     driver_ = new CompilerDriver(compiler_options_.get(),
                                  verification_results_,
                                  &method_inliner_map_,
@@ -1404,8 +1568,47 @@ class Dex2Oat FINAL {
                                  compiler_phases_timings_.get(),
                                  swap_fd_,
                                  profile_file_);
+    driver_->SetVerifierDeps(verifier_deps_.get());
+    driver_->SetCompiledDataMemoryLimit(compiled_code_memory_limit_);
+
+    if (!reuse_oat_filename_.empty()) {
+      TimingLogger::ScopedTiming t2("dex2oat Open previous oat file", timings_);
+      std::string error_msg;
+      previous_compilation_.reset(PreviousCompilation::Create(reuse_oat_filename_,
+                                                              dex_files_,
+                                                              *driver_,
+                                                              *key_value_store_,
+                                                              &error_msg));
+      if (previous_compilation_ == nullptr) {
+        LOG(WARNING) << "Not reusing compilation results from " << reuse_oat_filename_ << ": "
+                     << error_msg;
+      } else {
+        driver_->SetPreviousCompilation(previous_compilation_.get());
+      }
+    }
+
+    if (!compilation_cache_dir_.empty()) {
+      TimingLogger::ScopedTiming t2("dex2oat Open compilation cache", timings_);
+      std::string error_msg;
+      compilation_cache_.reset(CompilationCache::Create(compilation_cache_dir_,
+                                                        dex_files_,
+                                                        *driver_,
+                                                        *key_value_store_,
+                                                        &error_msg));
+      if (compilation_cache_ == nullptr) {
+        LOG(WARNING) << "Not using compilation cache " << compilation_cache_dir_ << ": "
+                     << error_msg;
+      } else {
+        driver_->SetCompilationCache(compilation_cache_.get());
+      }
+    }
 
     driver_->CompileAll(class_loader, dex_files_, timings_);
+
+    if (previous_compilation_ != nullptr) {
+      LOG(INFO) << "Reused compiled code of " << previous_compilation_->GetNumberOfReusedMethods()
+                << " methods from " << previous_compilation_->GetLocation();
+    }
   }
 
   // Notes on the interleaving of creating the image and oat file to
@@ -1609,6 +1812,16 @@ class Dex2Oat FINAL {
     if (dump_timing_ || (dump_slow_timing_ && timings_->GetTotalNs() > MsToNs(1000))) {
       LOG(INFO) << Dumpable<TimingLogger>(*timings_);
     }
+    if (dump_timing_ && driver_ != nullptr) {
+      std::ostringstream oss;
+      driver_->DumpParallelPhaseTimings(oss);
+      LOG(INFO) << "Parallel phases:\n" << oss.str();
+    }
+    if (dump_timing_ && compilation_cache_ != nullptr) {
+      std::ostringstream oss;
+      compilation_cache_->DumpStats(oss);
+      LOG(INFO) << oss.str();
+    }
     if (dump_passes_) {
       LOG(INFO) << Dumpable<CumulativeLogger>(*driver_->GetTimingsLogger());
     }
@@ -1889,6 +2102,7 @@ class Dex2Oat FINAL {
   std::vector<const char*> runtime_args_;
   std::string image_filename_;
   uintptr_t image_base_;
+  std::vector<std::string> boot_class_path_extension_;
   const char* image_classes_zip_filename_;
   const char* image_classes_filename_;
   const char* compiled_classes_zip_filename_;
@@ -1917,6 +2131,12 @@ class Dex2Oat FINAL {
   std::string dump_cfg_file_name_;
   std::string swap_file_name_;
   int swap_fd_;
+  size_t compiled_code_memory_limit_;
+  std::string reuse_oat_filename_;
+  std::unique_ptr<PreviousCompilation> previous_compilation_;
+  std::string compilation_cache_dir_;
+  std::unique_ptr<CompilationCache> compilation_cache_;
+  std::unique_ptr<verifier::VerifierDeps> verifier_deps_;
   std::string profile_file_;  // Profile file to use
   TimingLogger* timings_;
   std::unique_ptr<CumulativeLogger> compiler_phases_timings_;
@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdlib.h>
+#include <sys/stat.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "base/stringprintf.h"
+#include "common_runtime_test.h"
+#include "dex_file.h"
+#include "oat.h"
+#include "oat_file.h"
+#include "utf.h"
+#include "utils.h"
+
+namespace art {
+
+class Dex2oatTest : public CommonRuntimeTest {
+ public:
+  virtual void SetUp() {
+    CommonRuntimeTest::SetUp();
+    scratch_dir_ = android_data_ + "/Dex2oatTest";
+    ASSERT_EQ(0, mkdir(scratch_dir_.c_str(), 0700));
+  }
+
+  virtual void TearDown() {
+    ClearDirectory(scratch_dir_.c_str());
+    ASSERT_EQ(0, rmdir(scratch_dir_.c_str()));
+    CommonRuntimeTest::TearDown();
+  }
+
+ protected:
+  void Copy(const std::string& src, const std::string& dst) {
+    std::ifstream src_stream(src, std::ios::binary);
+    std::ofstream dst_stream(dst, std::ios::binary);
+    dst_stream << src_stream.rdbuf();
+  }
+
+  // Returns the location of the pre-compiled core.art.
+  std::string GetCoreImageLocation() {
+    if (IsHost()) {
+      const char* host_dir = getenv("ANDROID_HOST_OUT");
+      CHECK(host_dir != nullptr);
+      return std::string(host_dir) + "/framework/core.art";
+    } else {
+      return "/data/art-test/core.art";
+    }
+  }
+
+  bool Dex2Oat(const std::vector<std::string>& args, std::string* error_msg) {
+    std::vector<std::string> argv;
+    argv.push_back(Runtime::Current()->GetCompilerExecutable());
+    if (IsHost()) {
+      argv.push_back("--host");
+    }
+    // Use the boot images where they are rather than relocated copies.
+    argv.push_back("--runtime-arg");
+    argv.push_back("-Xnorelocate");
+    argv.insert(argv.end(), args.begin(), args.end());
+    return Exec(argv, error_msg);
+  }
+
+  // Finds the oat class of `descriptor` in the oat file compiled from `dex_location`.
+  void GetOatClass(const std::string& oat_filename,
+                   const std::string& dex_location,
+                   const char* descriptor,
+                   mirror::Class::Status* status,
+                   OatClassType* type) {
+    std::string error_msg;
+    std::unique_ptr<OatFile> oat_file(OatFile::Open(oat_filename, oat_filename, nullptr, nullptr,
+                                                    false, nullptr, &error_msg));
+    ASSERT_TRUE(oat_file.get() != nullptr) << error_msg;
+    const OatFile::OatDexFile* oat_dex_file = oat_file->GetOatDexFile(dex_location.c_str(),
+                                                                      nullptr);
+    ASSERT_TRUE(oat_dex_file != nullptr) << dex_location;
+    std::unique_ptr<const DexFile> dex_file = oat_dex_file->OpenDexFile(&error_msg);
+    ASSERT_TRUE(dex_file.get() != nullptr) << error_msg;
+    const DexFile::ClassDef* class_def =
+        dex_file->FindClassDef(descriptor, ComputeModifiedUtf8Hash(descriptor));
+    ASSERT_TRUE(class_def != nullptr) << descriptor;
+    OatFile::OatClass oat_class =
+        oat_dex_file->GetOatClass(dex_file->GetIndexForClassDef(*class_def));
+    *status = oat_class.GetStatus();
+    *type = oat_class.GetType();
+  }
+
+  std::string scratch_dir_;
+};
+
+// A boot class path entry that is compiled with a location other than its filename is not
+// appended to the boot class path, so its classes are compiled.
+TEST_F(Dex2oatTest, BootClassPathEntryWithOtherLocation) {
+  const std::string jar = scratch_dir_ + "/BootExtension.jar";
+  const std::string location = "/system/framework/BootExtension.jar";
+  const std::string odex = scratch_dir_ + "/BootExtension.odex";
+  Copy(GetTestDexFileName("BootExtension"), jar);
+
+  std::vector<std::string> args;
+  args.push_back("--dex-file=" + jar);
+  args.push_back("--dex-location=" + location);
+  args.push_back("--oat-file=" + odex);
+  args.push_back("--boot-image=" + GetCoreImageLocation());
+  args.push_back("--compiler-filter=speed");
+  args.push_back("--runtime-arg");
+  args.push_back("-Xbootclasspath:" + GetLibCoreDexFileName() + ":" + jar);
+  std::string error_msg;
+  ASSERT_TRUE(Dex2Oat(args, &error_msg)) << error_msg;
+
+  mirror::Class::Status status;
+  OatClassType type;
+  GetOatClass(odex, location, "LBootExtension;", &status, &type);
+  EXPECT_GE(status, mirror::Class::kStatusVerified);
+  EXPECT_NE(kOatClassNoneCompiled, type);
+}
+
+// Without an explicit boot class path, the entries recorded in the boot image outside of it are
+// appended to the boot class path, so that classes referencing them can be compiled.
+TEST_F(Dex2oatTest, BootClassPathExtensionRecordedInImage) {
+  const std::string extension_jar = scratch_dir_ + "/BootExtension.jar";
+  Copy(GetTestDexFileName("BootExtension"), extension_jar);
+
+  const std::string image_dir = scratch_dir_ + "/" + GetInstructionSetString(kRuntimeISA);
+  ASSERT_EQ(0, mkdir(image_dir.c_str(), 0700));
+  const std::string image_oat = image_dir + "/boot.oat";
+  std::vector<std::string> image_args;
+  image_args.push_back("--dex-file=" + GetLibCoreDexFileName());
+  image_args.push_back("--oat-file=" + image_oat);
+  image_args.push_back("--image=" + image_dir + "/boot.art");
+  image_args.push_back(StringPrintf("--base=0x%x", ART_BASE_ADDRESS));
+  image_args.push_back("--boot-class-path-extension=" + extension_jar);
+  image_args.push_back("--runtime-arg");
+  image_args.push_back("-Xms64m");
+  image_args.push_back("--runtime-arg");
+  image_args.push_back("-Xmx64m");
+  std::string error_msg;
+  ASSERT_TRUE(Dex2Oat(image_args, &error_msg)) << error_msg;
+  {
+    std::unique_ptr<OatFile> oat_file(OatFile::Open(image_oat, image_oat, nullptr, nullptr, false,
+                                                    nullptr, &error_msg));
+    ASSERT_TRUE(oat_file.get() != nullptr) << error_msg;
+    const char* boot_class_path =
+        oat_file->GetOatHeader().GetStoreValueByKey(OatHeader::kBootClassPathKey);
+    ASSERT_TRUE(boot_class_path != nullptr);
+    EXPECT_EQ(GetLibCoreDexFileName() + ":" + extension_jar, boot_class_path);
+  }
+
+  const std::string jar = scratch_dir_ + "/BootExtensionUser.jar";
+  const std::string odex = scratch_dir_ + "/BootExtensionUser.odex";
+  Copy(GetTestDexFileName("BootExtensionUser"), jar);
+  std::vector<std::string> args;
+  args.push_back("--dex-file=" + jar);
+  args.push_back("--oat-file=" + odex);
+  args.push_back("--boot-image=" + scratch_dir_ + "/boot.art");
+  args.push_back("--compiler-filter=speed");
+  // The boot class path must come from the image.
+  const char* boot_class_path_env = getenv("BOOTCLASSPATH");
+  const std::string saved_boot_class_path_env =
+      (boot_class_path_env != nullptr) ? boot_class_path_env : "";
+  unsetenv("BOOTCLASSPATH");
+  bool success = Dex2Oat(args, &error_msg);
+  if (boot_class_path_env != nullptr) {
+    setenv("BOOTCLASSPATH", saved_boot_class_path_env.c_str(), 1);
+  }
+  ASSERT_TRUE(success) << error_msg;
+
+  // The superclass of BootExtensionUser is found, so the class is verified and compiled.
+  mirror::Class::Status status;
+  OatClassType type;
+  GetOatClass(odex, jar, "LBootExtensionUser;", &status, &type);
+  EXPECT_GE(status, mirror::Class::kStatusVerified);
+  EXPECT_NE(kOatClassNoneCompiled, type);
+
+
+  // The code depends on the extension, so the oat file records its checksum and is out of
+  // date once the extension changes.
+  std::unique_ptr<OatFile> oat_file(OatFile::Open(odex, odex, nullptr, nullptr, false, nullptr,
+                                                  &error_msg));
+  ASSERT_TRUE(oat_file.get() != nullptr) << error_msg;
+  const char* boot_class_path_checksums =
+      oat_file->GetOatHeader().GetStoreValueByKey(OatHeader::kBootClassPathChecksumsKey);
+  ASSERT_TRUE(boot_class_path_checksums != nullptr);
+  EXPECT_NE(std::string::npos, std::string(boot_class_path_checksums).find(extension_jar));
+  EXPECT_TRUE(OatFile::CheckStaticDexFileDependencies(boot_class_path_checksums, &error_msg))
+      << error_msg;
+  Copy(GetTestDexFileName("BootExtensionUser"), extension_jar);
+  EXPECT_FALSE(OatFile::CheckStaticDexFileDependencies(boot_class_path_checksums, &error_msg));
+}
+
+}  // namespace art
@@ -146,6 +146,10 @@ static Intrinsics GetIntrinsic(InlineMethod method) {
     case kIntrinsicSystemArrayCopyCharArray:
       return Intrinsics::kSystemArrayCopyChar;
 
+    // java.util.zip.CRC32, not intrinsified by this compiler.
+    case kIntrinsicCRC32Update:
+      return Intrinsics::kNone;
+
     // Thread.currentThread.
     case kIntrinsicCurrentThread:
       return  Intrinsics::kThreadCurrentThread;
@@ -39,7 +39,9 @@ LIBART_COMMON_SRC_FILES := \
   base/unix_file/random_access_file_utils.cc \
   check_jni.cc \
   class_linker.cc \
+  class_lookup_table.cc \
   common_throws.cc \
+  compressed_section.cc \
   debugger.cc \
   dex_file.cc \
   dex_file_verifier.cc \
@@ -56,6 +58,7 @@ LIBART_COMMON_SRC_FILES := \
   gc/collector/concurrent_copying.cc \
   gc/collector/garbage_collector.cc \
   gc/collector/immune_region.cc \
+  gc/collector/incremental_compact.cc \
   gc/collector/mark_compact.cc \
   gc/collector/mark_sweep.cc \
   gc/collector/partial_mark_sweep.cc \
@@ -174,6 +177,7 @@ LIBART_COMMON_SRC_FILES := \
   verifier/reg_type.cc \
   verifier/reg_type_cache.cc \
   verifier/register_line.cc \
+  verifier/verifier_deps.cc \
   well_known_classes.cc \
   zip_archive.cc
 
@@ -36,6 +36,9 @@ extern "C" float art_quick_fmodf(float a, float b);          // REM_FLOAT[_2ADDR
 // Double-precision FP arithmetics.
 extern "C" double art_quick_fmod(double a, double b);        // REM_DOUBLE[_2ADDR]
 
+// Read barrier entrypoints.
+extern "C" mirror::Object* art_quick_read_barrier_mark(mirror::Object* obj);
+
 
 void InitEntryPoints(InterpreterEntryPoints* ipoints, JniEntryPoints* jpoints,
                      QuickEntryPoints* qpoints) {
@@ -162,6 +165,7 @@ void InitEntryPoints(InterpreterEntryPoints* ipoints, JniEntryPoints* jpoints,
 
   // Read barrier
   qpoints->pReadBarrierJni = ReadBarrierJni;
+  qpoints->pReadBarrierMark = art_quick_read_barrier_mark;
 };
 
 }  // namespace art
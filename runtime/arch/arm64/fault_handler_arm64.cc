@@ -123,6 +123,29 @@ bool SuspensionHandler::Action(int sig ATTRIBUTE_UNUSED, siginfo_t* info ATTRIBU
 
   uint32_t inst2 = *reinterpret_cast<uint32_t*>(ptr2);
   VLOG(signals) << "inst2: " << std::hex << inst2 << " checkinst2: " << checkinst2;
+
+  // The optimizing compiler emits loop back edge suspend checks as:
+  //      ldr xN, [x18, #168]
+  //      ldr wzr, [xN]
+  //      b <loop header>
+  //      b <suspend check slow path>
+  // The slow path saves the live registers and calls the runtime, so we resume
+  // at the second branch instead of calling art_quick_implicit_suspend.
+  if ((inst2 & 0xfffffc1f) == 0xb940001f) {
+    uint32_t base_reg = (inst2 >> 5) & 0x1f;
+    uint32_t inst1 = *reinterpret_cast<uint32_t*>(ptr1);
+    if (inst1 == (checkinst1 | base_reg)) {
+      VLOG(signals) << "optimizing suspend check match";
+      sc->pc += 8;
+
+      // Now remove the suspend trigger that caused this fault.
+      Thread::Current()->RemoveSuspendTrigger();
+      VLOG(signals) << "removed suspend trigger invoking suspend check slow path";
+      return true;
+    }
+    return false;
+  }
+
   if (inst2 != checkinst2) {
     // Second instruction is not good, not ours.
     return false;
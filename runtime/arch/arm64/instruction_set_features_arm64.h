@@ -53,7 +53,7 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
 
   uint32_t AsBitmap() const OVERRIDE;
 
-  // Return a string of the form "a53" or "none".
+  // Return a string of the form "a53,crc" or "none".
   std::string GetFeatureString() const OVERRIDE;
 
   // Generate code addressing Cortex-A53 erratum 835769?
@@ -66,6 +66,11 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
       return fix_cortex_a53_843419_;
   }
 
+  // Does the CPU implement the optional ARMv8 CRC32 instructions?
+  bool HasCRC() const {
+    return has_crc_;
+  }
+
   // NOTE: This flag can be tunned on a CPU basis. In general all ARMv8 CPUs
   // should prefer the Acquire-Release semantics over the explicit DMBs when
   // handling load/store-volatile. For a specific use case see the ARM64
@@ -85,20 +90,24 @@ class Arm64InstructionSetFeatures FINAL : public InstructionSetFeatures {
  private:
   explicit Arm64InstructionSetFeatures(bool smp,
                                        bool needs_a53_835769_fix,
-                                       bool needs_a53_843419_fix)
+                                       bool needs_a53_843419_fix,
+                                       bool has_crc)
       : InstructionSetFeatures(smp),
         fix_cortex_a53_835769_(needs_a53_835769_fix),
-        fix_cortex_a53_843419_(needs_a53_843419_fix) {
+        fix_cortex_a53_843419_(needs_a53_843419_fix),
+        has_crc_(has_crc) {
   }
 
   // Bitmap positions for encoding features as a bitmap.
   enum {
     kSmpBitfield = 1,
     kA53Bitfield = 2,
+    kCrcBitfield = 4,
   };
 
   const bool fix_cortex_a53_835769_;
   const bool fix_cortex_a53_843419_;
+  const bool has_crc_;
 
   DISALLOW_COPY_AND_ASSIGN(Arm64InstructionSetFeatures);
 };
@@ -28,10 +28,27 @@ TEST(Arm64InstructionSetFeaturesTest, Arm64Features) {
   ASSERT_TRUE(arm64_features.get() != nullptr) << error_msg;
   EXPECT_EQ(arm64_features->GetInstructionSet(), kArm64);
   EXPECT_TRUE(arm64_features->Equals(arm64_features.get()));
-  EXPECT_STREQ("smp,a53", arm64_features->GetFeatureString().c_str());
+  EXPECT_STREQ("smp,a53,-crc", arm64_features->GetFeatureString().c_str());
   EXPECT_EQ(arm64_features->AsBitmap(), 3U);
   // See the comments in instruction_set_features_arm64.h.
   EXPECT_TRUE(arm64_features->AsArm64InstructionSetFeatures()->PreferAcquireRelease());
+  EXPECT_FALSE(arm64_features->AsArm64InstructionSetFeatures()->HasCRC());
+
+  // Build features for a Cortex-A57 processor, which implements the CRC32 instructions.
+  std::unique_ptr<const InstructionSetFeatures> a57_features(
+      InstructionSetFeatures::FromVariant(kArm64, "cortex-a57", &error_msg));
+  ASSERT_TRUE(a57_features.get() != nullptr) << error_msg;
+  EXPECT_FALSE(a57_features->Equals(arm64_features.get()));
+  EXPECT_STREQ("smp,-a53,crc", a57_features->GetFeatureString().c_str());
+  EXPECT_EQ(a57_features->AsBitmap(), 5U);
+  EXPECT_TRUE(a57_features->AsArm64InstructionSetFeatures()->HasCRC());
+
+  // Features added from a string.
+  std::unique_ptr<const InstructionSetFeatures> crc_features(
+      arm64_features->AddFeaturesFromString("crc", &error_msg));
+  ASSERT_TRUE(crc_features.get() != nullptr) << error_msg;
+  EXPECT_STREQ("smp,a53,crc", crc_features->GetFeatureString().c_str());
+  EXPECT_EQ(crc_features->AsBitmap(), 7U);
 }
 
 }  // namespace art
@@ -355,6 +355,33 @@ bool SuspensionHandler::Action(int, siginfo_t*, void* context) {
   uint8_t* pc = reinterpret_cast<uint8_t*>(uc->CTX_EIP);
   uint8_t* sp = reinterpret_cast<uint8_t*>(uc->CTX_ESP);
 
+#if defined(__x86_64__)
+  // The optimizing compiler emits loop back edge suspend checks as:
+  //   mov r11, gs:[xxx]
+  //   test r11d, [r11]
+  //   jmp <loop header>
+  //   jmp <suspend check slow path>
+  // The slow path saves the live registers and calls art_quick_test_suspend, so we
+  // resume at the second jump instead of calling the runtime from here.
+  uint8_t optimizing_checkinst1[] = {0x65, 0x4c, 0x8b, 0x1c, 0x25,
+      static_cast<uint8_t>(trigger & 0xff), static_cast<uint8_t>((trigger >> 8) & 0xff), 0, 0};
+  uint8_t optimizing_checkinst2[] = {0x45, 0x85, 0x1b};
+  if (memcmp(pc, optimizing_checkinst2, sizeof(optimizing_checkinst2)) == 0 &&
+      memcmp(pc - sizeof(optimizing_checkinst1), optimizing_checkinst1,
+             sizeof(optimizing_checkinst1)) == 0) {
+    VLOG(signals) << "optimizing suspend check match";
+    uint8_t* jmp = pc + sizeof(optimizing_checkinst2);
+    // The jump to the loop header is either `jmp rel8` or `jmp rel32`.
+    uint8_t* slow_path_jmp = jmp + ((jmp[0] == 0xeb) ? 2 : 5);
+    uc->CTX_EIP = reinterpret_cast<uintptr_t>(slow_path_jmp);
+
+    // Now remove the suspend trigger that caused this fault.
+    Thread::Current()->RemoveSuspendTrigger();
+    VLOG(signals) << "removed suspend trigger invoking suspend check slow path";
+    return true;
+  }
+#endif
+
   if (pc[0] != checkinst2[0] || pc[1] != checkinst2[1]) {
     // Second instruction is not correct (test eax,[eax]).
     VLOG(signals) << "Not a suspension point";
@@ -236,6 +236,20 @@ class HashSet {
     return Iterator(this, NumBuckets());
   }
 
+  // Lower case for c++11 for each. const version.
+  ConstIterator begin() const {
+    ConstIterator ret(this, 0);
+    if (num_buckets_ != 0 && IsFreeSlot(ret.index_)) {
+      ++ret;  // Skip all the empty slots.
+    }
+    return ret;
+  }
+
+  // Lower case for c++11 for each. const version.
+  ConstIterator end() const {
+    return ConstIterator(this, NumBuckets());
+  }
+
   bool Empty() {
     return Size() == 0;
   }
@@ -1237,6 +1237,58 @@ void ClassLinker::InitFromImage() {
   VLOG(startup) << "ClassLinker::InitFromImage exiting";
 }
 
+void ClassLinker::AppendBootClassPathExtension(const std::vector<std::string>& dex_filenames,
+                                               const std::vector<std::string>& dex_locations,
+                                               const std::set<std::string>& excluded_locations,
+                                               bool use_oat_files) {
+  CHECK_EQ(dex_filenames.size(), dex_locations.size());
+  Thread* const self = Thread::Current();
+  std::set<std::string> boot_class_path_locations;
+  for (const DexFile* dex_file : boot_class_path_) {
+    boot_class_path_locations.insert(DexFile::GetBaseLocation(dex_file->GetLocation()));
+  }
+  for (size_t i = 0; i != dex_filenames.size(); ++i) {
+    const std::string& dex_filename = dex_filenames[i];
+    const std::string& dex_location = dex_locations[i];
+    if (boot_class_path_locations.find(dex_location) != boot_class_path_locations.end() ||
+        excluded_locations.find(dex_location) != excluded_locations.end()) {
+      continue;
+    }
+    std::vector<std::unique_ptr<const DexFile>> dex_files;
+    if (use_oat_files) {
+      OatFileAssistant oat_file_assistant(dex_filename.c_str(), kRuntimeISA, true);
+      if (oat_file_assistant.GetDexOptNeeded() == OatFileAssistant::kNoDexOptNeeded) {
+        std::unique_ptr<OatFile> oat_file = oat_file_assistant.GetBestOatFile();
+        if (oat_file.get() != nullptr) {
+          dex_files = OatFileAssistant::LoadDexFiles(*oat_file.get(), dex_location.c_str());
+          if (!dex_files.empty()) {
+            RegisterOatFile(oat_file.release());
+          }
+        }
+      }
+      if (dex_files.empty()) {
+        LOG(WARNING) << "No up to date oat file for boot class path entry " << dex_location
+                     << ", its code will not be precompiled";
+      }
+    }
+    if (dex_files.empty()) {
+      std::string error_msg;
+      if (!DexFile::Open(dex_filename.c_str(), dex_location.c_str(), &error_msg, &dex_files)) {
+        LOG(WARNING) << "Failed to open boot class path entry '" << dex_filename << "': "
+                     << error_msg;
+        continue;
+      }
+    }
+    for (std::unique_ptr<const DexFile>& dex_file : dex_files) {
+      VLOG(class_linker) << "Appending " << dex_file->GetLocation() << " to the boot class path";
+      AppendToBootClassPath(self, *dex_file.get());
+      boot_class_path_extension_.push_back(dex_file.get());
+      opened_dex_files_.push_back(std::move(dex_file));
+    }
+    boot_class_path_locations.insert(dex_location);
+  }
+}
+
 bool ClassLinker::ClassInClassTable(mirror::Class* klass) {
   ReaderMutexLock mu(Thread::Current(), *Locks::classlinker_classes_lock_);
   auto it = class_table_.Find(GcRoot<mirror::Class>(klass));
@@ -18,6 +18,7 @@
 #define ART_RUNTIME_CLASS_LINKER_H_
 
 #include <deque>
+#include <set>
 #include <string>
 #include <utility>
 #include <vector>
@@ -115,6 +116,18 @@ class ClassLinker {
   // Initialize class linker from one or more images.
   void InitFromImage() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Appends the dex files of the boot class path entries that the boot image does not contain,
+  // so that the boot image only needs to cover part of the boot class path and the other entries
+  // can be updated without rebuilding it. Entries whose location is in `excluded_locations` are
+  // skipped. If `use_oat_files` is true, an entry's dex files are loaded with its oat file when
+  // that is up to date; otherwise, or if there is no such oat file, the dex files are opened on
+  // their own.
+  void AppendBootClassPathExtension(const std::vector<std::string>& dex_filenames,
+                                    const std::vector<std::string>& dex_locations,
+                                    const std::set<std::string>& excluded_locations,
+                                    bool use_oat_files)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(dex_lock_);
+
   // Finds a class by its descriptor, loading it if necessary.
   // If class_loader is null, searches boot_class_path_.
   mirror::Class* FindClass(Thread* self, const char* descriptor,
@@ -292,6 +305,11 @@ class ClassLinker {
     return boot_class_path_;
   }
 
+  // Returns the dex files that AppendBootClassPathExtension() appended to the boot class path.
+  const std::vector<const DexFile*>& GetBootClassPathExtension() {
+    return boot_class_path_extension_;
+  }
+
   // Returns the first non-image oat file in the class path.
   const OatFile* GetPrimaryOatFile()
       LOCKS_EXCLUDED(dex_lock_);
@@ -694,6 +712,7 @@ class ClassLinker {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(Locks::classlinker_classes_lock_);
 
   std::vector<const DexFile*> boot_class_path_;
+  std::vector<const DexFile*> boot_class_path_extension_;
   std::vector<std::unique_ptr<const DexFile>> opened_dex_files_;
 
   mutable ReaderWriterMutex dex_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
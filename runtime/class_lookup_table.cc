@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_lookup_table.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/bit_utils.h"
+#include "dex_file-inl.h"
+#include "utf.h"
+
+namespace art {
+
+uint32_t ClassLookupTable::NumEntries(uint32_t num_class_defs) {
+  // Keep the load factor at or below 0.5, so that probe sequences are short and end at an empty
+  // entry.
+  return RoundUpToPowerOfTwo(std::max(num_class_defs, 1u) * 2u);
+}
+
+void ClassLookupTable::Create(const DexFile& dex_file, std::vector<uint8_t>* out) {
+  const uint32_t num_class_defs = dex_file.NumClassDefs();
+  const uint32_t num_entries = NumEntries(num_class_defs);
+  std::vector<Entry> entries(num_entries, Entry { 0u, DexFile::kDexNoIndex });
+  const uint32_t mask = num_entries - 1u;
+  for (uint32_t i = 0; i != num_class_defs; ++i) {
+    const char* descriptor = dex_file.GetClassDescriptor(dex_file.GetClassDef(i));
+    uint32_t hash = static_cast<uint32_t>(ComputeModifiedUtf8Hash(descriptor));
+    uint32_t pos = hash & mask;
+    while (entries[pos].class_def_index != DexFile::kDexNoIndex) {
+      pos = (pos + 1u) & mask;
+    }
+    entries[pos].hash = hash;
+    entries[pos].class_def_index = i;
+  }
+  const size_t begin = out->size();
+  out->resize(begin + sizeof(uint32_t) + num_entries * sizeof(Entry));
+  memcpy(out->data() + begin, &num_entries, sizeof(uint32_t));
+  memcpy(out->data() + begin + sizeof(uint32_t), entries.data(), num_entries * sizeof(Entry));
+}
+
+size_t ClassLookupTable::ValidatedSize(uint32_t num_class_defs,
+                                       const uint8_t* raw_data,
+                                       size_t available) {
+  if (available < sizeof(uint32_t)) {
+    return 0u;
+  }
+  const uint32_t num_entries = *reinterpret_cast<const uint32_t*>(raw_data);
+  if (num_entries != NumEntries(num_class_defs)) {
+    return 0u;
+  }
+  const size_t size = sizeof(uint32_t) + num_entries * sizeof(Entry);
+  if (size > available) {
+    return 0u;
+  }
+  return size;
+}
+
+uint32_t ClassLookupTable::Lookup(const char* descriptor, size_t hash) const {
+  const uint32_t hash32 = static_cast<uint32_t>(hash);
+  const uint32_t num_class_defs = dex_file_.NumClassDefs();
+  // A valid table has an empty entry to end the probing. Stop after visiting every entry in case
+  // it does not.
+  uint32_t pos = hash32 & mask_;
+  for (uint32_t i = 0; i <= mask_; ++i, pos = (pos + 1u) & mask_) {
+    const Entry& entry = entries_[pos];
+    if (entry.class_def_index == DexFile::kDexNoIndex) {
+      return DexFile::kDexNoIndex;
+    }
+    if (entry.hash == hash32 && LIKELY(entry.class_def_index < num_class_defs)) {
+      const DexFile::ClassDef& class_def = dex_file_.GetClassDef(entry.class_def_index);
+      if (strcmp(descriptor, dex_file_.GetClassDescriptor(class_def)) == 0) {
+        return entry.class_def_index;
+      }
+    }
+  }
+  return DexFile::kDexNoIndex;
+}
+
+}  // namespace art
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_CLASS_LOOKUP_TABLE_H_
+#define ART_RUNTIME_CLASS_LOOKUP_TABLE_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+
+namespace art {
+
+class DexFile;
+
+// A hash table from class descriptors to the class defs of a dex file, written to the oat file by
+// the compiler so that the runtime can look up the classes of a dex file without first searching
+// the string and type ids or building an index of the class defs.
+//
+// The table is a uint32_t number of entries, a power of two, followed by the entries. An entry
+// holds the low 32 bits of the descriptor's ComputeModifiedUtf8Hash() and the class def index,
+// or DexFile::kDexNoIndex if empty. Collisions are resolved by linear probing.
+class ClassLookupTable {
+ public:
+  // Appends the table for `dex_file` to `out`.
+  static void Create(const DexFile& dex_file, std::vector<uint8_t>* out);
+
+  // Returns the size of the table at `raw_data`, or 0 if its header does not describe a table for
+  // a dex file with `num_class_defs` class defs within `available` bytes. The entries are not
+  // checked here, which would touch the whole table whenever an oat file is opened; Lookup()
+  // checks the entries it visits instead.
+  static size_t ValidatedSize(uint32_t num_class_defs, const uint8_t* raw_data, size_t available);
+
+  ClassLookupTable(const DexFile& dex_file, const uint8_t* raw_data)
+      : dex_file_(dex_file),
+        mask_(*reinterpret_cast<const uint32_t*>(raw_data) - 1u),
+        entries_(reinterpret_cast<const Entry*>(raw_data + sizeof(uint32_t))) {}
+
+  // Returns the index of the class def of `descriptor`, or DexFile::kDexNoIndex if the dex file
+  // does not define it. `hash` must be ComputeModifiedUtf8Hash(descriptor). Entries with a class
+  // def index out of range are ignored.
+  uint32_t Lookup(const char* descriptor, size_t hash) const;
+
+ private:
+  struct Entry {
+    uint32_t hash;
+    uint32_t class_def_index;
+  };
+
+  static uint32_t NumEntries(uint32_t num_class_defs);
+
+  const DexFile& dex_file_;
+  const uint32_t mask_;
+  const Entry* const entries_;
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_CLASS_LOOKUP_TABLE_H_
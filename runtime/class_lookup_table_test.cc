@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_lookup_table.h"
+
+#include <string.h>
+
+#include <memory>
+
+#include "common_runtime_test.h"
+#include "dex_file-inl.h"
+#include "scoped_thread_state_change.h"
+#include "utf.h"
+
+namespace art {
+
+class ClassLookupTableTest : public CommonRuntimeTest {};
+
+TEST_F(ClassLookupTableTest, Lookup) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Nested"));
+  ASSERT_TRUE(dex_file.get() != nullptr);
+  ASSERT_NE(0u, dex_file->NumClassDefs());
+
+  std::vector<uint8_t> data;
+  ClassLookupTable::Create(*dex_file, &data);
+  ASSERT_EQ(data.size(),
+            ClassLookupTable::ValidatedSize(dex_file->NumClassDefs(), data.data(), data.size()));
+  ClassLookupTable table(*dex_file, data.data());
+
+  for (uint32_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+    const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+    EXPECT_EQ(i, table.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor))) << descriptor;
+  }
+  const char* missing = "LNested$Missing;";
+  EXPECT_EQ(DexFile::kDexNoIndex, table.Lookup(missing, ComputeModifiedUtf8Hash(missing)));
+}
+
+TEST_F(ClassLookupTableTest, Validation) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::unique_ptr<const DexFile> dex_file(OpenTestDexFile("Nested"));
+  ASSERT_TRUE(dex_file.get() != nullptr);
+  const uint32_t num_class_defs = dex_file->NumClassDefs();
+
+  std::vector<uint8_t> data;
+  ClassLookupTable::Create(*dex_file, &data);
+  // Truncated tables and tables for a different number of classes are rejected.
+  EXPECT_EQ(0u, ClassLookupTable::ValidatedSize(num_class_defs, data.data(), data.size() - 1u));
+  EXPECT_EQ(0u, ClassLookupTable::ValidatedSize(num_class_defs * 4u, data.data(), data.size()));
+  EXPECT_EQ(0u, ClassLookupTable::ValidatedSize(num_class_defs - 1u, data.data(), data.size()));
+
+  // The entries are only checked by lookups. Class def indexes out of range are ignored, and
+  // lookups end even if no entry is empty. Each entry is a hash and a class def index.
+  const size_t kEntrySize = 2u * sizeof(uint32_t);
+  uint32_t num_entries;
+  memcpy(&num_entries, data.data(), sizeof(uint32_t));
+  ASSERT_EQ(data.size(), sizeof(uint32_t) + num_entries * kEntrySize);
+  std::vector<uint8_t> corrupt(data);
+  for (uint32_t i = 0; i != num_entries; ++i) {
+    uint8_t* class_def_index = corrupt.data() + sizeof(uint32_t) + i * kEntrySize +
+        sizeof(uint32_t);
+    memcpy(class_def_index, &num_class_defs, sizeof(uint32_t));
+  }
+  ASSERT_EQ(corrupt.size(),
+            ClassLookupTable::ValidatedSize(num_class_defs, corrupt.data(), corrupt.size()));
+  ClassLookupTable table(*dex_file, corrupt.data());
+  for (uint32_t i = 0; i != num_class_defs; ++i) {
+    const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+    EXPECT_EQ(DexFile::kDexNoIndex, table.Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor)))
+        << descriptor;
+  }
+}
+
+}  // namespace art
@@ -25,6 +25,7 @@ namespace art {
 namespace verifier {
 
 class MethodVerifier;
+class VerifierDeps;
 
 }  // namespace verifier
 
@@ -45,6 +46,11 @@ class CompilerCallbacks {
   // done so. Return false if relocating in this way would be problematic.
   virtual bool IsRelocationPossible() = 0;
 
+  // Returns where the verifier records the lookups it relies on, or null if it should not.
+  virtual verifier::VerifierDeps* GetVerifierDeps() const {
+    return nullptr;
+  }
+
   bool IsBootImage() {
     return mode_ == CallbackMode::kCompileBootImage;
   }
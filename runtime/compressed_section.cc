@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compressed_section.h"
+
+#include <inttypes.h>
+#include <string.h>
+#include <zlib.h>
+
+#include <algorithm>
+
+#include "base/bit_utils.h"
+#include "base/casts.h"
+#include "base/logging.h"
+#include "base/stringprintf.h"
+
+namespace art {
+
+constexpr uint8_t CompressedSection::kMagic[];
+
+void CompressedSection::Compress(const uint8_t* data,
+                                 size_t size,
+                                 size_t block_size,
+                                 std::vector<uint8_t>* out) {
+  CHECK_GT(block_size, 0u);
+  CHECK_EQ(out->size() % 4u, 0u);
+  const size_t num_blocks = (size + block_size - 1u) / block_size;
+  const size_t section_begin = out->size();
+  const size_t offsets_begin = section_begin + sizeof(Header);
+  const size_t blocks_begin = offsets_begin + (num_blocks + 1u) * sizeof(uint32_t);
+  out->resize(blocks_begin);
+
+  Header header;
+  memcpy(header.magic_, kMagic, sizeof(kMagic));
+  header.uncompressed_size_ = dchecked_integral_cast<uint32_t>(size);
+  header.block_size_ = dchecked_integral_cast<uint32_t>(block_size);
+  header.num_blocks_ = dchecked_integral_cast<uint32_t>(num_blocks);
+  memcpy(out->data() + section_begin, &header, sizeof(header));
+
+  std::vector<uint32_t> offsets;
+  offsets.reserve(num_blocks + 1u);
+  for (size_t i = 0; i != num_blocks; ++i) {
+    offsets.push_back(dchecked_integral_cast<uint32_t>(out->size() - blocks_begin));
+    const size_t block_begin = i * block_size;
+    const size_t block_length = std::min(block_size, size - block_begin);
+    uLongf compressed_length = compressBound(block_length);
+    const size_t compressed_begin = out->size();
+    out->resize(compressed_begin + compressed_length);
+    int result = compress2(out->data() + compressed_begin,
+                           &compressed_length,
+                           data + block_begin,
+                           block_length,
+                           Z_BEST_COMPRESSION);
+    CHECK_EQ(result, Z_OK) << "Failed to compress block " << i;
+    out->resize(compressed_begin + compressed_length);
+  }
+  offsets.push_back(dchecked_integral_cast<uint32_t>(out->size() - blocks_begin));
+  memcpy(out->data() + offsets_begin, offsets.data(), offsets.size() * sizeof(uint32_t));
+  out->resize(RoundUp(out->size(), 4u), 0u);
+}
+
+bool CompressedSection::IsValid(const uint8_t* begin, size_t available, std::string* error_msg) {
+  if (available < sizeof(Header)) {
+    *error_msg = StringPrintf("Compressed section truncated: %zu bytes", available);
+    return false;
+  }
+  const Header* header = reinterpret_cast<const Header*>(begin);
+  if (memcmp(header->magic_, kMagic, sizeof(kMagic)) != 0) {
+    *error_msg = "Invalid compressed section magic";
+    return false;
+  }
+  if (header->block_size_ == 0u) {
+    *error_msg = "Compressed section with zero block size";
+    return false;
+  }
+  uint64_t expected_blocks =
+      (static_cast<uint64_t>(header->uncompressed_size_) + header->block_size_ - 1u) /
+      header->block_size_;
+  if (header->num_blocks_ != expected_blocks) {
+    *error_msg = StringPrintf("Compressed section with %u blocks, expected %" PRIu64,
+                              header->num_blocks_, expected_blocks);
+    return false;
+  }
+  uint64_t blocks_begin =
+      sizeof(Header) + (static_cast<uint64_t>(header->num_blocks_) + 1u) * sizeof(uint32_t);
+  if (blocks_begin > available) {
+    *error_msg = "Compressed section truncated in the block offsets";
+    return false;
+  }
+  const uint32_t* offsets = reinterpret_cast<const uint32_t*>(begin + sizeof(Header));
+  if (offsets[0] != 0u) {
+    *error_msg = StringPrintf("Compressed section with first block at %u", offsets[0]);
+    return false;
+  }
+  for (size_t i = 0; i != header->num_blocks_; ++i) {
+    if (offsets[i + 1u] < offsets[i]) {
+      *error_msg = StringPrintf("Compressed section with block %zu of negative size", i);
+      return false;
+    }
+  }
+  if (blocks_begin + offsets[header->num_blocks_] > available) {
+    *error_msg = "Compressed section truncated in the blocks";
+    return false;
+  }
+  return true;
+}
+
+size_t CompressedSection::Size() const {
+  return sizeof(Header) + (NumBlocks() + 1u) * sizeof(uint32_t) + GetBlockOffsets()[NumBlocks()];
+}
+
+bool CompressedSection::DecompressBlock(size_t index,
+                                        uint8_t* out,
+                                        std::string* error_msg) const {
+  DCHECK_LT(index, NumBlocks());
+  const Header& header = GetHeader();
+  const size_t block_begin = index * header.block_size_;
+  const size_t block_length = std::min<size_t>(header.block_size_,
+                                               header.uncompressed_size_ - block_begin);
+  const uint32_t* offsets = GetBlockOffsets();
+  uLongf length = block_length;
+  int result = uncompress(out,
+                          &length,
+                          GetBlocks() + offsets[index],
+                          offsets[index + 1u] - offsets[index]);
+  if (result != Z_OK || length != block_length) {
+    *error_msg = StringPrintf("Failed to decompress block %zu: zlib result %d, %" PRIu64 " of %zu "
+                              "bytes", index, result, static_cast<uint64_t>(length), block_length);
+    return false;
+  }
+  return true;
+}
+
+bool CompressedSection::Decompress(uint8_t* out, std::string* error_msg) const {
+  const size_t block_size = GetHeader().block_size_;
+  for (size_t i = 0, num_blocks = NumBlocks(); i != num_blocks; ++i) {
+    if (!DecompressBlock(i, out + i * block_size, error_msg)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace art
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_COMPRESSED_SECTION_H_
+#define ART_RUNTIME_COMPRESSED_SECTION_H_
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "globals.h"
+
+namespace art {
+
+// Data compressed with zlib in blocks of a fixed uncompressed size, with an index of the
+// compressed blocks so that any block can be decompressed without the ones before it.
+//
+// The section starts with a Header, followed by num_blocks_ + 1 uint32_t offsets of the
+// compressed blocks relative to the end of the offsets, followed by the compressed blocks.
+// The last offset is the total size of the compressed blocks. Every block decompresses to
+// block_size_ bytes except the last one, which holds the rest of the data.
+class CompressedSection {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * KB;
+
+  struct PACKED(4) Header {
+    uint8_t magic_[4];
+    uint32_t uncompressed_size_;
+    uint32_t block_size_;
+    uint32_t num_blocks_;
+  };
+
+  // Appends the compressed `data` to `out`. The size of `out` is kept a multiple of 4.
+  static void Compress(const uint8_t* data,
+                       size_t size,
+                       size_t block_size,
+                       std::vector<uint8_t>* out);
+
+  // Returns true if `begin` points to a well formed section that fits in `available` bytes.
+  // Otherwise returns false and describes the problem in `error_msg`.
+  static bool IsValid(const uint8_t* begin, size_t available, std::string* error_msg);
+
+  // `begin` must point to a section that passed IsValid().
+  explicit CompressedSection(const uint8_t* begin) : begin_(begin) {}
+
+  size_t UncompressedSize() const {
+    return GetHeader().uncompressed_size_;
+  }
+
+  size_t NumBlocks() const {
+    return GetHeader().num_blocks_;
+  }
+
+  // The size of the section, including the header and the block offsets.
+  size_t Size() const;
+
+  // Decompresses block `index` to `out`, which must have room for the block.
+  bool DecompressBlock(size_t index, uint8_t* out, std::string* error_msg) const;
+
+  // Decompresses the whole section to `out`, which must have room for UncompressedSize() bytes.
+  bool Decompress(uint8_t* out, std::string* error_msg) const;
+
+ private:
+  static constexpr uint8_t kMagic[] = { 'z', 'b', 'l', 'k' };
+
+  const Header& GetHeader() const {
+    return *reinterpret_cast<const Header*>(begin_);
+  }
+
+  const uint32_t* GetBlockOffsets() const {
+    return reinterpret_cast<const uint32_t*>(begin_ + sizeof(Header));
+  }
+
+  const uint8_t* GetBlocks() const {
+    return reinterpret_cast<const uint8_t*>(GetBlockOffsets() + NumBlocks() + 1u);
+  }
+
+  const uint8_t* const begin_;
+};
+
+}  // namespace art
+
+#endif  // ART_RUNTIME_COMPRESSED_SECTION_H_
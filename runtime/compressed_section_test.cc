@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "compressed_section.h"
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+namespace art {
+
+static void CheckRoundTrip(const std::vector<uint8_t>& data, size_t block_size) {
+  std::vector<uint8_t> compressed(4u, 0xffu);  // Data before the section is left alone.
+  CompressedSection::Compress(data.data(), data.size(), block_size, &compressed);
+  ASSERT_EQ(0u, compressed.size() % 4u);
+  const uint8_t* begin = compressed.data() + 4u;
+  const size_t available = compressed.size() - 4u;
+
+  std::string error_msg;
+  ASSERT_TRUE(CompressedSection::IsValid(begin, available, &error_msg)) << error_msg;
+  CompressedSection section(begin);
+  EXPECT_EQ(data.size(), section.UncompressedSize());
+  EXPECT_EQ((data.size() + block_size - 1u) / block_size, section.NumBlocks());
+  EXPECT_LE(section.Size(), available);
+
+  std::vector<uint8_t> decompressed(data.size());
+  ASSERT_TRUE(section.Decompress(decompressed.data(), &error_msg)) << error_msg;
+  EXPECT_EQ(data, decompressed);
+
+  // Each block can be decompressed on its own.
+  for (size_t i = 0; i != section.NumBlocks(); ++i) {
+    size_t block_begin = i * block_size;
+    size_t block_length = std::min(block_size, data.size() - block_begin);
+    std::vector<uint8_t> block(block_length);
+    ASSERT_TRUE(section.DecompressBlock(i, block.data(), &error_msg)) << error_msg;
+    EXPECT_TRUE(std::equal(block.begin(), block.end(), data.begin() + block_begin));
+  }
+
+  // Truncated sections are rejected.
+  EXPECT_FALSE(CompressedSection::IsValid(begin, section.Size() - 1u, &error_msg));
+}
+
+TEST(CompressedSectionTest, RoundTrip) {
+  std::vector<uint8_t> data;
+  for (size_t i = 0; i != 10000u; ++i) {
+    data.push_back(static_cast<uint8_t>((i * 7u) ^ (i >> 5)));
+  }
+  CheckRoundTrip(data, 4 * KB);
+  CheckRoundTrip(data, 1000u);
+  CheckRoundTrip(data, data.size());
+  CheckRoundTrip(data, CompressedSection::kDefaultBlockSize);
+}
+
+TEST(CompressedSectionTest, Empty) {
+  CheckRoundTrip(std::vector<uint8_t>(), 4 * KB);
+}
+
+TEST(CompressedSectionTest, InvalidMagic) {
+  std::vector<uint8_t> data(100u, 1u);
+  std::vector<uint8_t> compressed;
+  CompressedSection::Compress(data.data(), data.size(), 16u, &compressed);
+  compressed[0] ^= 0xffu;
+  std::string error_msg;
+  EXPECT_FALSE(CompressedSection::IsValid(compressed.data(), compressed.size(), &error_msg));
+}
+
+}  // namespace art
@@ -32,11 +32,13 @@
 #include "base/logging.h"
 #include "base/stringprintf.h"
 #include "class_linker.h"
+#include "class_lookup_table.h"
 #include "dex_file-inl.h"
 #include "dex_file_verifier.h"
 #include "globals.h"
 #include "leb128.h"
 #include "mirror/string.h"
+#include "oat_file.h"
 #include "os.h"
 #include "safe_map.h"
 #include "handle_scope-inl.h"
@@ -269,6 +271,21 @@ bool DexFile::OpenZip(int fd, const std::string& location, std::string* error_ms
   return DexFile::OpenFromZip(*zip_archive, location, error_msg, dex_files);
 }
 
+std::unique_ptr<const DexFile> DexFile::Open(MemMap* mem_map, size_t size,
+                                             const std::string& location,
+                                             uint32_t location_checksum,
+                                             const OatDexFile* oat_dex_file,
+                                             std::string* error_msg) {
+  CHECK_LE(size, mem_map->Size());
+  return OpenMemory(mem_map->Begin(),
+                    size,
+                    location,
+                    location_checksum,
+                    mem_map,
+                    oat_dex_file,
+                    error_msg);
+}
+
 std::unique_ptr<const DexFile> DexFile::OpenMemory(const std::string& location,
                                                    uint32_t location_checksum,
                                                    MemMap* mem_map,
@@ -472,6 +489,13 @@ uint32_t DexFile::GetVersion() const {
 
 const DexFile::ClassDef* DexFile::FindClassDef(const char* descriptor, size_t hash) const {
   DCHECK_EQ(ComputeModifiedUtf8Hash(descriptor), hash);
+  // If the compiler wrote a class lookup table to the oat file, use it.
+  const uint8_t* lookup_table_data =
+      (oat_dex_file_ != nullptr) ? oat_dex_file_->GetLookupTableData() : nullptr;
+  if (lookup_table_data != nullptr) {
+    uint32_t class_def_idx = ClassLookupTable(*this, lookup_table_data).Lookup(descriptor, hash);
+    return (class_def_idx != DexFile::kDexNoIndex) ? &GetClassDef(class_def_idx) : nullptr;
+  }
   // If we have an index lookup the descriptor via that as its constant time to search.
   Index* index = class_def_index_.LoadSequentiallyConsistent();
   if (index != nullptr) {
@@ -401,6 +401,13 @@ class DexFile {
     return OpenMemory(base, size, location, location_checksum, nullptr, oat_dex_file, error_msg);
   }
 
+  // Opens .dex file of `size` bytes at the start of `mem_map`, which the DexFile takes ownership of.
+  static std::unique_ptr<const DexFile> Open(MemMap* mem_map, size_t size,
+                                             const std::string& location,
+                                             uint32_t location_checksum,
+                                             const OatDexFile* oat_dex_file,
+                                             std::string* error_msg);
+
   // Open all classesXXX.dex files from a zip archive.
   static bool OpenFromZip(const ZipArchive& zip_archive, const std::string& location,
                           std::string* error_msg,
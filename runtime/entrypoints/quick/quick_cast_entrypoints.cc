@@ -16,6 +16,8 @@
 
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
+#include "read_barrier-inl.h"
+#include "thread.h"
 
 namespace art {
 
@@ -24,6 +26,12 @@ extern "C" uint32_t artIsAssignableFromCode(mirror::Class* klass, mirror::Class*
     SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
   DCHECK(klass != nullptr);
   DCHECK(ref_class != nullptr);
+  if (kUseReadBarrier && Thread::Current()->GetIsGcMarking()) {
+    // The assembly stubs load the classes without read barriers; the class
+    // comparisons below need the to-space references.
+    klass = down_cast<mirror::Class*>(ReadBarrier::Mark(klass));
+    ref_class = down_cast<mirror::Class*>(ReadBarrier::Mark(ref_class));
+  }
   return klass->IsAssignableFrom(ref_class) ? 1 : 0;
 }
 
@@ -71,6 +71,10 @@ extern void ReadBarrierJni(mirror::CompressedReference<mirror::Object>* handle_o
                            Thread* self)
     NO_THREAD_SAFETY_ANALYSIS HOT_ATTR;
 
+// Read barrier entrypoint used by compiled code to mark the reference it loaded.
+extern "C" mirror::Object* artReadBarrierMark(mirror::Object* obj)
+    NO_THREAD_SAFETY_ANALYSIS HOT_ATTR;
+
 }  // namespace art
 
 #endif  // ART_RUNTIME_ENTRYPOINTS_QUICK_QUICK_ENTRYPOINTS_H_
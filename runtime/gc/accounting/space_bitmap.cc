@@ -23,6 +23,7 @@
 #include "mirror/object-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object_array.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace gc {
@@ -184,6 +185,64 @@ void SpaceBitmap<kAlignment>::SweepWalk(const SpaceBitmap<kAlignment>& live_bitm
   }
 }
 
+// Sweeps one range of a ParallelSweepWalk().
+template<size_t kAlignment>
+class SweepWalkTask : public Task {
+ public:
+  SweepWalkTask(const SpaceBitmap<kAlignment>* live_bitmap,
+                const SpaceBitmap<kAlignment>* mark_bitmap,
+                uintptr_t sweep_begin, uintptr_t sweep_end,
+                typename SpaceBitmap<kAlignment>::SweepCallback* callback, void* arg)
+      : live_bitmap_(live_bitmap), mark_bitmap_(mark_bitmap), sweep_begin_(sweep_begin),
+        sweep_end_(sweep_end), callback_(callback), arg_(arg) {
+  }
+
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE {
+    SpaceBitmap<kAlignment>::SweepWalk(*live_bitmap_, *mark_bitmap_, sweep_begin_, sweep_end_,
+                                       callback_, arg_);
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const SpaceBitmap<kAlignment>* const live_bitmap_;
+  const SpaceBitmap<kAlignment>* const mark_bitmap_;
+  const uintptr_t sweep_begin_;
+  const uintptr_t sweep_end_;
+  typename SpaceBitmap<kAlignment>::SweepCallback* const callback_;
+  void* const arg_;
+};
+
+template<size_t kAlignment>
+void SpaceBitmap<kAlignment>::ParallelSweepWalk(const SpaceBitmap<kAlignment>& live_bitmap,
+                                                const SpaceBitmap<kAlignment>& mark_bitmap,
+                                                const std::vector<uintptr_t>& boundaries,
+                                                SpaceBitmap::SweepCallback* callback,
+                                                const std::vector<void*>& args,
+                                                ThreadPool* thread_pool, size_t thread_count) {
+  CHECK(thread_pool != nullptr);
+  CHECK_GT(thread_count, 0U);
+  CHECK_GE(boundaries.size(), 2U);
+  CHECK_EQ(args.size(), boundaries.size() - 1);
+  Thread* self = Thread::Current();
+  for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+    CHECK_LT(boundaries[i], boundaries[i + 1]);
+    if (i != 0) {
+      // Two threads must not clear bits in the same word.
+      DCHECK_ALIGNED(boundaries[i] - live_bitmap.heap_begin_, kBitsPerIntPtrT * kAlignment);
+    }
+    thread_pool->AddTask(self, new SweepWalkTask<kAlignment>(&live_bitmap, &mark_bitmap,
+                                                             boundaries[i], boundaries[i + 1],
+                                                             callback, args[i]));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+}
+
 template<size_t kAlignment>
 void SpaceBitmap<kAlignment>::WalkInstanceFields(SpaceBitmap<kAlignment>* visited,
                                                  ObjectCallback* callback, mirror::Object* obj,
@@ -33,6 +33,7 @@ namespace mirror {
   class Object;
 }  // namespace mirror
 class MemMap;
+class ThreadPool;
 
 namespace gc {
 namespace accounting {
@@ -143,6 +144,16 @@ class SpaceBitmap {
   static void SweepWalk(const SpaceBitmap& live, const SpaceBitmap& mark, uintptr_t base,
                         uintptr_t max, SweepCallback* thunk, void* arg);
 
+  // Like SweepWalk(), but the ranges [boundaries[i], boundaries[i + 1]) are walked in parallel by
+  // thread_count threads of thread_pool, including the calling thread. <callback> is called with
+  // args[i] for the garbage of the i-th range, on the thread that walks the range. The inner
+  // boundaries must be aligned to the words of the bitmaps so that the callbacks may clear the
+  // bits of their objects.
+  static void ParallelSweepWalk(const SpaceBitmap& live, const SpaceBitmap& mark,
+                                const std::vector<uintptr_t>& boundaries, SweepCallback* thunk,
+                                const std::vector<void*>& args, ThreadPool* thread_pool,
+                                size_t thread_count);
+
   void CopyFrom(SpaceBitmap* source_bitmap);
 
   // Starting address of our internal storage.
@@ -22,6 +22,7 @@
 #include "common_runtime_test.h"
 #include "globals.h"
 #include "space_bitmap-inl.h"
+#include "thread_pool.h"
 
 namespace art {
 namespace gc {
@@ -165,6 +166,69 @@ TEST_F(SpaceBitmapTest, VisitorPageAlignment) {
   RunTest<kPageSize>();
 }
 
+struct SweepRange {
+  uintptr_t begin;
+  uintptr_t end;
+  size_t count;
+};
+
+static void SweepRangeCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg) {
+  SweepRange* range = reinterpret_cast<SweepRange*>(arg);
+  for (size_t i = 0; i < num_ptrs; ++i) {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(ptrs[i]);
+    EXPECT_LE(range->begin, addr);
+    EXPECT_LT(addr, range->end);
+  }
+  range->count += num_ptrs;
+}
+
+TEST_F(SpaceBitmapTest, ParallelSweepWalk) {
+  uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x10000000);
+  size_t heap_capacity = 16 * MB;
+  std::unique_ptr<ContinuousSpaceBitmap> live_bitmap(
+      ContinuousSpaceBitmap::Create("live bitmap", heap_begin, heap_capacity));
+  std::unique_ptr<ContinuousSpaceBitmap> mark_bitmap(
+      ContinuousSpaceBitmap::Create("mark bitmap", heap_begin, heap_capacity));
+
+  RandGen r(0x1234);
+  size_t expected_garbage = 0;
+  for (int i = 0; i < 10000; ++i) {
+    mirror::Object* obj = reinterpret_cast<mirror::Object*>(
+        heap_begin + RoundDown(r.next() % heap_capacity, kObjectAlignment));
+    if (live_bitmap->Set(obj)) {
+      continue;
+    }
+    if (r.next() % 2 == 1) {
+      mark_bitmap->Set(obj);
+    } else {
+      ++expected_garbage;
+    }
+  }
+
+  // Ranges of different sizes, aligned to the words of the bitmaps.
+  static const size_t kBoundaryOffsets[] = { 0, 512, 1 * MB, 5 * MB, 5 * MB + 4 * KB, 16 * MB };
+  std::vector<uintptr_t> boundaries;
+  for (size_t offset : kBoundaryOffsets) {
+    boundaries.push_back(reinterpret_cast<uintptr_t>(heap_begin) + offset);
+  }
+  std::vector<SweepRange> ranges;
+  for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+    ranges.push_back(SweepRange { boundaries[i], boundaries[i + 1], 0U });
+  }
+  std::vector<void*> args;
+  for (SweepRange& range : ranges) {
+    args.push_back(&range);
+  }
+  ThreadPool thread_pool("Sweep test thread pool", 3);
+  ContinuousSpaceBitmap::ParallelSweepWalk(*live_bitmap, *mark_bitmap, boundaries,
+                                           &SweepRangeCallback, args, &thread_pool, 4);
+  size_t garbage = 0;
+  for (const SweepRange& range : ranges) {
+    garbage += range.count;
+  }
+  EXPECT_EQ(expected_garbage, garbage);
+}
+
 }  // namespace accounting
 }  // namespace gc
 }  // namespace art
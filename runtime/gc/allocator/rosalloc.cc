@@ -25,6 +25,7 @@
 #include "thread-inl.h"
 #include "thread_list.h"
 
+#include <algorithm>
 #include <map>
 #include <list>
 #include <sstream>
@@ -58,7 +59,8 @@ RosAlloc::RosAlloc(void* base, size_t capacity, size_t max_capacity,
       bulk_free_lock_("rosalloc bulk free lock", kRosAllocBulkFreeLock),
       page_release_mode_(page_release_mode),
       page_release_size_threshold_(page_release_size_threshold),
-      running_on_valgrind_(running_on_valgrind) {
+      running_on_valgrind_(running_on_valgrind),
+      is_parallel_bulk_free_(false) {
   DCHECK_EQ(RoundUp(capacity, kPageSize), capacity);
   DCHECK_EQ(RoundUp(max_capacity, kPageSize), max_capacity);
   CHECK_LE(capacity, max_capacity);
@@ -1163,7 +1165,114 @@ size_t RosAlloc::BulkFree(Thread* self, void** ptrs, size_t num_ptrs) {
   }
 
   WriterMutexLock wmu(self, bulk_free_lock_);
+  return BulkFreeLocked(self, ptrs, num_ptrs);
+}
+
+void RosAlloc::StartParallelBulkFree(Thread* self) {
+  bulk_free_lock_.ExclusiveLock(self);
+  DCHECK(!is_parallel_bulk_free_);
+  is_parallel_bulk_free_ = true;
+}
+
+void RosAlloc::FinishParallelBulkFree(Thread* self) {
+  DCHECK(is_parallel_bulk_free_);
+  is_parallel_bulk_free_ = false;
+  bulk_free_lock_.ExclusiveUnlock(self);
+}
+
+size_t RosAlloc::ParallelBulkFree(Thread* self, void** ptrs, size_t num_ptrs)
+    NO_THREAD_SAFETY_ANALYSIS {
+  // The bulk free lock is held by the thread that called StartParallelBulkFree().
+  DCHECK(is_parallel_bulk_free_);
+  return BulkFreeLocked(self, ptrs, num_ptrs);
+}
+
+uint8_t* RosAlloc::GetParallelBulkFreeBoundary(uint8_t* addr) {
+  MutexLock mu(Thread::Current(), lock_);
+  size_t pm_idx = RoundDownToPageMapIndex(addr);
+  DCHECK_LT(pm_idx, page_map_size_);
+  while (pm_idx > 0 &&
+         (page_map_[pm_idx] == kPageMapRunPart || page_map_[pm_idx] == kPageMapLargeObjectPart)) {
+    --pm_idx;
+  }
+  return base_ + pm_idx * kPageSize;
+}
 
+size_t RosAlloc::BeginRunEvacuation(Thread* self, size_t max_bytes,
+                                    std::vector<std::pair<uint8_t*, uint8_t*>>* ranges) {
+  Locks::mutator_lock_->AssertSharedHeld(self);
+  DCHECK(evacuating_runs_.empty());
+  struct Candidate {
+    Run* run;
+    size_t used_bytes;
+    // The bytes to copy per page released.
+    size_t cost;
+  };
+  std::vector<Candidate> candidates;
+  for (size_t idx = 0; idx < kNumOfSizeBrackets; ++idx) {
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    auto* non_full_runs = &non_full_runs_[idx];
+    if (non_full_runs->size() < 2) {
+      continue;
+    }
+    // Leave the fullest run so that the objects can be moved to it rather than to a new run.
+    Run* fullest_run = nullptr;
+    size_t fullest_run_free_slots = numOfSlots[idx];
+    for (Run* run : *non_full_runs) {
+      size_t free_slots = run->NumberOfFreeSlots();
+      if (free_slots < fullest_run_free_slots) {
+        fullest_run = run;
+        fullest_run_free_slots = free_slots;
+      }
+    }
+    for (Run* run : *non_full_runs) {
+      size_t used_slots = numOfSlots[idx] - run->NumberOfFreeSlots();
+      if (run == fullest_run ||
+          used_slots * 100 > numOfSlots[idx] * kMaxEvacuatedRunOccupancyPercent) {
+        continue;
+      }
+      size_t used_bytes = used_slots * bracketSizes[idx];
+      candidates.push_back({run, used_bytes, used_bytes / numOfPages[idx]});
+    }
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const Candidate& a, const Candidate& b) { return a.cost < b.cost; });
+  size_t evacuated_bytes = 0;
+  for (const Candidate& candidate : candidates) {
+    if (!evacuating_runs_.empty() && evacuated_bytes + candidate.used_bytes > max_bytes) {
+      continue;
+    }
+    Run* run = candidate.run;
+    size_t idx = run->size_bracket_idx_;
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    if (non_full_runs_[idx].erase(run) == 0) {
+      // A mutator refilled its current or thread local run with it since the candidates were
+      // chosen.
+      continue;
+    }
+    evacuating_runs_.push_back(run);
+    ranges->push_back(std::make_pair(reinterpret_cast<uint8_t*>(run) + headerSizes[idx],
+                                     reinterpret_cast<uint8_t*>(run->End())));
+    evacuated_bytes += candidate.used_bytes;
+  }
+  return evacuated_bytes;
+}
+
+void RosAlloc::EndRunEvacuation(Thread* self) {
+  Locks::mutator_lock_->AssertExclusiveHeld(self);
+  for (Run* run : evacuating_runs_) {
+    size_t idx = run->size_bracket_idx_;
+    MutexLock mu(self, *size_bracket_locks_[idx]);
+    // Nothing was allocated in the run, so it is still non full.
+    DCHECK(!run->IsFull());
+    DCHECK(non_full_runs_[idx].find(run) == non_full_runs_[idx].end());
+    non_full_runs_[idx].insert(run);
+  }
+  evacuating_runs_.clear();
+}
+
+size_t RosAlloc::BulkFreeLocked(Thread* self, void** ptrs, size_t num_ptrs) {
+  size_t freed_bytes = 0;
   // First mark slots to free in the bulk free bit map without locking the
   // size bracket locks. On host, unordered_set is faster than vector + flag.
 #ifdef HAVE_ANDROID_OS
@@ -429,6 +429,10 @@ class RosAlloc {
   // are less than this index. We use shared (current) runs for the rest.
   static const size_t kNumThreadLocalSizeBrackets = 8;
 
+  // The runs whose slots are at most this percent in use may be evacuated by an incremental
+  // compaction, see BeginRunEvacuation().
+  static constexpr size_t kMaxEvacuatedRunOccupancyPercent = 50;
+
  private:
   // The base address of the memory region that's managed by this allocator.
   uint8_t* base_;
@@ -505,6 +509,13 @@ class RosAlloc {
   // Whether this allocator is running under Valgrind.
   bool running_on_valgrind_;
 
+  // True between StartParallelBulkFree() and FinishParallelBulkFree().
+  bool is_parallel_bulk_free_ GUARDED_BY(bulk_free_lock_);
+
+  // The runs taken out of the non full run sets between BeginRunEvacuation() and
+  // EndRunEvacuation(). Only accessed by the collector that evacuates them.
+  std::vector<Run*> evacuating_runs_;
+
   // The base address of the memory region that's managed by this allocator.
   uint8_t* Begin() { return base_; }
   // The end address of the memory region that's managed by this allocator.
@@ -541,6 +552,10 @@ class RosAlloc {
   // The internal of non-bulk Free().
   size_t FreeInternal(Thread* self, void* ptr) LOCKS_EXCLUDED(lock_);
 
+  // The body of BulkFree().
+  size_t BulkFreeLocked(Thread* self, void** ptrs, size_t num_ptrs)
+      EXCLUSIVE_LOCKS_REQUIRED(bulk_free_lock_);
+
   // Allocates large objects.
   void* AllocLargeObject(Thread* self, size_t size, size_t* bytes_allocated,
                          size_t* usable_size, size_t* bytes_tl_bulk_allocated)
@@ -576,6 +591,32 @@ class RosAlloc {
   size_t BulkFree(Thread* self, void** ptrs, size_t num_ptrs)
       LOCKS_EXCLUDED(bulk_free_lock_);
 
+  // Parallel sweeping. Between StartParallelBulkFree() and FinishParallelBulkFree(), the caller
+  // holds the bulk free lock on behalf of the GC worker threads, which free their batches with
+  // ParallelBulkFree() at the same time. Each run or large object must be freed by a single
+  // thread, see GetParallelBulkFreeBoundary(). Individual frees and thread local run revocations
+  // wait until FinishParallelBulkFree(), as they do for a BulkFree().
+  void StartParallelBulkFree(Thread* self) EXCLUSIVE_LOCK_FUNCTION(bulk_free_lock_);
+  void FinishParallelBulkFree(Thread* self) UNLOCK_FUNCTION(bulk_free_lock_);
+  size_t ParallelBulkFree(Thread* self, void** ptrs, size_t num_ptrs);
+  // Returns the beginning of the run or the large object that contains the page of addr, or the
+  // page if it's free. The ranges between such boundaries do not share runs or large objects.
+  uint8_t* GetParallelBulkFreeBoundary(uint8_t* addr) LOCKS_EXCLUDED(lock_);
+
+  // Incremental compaction. BeginRunEvacuation() takes the sparsest non full runs out of the non
+  // full run sets, cheapest to evacuate first, until the bytes in use in them would exceed
+  // max_bytes, and appends the address ranges of their slots to ranges. It takes at least one run
+  // if any is sparse enough, and always leaves the fullest non full run of a size bracket. Until
+  // EndRunEvacuation() puts the runs back, nothing is allocated in them, so the caller can copy
+  // their objects to other runs and then free the old copies, which releases the pages of the
+  // runs that become empty. The runs in the non full run sets are neither current nor thread
+  // local runs, so BeginRunEvacuation() may be called while the mutators allocate; it skips the
+  // runs that they take meanwhile. EndRunEvacuation() must be called with the mutators suspended
+  // and the thread local runs revoked. Returns the bytes in use in the runs.
+  size_t BeginRunEvacuation(Thread* self, size_t max_bytes,
+                            std::vector<std::pair<uint8_t*, uint8_t*>>* ranges);
+  void EndRunEvacuation(Thread* self);
+
   // Returns true if the given allocation request can be allocated in
   // an existing thread local run without allocating a new run.
   ALWAYS_INLINE bool CanAllocFromThreadLocalRun(Thread* self, size_t size);
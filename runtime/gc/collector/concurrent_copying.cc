@@ -17,6 +17,7 @@
 #include "concurrent_copying.h"
 
 #include "art_field-inl.h"
+#include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
 #include "gc/space/image_space.h"
@@ -27,13 +28,22 @@
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
 namespace gc {
 namespace collector {
 
-ConcurrentCopying::ConcurrentCopying(Heap* heap, const std::string& name_prefix)
+// Process the mark queue with the GC worker threads when it is large enough.
+static constexpr bool kParallelProcessMarkStack = true;
+static constexpr size_t kMinimumParallelMarkStackSize = 128;
+// The size of the copy buffers of the GC worker threads. Larger objects are copied with a
+// region space allocation.
+static constexpr size_t kPlabSize = 32 * KB;
+static constexpr size_t kPlabMaxObjectSize = kPlabSize / 8;
+
+ConcurrentCopying::ConcurrentCopying(Heap* heap, bool young_gen, const std::string& name_prefix)
     : GarbageCollector(heap,
                        name_prefix + (name_prefix.empty() ? "" : " ") +
                        "concurrent copying + mark sweep"),
@@ -42,7 +52,11 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap, const std::string& name_prefix)
       heap_mark_bitmap_(nullptr), live_stack_freeze_size_(0),
       skipped_blocks_lock_("concurrent copying bytes blocks lock", kMarkSweepMarkStackLock),
       rb_table_(heap_->GetReadBarrierTable()),
-      force_evacuate_all_(false) {
+      force_evacuate_all_(false),
+      plabs_lock_("concurrent copying plabs lock", kMarkSweepMarkStackLock),
+      young_gen_(young_gen),
+      use_generational_cc_(heap->use_generational_cc_) {
+  CHECK(!young_gen_ || use_generational_cc_);
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
                 "The region space size and the read barrier table region size must match");
   cc_heap_bitmap_.reset(new accounting::HeapBitmap(heap));
@@ -115,12 +129,19 @@ void ConcurrentCopying::BindBitmaps() {
       cc_heap_bitmap_->AddContinuousSpaceBitmap(bitmap);
       cc_bitmaps_.push_back(bitmap);
     } else if (space == region_space_) {
-      accounting::ContinuousSpaceBitmap* bitmap =
-          accounting::ContinuousSpaceBitmap::Create("cc region space bitmap",
-                                                    space->Begin(), space->Capacity());
-      cc_heap_bitmap_->AddContinuousSpaceBitmap(bitmap);
-      cc_bitmaps_.push_back(bitmap);
-      region_space_bitmap_ = bitmap;
+      if (use_generational_cc_) {
+        // The marks of the old objects outlive the collection. Not deleted in ReclaimPhase().
+        region_space_bitmap_ = region_space_->GetRegionMarkBitmap();
+        CHECK(region_space_bitmap_ != nullptr);
+        cc_heap_bitmap_->AddContinuousSpaceBitmap(region_space_bitmap_);
+      } else {
+        accounting::ContinuousSpaceBitmap* bitmap =
+            accounting::ContinuousSpaceBitmap::Create("cc region space bitmap",
+                                                      space->Begin(), space->Capacity());
+        cc_heap_bitmap_->AddContinuousSpaceBitmap(bitmap);
+        cc_bitmaps_.push_back(bitmap);
+        region_space_bitmap_ = bitmap;
+      }
     }
   }
 }
@@ -144,7 +165,15 @@ void ConcurrentCopying::InitializePhase() {
     force_evacuate_all_ = false;
   }
   BindBitmaps();
+  if (use_generational_cc_ && !young_gen_) {
+    // A full collection marks all the live objects of the region space again. The cards of
+    // the old objects that refer to young objects are dirtied again by Process() and the
+    // write barrier.
+    region_space_bitmap_->Clear();
+    heap_->GetCardTable()->ClearSpaceCards(region_space_);
+  }
   if (kVerboseMode) {
+    LOG(INFO) << "young_gen=" << young_gen_;
     LOG(INFO) << "force_evacuate_all=" << force_evacuate_all_;
     LOG(INFO) << "Immune region: " << immune_region_.Begin() << "-" << immune_region_.End();
     LOG(INFO) << "GC end of InitializePhase";
@@ -177,6 +206,10 @@ class ThreadFlipVisitor : public Closure {
     if (kUseThreadLocalAllocationStack) {
       thread->RevokeThreadLocalAllocationStack();
     }
+    if (kUseReadBarrier) {
+      // Enable the GC root read barriers of compiled code before the thread resumes.
+      thread->SetIsGcMarking(true);
+    }
     ReaderMutexLock mu(self, *Locks::heap_bitmap_lock_);
     thread->VisitRoots(concurrent_copying_);
     concurrent_copying_->GetBarrier().Pass(self);
@@ -201,14 +234,27 @@ class FlipCallback : public Closure {
     Thread* self = Thread::Current();
     CHECK(thread == self);
     Locks::mutator_lock_->AssertExclusiveHeld(self);
-    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_);
+    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_, cc->young_gen_);
     cc->SwapStacks(self);
     if (ConcurrentCopying::kEnableFromSpaceAccountingCheck) {
       cc->RecordLiveStackFreezeSize(self);
-      cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
-      cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      if (cc->young_gen_) {
+        // The old regions stay in the to-space.
+        cc->from_space_num_objects_at_first_pause_ =
+            cc->region_space_->GetObjectsAllocatedInFromSpace() +
+            cc->region_space_->GetObjectsAllocatedInUnevacFromSpace();
+        cc->from_space_num_bytes_at_first_pause_ =
+            cc->region_space_->GetBytesAllocatedInFromSpace() +
+            cc->region_space_->GetBytesAllocatedInUnevacFromSpace();
+      } else {
+        cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
+        cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      }
     }
     cc->is_marking_ = true;
+    if (cc->young_gen_) {
+      cc->GrayDirtyOldObjects(self);
+    }
     if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
       CHECK(Runtime::Current()->IsAotCompiler());
       TimingLogger::ScopedTiming split2("(Paused)VisitTransactionRoots", cc->GetTimings());
@@ -256,6 +302,80 @@ void ConcurrentCopying::RecordLiveStackFreezeSize(Thread* self) {
   live_stack_freeze_size_ = heap_->GetLiveStack()->Size();
 }
 
+// Used to gray the marked objects of the old regions on dirty cards.
+class ConcurrentCopyingGrayDirtyObjectVisitor {
+ public:
+  explicit ConcurrentCopyingGrayDirtyObjectVisitor(ConcurrentCopying* cc)
+      : collector_(cc) {}
+
+  void operator()(mirror::Object* obj) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_) {
+    DCHECK(obj != nullptr);
+    DCHECK(collector_->region_space_->IsInToSpace(obj)) << obj;
+    // This may or may not succeed, which is ok. A card scan visits an object only once.
+    if (kUseBakerReadBarrier) {
+      obj->AtomicSetReadBarrierPointer(ReadBarrier::WhitePtr(), ReadBarrier::GrayPtr());
+    }
+    collector_->PushOntoMarkStack<true>(obj);
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+};
+
+// Used to mark the objects of the non-moving spaces on dirty cards.
+class ConcurrentCopyingMarkDirtyObjectVisitor {
+ public:
+  explicit ConcurrentCopyingMarkDirtyObjectVisitor(ConcurrentCopying* cc)
+      : collector_(cc) {}
+
+  void operator()(mirror::Object* obj) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_) {
+    DCHECK(obj != nullptr);
+    collector_->Mark(obj);
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+};
+
+// A young collection does not trace the old objects. Treat the old objects that were written
+// to since the last collection, which are the only ones that may refer to young objects, as
+// roots instead.
+void ConcurrentCopying::GrayDirtyOldObjects(Thread* self) {
+  TimingLogger::ScopedTiming split("(Paused)GrayDirtyOldObjects", GetTimings());
+  DCHECK(young_gen_);
+  WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
+  accounting::CardTable* card_table = heap_->GetCardTable();
+  // The old objects of the region space. The young regions have no marks.
+  ConcurrentCopyingGrayDirtyObjectVisitor gray_visitor(this);
+  size_t cards_scanned = card_table->Scan<true>(region_space_bitmap_, region_space_->Begin(),
+                                                region_space_->Limit(), gray_visitor);
+  // The non-moving spaces. The large objects only refer to their classes, which are not
+  // younger than they are.
+  ConcurrentCopyingMarkDirtyObjectVisitor mark_visitor(this);
+  for (const auto& space : heap_->GetContinuousSpaces()) {
+    if (space == region_space_ || immune_region_.ContainsSpace(space) ||
+        space->GetLiveBitmap() == nullptr) {
+      continue;
+    }
+    cards_scanned += card_table->Scan<true>(space->GetLiveBitmap(), space->Begin(),
+                                            space->End(), mark_visitor);
+  }
+  // The objects allocated in the non-moving spaces since the last collection are not in the
+  // live bitmaps yet.
+  accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+  for (auto* it = live_stack->Begin(), *end = live_stack->End(); it < end; ++it) {
+    mirror::Object* const obj = it->AsMirrorPtr();
+    if (obj != nullptr && obj->GetClass<kVerifyNone, kWithoutReadBarrier>() != nullptr) {
+      Mark(obj);
+    }
+  }
+  if (kVerboseMode) {
+    LOG(INFO) << "GrayDirtyOldObjects: cards_scanned=" << cards_scanned;
+  }
+}
+
 // Used to visit objects in the immune spaces.
 class ConcurrentCopyingImmuneSpaceObjVisitor {
  public:
@@ -412,13 +532,15 @@ void ConcurrentCopying::MarkingPhase() {
     // the mark stack here once again.
     ProcessMarkStack();
     CheckEmptyMarkQueue();
+    // No more copying. Give the unused ends of the PLABs back as skipped blocks.
+    RevokePlabs();
     // Disable marking.
     if (kUseTableLookupReadBarrier) {
       heap_->rb_table_->ClearAll();
       DCHECK(heap_->rb_table_->IsAllCleared());
     }
     is_mark_queue_push_disallowed_.StoreSequentiallyConsistent(1);
-    is_marking_ = false;
+    DisableMarking(self);
     if (kVerboseMode) {
       LOG(INFO) << "AllowNewSystemWeaks";
     }
@@ -431,6 +553,19 @@ void ConcurrentCopying::MarkingPhase() {
   }
 }
 
+void ConcurrentCopying::DisableMarking(Thread* self) {
+  // Switch off the GC root read barriers of compiled code together with is_marking_ so that
+  // threads attaching concurrently see a consistent state. Threads that still take the slow
+  // path until they observe the change only mark objects that are already marked.
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  is_marking_ = false;
+  if (kUseReadBarrier) {
+    for (Thread* thread : Runtime::Current()->GetThreadList()->GetList()) {
+      thread->SetIsGcMarking(false);
+    }
+  }
+}
+
 void ConcurrentCopying::IssueEmptyCheckpoint() {
   Thread* self = Thread::Current();
   EmptyCheckpoint check_point(this);
@@ -466,6 +601,149 @@ void ConcurrentCopying::PushOntoMarkStack(mirror::Object* to_ref) {
   }
 }
 
+// A chunk of the mark queue processed by a GC worker thread. The objects that the task marks
+// are pushed onto its thread-local mark stack instead of the shared mark queue, and the objects
+// that it copies go to its PLAB. When the mark stack overflows, half of it is given to the
+// thread pool as a new task so that idle workers can take it. This is work sharing, as in
+// MarkSweep, rather than a WorkStealingTask: a WorkStealingThreadPool has its own workers instead
+// of the heap's thread pool, and stealing would pop from the mark stack of another task while its
+// owner pushes onto it, which needs a lock or a concurrent deque on every push.
+class ConcurrentCopyingMarkStackTask : public Task {
+ public:
+  ConcurrentCopyingMarkStackTask(ThreadPool* thread_pool, ConcurrentCopying* cc)
+      : collector_(cc), thread_pool_(thread_pool), mark_stack_pos_(0), plab_(nullptr) {
+  }
+
+  static constexpr size_t kMaxSize = 1 * KB;
+
+  ALWAYS_INLINE void MarkStackPush(mirror::Object* obj)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    if (UNLIKELY(mark_stack_pos_ == kMaxSize)) {
+      // Mark stack overflow, give 1/2 the stack to the thread pool as a new work task.
+      mark_stack_pos_ /= 2;
+      auto* task = new ConcurrentCopyingMarkStackTask(thread_pool_, collector_);
+      for (size_t i = mark_stack_pos_; i < kMaxSize; ++i) {
+        task->MarkStackPush(mark_stack_[i]);
+      }
+      thread_pool_->AddTask(Thread::Current(), task);
+    }
+    DCHECK(obj != nullptr);
+    DCHECK_LT(mark_stack_pos_, kMaxSize);
+    mark_stack_[mark_stack_pos_++] = obj;
+  }
+
+  ConcurrentCopying::Plab* GetPlab() const {
+    return plab_;
+  }
+
+  virtual void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // The GC thread holds the mutator lock on behalf of the worker threads.
+    plab_ = collector_->AcquirePlab();
+    while (mark_stack_pos_ != 0) {
+      mirror::Object* obj = mark_stack_[--mark_stack_pos_];
+      collector_->ProcessMarkStackRef(obj, this);
+    }
+    collector_->ReleasePlab(plab_);
+    plab_ = nullptr;
+  }
+
+  virtual void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+  ThreadPool* const thread_pool_;
+  // Thread local mark stack for this task.
+  mirror::Object* mark_stack_[kMaxSize];
+  // Mark stack position.
+  size_t mark_stack_pos_;
+  // The PLAB of the worker thread while the task runs.
+  ConcurrentCopying::Plab* plab_;
+};
+
+inline void ConcurrentCopying::PushOntoMarkStack(mirror::Object* to_ref,
+                                                 ConcurrentCopyingMarkStackTask* task) {
+  if (task != nullptr) {
+    task->MarkStackPush(to_ref);
+  } else {
+    PushOntoMarkStack<true>(to_ref);
+  }
+}
+
+ConcurrentCopying::Plab* ConcurrentCopying::AcquirePlab() {
+  MutexLock mu(Thread::Current(), plabs_lock_);
+  if (free_plabs_.empty()) {
+    return new Plab();
+  }
+  Plab* plab = free_plabs_.back();
+  free_plabs_.pop_back();
+  return plab;
+}
+
+void ConcurrentCopying::ReleasePlab(Plab* plab) {
+  MutexLock mu(Thread::Current(), plabs_lock_);
+  free_plabs_.push_back(plab);
+}
+
+inline mirror::Object* ConcurrentCopying::AllocateInPlab(Plab* plab, size_t alloc_size) {
+  DCHECK(IsAligned<space::RegionSpace::kAlignment>(alloc_size));
+  if (alloc_size > kPlabMaxObjectSize) {
+    return nullptr;
+  }
+  // Never leave a gap that is too small for a dummy object.
+  const size_t min_object_size = RoundUp(sizeof(mirror::Object), space::RegionSpace::kAlignment);
+  size_t remaining = plab->end - plab->pos;
+  if (alloc_size > remaining ||
+      (alloc_size < remaining && remaining - alloc_size < min_object_size)) {
+    RetirePlab(plab);
+    uint8_t* begin = region_space_->AllocPlab(kPlabSize);
+    if (begin == nullptr) {
+      return nullptr;
+    }
+    plab->begin = begin;
+    plab->pos = begin;
+    plab->end = begin + kPlabSize;
+  }
+  mirror::Object* obj = reinterpret_cast<mirror::Object*>(plab->pos);
+  plab->pos += alloc_size;
+  return obj;
+}
+
+void ConcurrentCopying::RetirePlab(Plab* plab) {
+  if (plab->begin == nullptr) {
+    return;
+  }
+  size_t num_objects = plab->num_objects;
+  size_t unused_bytes = plab->end - plab->pos;
+  if (unused_bytes > 0) {
+    // Keep the region walkable and reuse the block like the lost copies.
+    FillWithDummyObject(reinterpret_cast<mirror::Object*>(plab->pos), unused_bytes);
+    heap_->num_bytes_allocated_.FetchAndAddSequentiallyConsistent(unused_bytes);
+    to_space_bytes_skipped_.FetchAndAddSequentiallyConsistent(unused_bytes);
+    to_space_objects_skipped_.FetchAndAddSequentiallyConsistent(1);
+    {
+      MutexLock mu(Thread::Current(), skipped_blocks_lock_);
+      skipped_blocks_map_.insert(std::make_pair(unused_bytes, plab->pos));
+    }
+    ++num_objects;
+  }
+  region_space_->RecordPlabObjects(plab->begin, num_objects);
+  *plab = Plab();
+}
+
+void ConcurrentCopying::RevokePlabs() {
+  std::vector<Plab*> plabs;
+  {
+    MutexLock mu(Thread::Current(), plabs_lock_);
+    plabs.swap(free_plabs_);
+  }
+  for (Plab* plab : plabs) {
+    RetirePlab(plab);
+    delete plab;
+  }
+}
+
 accounting::ObjectStack* ConcurrentCopying::GetAllocationStack() {
   return heap_->allocation_stack_.get();
 }
@@ -598,8 +876,18 @@ void ConcurrentCopying::VerifyNoFromSpaceReferences() {
     Runtime::Current()->VisitRoots(&ref_visitor);
   }
   // The to-space.
-  region_space_->WalkToSpace(ConcurrentCopyingVerifyNoFromSpaceRefsObjectVisitor::ObjectCallback,
-                             this);
+  if (use_generational_cc_) {
+    // The old regions keep dead objects, which may refer to freed regions. Walk the marked
+    // objects and the regions allocated since the flip only.
+    region_space_bitmap_->VisitMarkedRange(reinterpret_cast<uintptr_t>(region_space_->Begin()),
+                                           reinterpret_cast<uintptr_t>(region_space_->Limit()),
+                                           visitor);
+    region_space_->WalkNewlyAllocatedToSpace(
+        ConcurrentCopyingVerifyNoFromSpaceRefsObjectVisitor::ObjectCallback, this);
+  } else {
+    region_space_->WalkToSpace(ConcurrentCopyingVerifyNoFromSpaceRefsObjectVisitor::ObjectCallback,
+                               this);
+  }
   // Non-moving spaces.
   {
     WriterMutexLock mu(self, *Locks::heap_bitmap_lock_);
@@ -696,62 +984,106 @@ bool ConcurrentCopying::ProcessMarkStack() {
     LOG(INFO) << "ProcessMarkStack. ";
   }
   size_t count = 0;
+  size_t thread_count = GetThreadCount();
+  if (kParallelProcessMarkStack && thread_count > 1) {
+    count += ProcessMarkStackParallel(thread_count);
+  }
   mirror::Object* to_ref;
   while ((to_ref = PopOffMarkStack()) != nullptr) {
     ++count;
-    DCHECK(!region_space_->IsInFromSpace(to_ref));
-    if (kUseBakerReadBarrier) {
-      DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr())
-          << " " << to_ref << " " << to_ref->GetReadBarrierPointer()
-          << " is_marked=" << IsMarked(to_ref);
-    }
-    // Scan ref fields.
-    Scan(to_ref);
-    // Mark the gray ref as white or black.
-    if (kUseBakerReadBarrier) {
-      DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr())
-          << " " << to_ref << " " << to_ref->GetReadBarrierPointer()
-          << " is_marked=" << IsMarked(to_ref);
-    }
-    if (to_ref->GetClass<kVerifyNone, kWithoutReadBarrier>()->IsTypeOfReferenceClass() &&
-        to_ref->AsReference()->GetReferent<kWithoutReadBarrier>() != nullptr &&
-        !IsInToSpace(to_ref->AsReference()->GetReferent<kWithoutReadBarrier>())) {
-      // Leave References gray so that GetReferent() will trigger RB.
-      CHECK(to_ref->AsReference()->IsEnqueued()) << "Left unenqueued ref gray " << to_ref;
-    } else {
+    ProcessMarkStackRef(to_ref, nullptr);
+  }
+  // Return true if the stack was empty.
+  return count == 0;
+}
+
+inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref,
+                                                   ConcurrentCopyingMarkStackTask* task) {
+  DCHECK(!region_space_->IsInFromSpace(to_ref));
+  if (kUseBakerReadBarrier) {
+    DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr())
+        << " " << to_ref << " " << to_ref->GetReadBarrierPointer()
+        << " is_marked=" << IsMarked(to_ref);
+  }
+  // Scan ref fields.
+  Scan(to_ref, task);
+  // Mark the gray ref as white or black.
+  if (kUseBakerReadBarrier) {
+    DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr())
+        << " " << to_ref << " " << to_ref->GetReadBarrierPointer()
+        << " is_marked=" << IsMarked(to_ref);
+  }
+  if (to_ref->GetClass<kVerifyNone, kWithoutReadBarrier>()->IsTypeOfReferenceClass() &&
+      to_ref->AsReference()->GetReferent<kWithoutReadBarrier>() != nullptr &&
+      !IsInToSpace(to_ref->AsReference()->GetReferent<kWithoutReadBarrier>())) {
+    // Leave References gray so that GetReferent() will trigger RB.
+    CHECK(to_ref->AsReference()->IsEnqueued()) << "Left unenqueued ref gray " << to_ref;
+  } else {
 #ifdef USE_BAKER_OR_BROOKS_READ_BARRIER
-      if (kUseBakerReadBarrier) {
-        if (region_space_->IsInToSpace(to_ref)) {
-          // If to-space, change from gray to white.
-          bool success = to_ref->AtomicSetReadBarrierPointer(ReadBarrier::GrayPtr(),
-                                                             ReadBarrier::WhitePtr());
-          CHECK(success) << "Must succeed as we won the race.";
-          CHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::WhitePtr());
-        } else {
-          // If non-moving space/unevac from space, change from gray
-          // to black. We can't change gray to white because it's not
-          // safe to use CAS if two threads change values in opposite
-          // directions (A->B and B->A). So, we change it to black to
-          // indicate non-moving objects that have been marked
-          // through. Note we'd need to change from black to white
-          // later (concurrently).
-          bool success = to_ref->AtomicSetReadBarrierPointer(ReadBarrier::GrayPtr(),
-                                                             ReadBarrier::BlackPtr());
-          CHECK(success) << "Must succeed as we won the race.";
-          CHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::BlackPtr());
-        }
+    if (kUseBakerReadBarrier) {
+      if (region_space_->IsInToSpace(to_ref)) {
+        // If to-space, change from gray to white.
+        bool success = to_ref->AtomicSetReadBarrierPointer(ReadBarrier::GrayPtr(),
+                                                           ReadBarrier::WhitePtr());
+        CHECK(success) << "Must succeed as we won the race.";
+        CHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::WhitePtr());
+      } else {
+        // If non-moving space/unevac from space, change from gray
+        // to black. We can't change gray to white because it's not
+        // safe to use CAS if two threads change values in opposite
+        // directions (A->B and B->A). So, we change it to black to
+        // indicate non-moving objects that have been marked
+        // through. Note we'd need to change from black to white
+        // later (concurrently).
+        bool success = to_ref->AtomicSetReadBarrierPointer(ReadBarrier::GrayPtr(),
+                                                           ReadBarrier::BlackPtr());
+        CHECK(success) << "Must succeed as we won the race.";
+        CHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::BlackPtr());
       }
+    }
 #else
-      DCHECK(!kUseBakerReadBarrier);
+    DCHECK(!kUseBakerReadBarrier);
 #endif
+  }
+  if (ReadBarrier::kEnableToSpaceInvariantChecks || kIsDebugBuild) {
+    ConcurrentCopyingAssertToSpaceInvariantObjectVisitor visitor(this);
+    visitor(to_ref);
+  }
+}
+
+size_t ConcurrentCopying::ProcessMarkStackParallel(size_t thread_count) {
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  size_t count = 0;
+  // Mutators keep pushing onto the mark queue through the read barriers. Hand the mark queue to
+  // the worker threads until it's small.
+  for (size_t size = mark_queue_.Size(); size >= kMinimumParallelMarkStackSize;
+       size = mark_queue_.Size()) {
+    const size_t chunk_size = std::min(size / thread_count + 1,
+                                       ConcurrentCopyingMarkStackTask::kMaxSize);
+    for (size_t i = 0; i < size; ) {
+      auto* task = new ConcurrentCopyingMarkStackTask(thread_pool, this);
+      for (size_t j = 0; j < chunk_size && i < size; ++j, ++i) {
+        mirror::Object* to_ref = PopOffMarkStack();
+        DCHECK(to_ref != nullptr) << "The single consumer can dequeue at least the size";
+        task->MarkStackPush(to_ref);
+      }
+      thread_pool->AddTask(self, task);
     }
-    if (ReadBarrier::kEnableToSpaceInvariantChecks || kIsDebugBuild) {
-      ConcurrentCopyingAssertToSpaceInvariantObjectVisitor visitor(this);
-      visitor(to_ref);
-    }
+    count += size;
+    thread_pool->SetMaxActiveWorkers(thread_count - 1);
+    thread_pool->StartWorkers(self);
+    thread_pool->Wait(self, true, true);
+    thread_pool->StopWorkers(self);
   }
-  // Return true if the stack was empty.
-  return count == 0;
+  return count;
+}
+
+size_t ConcurrentCopying::GetThreadCount() const {
+  if (heap_->GetThreadPool() == nullptr || !heap_->CareAboutPauseTimes()) {
+    return 1;
+  }
+  return heap_->GetConcGCThreadCount() + 1;
 }
 
 void ConcurrentCopying::CheckEmptyMarkQueue() {
@@ -777,16 +1109,18 @@ void ConcurrentCopying::SweepSystemWeaks(Thread* self) {
   Runtime::Current()->SweepSystemWeaks(IsMarkedCallback, this);
 }
 
-void ConcurrentCopying::Sweep(bool swap_bitmaps) {
-  {
-    TimingLogger::ScopedTiming t("MarkStackAsLive", GetTimings());
-    accounting::ObjectStack* live_stack = heap_->GetLiveStack();
-    if (kEnableFromSpaceAccountingCheck) {
-      CHECK_GE(live_stack_freeze_size_, live_stack->Size());
-    }
-    heap_->MarkAllocStackAsLive(live_stack);
-    live_stack->Reset();
+void ConcurrentCopying::MarkLiveStackAsLive() {
+  TimingLogger::ScopedTiming t("MarkStackAsLive", GetTimings());
+  accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+  if (kEnableFromSpaceAccountingCheck) {
+    CHECK_GE(live_stack_freeze_size_, live_stack->Size());
   }
+  heap_->MarkAllocStackAsLive(live_stack);
+  live_stack->Reset();
+}
+
+void ConcurrentCopying::Sweep(bool swap_bitmaps) {
+  MarkLiveStackAsLive();
   CHECK(mark_queue_.IsEmpty());
   TimingLogger::ScopedTiming split("Sweep", GetTimings());
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
@@ -929,7 +1263,11 @@ void ConcurrentCopying::ReclaimPhase() {
 
   {
     TimingLogger::ScopedTiming split4("ClearFromSpace", GetTimings());
-    region_space_->ClearFromSpace();
+    uint64_t cleared_unevac_bytes;
+    uint64_t cleared_unevac_objects;
+    region_space_->ClearFromSpace(&cleared_unevac_bytes, &cleared_unevac_objects);
+    // The dead large objects that were marked in place.
+    RecordFree(ObjectBytePair(cleared_unevac_objects, cleared_unevac_bytes));
   }
 
   {
@@ -937,10 +1275,19 @@ void ConcurrentCopying::ReclaimPhase() {
     if (kUseBakerReadBarrier) {
       ClearBlackPtrs();
     }
-    Sweep(false);
-    SwapBitmaps();
+    if (young_gen_) {
+      // The non-moving spaces are old and not swept. Keep the objects allocated in them since
+      // the last collection.
+      MarkLiveStackAsLive();
+    } else {
+      Sweep(false);
+      SwapBitmaps();
+    }
     heap_->UnBindBitmaps();
 
+    if (use_generational_cc_) {
+      cc_heap_bitmap_->RemoveContinuousSpaceBitmap(region_space_bitmap_);
+    }
     // Remove bitmaps for the immune spaces.
     while (!cc_bitmaps_.empty()) {
       accounting::ContinuousSpaceBitmap* cc_bitmap = cc_bitmaps_.back();
@@ -982,11 +1329,25 @@ class ConcurrentCopyingComputeUnevacFromSpaceLiveRatioVisitor {
 
 // Compute how much live objects are left in regions.
 void ConcurrentCopying::ComputeUnevacFromSpaceLiveRatio() {
-  region_space_->AssertAllRegionLiveBytesZeroOrCleared();
+  region_space_->AssertAllRegionLiveBytesZeroOrCleared(young_gen_);
   ConcurrentCopyingComputeUnevacFromSpaceLiveRatioVisitor visitor(this);
-  region_space_bitmap_->VisitMarkedRange(reinterpret_cast<uintptr_t>(region_space_->Begin()),
-                                         reinterpret_cast<uintptr_t>(region_space_->Limit()),
-                                         visitor);
+  if (use_generational_cc_) {
+    // The bitmap also has the marks of the old and the copied objects. Visit the unevac
+    // from-space regions only.
+    for (uint8_t* addr = region_space_->Begin(); addr < region_space_->Limit();
+         addr += space::RegionSpace::kRegionSize) {
+      if (region_space_->IsInUnevacFromSpace(reinterpret_cast<mirror::Object*>(addr))) {
+        region_space_bitmap_->VisitMarkedRange(
+            reinterpret_cast<uintptr_t>(addr),
+            reinterpret_cast<uintptr_t>(addr + space::RegionSpace::kRegionSize),
+            visitor);
+      }
+    }
+  } else {
+    region_space_bitmap_->VisitMarkedRange(reinterpret_cast<uintptr_t>(region_space_->Begin()),
+                                           reinterpret_cast<uintptr_t>(region_space_->Limit()),
+                                           visitor);
+  }
 }
 
 // Assert the to-space invariant.
@@ -1098,13 +1459,14 @@ void ConcurrentCopying::AssertToSpaceInvariant(mirror::Object* obj, MemberOffset
 // Used to scan ref fields of an object.
 class ConcurrentCopyingRefFieldsVisitor {
  public:
-  explicit ConcurrentCopyingRefFieldsVisitor(ConcurrentCopying* collector)
-      : collector_(collector) {}
+  ConcurrentCopyingRefFieldsVisitor(ConcurrentCopying* collector,
+                                    ConcurrentCopyingMarkStackTask* task)
+      : collector_(collector), task_(task) {}
 
   void operator()(mirror::Object* obj, MemberOffset offset, bool /* is_static */)
       const ALWAYS_INLINE SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       SHARED_LOCKS_REQUIRED(Locks::heap_bitmap_lock_) {
-    collector_->Process(obj, offset);
+    collector_->Process(obj, offset, task_);
   }
 
   void operator()(mirror::Class* klass, mirror::Reference* ref) const
@@ -1115,22 +1477,31 @@ class ConcurrentCopyingRefFieldsVisitor {
 
  private:
   ConcurrentCopying* const collector_;
+  ConcurrentCopyingMarkStackTask* const task_;
 };
 
 // Scan ref fields of an object.
-void ConcurrentCopying::Scan(mirror::Object* to_ref) {
+void ConcurrentCopying::Scan(mirror::Object* to_ref, ConcurrentCopyingMarkStackTask* task) {
   DCHECK(!region_space_->IsInFromSpace(to_ref));
-  ConcurrentCopyingRefFieldsVisitor visitor(this);
+  ConcurrentCopyingRefFieldsVisitor visitor(this, task);
   to_ref->VisitReferences<true>(visitor, visitor);
 }
 
 // Process a field.
-inline void ConcurrentCopying::Process(mirror::Object* obj, MemberOffset offset) {
+inline void ConcurrentCopying::Process(mirror::Object* obj, MemberOffset offset,
+                                       ConcurrentCopyingMarkStackTask* task) {
   mirror::Object* ref = obj->GetFieldObject<mirror::Object, kVerifyNone, kWithoutReadBarrier, false>(offset);
-  if (ref == nullptr || region_space_->IsInToSpace(ref)) {
+  if (ref == nullptr) {
+    return;
+  }
+  if (region_space_->IsInToSpace(ref)) {
+    if (use_generational_cc_ && region_space_->IsInNewlyAllocatedToSpace(ref)) {
+      // obj survives this collection and refers to an object that is young in the next one.
+      heap_->GetCardTable()->MarkCard(obj);
+    }
     return;
   }
-  mirror::Object* to_ref = Mark(ref);
+  mirror::Object* to_ref = Mark(ref, task);
   if (to_ref == ref) {
     return;
   }
@@ -1281,7 +1652,8 @@ mirror::Object* ConcurrentCopying::AllocateInSkippedBlock(size_t alloc_size) {
   return reinterpret_cast<mirror::Object*>(addr);
 }
 
-mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
+mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref,
+                                        ConcurrentCopyingMarkStackTask* task) {
   DCHECK(region_space_->IsInFromSpace(from_ref));
   // No read barrier to avoid nested RB that might violate the to-space
   // invariant. Note that from_ref is a from space ref so the SizeOf()
@@ -1292,11 +1664,22 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
   size_t non_moving_space_bytes_allocated = 0U;
   size_t bytes_allocated = 0U;
   size_t dummy;
-  mirror::Object* to_ref = region_space_->AllocNonvirtual<true>(
-      region_space_alloc_size, &region_space_bytes_allocated, nullptr, &dummy);
-  bytes_allocated = region_space_bytes_allocated;
+  // GC worker threads copy into their PLABs to avoid contending on the evacuation region.
+  Plab* plab = task != nullptr ? task->GetPlab() : nullptr;
+  mirror::Object* to_ref = nullptr;
+  if (plab != nullptr) {
+    to_ref = AllocateInPlab(plab, region_space_alloc_size);
+  }
   if (to_ref != nullptr) {
-    DCHECK_EQ(region_space_alloc_size, region_space_bytes_allocated);
+    bytes_allocated = region_space_alloc_size;
+  } else {
+    plab = nullptr;
+    to_ref = region_space_->AllocNonvirtual<true>(
+        region_space_alloc_size, &region_space_bytes_allocated, nullptr, &dummy);
+    bytes_allocated = region_space_bytes_allocated;
+    if (to_ref != nullptr) {
+      DCHECK_EQ(region_space_alloc_size, region_space_bytes_allocated);
+    }
   }
   bool fall_back_to_non_moving = false;
   if (UNLIKELY(to_ref == nullptr)) {
@@ -1344,8 +1727,12 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
       // the forwarding pointer first. Make the lost copy (to_ref)
       // look like a valid but dead (dummy) object and keep it for
       // future reuse.
-      FillWithDummyObject(to_ref, bytes_allocated);
-      if (!fall_back_to_non_moving) {
+      if (plab != nullptr) {
+        // The lost copy is at the end of the PLAB. Give the space back to the PLAB.
+        DCHECK_EQ(reinterpret_cast<uint8_t*>(to_ref) + bytes_allocated, plab->pos);
+        plab->pos = reinterpret_cast<uint8_t*>(to_ref);
+      } else if (!fall_back_to_non_moving) {
+        FillWithDummyObject(to_ref, bytes_allocated);
         DCHECK(region_space_->IsInToSpace(to_ref));
         if (bytes_allocated > space::RegionSpace::kRegionSize) {
           // Free the large alloc.
@@ -1360,6 +1747,7 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
                                                     reinterpret_cast<uint8_t*>(to_ref)));
         }
       } else {
+        FillWithDummyObject(to_ref, bytes_allocated);
         DCHECK(heap_->non_moving_space_->HasAddress(to_ref));
         DCHECK_EQ(bytes_allocated, non_moving_space_bytes_allocated);
         // Free the non-moving-space chunk.
@@ -1393,18 +1781,29 @@ mirror::Object* ConcurrentCopying::Copy(mirror::Object* from_ref) {
       // The CAS succeeded.
       objects_moved_.FetchAndAddSequentiallyConsistent(1);
       bytes_moved_.FetchAndAddSequentiallyConsistent(region_space_alloc_size);
+      if (plab != nullptr) {
+        ++plab->num_objects;
+      }
       if (LIKELY(!fall_back_to_non_moving)) {
         DCHECK(region_space_->IsInToSpace(to_ref));
+        if (use_generational_cc_) {
+          // The copy is old. Keep its mark for the following young collections.
+          region_space_bitmap_->AtomicTestAndSet(to_ref);
+        }
       } else {
         DCHECK(heap_->non_moving_space_->HasAddress(to_ref));
         DCHECK_EQ(bytes_allocated, non_moving_space_bytes_allocated);
+        if (young_gen_) {
+          // A young collection does not swap the bitmaps of the non-moving space.
+          heap_->non_moving_space_->GetLiveBitmap()->AtomicTestAndSet(to_ref);
+        }
       }
       if (kUseBakerReadBarrier) {
         DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr());
       }
       DCHECK(GetFwdPtr(from_ref) == to_ref);
       CHECK_NE(to_ref->GetLockWord(false).GetState(), LockWord::kForwardingAddress);
-      PushOntoMarkStack<true>(to_ref);
+      PushOntoMarkStack(to_ref, task);
       return to_ref;
     } else {
       // The CAS failed. It may have lost the race or may have failed
@@ -1485,7 +1884,8 @@ bool ConcurrentCopying::IsOnAllocStack(mirror::Object* ref) {
   return alloc_stack->Contains(ref);
 }
 
-mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
+mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref,
+                                        ConcurrentCopyingMarkStackTask* task) {
   if (from_ref == nullptr) {
     return nullptr;
   }
@@ -1519,7 +1919,7 @@ mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
     }
     if (to_ref == nullptr) {
       // It isn't marked yet. Mark it by copying it to the to-space.
-      to_ref = Copy(from_ref);
+      to_ref = Copy(from_ref, task);
     }
     DCHECK(region_space_->IsInToSpace(to_ref) || heap_->non_moving_space_->HasAddress(to_ref))
         << "from_ref=" << from_ref << " to_ref=" << to_ref;
@@ -1537,7 +1937,7 @@ mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
       if (kUseBakerReadBarrier) {
         DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr());
       }
-      PushOntoMarkStack<true>(to_ref);
+      PushOntoMarkStack(to_ref, task);
     }
   } else {
     // from_ref is in a non-moving space.
@@ -1564,7 +1964,7 @@ mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
         if (kUseBakerReadBarrier) {
           DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr());
         }
-        PushOntoMarkStack<true>(to_ref);
+        PushOntoMarkStack(to_ref, task);
       }
     } else {
       // Use the mark bitmap.
@@ -1620,7 +2020,7 @@ mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
             if (kUseBakerReadBarrier) {
               DCHECK(to_ref->GetReadBarrierPointer() == ReadBarrier::GrayPtr());
             }
-            PushOntoMarkStack<true>(to_ref);
+            PushOntoMarkStack(to_ref, task);
           }
         }
       }
@@ -1630,6 +2030,10 @@ mirror::Object* ConcurrentCopying::Mark(mirror::Object* from_ref) {
 }
 
 void ConcurrentCopying::FinishPhase() {
+  {
+    MutexLock mu(Thread::Current(), plabs_lock_);
+    CHECK(free_plabs_.empty());
+  }
   region_space_ = nullptr;
   CHECK(mark_queue_.IsEmpty());
   mark_queue_.Clear();
@@ -49,6 +49,8 @@ namespace space {
 
 namespace collector {
 
+class ConcurrentCopyingMarkStackTask;
+
 // Concurrent queue. Used as the mark stack. TODO: use a concurrent
 // stack for locality.
 class MarkQueue {
@@ -118,6 +120,13 @@ class MarkQueue {
     return h == t;
   }
 
+  // The number of elements that the consumer can at least dequeue.
+  size_t Size() {
+    size_t h = head_.LoadSequentiallyConsistent();
+    size_t t = tail_.LoadSequentiallyConsistent();
+    return t - h;
+  }
+
   void Clear() {
     head_.StoreRelaxed(0);
     tail_.StoreRelaxed(0);
@@ -142,7 +151,9 @@ class ConcurrentCopying : public GarbageCollector {
   // Enable verbose mode.
   static constexpr bool kVerboseMode = true;
 
-  ConcurrentCopying(Heap* heap, const std::string& name_prefix = "");
+  // If young_gen is true, the collector only collects the regions allocated by mutators since
+  // the last collection, see RegionSpace::SetFromSpace().
+  ConcurrentCopying(Heap* heap, bool young_gen = false, const std::string& name_prefix = "");
   ~ConcurrentCopying();
 
   virtual void RunPhases() OVERRIDE;
@@ -154,7 +165,7 @@ class ConcurrentCopying : public GarbageCollector {
   void BindBitmaps() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
       LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
   virtual GcType GetGcType() const OVERRIDE {
-    return kGcTypePartial;
+    return young_gen_ ? kGcTypeSticky : kGcTypePartial;
   }
   virtual CollectorType GetCollectorType() const OVERRIDE {
     return kCollectorTypeCC;
@@ -173,7 +184,10 @@ class ConcurrentCopying : public GarbageCollector {
     DCHECK(ref != nullptr);
     return IsMarked(ref) == ref;
   }
-  mirror::Object* Mark(mirror::Object* from_ref) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Mark from_ref. If task is not null, newly marked objects are pushed onto the task's mark
+  // stack rather than the shared mark queue, and objects are copied into the task's PLAB.
+  mirror::Object* Mark(mirror::Object* from_ref, ConcurrentCopyingMarkStackTask* task = nullptr)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   bool IsMarking() const {
     return is_marking_;
   }
@@ -185,12 +199,24 @@ class ConcurrentCopying : public GarbageCollector {
   }
 
  private:
+  // A copy buffer of a GC worker thread, see RegionSpace::AllocPlab().
+  struct Plab {
+    uint8_t* begin = nullptr;
+    uint8_t* pos = nullptr;
+    uint8_t* end = nullptr;
+    size_t num_objects = 0;  // The number of objects copied into the PLAB.
+  };
+
   mirror::Object* PopOffMarkStack();
   template<bool kThreadSafe>
   void PushOntoMarkStack(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  mirror::Object* Copy(mirror::Object* from_ref) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  void Scan(mirror::Object* to_ref) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
-  void Process(mirror::Object* obj, MemberOffset offset)
+  void PushOntoMarkStack(mirror::Object* obj, ConcurrentCopyingMarkStackTask* task)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  mirror::Object* Copy(mirror::Object* from_ref, ConcurrentCopyingMarkStackTask* task)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void Scan(mirror::Object* to_ref, ConcurrentCopyingMarkStackTask* task)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void Process(mirror::Object* obj, MemberOffset offset, ConcurrentCopyingMarkStackTask* task)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   virtual void VisitRoots(mirror::Object*** roots, size_t count, const RootInfo& info)
       OVERRIDE SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -201,6 +227,21 @@ class ConcurrentCopying : public GarbageCollector {
   accounting::ObjectStack* GetAllocationStack();
   accounting::ObjectStack* GetLiveStack();
   bool ProcessMarkStack() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Scan a gray object popped off a mark stack and turn it white or black.
+  void ProcessMarkStackRef(mirror::Object* to_ref, ConcurrentCopyingMarkStackTask* task)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Process the mark queue with the heap thread pool. Returns the number of objects that were
+  // taken off the mark queue.
+  size_t ProcessMarkStackParallel(size_t thread_count) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  size_t GetThreadCount() const;
+  Plab* AcquirePlab() LOCKS_EXCLUDED(plabs_lock_);
+  void ReleasePlab(Plab* plab) LOCKS_EXCLUDED(plabs_lock_);
+  mirror::Object* AllocateInPlab(Plab* plab, size_t alloc_size)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  // Fill the unused end of the PLAB with a dummy object, which is recorded as a skipped block,
+  // and record the objects of the PLAB in the region space.
+  void RetirePlab(Plab* plab) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void RevokePlabs() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(plabs_lock_);
   void DelayReferenceReferent(mirror::Class* klass, mirror::Reference* reference)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void ProcessReferences(Thread* self, bool concurrent)
@@ -229,6 +270,8 @@ class ConcurrentCopying : public GarbageCollector {
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void CheckEmptyMarkQueue() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void IssueEmptyCheckpoint() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  void DisableMarking(Thread* self) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      LOCKS_EXCLUDED(Locks::thread_list_lock_);
   bool IsOnAllocStack(mirror::Object* ref) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   mirror::Object* GetFwdPtr(mirror::Object* from_ref)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -236,6 +279,11 @@ class ConcurrentCopying : public GarbageCollector {
   void SwapStacks(Thread* self) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
   void RecordLiveStackFreezeSize(Thread* self);
   void ComputeUnevacFromSpaceLiveRatio();
+  void MarkLiveStackAsLive() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::heap_bitmap_lock_);
+  // Gray the old objects on dirty cards, which may refer to young objects. Called in the flip
+  // pause of a young collection.
+  void GrayDirtyOldObjects(Thread* self) EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
 
   space::RegionSpace* region_space_;      // The underlying region space.
   std::unique_ptr<Barrier> gc_barrier_;
@@ -269,6 +317,17 @@ class ConcurrentCopying : public GarbageCollector {
   accounting::ReadBarrierTable* rb_table_;
   bool force_evacuate_all_;  // True if all regions are evacuated.
 
+  // The PLABs that no GC worker task uses at the moment. Retired at the end of marking.
+  Mutex plabs_lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  std::vector<Plab*> free_plabs_ GUARDED_BY(plabs_lock_);
+
+  // True if this collector collects the young regions only.
+  const bool young_gen_;
+  // True if the heap alternates young and full collections. The region space bitmap is then
+  // the region mark bitmap of the region space, which keeps the marks of the old objects, and
+  // the card table records the old objects that may refer to young objects.
+  const bool use_generational_cc_;
+
   friend class ConcurrentCopyingRefFieldsVisitor;
   friend class ConcurrentCopyingImmuneSpaceObjVisitor;
   friend class ConcurrentCopyingVerifyNoFromSpaceRefsVisitor;
@@ -278,6 +337,9 @@ class ConcurrentCopying : public GarbageCollector {
   friend class ThreadFlipVisitor;
   friend class FlipCallback;
   friend class ConcurrentCopyingComputeUnevacFromSpaceLiveRatioVisitor;
+  friend class ConcurrentCopyingGrayDirtyObjectVisitor;
+  friend class ConcurrentCopyingMarkStackTask;
+  friend class ConcurrentCopyingMarkDirtyObjectVisitor;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(ConcurrentCopying);
 };
@@ -0,0 +1,550 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "incremental_compact.h"
+
+#include <algorithm>
+
+#include "base/logging.h"
+#include "base/mutex-inl.h"
+#include "base/timing_logger.h"
+#include "gc/accounting/card_table-inl.h"
+#include "gc/accounting/heap_bitmap-inl.h"
+#include "gc/accounting/mod_union_table.h"
+#include "gc/accounting/space_bitmap-inl.h"
+#include "gc/allocator/rosalloc.h"
+#include "gc/heap.h"
+#include "gc/reference_processor.h"
+#include "gc/space/large_object_space.h"
+#include "gc/space/rosalloc_space.h"
+#include "gc/space/space-inl.h"
+#include "lock_word.h"
+#include "mirror/class-inl.h"
+#include "mirror/object-inl.h"
+#include "mirror/reference-inl.h"
+#include "runtime.h"
+#include "thread-inl.h"
+#include "thread_list.h"
+#include "utils.h"
+
+namespace art {
+namespace gc {
+namespace collector {
+
+IncrementalCompact::IncrementalCompact(Heap* heap, const std::string& name_prefix)
+    : GarbageCollector(heap,
+                       name_prefix + (name_prefix.empty() ? "" : " ") + "incremental compact"),
+      space_(nullptr), self_(nullptr), evacuation_budget_(0), evacuated_bytes_(0),
+      evacuated_begin_(nullptr), evacuated_end_(nullptr), evacuation_failed_(false),
+      bytes_moved_(0), objects_moved_(0), copy_duration_(0) {
+}
+
+void IncrementalCompact::RunPhases() {
+  Thread* self = Thread::Current();
+  InitializePhase();
+  CHECK(!Locks::mutator_lock_->IsExclusiveHeld(self));
+  {
+    ReaderMutexLock mu(self, *Locks::mutator_lock_);
+    RecordReferencesPhase();
+  }
+  if (!evacuated_ranges_.empty()) {
+    ScopedPause pause(this);
+    GetHeap()->PreGcVerificationPaused(this);
+    GetHeap()->PrePauseRosAllocVerification(this);
+    EvacuationPhase();
+    GetHeap()->PostGcVerificationPaused(this);
+  }
+  FinishPhase();
+}
+
+void IncrementalCompact::SetSpace(space::RosAllocSpace* space) {
+  DCHECK(space != nullptr);
+  space_ = space;
+}
+
+void IncrementalCompact::InitializePhase() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  CHECK(space_ != nullptr);
+  CHECK(space_->CanMoveObjects()) << "Attempting to compact non-movable space " << *space_;
+  self_ = Thread::Current();
+  evacuated_ranges_.clear();
+  evacuated_bytes_ = 0;
+  evacuated_begin_ = nullptr;
+  evacuated_end_ = nullptr;
+  recorded_references_.clear();
+  evacuated_objects_.clear();
+  evacuation_failed_ = false;
+  bytes_moved_ = 0;
+  objects_moved_ = 0;
+  copy_duration_ = 0;
+}
+
+void IncrementalCompact::EvacuationPhase() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  // The objects allocated since the last GC are only on the allocation stack. Mark them live so
+  // that the live bitmaps have all the objects to copy and to update.
+  if (kUseThreadLocalAllocationStack) {
+    t.NewTiming("RevokeAllThreadLocalAllocationStacks");
+    heap_->RevokeAllThreadLocalAllocationStacks(self_);
+  }
+  t.NewTiming("SwapStacks");
+  heap_->SwapStacks(self_);
+  WriterMutexLock mu(self_, *Locks::heap_bitmap_lock_);
+  {
+    TimingLogger::ScopedTiming t2("MarkAllocStackAsLive", GetTimings());
+    heap_->MarkAllocStackAsLive(heap_->GetLiveStack());
+  }
+  RevokeAllThreadLocalBuffers();
+  uint64_t copy_start = NanoTime();
+  EvacuateObjects();
+  copy_duration_ = NanoTime() - copy_start;
+  // The copies were allocated in the shared current runs, revoke them too.
+  RevokeAllThreadLocalBuffers();
+  UpdateReferences();
+  heap_->GetLiveStack()->Reset();
+  t.NewTiming("EndRunEvacuation");
+  copy_start = NanoTime();
+  space_->GetRosAlloc()->EndRunEvacuation(self_);
+  // Nothing refers to the old copies anymore. Freeing them releases the pages of the runs that
+  // became empty.
+  t.NewTiming("FreeEvacuatedObjects");
+  space_->FreeList(self_, evacuated_objects_.size(), evacuated_objects_.data());
+  copy_duration_ += NanoTime() - copy_start;
+  VLOG(heap) << "Incremental compaction evacuated " << evacuated_ranges_.size() << " runs ("
+             << PrettySize(evacuated_bytes_) << " in use), moved " << objects_moved_
+             << " objects (" << PrettySize(bytes_moved_) << "), updated "
+             << recorded_references_.size() << " recorded references"
+             << (evacuation_failed_ ? ", ran out of space" : "");
+}
+
+bool IncrementalCompact::EvacuateObject(mirror::Object* obj) {
+  const size_t object_size = obj->SizeOf();
+  size_t bytes_allocated, dummy;
+  // The evacuated runs are out of the allocator, so the copy goes to another run.
+  mirror::Object* forward_address = space_->AllocThreadUnsafe(self_, object_size,
+                                                              &bytes_allocated, nullptr, &dummy);
+  if (UNLIKELY(forward_address == nullptr)) {
+    return false;
+  }
+  DCHECK(reinterpret_cast<uint8_t*>(forward_address) < evacuated_begin_ ||
+         reinterpret_cast<uint8_t*>(forward_address) >= evacuated_end_ ||
+         std::none_of(evacuated_ranges_.begin(), evacuated_ranges_.end(),
+                      [forward_address](const std::pair<uint8_t*, uint8_t*>& range) {
+                        uint8_t* addr = reinterpret_cast<uint8_t*>(forward_address);
+                        return range.first <= addr && addr < range.second;
+                      }));
+  // The copy keeps the lock word, so hash codes and monitors are preserved.
+  memcpy(forward_address, obj, object_size);
+  if (kUseBakerOrBrooksReadBarrier) {
+    obj->AssertReadBarrierPointer();
+    if (kUseBrooksReadBarrier) {
+      DCHECK_EQ(forward_address->GetReadBarrierPointer(), obj);
+      forward_address->SetReadBarrierPointer(forward_address);
+    }
+    forward_address->AssertReadBarrierPointer();
+  }
+  accounting::ContinuousSpaceBitmap* live_bitmap = space_->GetLiveBitmap();
+  live_bitmap->Clear(obj);
+  live_bitmap->Set(forward_address);
+  obj->SetLockWord(LockWord::FromForwardingAddress(reinterpret_cast<size_t>(forward_address)),
+                   false);
+  evacuated_objects_.push_back(obj);
+  ++objects_moved_;
+  bytes_moved_ += bytes_allocated;
+  return true;
+}
+
+class EvacuateObjectVisitor {
+ public:
+  explicit EvacuateObjectVisitor(IncrementalCompact* collector) : collector_(collector) {
+  }
+
+  void operator()(mirror::Object* obj) const
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_) {
+    // Leave the remaining objects in place once the space is full. Their runs are put back into
+    // the allocator as they are.
+    if (!collector_->evacuation_failed_ && !collector_->EvacuateObject(obj)) {
+      collector_->evacuation_failed_ = true;
+    }
+  }
+
+ private:
+  IncrementalCompact* const collector_;
+};
+
+void IncrementalCompact::EvacuateObjects() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  accounting::ContinuousSpaceBitmap* live_bitmap = space_->GetLiveBitmap();
+  EvacuateObjectVisitor visitor(this);
+  for (const auto& range : evacuated_ranges_) {
+    live_bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(range.first),
+                                  reinterpret_cast<uintptr_t>(range.second),
+                                  visitor);
+  }
+}
+
+inline bool IncrementalCompact::IsInEvacuatedRun(const void* addr) const {
+  const uint8_t* address = reinterpret_cast<const uint8_t*>(addr);
+  if (address < evacuated_begin_ || address >= evacuated_end_) {
+    return false;
+  }
+  // Find the last range that begins at or before the address.
+  auto it = std::upper_bound(evacuated_ranges_.begin(), evacuated_ranges_.end(), address,
+                             [](const uint8_t* a, const std::pair<uint8_t*, uint8_t*>& range) {
+                               return a < range.first;
+                             });
+  return it != evacuated_ranges_.begin() && address < (it - 1)->second;
+}
+
+inline mirror::Object* IncrementalCompact::GetForwardingAddress(mirror::Object* obj) const {
+  DCHECK(obj != nullptr);
+  uint8_t* addr = reinterpret_cast<uint8_t*>(obj);
+  if (addr < evacuated_begin_ || addr >= evacuated_end_) {
+    return obj;
+  }
+  // Only the evacuated objects have a forwarding address in their lock word.
+  LockWord lock_word = obj->GetLockWord(false);
+  if (lock_word.GetState() == LockWord::kForwardingAddress) {
+    return reinterpret_cast<mirror::Object*>(lock_word.ForwardingAddress());
+  }
+  return obj;
+}
+
+mirror::Object* IncrementalCompact::ForwardingAddressCallback(mirror::Object* obj, void* arg) {
+  return reinterpret_cast<IncrementalCompact*>(arg)->GetForwardingAddress(obj);
+}
+
+void IncrementalCompact::VisitRoots(
+    mirror::Object*** roots, size_t count, const RootInfo& info ATTRIBUTE_UNUSED) {
+  for (size_t i = 0; i < count; ++i) {
+    mirror::Object* obj = *roots[i];
+    mirror::Object* new_obj = GetForwardingAddress(obj);
+    if (obj != new_obj) {
+      *roots[i] = new_obj;
+    }
+  }
+}
+
+void IncrementalCompact::VisitRoots(
+    mirror::CompressedReference<mirror::Object>** roots, size_t count,
+    const RootInfo& info ATTRIBUTE_UNUSED) {
+  for (size_t i = 0; i < count; ++i) {
+    mirror::Object* obj = roots[i]->AsMirrorPtr();
+    mirror::Object* new_obj = GetForwardingAddress(obj);
+    if (obj != new_obj) {
+      roots[i]->Assign(new_obj);
+    }
+  }
+}
+
+inline void IncrementalCompact::UpdateHeapReference(
+    mirror::HeapReference<mirror::Object>* reference) {
+  mirror::Object* obj = reference->AsMirrorPtr();
+  if (obj != nullptr) {
+    mirror::Object* new_obj = GetForwardingAddress(obj);
+    if (obj != new_obj) {
+      reference->Assign(new_obj);
+    }
+  }
+}
+
+void IncrementalCompact::UpdateHeapReferenceCallback(
+    mirror::HeapReference<mirror::Object>* reference, void* arg) {
+  reinterpret_cast<IncrementalCompact*>(arg)->UpdateHeapReference(reference);
+}
+
+inline void IncrementalCompact::RecordHeapReference(
+    mirror::HeapReference<mirror::Object>* reference) {
+  // The mutators may store to the reference meanwhile. They dirty its card after the store, so the
+  // pause updates the reference if this load misses the new value.
+  mirror::Object* obj = reference->AsMirrorPtr();
+  if (obj != nullptr && IsInEvacuatedRun(obj)) {
+    recorded_references_.push_back(reference);
+  }
+}
+
+void IncrementalCompact::RecordHeapReferenceCallback(
+    mirror::HeapReference<mirror::Object>* reference, void* arg) {
+  reinterpret_cast<IncrementalCompact*>(arg)->RecordHeapReference(reference);
+}
+
+class IncrementalCompactRecordReferenceVisitor {
+ public:
+  explicit IncrementalCompactRecordReferenceVisitor(IncrementalCompact* collector)
+      : collector_(collector) {
+  }
+
+  void operator()(mirror::Object* obj, MemberOffset offset, bool /*is_static*/) const
+      ALWAYS_INLINE SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    collector_->RecordHeapReference(obj->GetFieldObjectReferenceAddr<kVerifyNone>(offset));
+  }
+
+  void operator()(mirror::Class* /*klass*/, mirror::Reference* ref) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    collector_->RecordHeapReference(
+        ref->GetFieldObjectReferenceAddr<kVerifyNone>(mirror::Reference::ReferentOffset()));
+  }
+
+ private:
+  IncrementalCompact* const collector_;
+};
+
+void IncrementalCompact::RecordObjectReferences(mirror::Object* obj) {
+  // The objects of the evacuated runs are updated as a whole once they are copied.
+  if (IsInEvacuatedRun(obj)) {
+    return;
+  }
+  IncrementalCompactRecordReferenceVisitor visitor(this);
+  obj->VisitReferences<kMovingClasses>(visitor, visitor);
+}
+
+class IncrementalCompactRecordObjectReferencesVisitor {
+ public:
+  explicit IncrementalCompactRecordObjectReferencesVisitor(IncrementalCompact* collector)
+      : collector_(collector) {
+  }
+
+  void operator()(mirror::Object* obj) const SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      ALWAYS_INLINE {
+    collector_->RecordObjectReferences(obj);
+  }
+
+ private:
+  IncrementalCompact* const collector_;
+};
+
+void IncrementalCompact::RecordReferencesPhase() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  // The runs in the non full run sets are neither current nor thread local runs, so they can be
+  // taken out of the allocator while the mutators allocate.
+  allocator::RosAlloc* rosalloc = space_->GetRosAlloc();
+  evacuated_bytes_ = rosalloc->BeginRunEvacuation(self_, evacuation_budget_, &evacuated_ranges_);
+  if (evacuated_ranges_.empty()) {
+    VLOG(heap) << "Incremental compaction found no sparse runs in " << *space_;
+    return;
+  }
+  std::sort(evacuated_ranges_.begin(), evacuated_ranges_.end());
+  evacuated_begin_ = evacuated_ranges_.front().first;
+  evacuated_end_ = evacuated_ranges_.back().second;
+  // From here on, the mutators dirty the cards of the objects they write. The cards of the image
+  // and zygote spaces go to their mod union tables, the other cards are aged.
+  heap_->ProcessCards(GetTimings(), false, true, false);
+  WriterMutexLock mu(self_, *Locks::heap_bitmap_lock_);
+  // The scan takes as long as the heap is large, but the mutators run meanwhile.
+  IncrementalCompactRecordObjectReferencesVisitor visitor(this);
+  for (const auto& space : heap_->GetContinuousSpaces()) {
+    accounting::ModUnionTable* table = heap_->FindModUnionTableFromSpace(space);
+    if (table != nullptr) {
+      TimingLogger::ScopedTiming t2(
+          space->IsZygoteSpace() ? "RecordZygoteModUnionTableReferences" :
+                                   "RecordImageModUnionTableReferences",
+                                   GetTimings());
+      table->UpdateAndMarkReferences(&RecordHeapReferenceCallback, this);
+    } else {
+      accounting::ContinuousSpaceBitmap* bitmap = space->GetLiveBitmap();
+      if (bitmap != nullptr) {
+        TimingLogger::ScopedTiming t2("RecordSpaceReferences", GetTimings());
+        bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(space->Begin()),
+                                 reinterpret_cast<uintptr_t>(space->End()),
+                                 visitor);
+      }
+    }
+  }
+  space::LargeObjectSpace* los = heap_->GetLargeObjectsSpace();
+  if (los != nullptr) {
+    TimingLogger::ScopedTiming t2("RecordLargeObjectReferences", GetTimings());
+    los->GetLiveBitmap()->VisitMarkedRange(reinterpret_cast<uintptr_t>(los->Begin()),
+                                           reinterpret_cast<uintptr_t>(los->End()),
+                                           visitor);
+  }
+}
+
+class IncrementalCompactUpdateReferenceVisitor {
+ public:
+  explicit IncrementalCompactUpdateReferenceVisitor(IncrementalCompact* collector)
+      : collector_(collector) {
+  }
+
+  void operator()(mirror::Object* obj, MemberOffset offset, bool /*is_static*/) const
+      ALWAYS_INLINE EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    collector_->UpdateHeapReference(obj->GetFieldObjectReferenceAddr<kVerifyNone>(offset));
+  }
+
+  void operator()(mirror::Class* /*klass*/, mirror::Reference* ref) const
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    collector_->UpdateHeapReference(
+        ref->GetFieldObjectReferenceAddr<kVerifyNone>(mirror::Reference::ReferentOffset()));
+  }
+
+ private:
+  IncrementalCompact* const collector_;
+};
+
+void IncrementalCompact::UpdateObjectReferences(mirror::Object* obj) {
+  IncrementalCompactUpdateReferenceVisitor visitor(this);
+  obj->VisitReferences<kMovingClasses>(visitor, visitor);
+}
+
+class IncrementalCompactUpdateObjectReferencesVisitor {
+ public:
+  explicit IncrementalCompactUpdateObjectReferencesVisitor(IncrementalCompact* collector)
+      : collector_(collector) {
+  }
+
+  void operator()(mirror::Object* obj) const EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
+      ALWAYS_INLINE {
+    collector_->UpdateObjectReferences(obj);
+  }
+
+ private:
+  IncrementalCompact* const collector_;
+};
+
+// Updates the large objects that are outside of the card table or on a card that is not clean.
+class IncrementalCompactUpdateLargeObjectVisitor {
+ public:
+  IncrementalCompactUpdateLargeObjectVisitor(IncrementalCompact* collector,
+                                             accounting::CardTable* card_table)
+      : collector_(collector), card_table_(card_table) {
+  }
+
+  void operator()(mirror::Object* obj) const EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    uint8_t* begin = reinterpret_cast<uint8_t*>(obj);
+    uint8_t* last = begin + obj->SizeOf() - 1;
+    if (card_table_->AddrIsInCardTable(begin) && card_table_->AddrIsInCardTable(last)) {
+      const uint8_t* card_end = card_table_->CardFromAddr(last) + 1;
+      for (const uint8_t* card = card_table_->CardFromAddr(begin); card != card_end; ++card) {
+        if (*card != accounting::CardTable::kCardClean) {
+          collector_->UpdateObjectReferences(obj);
+          return;
+        }
+      }
+      return;
+    }
+    collector_->UpdateObjectReferences(obj);
+  }
+
+ private:
+  IncrementalCompact* const collector_;
+  accounting::CardTable* const card_table_;
+};
+
+void IncrementalCompact::UpdateReferences() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  Runtime* runtime = Runtime::Current();
+  // Update roots.
+  runtime->VisitRoots(this);
+  {
+    TimingLogger::ScopedTiming t2("UpdateRecordedReferences", GetTimings());
+    for (mirror::HeapReference<mirror::Object>* reference : recorded_references_) {
+      UpdateHeapReference(reference);
+    }
+  }
+  // Update the objects written since the references were recorded. Their cards are dirty, the
+  // cards of the objects written before were cleared or aged.
+  IncrementalCompactUpdateObjectReferencesVisitor visitor(this);
+  accounting::CardTable* card_table = heap_->GetCardTable();
+  {
+    TimingLogger::ScopedTiming t2("UpdateDirtyCards", GetTimings());
+    for (const auto& space : heap_->GetContinuousSpaces()) {
+      accounting::ContinuousSpaceBitmap* bitmap = space->GetLiveBitmap();
+      if (bitmap != nullptr) {
+        card_table->Scan<false>(bitmap, space->Begin(), space->End(), visitor);
+      }
+    }
+  }
+  space::LargeObjectSpace* los = heap_->GetLargeObjectsSpace();
+  if (los != nullptr) {
+    // The cards of the large objects are never aged, so only the clean ones can be skipped.
+    TimingLogger::ScopedTiming t2("UpdateLargeObjectReferences", GetTimings());
+    IncrementalCompactUpdateLargeObjectVisitor los_visitor(this, card_table);
+    los->GetLiveBitmap()->VisitMarkedRange(reinterpret_cast<uintptr_t>(los->Begin()),
+                                           reinterpret_cast<uintptr_t>(los->End()),
+                                           los_visitor);
+  }
+  {
+    // The objects allocated since the last GC were not in the live bitmaps when the references were
+    // recorded, and the runtime may initialize them without write barriers.
+    TimingLogger::ScopedTiming t2("UpdateAllocatedObjectReferences", GetTimings());
+    accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+    for (auto* it = live_stack->Begin(); it != live_stack->End(); ++it) {
+      mirror::Object* obj = it->AsMirrorPtr();
+      if (obj != nullptr) {
+        UpdateObjectReferences(GetForwardingAddress(obj));
+      }
+    }
+  }
+  {
+    // The copies still refer to what the old copies referred to. The objects left in the evacuated
+    // runs if the space ran out of room were not recorded either.
+    TimingLogger::ScopedTiming t2("UpdateEvacuatedObjectReferences", GetTimings());
+    uint64_t start = NanoTime();
+    for (mirror::Object* obj : evacuated_objects_) {
+      UpdateObjectReferences(GetForwardingAddress(obj));
+    }
+    if (evacuation_failed_) {
+      accounting::ContinuousSpaceBitmap* live_bitmap = space_->GetLiveBitmap();
+      for (const auto& range : evacuated_ranges_) {
+        live_bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(range.first),
+                                      reinterpret_cast<uintptr_t>(range.second),
+                                      visitor);
+      }
+    }
+    copy_duration_ += NanoTime() - start;
+  }
+  // Update the system weaks.
+  runtime->SweepSystemWeaks(&ForwardingAddressCallback, this);
+  // Update the reference processor cleared list.
+  heap_->GetReferenceProcessor()->UpdateRoots(&ForwardingAddressCallback, this);
+}
+
+void IncrementalCompact::RedirtyAgedCards() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  accounting::CardTable* card_table = heap_->GetCardTable();
+  for (const auto& space : heap_->GetContinuousSpaces()) {
+    if (heap_->FindModUnionTableFromSpace(space) == nullptr) {
+      card_table->ModifyCardsAtomic(
+          space->Begin(), space->End(),
+          [](uint8_t card) {
+            return (card == accounting::CardTable::kCardDirty - 1)
+                ? accounting::CardTable::kCardDirty : card;
+          },
+          VoidFunctor());
+    }
+  }
+}
+
+void IncrementalCompact::FinishPhase() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  if (!evacuated_ranges_.empty()) {
+    RedirtyAgedCards();
+  }
+  space_ = nullptr;
+  // Keep evacuated_ranges_ for GetRunsEvacuated().
+  recorded_references_.clear();
+  recorded_references_.shrink_to_fit();
+  evacuated_objects_.clear();
+  evacuated_objects_.shrink_to_fit();
+}
+
+void IncrementalCompact::RevokeAllThreadLocalBuffers() {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  GetHeap()->RevokeAllThreadLocalBuffers();
+}
+
+}  // namespace collector
+}  // namespace gc
+}  // namespace art
@@ -0,0 +1,210 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_COLLECTOR_INCREMENTAL_COMPACT_H_
+#define ART_RUNTIME_GC_COLLECTOR_INCREMENTAL_COMPACT_H_
+
+#include <utility>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "garbage_collector.h"
+#include "gc_root.h"
+#include "object_callbacks.h"
+
+namespace art {
+
+class Thread;
+
+namespace mirror {
+  class Object;
+}  // namespace mirror
+
+namespace gc {
+
+class Heap;
+
+namespace space {
+  class RosAllocSpace;
+}  // namespace space
+
+namespace collector {
+
+// Compacts a RosAlloc space a few runs at a time. Each run of the collector is one increment that
+// takes the sparsest runs of the space out of the allocator, copies their objects to other runs of
+// the space and frees them. The bytes copied per increment are bounded by the evacuation budget so
+// that a fragmented space can be compacted over several short pauses rather than copied as a
+// whole. Like the semi-space collector, the objects are forwarded through their lock words, and
+// every reference to them is updated before the mutators resume, so the mutators never see an old
+// copy.
+//
+// The references to update are found without scanning the heap in the pause. Before the pause,
+// while the mutators run, the collector ages the cards and records the heap references that point
+// into the chosen runs. The pause then only updates the roots, the recorded references, the
+// objects on cards dirtied since and the objects allocated since the last collection.
+class IncrementalCompact : public GarbageCollector {
+ public:
+  explicit IncrementalCompact(Heap* heap, const std::string& name_prefix = "");
+  ~IncrementalCompact() {}
+
+  virtual void RunPhases() OVERRIDE NO_THREAD_SAFETY_ANALYSIS;
+  void InitializePhase();
+  void RecordReferencesPhase() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_)
+      LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
+  void EvacuationPhase() EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_)
+      LOCKS_EXCLUDED(Locks::heap_bitmap_lock_);
+  void FinishPhase();
+  virtual GcType GetGcType() const OVERRIDE {
+    return kGcTypePartial;
+  }
+  virtual CollectorType GetCollectorType() const OVERRIDE {
+    return kCollectorTypeHomogeneousSpaceCompact;
+  }
+
+  // Sets the space to compact.
+  void SetSpace(space::RosAllocSpace* space);
+
+  // Sets the maximum number of bytes that the next increment copies. An increment copies at least
+  // one run if any is sparse enough.
+  void SetEvacuationBudget(size_t evacuation_budget) {
+    evacuation_budget_ = evacuation_budget;
+  }
+
+  // The number of runs evacuated and of bytes and objects copied by the last increment.
+  size_t GetRunsEvacuated() const {
+    return evacuated_ranges_.size();
+  }
+  size_t GetBytesMoved() const {
+    return bytes_moved_;
+  }
+  size_t GetObjectsMoved() const {
+    return objects_moved_;
+  }
+  // The part of the pause of the last increment spent copying and freeing the evacuated objects.
+  // The rest of the pause, mostly updating the roots and the objects written or allocated since
+  // the last collection, depends on the mutators rather than on the evacuation budget.
+  uint64_t GetCopyDuration() const {
+    return copy_duration_;
+  }
+
+  virtual void VisitRoots(mirror::Object*** roots, size_t count, const RootInfo& info)
+      OVERRIDE EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  virtual void VisitRoots(mirror::CompressedReference<mirror::Object>** roots, size_t count,
+                          const RootInfo& info)
+      OVERRIDE EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+ protected:
+  // Copies an object of an evacuated run to another run of the space and stores the address of
+  // the copy in the lock word of the object. Returns false if the space is full.
+  bool EvacuateObject(mirror::Object* obj)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_);
+
+  // Copies the objects of the evacuated runs.
+  void EvacuateObjects()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_);
+
+  // Returns true if `addr` is in the slots of an evacuated run.
+  bool IsInEvacuatedRun(const void* addr) const;
+
+  // Records `reference` if it points into an evacuated run.
+  void RecordHeapReference(mirror::HeapReference<mirror::Object>* reference)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void RecordHeapReferenceCallback(mirror::HeapReference<mirror::Object>* reference,
+                                          void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Records the references of a single object that point into an evacuated run.
+  void RecordObjectReferences(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Turns the cards of the spaces without a mod union table that RecordReferencesPhase() aged
+  // back into dirty cards, so that the next sticky collection still sees the objects written
+  // since the last collection.
+  void RedirtyAgedCards();
+
+  // Returns the address of the copy if the object was evacuated, otherwise the object.
+  mirror::Object* GetForwardingAddress(mirror::Object* obj) const
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  static mirror::Object* ForwardingAddressCallback(mirror::Object* obj, void* arg)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Update the references of roots, objects and system weaks to the evacuated objects. Only the
+  // recorded references and the objects written or allocated since they were recorded are visited.
+  void UpdateReferences()
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_, Locks::heap_bitmap_lock_);
+
+  // Update a single heap reference.
+  void UpdateHeapReference(mirror::HeapReference<mirror::Object>* reference)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void UpdateHeapReferenceCallback(mirror::HeapReference<mirror::Object>* reference,
+                                          void* arg)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Update all of the references of a single object.
+  void UpdateObjectReferences(mirror::Object* obj)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Revoke all the thread-local buffers.
+  void RevokeAllThreadLocalBuffers() OVERRIDE;
+
+  // The RosAlloc space which we are compacting.
+  space::RosAllocSpace* space_;
+
+  Thread* self_;
+
+  // The maximum number of bytes that an increment copies.
+  size_t evacuation_budget_;
+
+  // The slots of the evacuated runs, sorted by address.
+  std::vector<std::pair<uint8_t*, uint8_t*>> evacuated_ranges_;
+  // The bytes in use in the evacuated runs when they were chosen.
+  size_t evacuated_bytes_;
+  // The lowest and highest addresses of the evacuated runs, to skip most references quickly.
+  uint8_t* evacuated_begin_;
+  uint8_t* evacuated_end_;
+
+  // The heap references that pointed into the evacuated runs when RecordReferencesPhase() scanned
+  // the heap. References stored later are on dirty cards or in newly allocated objects.
+  std::vector<mirror::HeapReference<mirror::Object>*> recorded_references_;
+
+  // The evacuated objects, freed once all the references to them are updated.
+  std::vector<mirror::Object*> evacuated_objects_;
+
+  // True if the space ran out of room for the copies.
+  bool evacuation_failed_;
+
+  size_t bytes_moved_;
+  size_t objects_moved_;
+  uint64_t copy_duration_;
+
+ private:
+  friend class EvacuateObjectVisitor;
+  friend class IncrementalCompactRecordObjectReferencesVisitor;
+  friend class IncrementalCompactRecordReferenceVisitor;
+  friend class IncrementalCompactUpdateLargeObjectVisitor;
+  friend class IncrementalCompactUpdateObjectReferencesVisitor;
+  friend class IncrementalCompactUpdateReferenceVisitor;
+
+  DISALLOW_IMPLICIT_CONSTRUCTORS(IncrementalCompact);
+};
+
+}  // namespace collector
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_COLLECTOR_INCREMENTAL_COMPACT_H_
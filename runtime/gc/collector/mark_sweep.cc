@@ -39,6 +39,7 @@
 #include "gc/reference_processor.h"
 #include "gc/space/image_space.h"
 #include "gc/space/large_object_space.h"
+#include "gc/space/rosalloc_space.h"
 #include "gc/space/space-inl.h"
 #include "mark_sweep-inl.h"
 #include "mirror/object-inl.h"
@@ -68,6 +69,10 @@ static constexpr bool kParallelRecursiveMark = true;
 // ProcessMarkStack with very small mark stacks.
 static constexpr size_t kMinimumParallelMarkStackSize = 128;
 static constexpr bool kParallelProcessMarkStack = true;
+// Sweep the RosAlloc spaces and the large object space with the GC threads if they have at least
+// this many bytes.
+static constexpr bool kParallelSweep = true;
+static constexpr size_t kMinimumParallelSweepSize = 4 * MB;
 
 // Profiling and information flags.
 static constexpr bool kProfileLargeObjects = false;
@@ -1225,12 +1230,19 @@ void MarkSweep::Sweep(bool swap_bitmaps) {
     live_stack->Reset();
     DCHECK(mark_stack_->IsEmpty());
   }
+  const size_t thread_count = GetParallelSweepThreadCount();
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
     if (space->IsContinuousMemMapAllocSpace()) {
       space::ContinuousMemMapAllocSpace* alloc_space = space->AsContinuousMemMapAllocSpace();
       TimingLogger::ScopedTiming split(
           alloc_space->IsZygoteSpace() ? "SweepZygoteSpace" : "SweepMallocSpace", GetTimings());
-      RecordFree(alloc_space->Sweep(swap_bitmaps));
+      if (thread_count > 1 && alloc_space->IsRosAllocSpace() &&
+          alloc_space->Size() >= kMinimumParallelSweepSize) {
+        RecordFree(alloc_space->AsRosAllocSpace()->SweepParallel(
+            swap_bitmaps, heap_->GetThreadPool(), thread_count));
+      } else {
+        RecordFree(alloc_space->Sweep(swap_bitmaps));
+      }
     }
   }
   SweepLargeObjects(swap_bitmaps);
@@ -1240,8 +1252,22 @@ void MarkSweep::SweepLargeObjects(bool swap_bitmaps) {
   space::LargeObjectSpace* los = heap_->GetLargeObjectsSpace();
   if (los != nullptr) {
     TimingLogger::ScopedTiming split(__FUNCTION__, GetTimings());
-    RecordFreeLOS(los->Sweep(swap_bitmaps));
+    const size_t thread_count = GetParallelSweepThreadCount();
+    if (thread_count > 1 && los->GetBytesAllocated() >= kMinimumParallelSweepSize) {
+      RecordFreeLOS(los->SweepParallel(swap_bitmaps, heap_->GetThreadPool(), thread_count));
+    } else {
+      RecordFreeLOS(los->Sweep(swap_bitmaps));
+    }
+  }
+}
+
+size_t MarkSweep::GetParallelSweepThreadCount() const {
+  // The parallel sweeping bypasses the valgrind wrappers of the spaces.
+  if (!kParallelSweep || Runtime::Current()->RunningOnValgrind()) {
+    return 1;
   }
+  // Sweeping is concurrent.
+  return GetThreadCount(false);
 }
 
 // Process the "referent" field in a java.lang.ref.Reference.  If the referent has not yet been
@@ -250,6 +250,9 @@ class MarkSweep : public GarbageCollector {
   // whether or not we care about pauses.
   size_t GetThreadCount(bool paused) const;
 
+  // Returns how many threads sweep the spaces that support parallel sweeping.
+  size_t GetParallelSweepThreadCount() const;
+
   // Push a single reference on a mark stack.
   void PushOnMarkStack(mirror::Object* obj) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
@@ -296,6 +296,19 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self, AllocatorType allocator
     case kAllocatorTypeTLAB: {
       DCHECK_ALIGNED(alloc_size, space::BumpPointerSpace::kAlignment);
       if (UNLIKELY(self->TlabSize() < alloc_size)) {
+        if (UNLIKELY(!tlabs_enabled_)) {
+          // Allocate the object on its own, see SetTlabsEnabled.
+          if (UNLIKELY(IsOutOfMemoryOnAllocation<kGrow>(allocator_type, alloc_size))) {
+            return nullptr;
+          }
+          ret = bump_pointer_space_->AllocNonvirtual(alloc_size);
+          if (LIKELY(ret != nullptr)) {
+            *bytes_allocated = alloc_size;
+            *usable_size = alloc_size;
+            *bytes_tl_bulk_allocated = alloc_size;
+          }
+          break;
+        }
         const size_t new_tlab_size = alloc_size + kDefaultTLABSize;
         if (UNLIKELY(IsOutOfMemoryOnAllocation<kGrow>(allocator_type, new_tlab_size))) {
           return nullptr;
@@ -327,7 +340,7 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self, AllocatorType allocator
       DCHECK(region_space_ != nullptr);
       DCHECK_ALIGNED(alloc_size, space::RegionSpace::kAlignment);
       if (UNLIKELY(self->TlabSize() < alloc_size)) {
-        if (space::RegionSpace::kRegionSize >= alloc_size) {
+        if (space::RegionSpace::kRegionSize >= alloc_size && LIKELY(tlabs_enabled_)) {
           // Non-large. Check OOME for a tlab.
           if (LIKELY(!IsOutOfMemoryOnAllocation<kGrow>(allocator_type, space::RegionSpace::kRegionSize))) {
             // Try to allocate a tlab.
@@ -351,7 +364,7 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self, AllocatorType allocator
             }
           }
         } else {
-          // Large. Check OOME.
+          // Large, or thread-local buffers are disabled (see SetTlabsEnabled). Check OOME.
           if (LIKELY(!IsOutOfMemoryOnAllocation<kGrow>(allocator_type, alloc_size))) {
             ret = region_space_->AllocNonvirtual<false>(alloc_size, bytes_allocated, usable_size,
                                                         bytes_tl_bulk_allocated);
@@ -42,6 +42,7 @@
 #include "gc/accounting/remembered_set.h"
 #include "gc/accounting/space_bitmap-inl.h"
 #include "gc/collector/concurrent_copying.h"
+#include "gc/collector/incremental_compact.h"
 #include "gc/collector/mark_compact.h"
 #include "gc/collector/mark_sweep-inl.h"
 #include "gc/collector/partial_mark_sweep.h"
@@ -114,6 +115,13 @@ static constexpr size_t kDefaultAllocationStackSize = 8 * MB /
 // System.runFinalization can deadlock with native allocations, to deal with this, we have a
 // timeout on how long we wait for finalizers to run. b/21544853
 static constexpr uint64_t kNativeAllocationFinalizeTimeout = MsToNs(250u);
+// The bytes that the first increment of an incremental compaction copies, and the least and most
+// that an increment copies as the budget adapts to the pauses.
+static constexpr size_t kInitialIncrementalCompactionBudget = 256 * KB;
+static constexpr size_t kMinIncrementalCompactionBudget = 16 * KB;
+static constexpr size_t kMaxIncrementalCompactionBudget = 4 * MB;
+// The mutators run for this many times the pause budget between two increments.
+static constexpr size_t kIncrementalCompactionIntervalFactor = 4;
 
 Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max_free,
            double target_utilization, double foreground_heap_growth_multiplier,
@@ -128,7 +136,10 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
            bool verify_pre_gc_rosalloc, bool verify_pre_sweeping_rosalloc,
            bool verify_post_gc_rosalloc, bool gc_stress_mode,
            bool use_homogeneous_space_compaction_for_oom,
-           uint64_t min_interval_homogeneous_space_compaction_by_oom)
+           uint64_t min_interval_homogeneous_space_compaction_by_oom,
+           bool use_generational_cc,
+           size_t region_evacuation_budget,
+           uint64_t incremental_compaction_pause)
     : non_moving_space_(nullptr),
       rosalloc_space_(nullptr),
       dlmalloc_space_(nullptr),
@@ -194,15 +205,26 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
       total_allocation_time_(0),
       verify_object_mode_(kVerifyObjectModeDisabled),
       disable_moving_gc_count_(0),
+      young_concurrent_copying_collector_(nullptr),
+      active_concurrent_copying_collector_(nullptr),
+      incremental_compact_collector_(nullptr),
       running_on_valgrind_(Runtime::Current()->RunningOnValgrind()),
       use_tlab_(use_tlab),
+      use_generational_cc_(use_generational_cc && !use_tlab),
+      tlabs_enabled_(true),
       main_space_backup_(nullptr),
       min_interval_homogeneous_space_compaction_by_oom_(
           min_interval_homogeneous_space_compaction_by_oom),
       last_time_homogeneous_space_compaction_by_oom_(NanoTime()),
       pending_collector_transition_(nullptr),
       pending_heap_trim_(nullptr),
+      pending_incremental_compaction_(nullptr),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
+      incremental_compaction_pause_(incremental_compaction_pause),
+      incremental_compaction_budget_(kInitialIncrementalCompactionBudget),
+      incremental_compaction_start_time_(0),
+      incremental_compaction_increments_(0),
+      incremental_compaction_bytes_moved_(0),
       running_collection_is_blocking_(false),
       blocking_gc_count_(0U),
       blocking_gc_time_(0U),
@@ -219,6 +241,9 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
   if (VLOG_IS_ON(heap) || VLOG_IS_ON(startup)) {
     LOG(INFO) << "Heap() entering";
   }
+  if (use_generational_cc && use_tlab) {
+    LOG(WARNING) << "Ignoring -XX:EnableGenerationalCC since -XX:UseTLAB is set";
+  }
   Runtime* const runtime = Runtime::Current();
   // If we aren't the zygote, switch to the default non zygote allocator. This may update the
   // entrypoints.
@@ -353,6 +378,10 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
   // Create other spaces based on whether or not we have a moving GC.
   if (foreground_collector_type_ == kCollectorTypeCC) {
     region_space_ = space::RegionSpace::Create("Region space", capacity_ * 2, request_begin);
+    region_space_->SetEvacuationBudget(region_evacuation_budget);
+    if (use_generational_cc_) {
+      region_space_->CreateRegionMarkBitmap();
+    }
     AddSpace(region_space_);
   } else if (IsMovingGc(foreground_collector_type_) &&
       foreground_collector_type_ != kCollectorTypeGSS) {
@@ -495,11 +524,24 @@ Heap::Heap(size_t initial_size, size_t growth_limit, size_t min_free, size_t max
     if (MayUseCollector(kCollectorTypeCC)) {
       concurrent_copying_collector_ = new collector::ConcurrentCopying(this);
       garbage_collectors_.push_back(concurrent_copying_collector_);
+      if (use_generational_cc_) {
+        young_concurrent_copying_collector_ =
+            new collector::ConcurrentCopying(this, true, "young");
+        garbage_collectors_.push_back(young_concurrent_copying_collector_);
+      }
+      active_concurrent_copying_collector_.StoreRelaxed(concurrent_copying_collector_);
     }
     if (MayUseCollector(kCollectorTypeMC)) {
       mark_compact_collector_ = new collector::MarkCompact(this);
       garbage_collectors_.push_back(mark_compact_collector_);
     }
+    // Incremental compaction only moves RosAlloc runs, and valgrind spaces pad the objects.
+    if (MayUseCollector(kCollectorTypeHomogeneousSpaceCompact) &&
+        incremental_compaction_pause_ != 0 && main_space_ != nullptr &&
+        main_space_->IsRosAllocSpace() && !running_on_valgrind_) {
+      incremental_compact_collector_ = new collector::IncrementalCompact(this);
+      garbage_collectors_.push_back(incremental_compact_collector_);
+    }
   }
   if (GetImageSpace() != nullptr && non_moving_space_ != nullptr &&
       (is_zygote || separate_non_moving_space || foreground_collector_type_ == kCollectorTypeGSS)) {
@@ -1167,7 +1209,11 @@ void Heap::DoPendingCollectorTransition() {
   // Launch homogeneous space compaction if it is desired.
   if (desired_collector_type == kCollectorTypeHomogeneousSpaceCompact) {
     if (!CareAboutPauseTimes()) {
-      PerformHomogeneousSpaceCompact();
+      if (incremental_compact_collector_ != nullptr) {
+        PerformIncrementalSpaceCompaction();
+      } else {
+        PerformHomogeneousSpaceCompact();
+      }
     } else {
       VLOG(gc) << "Homogeneous compaction ignored due to jank perceptible process state";
     }
@@ -1870,6 +1916,86 @@ HomogeneousSpaceCompactResult Heap::PerformHomogeneousSpaceCompact() {
   return HomogeneousSpaceCompactResult::kSuccess;
 }
 
+HomogeneousSpaceCompactResult Heap::PerformIncrementalSpaceCompaction() {
+  count_requested_homogeneous_space_compaction_++;
+  incremental_compaction_budget_ = kInitialIncrementalCompactionBudget;
+  incremental_compaction_start_time_ = NanoTime();
+  incremental_compaction_increments_ = 0;
+  incremental_compaction_bytes_moved_ = 0;
+  return ContinueIncrementalSpaceCompaction();
+}
+
+HomogeneousSpaceCompactResult Heap::ContinueIncrementalSpaceCompaction() {
+  Thread* self = Thread::Current();
+  ScopedThreadStateChange tsc(self, kWaitingPerformingGc);
+  Locks::mutator_lock_->AssertNotHeld(self);
+  if (CareAboutPauseTimes()) {
+    // The process became jank perceptible, the rest waits for the next transition.
+    return HomogeneousSpaceCompactResult::kErrorReject;
+  }
+  {
+    ScopedThreadStateChange tsc2(self, kWaitingForGcToComplete);
+    MutexLock mu(self, *gc_complete_lock_);
+    // Ensure there is only one GC at a time.
+    WaitForGcToCompleteLocked(kGcCauseHomogeneousSpaceCompact, self);
+    // Other GCs may run between the increments, recheck everything.
+    if (disable_moving_gc_count_ != 0 || IsMovingGc(collector_type_) ||
+        !main_space_->CanMoveObjects()) {
+      return HomogeneousSpaceCompactResult::kErrorReject;
+    }
+    collector_type_running_ = kCollectorTypeHomogeneousSpaceCompact;
+  }
+  if (Runtime::Current()->IsShuttingDown(self)) {
+    // Don't allow heap transitions to happen if the runtime is shutting down since these can
+    // cause objects to get finalized.
+    FinishGC(self, collector::kGcTypeNone);
+    return HomogeneousSpaceCompactResult::kErrorVMShuttingDown;
+  }
+  incremental_compact_collector_->SetSpace(main_space_->AsRosAllocSpace());
+  incremental_compact_collector_->SetEvacuationBudget(incremental_compaction_budget_);
+  incremental_compact_collector_->Run(kGcCauseHomogeneousSpaceCompact, false);
+  uint64_t pause_time = 0;
+  for (uint64_t pause : incremental_compact_collector_->GetCurrentIteration()->GetPauseTimes()) {
+    pause_time = std::max(pause_time, pause);
+  }
+  const uint64_t copy_time =
+      std::min(pause_time, incremental_compact_collector_->GetCopyDuration());
+  const uint64_t update_time = pause_time - copy_time;
+  const size_t runs_evacuated = incremental_compact_collector_->GetRunsEvacuated();
+  incremental_compaction_bytes_moved_ += incremental_compact_collector_->GetBytesMoved();
+  ++incremental_compaction_increments_;
+  LogGC(kGcCauseHomogeneousSpaceCompact, incremental_compact_collector_);
+  // The increment doesn't collect anything, don't count it as a GC.
+  FinishGC(self, collector::kGcTypeNone);
+  if (runs_evacuated == 0) {
+    // No run is sparse enough anymore.
+    count_performed_homogeneous_space_compaction_++;
+    VLOG(heap) << "Heap incremental space compaction took "
+               << PrettyDuration(NanoTime() - incremental_compaction_start_time_) << " in "
+               << incremental_compaction_increments_ << " increments, moved "
+               << PrettySize(incremental_compaction_bytes_moved_);
+    return HomogeneousSpaceCompactResult::kSuccess;
+  }
+  // Adapt the budget to the time spent copying, which is what the budget bounds. The rest of the
+  // pause depends on what the mutators wrote and allocated since the last GC, so if it alone
+  // exceeded the pause budget, copy as little as possible until the mutators calm down.
+  const uint64_t copy_allowance = incremental_compaction_pause_ - std::min(
+      update_time, incremental_compaction_pause_);
+  if (copy_allowance == 0) {
+    incremental_compaction_budget_ = kMinIncrementalCompactionBudget;
+  } else if (copy_time > copy_allowance) {
+    incremental_compaction_budget_ =
+        std::max(incremental_compaction_budget_ / 2, kMinIncrementalCompactionBudget);
+  } else if (copy_time < copy_allowance / 2) {
+    incremental_compaction_budget_ =
+        std::min(incremental_compaction_budget_ * 2, kMaxIncrementalCompactionBudget);
+  }
+  // Let the mutators run between the increments.
+  RequestIncrementalCompaction(
+      self, incremental_compaction_pause_ * kIncrementalCompactionIntervalFactor);
+  return HomogeneousSpaceCompactResult::kSuccess;
+}
+
 void Heap::TransitionCollector(CollectorType collector_type) {
   if (collector_type == collector_type_) {
     return;
@@ -2025,6 +2151,9 @@ void Heap::ChangeCollector(CollectorType collector_type) {
     gc_plan_.clear();
     switch (collector_type_) {
       case kCollectorTypeCC: {
+        if (use_generational_cc_) {
+          gc_plan_.push_back(collector::kGcTypeSticky);
+        }
         gc_plan_.push_back(collector::kGcTypeFull);
         if (use_tlab_) {
           ChangeAllocator(kAllocatorTypeRegionTLAB);
@@ -2433,10 +2562,18 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type, GcCaus
         semi_space_collector_->SetSwapSemiSpaces(true);
         collector = semi_space_collector_;
         break;
-      case kCollectorTypeCC:
-        concurrent_copying_collector_->SetRegionSpace(region_space_);
-        collector = concurrent_copying_collector_;
+      case kCollectorTypeCC: {
+        collector::ConcurrentCopying* cc =
+            (use_generational_cc_ && gc_type == collector::kGcTypeSticky)
+                ? young_concurrent_copying_collector_
+                : concurrent_copying_collector_;
+        cc->SetRegionSpace(region_space_);
+        // No collector is marking here, and the pause that starts marking orders this store
+        // before the read barriers that need the new collector.
+        active_concurrent_copying_collector_.StoreRelease(cc);
+        collector = cc;
         break;
+      }
       case kCollectorTypeMC:
         mark_compact_collector_->SetSpace(bump_pointer_space_);
         collector = mark_compact_collector_;
@@ -2444,11 +2581,14 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type, GcCaus
       default:
         LOG(FATAL) << "Invalid collector type " << static_cast<size_t>(collector_type_);
     }
-    if (collector != mark_compact_collector_ && collector != concurrent_copying_collector_) {
+    if (collector != mark_compact_collector_ && collector != concurrent_copying_collector_ &&
+        collector != young_concurrent_copying_collector_) {
       temp_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
       CHECK(temp_space_->IsEmpty());
     }
-    gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    if (collector != young_concurrent_copying_collector_) {
+      gc_type = collector::kGcTypeFull;  // TODO: Not hard code this in.
+    }
   } else if (current_allocator_ == kAllocatorTypeRosAlloc ||
       current_allocator_ == kAllocatorTypeDlMalloc) {
     collector = FindCollectorByGcType(gc_type);
@@ -3291,8 +3431,10 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
   } else {
     collector::GcType non_sticky_gc_type =
         HasZygoteSpace() ? collector::kGcTypePartial : collector::kGcTypeFull;
-    // Find what the next non sticky collector will be.
-    collector::GarbageCollector* non_sticky_collector = FindCollectorByGcType(non_sticky_gc_type);
+    // Find what the next non sticky collector will be. CC runs its full collector for the
+    // non sticky GC types.
+    collector::GarbageCollector* non_sticky_collector = collector_type_ == kCollectorTypeCC ?
+        concurrent_copying_collector_ : FindCollectorByGcType(non_sticky_gc_type);
     // If the throughput of the current sticky GC >= throughput of the non sticky collector, then
     // do another sticky collection next.
     // We also check that the bytes allocated aren't over the footprint limit in order to prevent a
@@ -3490,6 +3632,40 @@ void Heap::RequestCollectorTransition(CollectorType desired_collector_type, uint
   task_processor_->AddTask(self, added_task);
 }
 
+class Heap::IncrementalCompactionTask : public HeapTask {
+ public:
+  explicit IncrementalCompactionTask(uint64_t target_time) : HeapTask(target_time) { }
+  virtual void Run(Thread* self) OVERRIDE {
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    // Clear the pending task first since the increment requests the next one.
+    heap->ClearPendingIncrementalCompaction(self);
+    heap->ContinueIncrementalSpaceCompaction();
+  }
+};
+
+void Heap::ClearPendingIncrementalCompaction(Thread* self) {
+  MutexLock mu(self, *pending_task_lock_);
+  pending_incremental_compaction_ = nullptr;
+}
+
+void Heap::RequestIncrementalCompaction(Thread* self, uint64_t delta_time) {
+  if (!CanAddHeapTask(self)) {
+    return;
+  }
+  IncrementalCompactionTask* added_task = nullptr;
+  const uint64_t target_time = NanoTime() + delta_time;
+  {
+    MutexLock mu(self, *pending_task_lock_);
+    if (pending_incremental_compaction_ != nullptr) {
+      task_processor_->UpdateTargetRunTime(self, pending_incremental_compaction_, target_time);
+      return;
+    }
+    added_task = new IncrementalCompactionTask(target_time);
+    pending_incremental_compaction_ = added_task;
+  }
+  task_processor_->AddTask(self, added_task);
+}
+
 class Heap::HeapTrimTask : public HeapTask {
  public:
   explicit HeapTrimTask(uint64_t delta_time) : HeapTask(NanoTime() + delta_time) { }
@@ -3576,6 +3752,17 @@ void Heap::RevokeAllThreadLocalBuffers() {
   }
 }
 
+void Heap::SetTlabsEnabled(bool enabled) {
+  if (tlabs_enabled_ == enabled) {
+    return;
+  }
+  tlabs_enabled_ = enabled;
+  if (!enabled) {
+    // Empty buffers make the inline allocation paths in compiled code fall back to the runtime.
+    RevokeAllThreadLocalBuffers();
+  }
+}
+
 bool Heap::IsGCRequestPending() const {
   return concurrent_gc_pending_.LoadRelaxed();
 }
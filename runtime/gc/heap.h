@@ -71,6 +71,7 @@ namespace accounting {
 namespace collector {
   class ConcurrentCopying;
   class GarbageCollector;
+  class IncrementalCompact;
   class MarkCompact;
   class MarkSweep;
   class SemiSpace;
@@ -147,6 +148,11 @@ class Heap {
   static constexpr double kDefaultHeapGrowthMultiplier = 2.0;
   // Primitive arrays larger than this size are put in the large object space.
   static constexpr size_t kDefaultLargeObjectThreshold = 3 * kPageSize;
+  // The max live bytes that CC copies out of the old regions in a full collection, 0 if unlimited.
+  static constexpr size_t kDefaultRegionEvacuationBudget = 0;
+  // The pause budget of each increment when homogeneous space compaction compacts the main
+  // RosAlloc space incrementally, 0 to copy the whole space in one pause.
+  static constexpr uint64_t kDefaultIncrementalCompactionPause = 0;
   // Whether or not parallel GC is enabled. If not, then we never create the thread pool.
   static constexpr bool kDefaultEnableParallelGC = false;
 
@@ -183,7 +189,10 @@ class Heap {
                 bool verify_pre_gc_rosalloc, bool verify_pre_sweeping_rosalloc,
                 bool verify_post_gc_rosalloc, bool gc_stress_mode,
                 bool use_homogeneous_space_compaction,
-                uint64_t min_interval_homogeneous_space_compaction_by_oom);
+                uint64_t min_interval_homogeneous_space_compaction_by_oom,
+                bool use_generational_cc,
+                size_t region_evacuation_budget,
+                uint64_t incremental_compaction_pause);
 
   ~Heap();
 
@@ -501,6 +510,10 @@ class Heap {
   void RevokeThreadLocalBuffers(Thread* thread);
   void RevokeRosAllocThreadLocalBuffers(Thread* thread);
   void RevokeAllThreadLocalBuffers();
+  // Enable or disable handing out new thread-local allocation buffers. Compiled code bump-allocates
+  // from these buffers without going through the allocation entrypoints, so they are disabled
+  // while the entrypoints are instrumented. Requires all other threads to be suspended.
+  void SetTlabsEnabled(bool enabled);
   void AssertThreadLocalBuffersAreRevoked(Thread* thread);
   void AssertAllBumpPointerSpaceThreadLocalBuffersAreRevoked();
   void RosAllocVerification(TimingLogger* timings, const char* name)
@@ -640,8 +653,10 @@ class Heap {
     return zygote_space_ != nullptr;
   }
 
+  // Return the concurrent copying collector that runs or ran last. Mutator read barriers call
+  // this, so it is only switched between collections, before the next collector starts marking.
   collector::ConcurrentCopying* ConcurrentCopyingCollector() {
-    return concurrent_copying_collector_;
+    return active_concurrent_copying_collector_.LoadAcquire();
   }
 
   CollectorType CurrentCollectorType() {
@@ -690,6 +705,7 @@ class Heap {
   class ConcurrentGCTask;
   class CollectorTransitionTask;
   class HeapTrimTask;
+  class IncrementalCompactionTask;
 
   // Compact source space to target space. Returns the collector used.
   collector::GarbageCollector* Compact(space::ContinuousMemMapAllocSpace* target_space,
@@ -789,6 +805,8 @@ class Heap {
 
   void RequestCollectorTransition(CollectorType desired_collector_type, uint64_t delta_time)
       LOCKS_EXCLUDED(pending_task_lock_);
+  void RequestIncrementalCompaction(Thread* self, uint64_t delta_time)
+      LOCKS_EXCLUDED(pending_task_lock_);
 
   void RequestConcurrentGCAndSaveObject(Thread* self, bool force_full, mirror::Object** obj)
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
@@ -825,6 +843,12 @@ class Heap {
 
   // Create a new alloc space and compact default alloc space to it.
   HomogeneousSpaceCompactResult PerformHomogeneousSpaceCompact();
+  // Compact the main space in place with increments of incremental_compact_collector_, each in
+  // its own pause, until no run is sparse enough or the process becomes jank perceptible. Runs the
+  // first increment, the others run as delayed heap tasks.
+  HomogeneousSpaceCompactResult PerformIncrementalSpaceCompaction();
+  // Run the next increment of the current incremental space compaction.
+  HomogeneousSpaceCompactResult ContinueIncrementalSpaceCompaction();
 
   // Create the main free list malloc space, either a RosAlloc space or DlMalloc space.
   void CreateMainMallocSpace(MemMap* mem_map, size_t initial_size, size_t growth_limit,
@@ -867,6 +891,7 @@ class Heap {
   void ClearConcurrentGCRequest();
   void ClearPendingTrim(Thread* self) LOCKS_EXCLUDED(pending_task_lock_);
   void ClearPendingCollectorTransition(Thread* self) LOCKS_EXCLUDED(pending_task_lock_);
+  void ClearPendingIncrementalCompaction(Thread* self) LOCKS_EXCLUDED(pending_task_lock_);
 
   // What kind of concurrency behavior is the runtime after? Currently true for concurrent mark
   // sweep GC, false for other GC types.
@@ -1141,10 +1166,23 @@ class Heap {
   collector::SemiSpace* semi_space_collector_;
   collector::MarkCompact* mark_compact_collector_;
   collector::ConcurrentCopying* concurrent_copying_collector_;
+  // The young collector of the generational mode of CC, see use_generational_cc_.
+  collector::ConcurrentCopying* young_concurrent_copying_collector_;
+  Atomic<collector::ConcurrentCopying*> active_concurrent_copying_collector_;
+  // Non null if homogeneous space compaction compacts the main space incrementally.
+  collector::IncrementalCompact* incremental_compact_collector_;
 
   const bool running_on_valgrind_;
   const bool use_tlab_;
 
+  // True if CC alternates young collections, which only collect the regions allocated since the
+  // last collection, with full collections. Not supported with TLABs as the region space does not
+  // track the regions of TLABs as newly allocated.
+  const bool use_generational_cc_;
+
+  // False while allocations must not be served from new thread-local buffers, see SetTlabsEnabled.
+  bool tlabs_enabled_;
+
   // Pointer to the space which becomes the new main space when we do homogeneous space compaction.
   // Use unique_ptr since the space is only added during the homogeneous compaction phase.
   std::unique_ptr<space::MallocSpace> main_space_backup_;
@@ -1173,10 +1211,23 @@ class Heap {
   // Active tasks which we can modify (change target time, desired collector type, etc..).
   CollectorTransitionTask* pending_collector_transition_ GUARDED_BY(pending_task_lock_);
   HeapTrimTask* pending_heap_trim_ GUARDED_BY(pending_task_lock_);
+  IncrementalCompactionTask* pending_incremental_compaction_ GUARDED_BY(pending_task_lock_);
 
   // Whether or not we use homogeneous space compaction to avoid OOM errors.
   bool use_homogeneous_space_compaction_for_oom_;
 
+  // The pause budget of an increment of incremental space compaction, see
+  // kDefaultIncrementalCompactionPause.
+  const uint64_t incremental_compaction_pause_;
+  // The state of the current incremental space compaction. Only the heap task daemon, which runs
+  // the increments one after the other, accesses it.
+  // The bytes that the next increment copies, adapted to keep the time spent copying within what
+  // the pause budget leaves after updating the references.
+  size_t incremental_compaction_budget_;
+  uint64_t incremental_compaction_start_time_;
+  size_t incremental_compaction_increments_;
+  size_t incremental_compaction_bytes_moved_;
+
   // True if the currently running collection has made some thread wait.
   bool running_collection_is_blocking_ GUARDED_BY(gc_complete_lock_);
   // The number of blocking GC runs.
@@ -1209,6 +1260,7 @@ class Heap {
 
   friend class CollectorTransitionTask;
   friend class collector::GarbageCollector;
+  friend class collector::IncrementalCompact;
   friend class collector::MarkCompact;
   friend class collector::ConcurrentCopying;
   friend class collector::MarkSweep;
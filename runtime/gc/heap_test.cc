@@ -18,11 +18,14 @@
 #include "common_runtime_test.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/collector/concurrent_copying.h"
 #include "handle_scope-inl.h"
+#include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
 #include "scoped_thread_state_change.h"
+#include "thread_list.h"
 
 namespace art {
 namespace gc {
@@ -84,5 +87,140 @@ TEST_F(ZygoteHeapTest, PreZygoteFork) {
   Runtime::Current()->GetHeap()->PreZygoteFork();
 }
 
+class GenerationalCCHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xgc:CC", nullptr));
+    options->push_back(std::make_pair("-XX:EnableGenerationalCC", nullptr));
+  }
+};
+
+TEST_F(GenerationalCCHeapTest, YoungCollection) {
+  // CC needs read barriers.
+  if (!kUseReadBarrier) {
+    printf("WARNING: TEST DISABLED WITHOUT READ BARRIERS\n");
+    return;
+  }
+  Heap* heap = Runtime::Current()->GetHeap();
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<2> hs(soa.Self());
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  Handle<mirror::ObjectArray<mirror::Object>> array(hs.NewHandle(
+      mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), 16)));
+  ASSERT_TRUE(array.Get() != nullptr);
+  // A full collection makes the array old, then the strings allocated after it are young.
+  heap->CollectGarbage(false);
+  EXPECT_EQ(collector::kGcTypePartial, heap->ConcurrentCopyingCollector()->GetGcType());
+  for (int32_t i = 0; i < 16; ++i) {
+    array->Set<false>(i, mirror::String::AllocFromModifiedUtf8(soa.Self(), "young"));
+    // Garbage for the young collection.
+    mirror::String::AllocFromModifiedUtf8(soa.Self(), "garbage");
+  }
+  // The next background collection is a young one, run by the young collector.
+  heap->ConcurrentGC(soa.Self(), false);
+  collector::ConcurrentCopying* young = heap->ConcurrentCopyingCollector();
+  EXPECT_EQ(collector::kGcTypeSticky, young->GetGcType());
+  EXPECT_NE(0u, young->NumberOfIterations());
+  // The young objects referenced from the old array survive.
+  for (int32_t i = 0; i < 16; ++i) {
+    mirror::Object* str = array->Get(i);
+    ASSERT_TRUE(str != nullptr);
+    EXPECT_TRUE(str->AsString()->Equals("young"));
+  }
+}
+
+TEST_F(GenerationalCCHeapTest, YoungCollectionFreesDeadLargeObject) {
+  // CC needs read barriers.
+  if (!kUseReadBarrier) {
+    printf("WARNING: TEST DISABLED WITHOUT READ BARRIERS\n");
+    return;
+  }
+  Heap* heap = Runtime::Current()->GetHeap();
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  heap->CollectGarbage(false);
+  // An object array of more than a region is allocated in large regions of the region space,
+  // which a young collection marks in place.
+  static constexpr int32_t kLength = 2 * MB / sizeof(mirror::HeapReference<mirror::Object>);
+  ASSERT_TRUE(mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), kLength) != nullptr);
+  const size_t large_bytes = kLength * sizeof(mirror::HeapReference<mirror::Object>);
+  const size_t bytes_before = heap->GetBytesAllocated();
+  heap->ConcurrentGC(soa.Self(), false);
+  EXPECT_EQ(collector::kGcTypeSticky, heap->ConcurrentCopyingCollector()->GetGcType());
+  // The dead large object is freed by the young collection rather than the next full one.
+  EXPECT_LE(heap->GetBytesAllocated() + large_bytes, bytes_before);
+}
+
+class ParallelCCHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-Xgc:CC", nullptr));
+    options->push_back(std::make_pair("-XX:ParallelGCThreads=4", nullptr));
+    options->push_back(std::make_pair("-XX:ConcGCThreads=4", nullptr));
+  }
+};
+
+TEST_F(ParallelCCHeapTest, ParallelMarking) {
+  // CC needs read barriers.
+  if (!kUseReadBarrier) {
+    printf("WARNING: TEST DISABLED WITHOUT READ BARRIERS\n");
+    return;
+  }
+  Heap* heap = Runtime::Current()->GetHeap();
+  // The collector only marks in parallel when pause times matter and there is a thread pool.
+  ASSERT_TRUE(heap->CareAboutPauseTimes());
+  ASSERT_TRUE(heap->GetThreadPool() != nullptr);
+  // Scanning the root queues kNumArrays arrays, and scanning each of those queues kArrayLength
+  // leaves, well above the minimum mark queue size for parallel marking. The copies of the
+  // leaves take many PLABs.
+  static constexpr int32_t kNumArrays = 64;
+  static constexpr int32_t kArrayLength = 512;
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<2> hs(self);
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(self, "[Ljava/lang/Object;")));
+  Handle<mirror::ObjectArray<mirror::Object>> root(hs.NewHandle(
+      mirror::ObjectArray<mirror::Object>::Alloc(self, c.Get(), kNumArrays)));
+  ASSERT_TRUE(root.Get() != nullptr);
+  for (int32_t i = 0; i < kNumArrays; ++i) {
+    mirror::ObjectArray<mirror::Object>* array =
+        mirror::ObjectArray<mirror::Object>::Alloc(self, c.Get(), kArrayLength);
+    ASSERT_TRUE(array != nullptr);
+    root->Set<false>(i, array);
+    for (int32_t j = 0; j < kArrayLength; ++j) {
+      mirror::IntArray* leaf = mirror::IntArray::Alloc(self, 2);
+      ASSERT_TRUE(leaf != nullptr);
+      leaf->Set(0, i);
+      leaf->Set(1, j);
+      root->Get(i)->AsObjectArray<mirror::Object>()->Set<false>(j, leaf);
+    }
+  }
+  for (size_t gc = 0; gc < 3; ++gc) {
+    heap->CollectGarbage(false);
+    for (int32_t i = 0; i < kNumArrays; ++i) {
+      mirror::ObjectArray<mirror::Object>* array =
+          root->Get(i)->AsObjectArray<mirror::Object>();
+      ASSERT_EQ(kArrayLength, array->GetLength());
+      for (int32_t j = 0; j < kArrayLength; ++j) {
+        mirror::IntArray* leaf = array->Get(j)->AsIntArray();
+        ASSERT_EQ(2, leaf->GetLength());
+        EXPECT_EQ(i, leaf->Get(0));
+        EXPECT_EQ(j, leaf->Get(1));
+      }
+    }
+    // The heap walk also walks over the dummy objects that fill the retired PLABs.
+    ScopedThreadStateChange tsc(self, kSuspended);
+    ThreadList* thread_list = Runtime::Current()->GetThreadList();
+    thread_list->SuspendAll(__FUNCTION__);
+    size_t failures = heap->VerifyHeapReferences();
+    thread_list->ResumeAll();
+    EXPECT_EQ(0u, failures);
+  }
+}
+
 }  // namespace gc
 }  // namespace art
@@ -184,20 +184,25 @@ void LargeObjectMapSpace::SetAllLargeObjectsAsZygoteObjects(Thread* self) {
 }
 
 size_t LargeObjectMapSpace::Free(Thread* self, mirror::Object* ptr) {
-  MutexLock mu(self, lock_);
-  auto it = large_objects_.find(ptr);
-  if (UNLIKELY(it == large_objects_.end())) {
-    Runtime::Current()->GetHeap()->DumpSpaces(LOG(INTERNAL_FATAL));
-    LOG(FATAL) << "Attempted to free large object " << ptr << " which was not live";
-  }
-  MemMap* mem_map = it->second.mem_map;
-  const size_t map_size = mem_map->BaseSize();
-  DCHECK_GE(num_bytes_allocated_, map_size);
-  size_t allocation_size = map_size;
-  num_bytes_allocated_ -= allocation_size;
-  --num_objects_allocated_;
+  MemMap* mem_map;
+  size_t allocation_size;
+  {
+    MutexLock mu(self, lock_);
+    auto it = large_objects_.find(ptr);
+    if (UNLIKELY(it == large_objects_.end())) {
+      Runtime::Current()->GetHeap()->DumpSpaces(LOG(INTERNAL_FATAL));
+      LOG(FATAL) << "Attempted to free large object " << ptr << " which was not live";
+    }
+    mem_map = it->second.mem_map;
+    const size_t map_size = mem_map->BaseSize();
+    DCHECK_GE(num_bytes_allocated_, map_size);
+    allocation_size = map_size;
+    num_bytes_allocated_ -= allocation_size;
+    --num_objects_allocated_;
+    large_objects_.erase(it);
+  }
+  // Unmap outside of the lock so that the threads of a parallel sweep don't wait for each other.
   delete mem_map;
-  large_objects_.erase(it);
   return allocation_size;
 }
 
@@ -606,6 +611,65 @@ collector::ObjectBytePair LargeObjectSpace::Sweep(bool swap_bitmaps) {
   return scc.freed;
 }
 
+void LargeObjectSpace::ParallelSweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg) {
+  // Runs on the GC worker threads. The GC thread holds the heap bitmap lock on their behalf.
+  SweepCallbackContext* context = static_cast<SweepCallbackContext*>(arg);
+  space::LargeObjectSpace* space = context->space->AsLargeObjectSpace();
+  if (!context->swap_bitmaps) {
+    // The ranges of the threads do not share bitmap words.
+    accounting::LargeObjectBitmap* bitmap = space->GetLiveBitmap();
+    for (size_t i = 0; i < num_ptrs; ++i) {
+      bitmap->Clear(ptrs[i]);
+    }
+  }
+  context->freed.objects += num_ptrs;
+  context->freed.bytes += space->FreeList(Thread::Current(), num_ptrs, ptrs);
+}
+
+collector::ObjectBytePair LargeObjectSpace::SweepParallel(bool swap_bitmaps,
+                                                          ThreadPool* thread_pool,
+                                                          size_t thread_count) {
+  if (Begin() >= End()) {
+    return collector::ObjectBytePair(0, 0);
+  }
+  accounting::LargeObjectBitmap* live_bitmap = GetLiveBitmap();
+  accounting::LargeObjectBitmap* mark_bitmap = GetMarkBitmap();
+  if (swap_bitmaps) {
+    std::swap(live_bitmap, mark_bitmap);
+  }
+  // The ranges begin at words of the bitmaps, as each word covers several large objects.
+  static constexpr size_t kBitmapWordSpan = kBitsPerIntPtrT * kLargeObjectAlignment;
+  const uintptr_t heap_begin = live_bitmap->HeapBegin();
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(Begin());
+  const uintptr_t end = reinterpret_cast<uintptr_t>(End());
+  const size_t num_ranges = thread_count * kParallelSweepRangesPerThread;
+  const size_t range_size = RoundUp(std::max<size_t>((end - begin) / num_ranges, 1U),
+                                    kBitmapWordSpan);
+  std::vector<uintptr_t> boundaries;
+  boundaries.push_back(begin);
+  for (uintptr_t addr = begin + range_size; addr < end; addr += range_size) {
+    uintptr_t boundary = heap_begin + RoundDown(addr - heap_begin, kBitmapWordSpan);
+    if (boundary > boundaries.back()) {
+      boundaries.push_back(boundary);
+    }
+  }
+  boundaries.push_back(end);
+  std::vector<SweepCallbackContext> contexts(boundaries.size() - 1,
+                                             SweepCallbackContext(swap_bitmaps, this));
+  std::vector<void*> args;
+  for (SweepCallbackContext& context : contexts) {
+    args.push_back(&context);
+  }
+  accounting::LargeObjectBitmap::ParallelSweepWalk(*live_bitmap, *mark_bitmap, boundaries,
+                                                   &ParallelSweepCallback, args, thread_pool,
+                                                   thread_count);
+  collector::ObjectBytePair freed;
+  for (const SweepCallbackContext& context : contexts) {
+    freed.Add(context.freed);
+  }
+  return freed;
+}
+
 void LargeObjectSpace::LogFragmentationAllocFailure(std::ostream& /*os*/,
                                                     size_t /*failed_alloc_bytes*/) {
   UNIMPLEMENTED(FATAL);
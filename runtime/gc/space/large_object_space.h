@@ -26,6 +26,9 @@
 #include <vector>
 
 namespace art {
+
+class ThreadPool;
+
 namespace gc {
 namespace space {
 
@@ -75,6 +78,9 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
     return this;
   }
   collector::ObjectBytePair Sweep(bool swap_bitmaps);
+  // Sweep with thread_count threads of thread_pool, each sweeping its own address ranges.
+  collector::ObjectBytePair SweepParallel(bool swap_bitmaps, ThreadPool* thread_pool,
+                                          size_t thread_count);
   virtual bool CanMoveObjects() const OVERRIDE {
     return false;
   }
@@ -107,6 +113,7 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
  protected:
   explicit LargeObjectSpace(const std::string& name, uint8_t* begin, uint8_t* end);
   static void SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg);
+  static void ParallelSweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg);
 
   // Approximate number of bytes which have been allocated into the space.
   uint64_t num_bytes_allocated_;
@@ -111,6 +111,16 @@ inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes, size_t* by
   return nullptr;
 }
 
+inline uint8_t* RegionSpace::AllocPlab(size_t num_bytes) {
+  DCHECK(IsAligned<kAlignment>(num_bytes));
+  DCHECK_LE(num_bytes, kRegionSize);
+  size_t bytes_allocated;
+  size_t bytes_tl_bulk_allocated;
+  mirror::Object* obj = AllocNonvirtual<true>(num_bytes, &bytes_allocated, nullptr,
+                                              &bytes_tl_bulk_allocated);
+  return reinterpret_cast<uint8_t*>(obj);
+}
+
 inline mirror::Object* RegionSpace::Region::Alloc(size_t num_bytes, size_t* bytes_allocated,
                                                   size_t* usable_size,
                                                   size_t* bytes_tl_bulk_allocated) {
@@ -223,7 +233,7 @@ uint64_t RegionSpace::GetObjectsAllocatedInternal() {
   return bytes;
 }
 
-template<bool kToSpaceOnly>
+template<bool kToSpaceOnly, bool kNewlyAllocatedOnly>
 void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
   // TODO: MutexLock on region_lock_ won't work due to lock order
   // issues (the classloader classes lock and the monitor lock). We
@@ -231,7 +241,8 @@ void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
   Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
   for (size_t i = 0; i < num_regions_; ++i) {
     Region* r = &regions_[i];
-    if (r->IsFree() || (kToSpaceOnly && !r->IsInToSpace())) {
+    if (r->IsFree() || (kToSpaceOnly && !r->IsInToSpace()) ||
+        (kNewlyAllocatedOnly && !r->IsNewlyAllocated())) {
       continue;
     }
     if (r->IsLarge()) {
@@ -300,6 +311,10 @@ mirror::Object* RegionSpace::AllocLarge(size_t num_bytes, size_t* bytes_allocate
       Region* first_reg = &regions_[left];
       DCHECK(first_reg->IsFree());
       first_reg->UnfreeLarge(time_);
+      if (!kForEvac) {
+        // Evacuated large objects have survived a collection and are old.
+        first_reg->SetNewlyAllocated();
+      }
       ++num_non_free_regions_;
       first_reg->SetTop(first_reg->Begin() + num_bytes);
       for (size_t p = left + 1; p < right; ++p) {
@@ -14,6 +14,8 @@
  * limitations under the License.
  */
 
+#include <algorithm>
+
 #include "bump_pointer_space.h"
 #include "bump_pointer_space-inl.h"
 #include "mirror/object-inl.h"
@@ -47,7 +49,7 @@ RegionSpace* RegionSpace::Create(const std::string& name, size_t capacity,
 RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
     : ContinuousMemMapAllocSpace(name, mem_map, mem_map->Begin(), mem_map->End(), mem_map->End(),
                                  kGcRetentionPolicyAlwaysCollect),
-      region_lock_("Region lock", kRegionSpaceRegionLock), time_(1U) {
+      region_lock_("Region lock", kRegionSpaceRegionLock), time_(1U), evacuation_budget_(0U) {
   size_t mem_map_size = mem_map->Size();
   CHECK_ALIGNED(mem_map_size, kRegionSize);
   CHECK_ALIGNED(mem_map->Begin(), kRegionSize);
@@ -115,13 +117,14 @@ size_t RegionSpace::ToSpaceSize() {
   return num_regions * kRegionSize;
 }
 
-inline bool RegionSpace::Region::ShouldBeEvacuated() {
+inline bool RegionSpace::Region::ShouldBeEvacuated(bool young_gen) {
   DCHECK((IsAllocated() || IsLarge()) && IsInToSpace());
   // if the region was allocated after the start of the
   // previous GC or the live ratio is below threshold, evacuate
-  // it.
+  // it. A young collection marks the newly allocated large
+  // regions in place rather than copy their objects.
   bool result;
-  if (is_newly_allocated_) {
+  if (is_newly_allocated_ && (!young_gen || IsAllocated())) {
     result = true;
   } else {
     bool is_live_percent_valid = live_bytes_ != static_cast<size_t>(-1);
@@ -143,17 +146,67 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
   return result;
 }
 
+// Young regions are evacuated, as most of their objects are expected
+// to be dead, and large regions are evacuated (freed) if they are
+// dead. The old regions whose live percent is below the threshold
+// are the candidates for compaction. With an evacuation budget, they
+// are evacuated in the order of their cost/benefit scores, garbage
+// first, until their live bytes would exceed the budget. The others
+// are marked in place.
+void RegionSpace::SelectRegionsToEvacuate(std::vector<bool>* evacuate) {
+  evacuate->assign(num_regions_, false);
+  std::vector<Region*> candidates;
+  for (size_t i = 0; i < num_regions_; ++i) {
+    Region* r = &regions_[i];
+    if (r->IsFree() || r->IsLargeTail() || !r->ShouldBeEvacuated(false)) {
+      continue;
+    }
+    if (r->IsAllocated() && !r->IsNewlyAllocated()) {
+      candidates.push_back(r);
+    } else {
+      (*evacuate)[i] = true;
+    }
+  }
+  if (evacuation_budget_ != 0U) {
+    const uint32_t time = time_;
+    std::sort(candidates.begin(), candidates.end(), [time](Region* a, Region* b) {
+      return a->EvacuationScore(time) > b->EvacuationScore(time);
+    });
+  }
+  size_t bytes_to_copy = 0U;
+  size_t num_selected = 0U;
+  for (Region* r : candidates) {
+    size_t live_bytes = r->LiveBytes();
+    if (evacuation_budget_ != 0U && bytes_to_copy + live_bytes > evacuation_budget_) {
+      continue;
+    }
+    bytes_to_copy += live_bytes;
+    ++num_selected;
+    (*evacuate)[r->Idx()] = true;
+  }
+  VLOG(heap) << "Evacuating " << num_selected << " of " << candidates.size()
+             << " candidate old regions, " << PrettySize(bytes_to_copy) << " live";
+}
+
 // Determine which regions to evacuate and mark them as
-// from-space. Mark the rest as unevacuated from-space.
-void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all) {
+// from-space. Mark the rest as unevacuated from-space, except for
+// the old regions of a young collection, which stay in the
+// to-space.
+void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all,
+                               bool young_gen) {
   ++time_;
   if (kUseTableLookupReadBarrier) {
     DCHECK(rb_table->IsAllCleared());
     rb_table->SetAll();
   }
   MutexLock mu(Thread::Current(), region_lock_);
+  std::vector<bool> evacuate;
+  if (!young_gen && !force_evacuate_all) {
+    SelectRegionsToEvacuate(&evacuate);
+  }
   size_t num_expected_large_tails = 0;
   bool prev_large_evacuated = false;
+  bool prev_large_collected = false;
   for (size_t i = 0; i < num_regions_; ++i) {
     Region* r = &regions_[i];
     RegionState state = r->State();
@@ -164,17 +217,24 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        // A young collection collects only the young regions.
+        bool should_collect = !young_gen || r->IsNewlyAllocated();
+        bool should_evacuate = should_collect &&
+            (young_gen ? r->ShouldBeEvacuated(true) : force_evacuate_all || evacuate[i]);
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
-        } else {
+        } else if (should_collect) {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
+        } else if (kUseTableLookupReadBarrier) {
+          // Old regions stay in the to-space.
+          rb_table->Clear(r->Begin(), r->End());
         }
         if (UNLIKELY(state == RegionState::kRegionStateLarge &&
                      type == RegionType::kRegionTypeToSpace)) {
           prev_large_evacuated = should_evacuate;
+          prev_large_collected = should_collect;
           num_expected_large_tails = RoundUp(r->BytesAllocated(), kRegionSize) / kRegionSize - 1;
           DCHECK_GT(num_expected_large_tails, 0U);
         }
@@ -184,9 +244,11 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         if (prev_large_evacuated) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
-        } else {
+        } else if (prev_large_collected) {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
+        } else if (kUseTableLookupReadBarrier) {
+          rb_table->Clear(r->Begin(), r->End());
         }
         --num_expected_large_tails;
       }
@@ -202,7 +264,10 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
   evac_region_ = &full_region_;
 }
 
-void RegionSpace::ClearFromSpace() {
+void RegionSpace::ClearFromSpace(uint64_t* cleared_unevac_bytes,
+                                 uint64_t* cleared_unevac_objects) {
+  *cleared_unevac_bytes = 0U;
+  *cleared_unevac_objects = 0U;
   MutexLock mu(Thread::Current(), region_lock_);
   for (size_t i = 0; i < num_regions_; ++i) {
     Region* r = &regions_[i];
@@ -210,17 +275,38 @@ void RegionSpace::ClearFromSpace() {
       r->Clear();
       --num_non_free_regions_;
     } else if (r->IsInUnevacFromSpace()) {
-      r->SetUnevacFromSpaceAsToSpace();
+      if (r->IsLarge() && r->LiveBytes() == 0U) {
+        // A dead large object that was marked in place, free its
+        // regions now rather than in the next full collection.
+        size_t bytes_allocated = r->BytesAllocated();
+        size_t num_large_regions = RoundUp(bytes_allocated, kRegionSize) / kRegionSize;
+        *cleared_unevac_bytes += bytes_allocated;
+        *cleared_unevac_objects += r->ObjectsAllocated();
+        for (size_t j = 0; j < num_large_regions; ++j) {
+          Region* large_region = &regions_[i + j];
+          DCHECK(large_region->IsInUnevacFromSpace());
+          DCHECK(j == 0 || large_region->IsLargeTail());
+          large_region->Clear();
+          --num_non_free_regions_;
+        }
+        i += num_large_regions - 1;
+      } else {
+        r->SetUnevacFromSpaceAsToSpace();
+      }
     }
   }
   evac_region_ = nullptr;
 }
 
-void RegionSpace::AssertAllRegionLiveBytesZeroOrCleared() {
+void RegionSpace::AssertAllRegionLiveBytesZeroOrCleared(bool young_gen) {
   if (kIsDebugBuild) {
     MutexLock mu(Thread::Current(), region_lock_);
     for (size_t i = 0; i < num_regions_; ++i) {
       Region* r = &regions_[i];
+      if (young_gen && r->IsInToSpace() && !r->IsNewlyAllocated()) {
+        // An old region of a young collection keeps the live bytes of its last marking.
+        continue;
+      }
       size_t live_bytes = r->LiveBytes();
       CHECK(live_bytes == 0U || live_bytes == static_cast<size_t>(-1)) << live_bytes;
     }
@@ -276,10 +362,20 @@ void RegionSpace::Clear() {
     }
     r->Clear();
   }
+  if (region_mark_bitmap_ != nullptr) {
+    region_mark_bitmap_->Clear();
+  }
   current_region_ = &full_region_;
   evac_region_ = &full_region_;
 }
 
+void RegionSpace::CreateRegionMarkBitmap() {
+  CHECK(region_mark_bitmap_ == nullptr);
+  region_mark_bitmap_.reset(accounting::ContinuousSpaceBitmap::Create("region space mark bitmap",
+                                                                      Begin(), Capacity()));
+  CHECK(region_mark_bitmap_ != nullptr) << "Failed to create the region space mark bitmap";
+}
+
 void RegionSpace::Dump(std::ostream& os) const {
   os << GetName() << " "
       << reinterpret_cast<void*>(Begin()) << "-" << reinterpret_cast<void*>(Limit());
@@ -332,6 +428,16 @@ void RegionSpace::RecordAlloc(mirror::Object* ref) {
   reinterpret_cast<Atomic<uint64_t>*>(&r->objects_allocated_)->FetchAndAddSequentiallyConsistent(1);
 }
 
+void RegionSpace::RecordPlabObjects(uint8_t* plab_begin, size_t num_objects) {
+  CHECK(plab_begin != nullptr);
+  CHECK_GE(num_objects, 1U) << "A PLAB is at least one (dummy) object";
+  Region* r = RefToRegion(reinterpret_cast<mirror::Object*>(plab_begin));
+  DCHECK(r->IsAllocated() && r->IsInToSpace());
+  // The PLAB was allocated as a single object.
+  reinterpret_cast<Atomic<uint64_t>*>(&r->objects_allocated_)->FetchAndAddSequentiallyConsistent(
+      num_objects - 1);
+}
+
 bool RegionSpace::AllocNewTlab(Thread* self) {
   MutexLock mu(self, region_lock_);
   RevokeThreadLocalBuffersLocked(self);
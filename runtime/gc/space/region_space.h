@@ -57,6 +57,12 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   mirror::Object* AllocLarge(size_t num_bytes, size_t* bytes_allocated, size_t* usable_size,
                              size_t* bytes_tl_bulk_allocated);
   void FreeLarge(mirror::Object* large_obj, size_t bytes_allocated);
+  // Allocate a copy buffer (PLAB) of num_bytes in the evacuation region. A GC thread copies
+  // objects into its PLAB without contending with the other GC threads on the region top.
+  // The PLAB counts as one object until RecordPlabObjects() is called. Returns null on failure.
+  ALWAYS_INLINE uint8_t* AllocPlab(size_t num_bytes);
+  // Record the number of objects that were copied into the PLAB at plab_begin.
+  void RecordPlabObjects(uint8_t* plab_begin, size_t num_objects);
 
   // Return the storage space required by obj.
   size_t AllocationSize(mirror::Object* obj, size_t* usable_size) OVERRIDE
@@ -79,10 +85,18 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return nullptr;
   }
   accounting::ContinuousSpaceBitmap* GetMarkBitmap() const OVERRIDE {
-    // No mark bitmap.
+    // No mark bitmap. The heap bitmaps do not cover this space, see GetRegionMarkBitmap().
     return nullptr;
   }
 
+  // Create the region mark bitmap. Used by the generational mode of the concurrent copying
+  // collector, which keeps the marks of the objects in the old regions across young collections.
+  void CreateRegionMarkBitmap();
+  // Return the region mark bitmap, or null if it was not created.
+  accounting::ContinuousSpaceBitmap* GetRegionMarkBitmap() const {
+    return region_mark_bitmap_.get();
+  }
+
   void Clear() OVERRIDE LOCKS_EXCLUDED(region_lock_);
 
   void Dump(std::ostream& os) const;
@@ -157,6 +171,12 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     WalkInternal<true>(callback, arg);
   }
 
+  // Walk the to-space regions that were allocated by mutators since the last SetFromSpace().
+  void WalkNewlyAllocatedToSpace(ObjectCallback* callback, void* arg)
+      EXCLUSIVE_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    WalkInternal<true, true>(callback, arg);
+  }
+
   accounting::ContinuousSpaceBitmap::SweepCallback* GetSweepCallback() OVERRIDE {
     return nullptr;
   }
@@ -200,20 +220,44 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return RegionType::kRegionTypeNone;
   }
 
-  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all)
+  // Return true if ref is in a to-space region that mutators allocated since the last
+  // SetFromSpace(), that is, a region that will be young in the next collection.
+  bool IsInNewlyAllocatedToSpace(mirror::Object* ref) {
+    if (HasAddress(ref)) {
+      Region* r = RefToRegionUnlocked(ref);
+      return r->IsInToSpace() && r->IsNewlyAllocated();
+    }
+    return false;
+  }
+
+  // Determine which regions to evacuate and mark them as from-space. If young_gen is true,
+  // only the regions allocated by mutators since the last collection (the young regions) are
+  // collected and the other (old) regions stay in the to-space.
+  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all,
+                    bool young_gen)
       LOCKS_EXCLUDED(region_lock_);
 
+  // Limit the live bytes that a full collection copies out of the old regions to
+  // evacuation_budget bytes. 0 means no limit.
+  void SetEvacuationBudget(size_t evacuation_budget) {
+    evacuation_budget_ = evacuation_budget;
+  }
+
   size_t FromSpaceSize();
   size_t UnevacFromSpaceSize();
   size_t ToSpaceSize();
-  void ClearFromSpace();
+  // Free the from-space regions and the regions of the dead large objects in the unevac
+  // from-space, and turn the other unevac from-space regions into to-space. Return the bytes and
+  // the objects of the dead large objects, which were not accounted as freed by the collector.
+  void ClearFromSpace(uint64_t* cleared_unevac_bytes, uint64_t* cleared_unevac_objects);
 
   void AddLiveBytes(mirror::Object* ref, size_t alloc_size) {
     Region* reg = RefToRegionUnlocked(ref);
     reg->AddLiveBytes(alloc_size);
   }
 
-  void AssertAllRegionLiveBytesZeroOrCleared();
+  // If young_gen is true, the old regions that stayed in the to-space are not checked.
+  void AssertAllRegionLiveBytesZeroOrCleared(bool young_gen);
 
   void RecordAlloc(mirror::Object* ref);
   bool AllocNewTlab(Thread* self);
@@ -225,7 +269,11 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
  private:
   RegionSpace(const std::string& name, MemMap* mem_map);
 
-  template<bool kToSpaceOnly>
+  // Fill evacuate with the regions that a full collection evacuates.
+  void SelectRegionsToEvacuate(std::vector<bool>* evacuate)
+      EXCLUSIVE_LOCKS_REQUIRED(region_lock_);
+
+  template<bool kToSpaceOnly, bool kNewlyAllocatedOnly = false>
   void WalkInternal(ObjectCallback* callback, void* arg) NO_THREAD_SAFETY_ANALYSIS;
 
   class Region {
@@ -310,6 +358,10 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       is_newly_allocated_ = true;
     }
 
+    bool IsNewlyAllocated() const {
+      return is_newly_allocated_;
+    }
+
     // Non-large, non-large-tail allocated.
     bool IsAllocated() const {
       return state_ == RegionState::kRegionStateAllocated;
@@ -368,9 +420,23 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     void SetUnevacFromSpaceAsToSpace() {
       DCHECK(!IsFree() && IsInUnevacFromSpace());
       type_ = RegionType::kRegionTypeToSpace;
+      // The region survived a collection and is old from now on.
+      is_newly_allocated_ = false;
     }
 
-    ALWAYS_INLINE bool ShouldBeEvacuated();
+    ALWAYS_INLINE bool ShouldBeEvacuated(bool young_gen);
+
+    // The cost/benefit score of evacuating an old region: the space that is reclaimed, weighted
+    // by the age of the region, over the live bytes that are copied. Old regions that are mostly
+    // garbage and have been stable for long score high.
+    double EvacuationScore(uint32_t time) const {
+      DCHECK(IsAllocated() && !IsNewlyAllocated());
+      DCHECK_NE(live_bytes_, static_cast<size_t>(-1));
+      DCHECK_LE(live_bytes_, kRegionSize);
+      DCHECK_GT(time, alloc_time_);
+      double age = time - alloc_time_;
+      return (kRegionSize - live_bytes_) * age / (kRegionSize + live_bytes_);
+    }
 
     void AddLiveBytes(size_t live_bytes) {
       DCHECK(IsInUnevacFromSpace());
@@ -469,7 +535,8 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     uint64_t objects_allocated_;   // The number of objects allocated.
     uint32_t alloc_time_;          // The allocation time of the region.
     size_t live_bytes_;            // The live bytes. Used to compute the live percent.
-    bool is_newly_allocated_;      // True if it's allocated after the last collection.
+    bool is_newly_allocated_;      // True if it's allocated by mutators after the last
+                                   // collection, i.e. the region is young.
     bool is_a_tlab_;               // True if it's a tlab.
     Thread* thread_;               // The owning thread if it's a tlab.
 
@@ -511,11 +578,16 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   uint32_t time_;                  // The time as the number of collections since the startup.
   size_t num_regions_;             // The number of regions in this space.
   size_t num_non_free_regions_;    // The number of non-free regions in this space.
+  size_t evacuation_budget_;       // The max bytes to copy out of old regions, 0 if unlimited.
   std::unique_ptr<Region[]> regions_ GUARDED_BY(region_lock_);
                                    // The pointer to the region array.
   Region* current_region_;         // The region that's being allocated currently.
   Region* evac_region_;            // The region that's being evacuated to currently.
   Region full_region_;             // The dummy/sentinel region that looks full.
+  // The marks of the objects that survived the collections, see GetRegionMarkBitmap().
+  std::unique_ptr<accounting::ContinuousSpaceBitmap> region_mark_bitmap_;
+
+  friend class RegionSpaceTest;
 
   DISALLOW_COPY_AND_ASSIGN(RegionSpace);
 };
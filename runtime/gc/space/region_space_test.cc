@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "region_space.h"
+
+#include <memory>
+#include <vector>
+
+#include "common_runtime_test.h"
+#include "region_space-inl.h"
+
+namespace art {
+namespace gc {
+namespace space {
+
+class RegionSpaceTest : public CommonRuntimeTest {
+ protected:
+  static constexpr size_t kNumRegions = 8;
+  static constexpr uint32_t kTime = 10;
+
+  void SetUp() OVERRIDE {
+    CommonRuntimeTest::SetUp();
+    space_.reset(RegionSpace::Create("test region space", kNumRegions * RegionSpace::kRegionSize,
+                                     nullptr));
+    ASSERT_TRUE(space_ != nullptr);
+    space_->time_ = kTime;
+  }
+
+  void TearDown() OVERRIDE {
+    space_.reset();
+    CommonRuntimeTest::TearDown();
+  }
+
+  // Make region idx a full region that was allocated at alloc_time and survived a collection
+  // with live_bytes live.
+  void MakeOldRegion(size_t idx, uint32_t alloc_time, size_t live_bytes) {
+    MutexLock mu(Thread::Current(), space_->region_lock_);
+    RegionSpace::Region* r = &space_->regions_[idx];
+    r->Unfree(alloc_time);
+    ++space_->num_non_free_regions_;
+    size_t bytes_allocated;
+    size_t bytes_tl_bulk_allocated;
+    ASSERT_TRUE(r->Alloc(RegionSpace::kRegionSize, &bytes_allocated, nullptr,
+                         &bytes_tl_bulk_allocated) != nullptr);
+    r->SetAsUnevacFromSpace();
+    r->AddLiveBytes(live_bytes);
+    r->SetUnevacFromSpaceAsToSpace();
+  }
+
+  // Make region idx a region that mutators allocated in since the last collection.
+  void MakeYoungRegion(size_t idx) {
+    MutexLock mu(Thread::Current(), space_->region_lock_);
+    RegionSpace::Region* r = &space_->regions_[idx];
+    r->Unfree(kTime);
+    ++space_->num_non_free_regions_;
+    r->SetNewlyAllocated();
+  }
+
+  std::vector<bool> SelectRegionsToEvacuate(size_t evacuation_budget) {
+    space_->SetEvacuationBudget(evacuation_budget);
+    std::vector<bool> evacuate;
+    MutexLock mu(Thread::Current(), space_->region_lock_);
+    space_->SelectRegionsToEvacuate(&evacuate);
+    return evacuate;
+  }
+
+  std::unique_ptr<RegionSpace> space_;
+};
+
+TEST_F(RegionSpaceTest, SelectRegionsToEvacuate) {
+  static constexpr size_t kPercent = RegionSpace::kRegionSize / 100;
+  // From the highest to the lowest score: mostly garbage and stable for long first.
+  MakeOldRegion(0, 1, 10 * kPercent);
+  MakeOldRegion(1, 1, 30 * kPercent);
+  MakeOldRegion(2, 1, 60 * kPercent);
+  // As sparse as region 0 but allocated recently, so it scores lower than the others.
+  MakeOldRegion(3, kTime - 1, 10 * kPercent);
+  // Too dense to be a candidate.
+  MakeOldRegion(4, 1, 90 * kPercent);
+  // Young regions are evacuated regardless of the budget.
+  MakeYoungRegion(5);
+  // Regions 6 and 7 are free.
+
+  // No budget: all the candidates.
+  EXPECT_EQ(std::vector<bool>({true, true, true, true, false, true, false, false}),
+            SelectRegionsToEvacuate(0U));
+  // Only the best candidate fits.
+  EXPECT_EQ(std::vector<bool>({true, false, false, false, false, true, false, false}),
+            SelectRegionsToEvacuate(10 * kPercent));
+  // Region 3 fits as well, but region 0 scores higher.
+  EXPECT_EQ(std::vector<bool>({true, false, false, false, false, true, false, false}),
+            SelectRegionsToEvacuate(15 * kPercent));
+  // The two best candidates fit exactly.
+  EXPECT_EQ(std::vector<bool>({true, true, false, false, false, true, false, false}),
+            SelectRegionsToEvacuate(40 * kPercent));
+  // Region 2 does not fit, but the lower scoring region 3 still does.
+  EXPECT_EQ(std::vector<bool>({true, true, false, true, false, true, false, false}),
+            SelectRegionsToEvacuate(50 * kPercent));
+  // A budget smaller than any candidate only leaves the young region.
+  EXPECT_EQ(std::vector<bool>({false, false, false, false, false, true, false, false}),
+            SelectRegionsToEvacuate(kPercent));
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
@@ -204,6 +204,11 @@ size_t RosAllocSpace::Free(Thread* self, mirror::Object* ptr) {
 }
 
 size_t RosAllocSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) {
+  return FreeListInternal<false>(self, num_ptrs, ptrs);
+}
+
+template<bool kParallel>
+size_t RosAllocSpace::FreeListInternal(Thread* self, size_t num_ptrs, mirror::Object** ptrs) {
   DCHECK(ptrs != nullptr);
 
   size_t verify_bytes = 0;
@@ -237,13 +242,76 @@ size_t RosAllocSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** p
     CHECK_EQ(num_broken_ptrs, 0u);
   }
 
-  const size_t bytes_freed = rosalloc_->BulkFree(self, reinterpret_cast<void**>(ptrs), num_ptrs);
+  const size_t bytes_freed = kParallel ?
+      rosalloc_->ParallelBulkFree(self, reinterpret_cast<void**>(ptrs), num_ptrs) :
+      rosalloc_->BulkFree(self, reinterpret_cast<void**>(ptrs), num_ptrs);
   if (kVerifyFreedBytes) {
     CHECK_EQ(verify_bytes, bytes_freed);
   }
   return bytes_freed;
 }
 
+void RosAllocSpace::ParallelSweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg) {
+  // Runs on the GC worker threads, which hold no locks. The GC thread holds the heap bitmap lock
+  // and the bulk free lock on their behalf.
+  SweepCallbackContext* context = static_cast<SweepCallbackContext*>(arg);
+  RosAllocSpace* space = context->space->AsRosAllocSpace();
+  if (!context->swap_bitmaps) {
+    // The ranges of the threads do not share bitmap words.
+    accounting::ContinuousSpaceBitmap* bitmap = space->GetLiveBitmap();
+    for (size_t i = 0; i < num_ptrs; ++i) {
+      bitmap->Clear(ptrs[i]);
+    }
+  }
+  context->freed.objects += num_ptrs;
+  context->freed.bytes += space->FreeListInternal<true>(Thread::Current(), num_ptrs, ptrs);
+}
+
+collector::ObjectBytePair RosAllocSpace::SweepParallel(bool swap_bitmaps, ThreadPool* thread_pool,
+                                                       size_t thread_count) {
+  accounting::ContinuousSpaceBitmap* live_bitmap = GetLiveBitmap();
+  accounting::ContinuousSpaceBitmap* mark_bitmap = GetMarkBitmap();
+  // If the bitmaps are bound then sweeping this space clearly won't do anything.
+  if (live_bitmap == mark_bitmap) {
+    return collector::ObjectBytePair(0, 0);
+  }
+  if (swap_bitmaps) {
+    std::swap(live_bitmap, mark_bitmap);
+  }
+  // A run or a large object that has garbage can't be freed or reallocated by the mutators while
+  // we sweep, so the ranges stay free of shared runs even though the mutators keep allocating.
+  uint8_t* const begin = Begin();
+  uint8_t* const end = End();
+  const size_t num_ranges = thread_count * kParallelSweepRangesPerThread;
+  const size_t range_size = RoundUp(std::max<size_t>((end - begin) / num_ranges, 1U), kPageSize);
+  std::vector<uintptr_t> boundaries;
+  boundaries.push_back(reinterpret_cast<uintptr_t>(begin));
+  for (uint8_t* addr = begin + range_size; addr < end; addr += range_size) {
+    uintptr_t boundary = reinterpret_cast<uintptr_t>(rosalloc_->GetParallelBulkFreeBoundary(addr));
+    if (boundary > boundaries.back()) {
+      boundaries.push_back(boundary);
+    }
+  }
+  boundaries.push_back(reinterpret_cast<uintptr_t>(end));
+  std::vector<SweepCallbackContext> contexts(boundaries.size() - 1,
+                                             SweepCallbackContext(swap_bitmaps, this));
+  std::vector<void*> args;
+  for (SweepCallbackContext& context : contexts) {
+    args.push_back(&context);
+  }
+  Thread* self = Thread::Current();
+  rosalloc_->StartParallelBulkFree(self);
+  accounting::ContinuousSpaceBitmap::ParallelSweepWalk(*live_bitmap, *mark_bitmap, boundaries,
+                                                       &ParallelSweepCallback, args, thread_pool,
+                                                       thread_count);
+  rosalloc_->FinishParallelBulkFree(self);
+  collector::ObjectBytePair freed;
+  for (const SweepCallbackContext& context : contexts) {
+    freed.Add(context.freed);
+  }
+  return freed;
+}
+
 size_t RosAllocSpace::Trim() {
   VLOG(heap) << "RosAllocSpace::Trim() ";
   {
@@ -22,6 +22,9 @@
 #include "space.h"
 
 namespace art {
+
+class ThreadPool;
+
 namespace gc {
 
 namespace collector {
@@ -68,6 +71,13 @@ class RosAllocSpace : public MallocSpace {
   size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) OVERRIDE
       SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // Sweep with thread_count threads of thread_pool. The space is split at run boundaries into
+  // ranges, and each thread frees the garbage of its ranges into the runs with
+  // RosAlloc::ParallelBulkFree().
+  collector::ObjectBytePair SweepParallel(bool swap_bitmaps, ThreadPool* thread_pool,
+                                          size_t thread_count)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   mirror::Object* AllocNonvirtual(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                                   size_t* usable_size, size_t* bytes_tl_bulk_allocated) {
     // RosAlloc zeroes memory internally.
@@ -155,6 +165,12 @@ class RosAllocSpace : public MallocSpace {
   mirror::Object* AllocCommon(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                               size_t* usable_size, size_t* bytes_tl_bulk_allocated);
 
+  template<bool kParallel>
+  size_t FreeListInternal(Thread* self, size_t num_ptrs, mirror::Object** ptrs)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void ParallelSweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
   void* CreateAllocator(void* base, size_t morecore_start, size_t initial_size,
                         size_t maximum_size, bool low_memory_mode) OVERRIDE {
     return CreateRosAlloc(base, morecore_start, initial_size, maximum_size, low_memory_mode,
@@ -0,0 +1,284 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "space_test.h"
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "gc/allocator/rosalloc.h"
+#include "gc/collector/incremental_compact.h"
+#include "handle_scope-inl.h"
+#include "lock_word.h"
+#include "mirror/object_array-inl.h"
+#include "monitor.h"
+#include "thread_list.h"
+
+namespace art {
+namespace gc {
+namespace space {
+
+class RosAllocSpaceCompactionTest : public SpaceTest {
+ protected:
+  typedef std::vector<std::vector<mirror::Object*>> Runs;
+
+  RosAllocSpace* CreateSpace(bool can_move_objects) {
+    RosAllocSpace* space = RosAllocSpace::Create("test", 4 * MB, 16 * MB, 16 * MB, nullptr,
+                                                 Runtime::Current()->GetHeap()->IsLowMemoryMode(),
+                                                 can_move_objects);
+    CHECK(space != nullptr);
+    // Make space findable to the heap, will also delete space when runtime is cleaned up.
+    AddSpace(space);
+    return space;
+  }
+
+  // Fills num_runs runs of the size bracket of object_size with byte arrays, the objects of each
+  // run in an element of runs. The next run is left as the current run of the size bracket, so
+  // that the filled runs go to the non full runs as soon as one of their objects is freed.
+  void FillRuns(RosAllocSpace* space, Thread* self, size_t object_size, size_t num_runs,
+                Runs* runs) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    uint8_t* current_run = nullptr;
+    while (true) {
+      size_t dummy;
+      mirror::Object* obj = Alloc(space, self, object_size, &dummy, nullptr, &dummy);
+      ASSERT_TRUE(obj != nullptr);
+      uint8_t* run = GetRun(space, obj);
+      if (run != current_run) {
+        if (runs->size() == num_runs) {
+          break;
+        }
+        runs->push_back(std::vector<mirror::Object*>());
+        current_run = run;
+      }
+      runs->back().push_back(obj);
+    }
+  }
+
+  // Frees the objects of the run but the first num_kept ones.
+  void KeepObjects(RosAllocSpace* space, Thread* self, std::vector<mirror::Object*>* run,
+                   size_t num_kept) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    ASSERT_GT(num_kept, 0u);
+    for (size_t i = num_kept; i < run->size(); ++i) {
+      space->Free(self, (*run)[i]);
+    }
+    run->resize(num_kept);
+  }
+
+  static uint8_t* GetRun(RosAllocSpace* space, mirror::Object* obj) {
+    return space->GetRosAlloc()->GetParallelBulkFreeBoundary(reinterpret_cast<uint8_t*>(obj));
+  }
+
+  // Takes the runs to evacuate with the mutators suspended like the incremental compaction, puts
+  // them back, and returns the runs and the bytes in use in them.
+  size_t EvacuateRuns(RosAllocSpace* space, size_t max_bytes, std::set<uint8_t*>* runs) {
+    Thread* self = Thread::Current();
+    allocator::RosAlloc* rosalloc = space->GetRosAlloc();
+    std::vector<std::pair<uint8_t*, uint8_t*>> ranges;
+    ThreadList* thread_list = Runtime::Current()->GetThreadList();
+    thread_list->SuspendAll(__FUNCTION__);
+    size_t evacuated_bytes = rosalloc->BeginRunEvacuation(self, max_bytes, &ranges);
+    rosalloc->EndRunEvacuation(self);
+    thread_list->ResumeAll();
+    for (const auto& range : ranges) {
+      uint8_t* run = rosalloc->GetParallelBulkFreeBoundary(range.first);
+      EXPECT_LT(run, range.first);
+      EXPECT_LT(range.first, range.second);
+      EXPECT_TRUE(runs->insert(run).second);
+    }
+    return evacuated_bytes;
+  }
+
+  static void CountFreePageBytes(void* start, void* end, size_t used_bytes, void* arg) {
+    size_t bytes = reinterpret_cast<uint8_t*>(end) - reinterpret_cast<uint8_t*>(start);
+    // Slots are smaller than a page, only the free page runs are a multiple of the page size.
+    if (used_bytes == 0 && IsAligned<kPageSize>(bytes)) {
+      *reinterpret_cast<size_t*>(arg) += bytes;
+    }
+  }
+
+  static size_t GetFreePageBytes(RosAllocSpace* space) {
+    size_t free_page_bytes = 0;
+    space->GetRosAlloc()->InspectAll(CountFreePageBytes, &free_page_bytes);
+    return free_page_bytes;
+  }
+};
+
+TEST_F(RosAllocSpaceCompactionTest, RunSelection) {
+  RosAllocSpace* space = CreateSpace(false);
+  Runs small_runs;
+  Runs large_runs;
+  {
+    Thread* self = Thread::Current();
+    ScopedObjectAccess soa(self);
+    FillRuns(space, self, 1 * KB, 6, &small_runs);
+    FillRuns(space, self, 2 * KB, 4, &large_runs);
+    const size_t small_slots = small_runs[0].size();
+    const size_t large_slots = large_runs[0].size();
+    ASSERT_GE(small_slots, 8u);
+    ASSERT_GE(large_slots, 8u);
+    // Sparse enough to be evacuated, the first one is the cheapest.
+    KeepObjects(space, self, &small_runs[0], 1);
+    KeepObjects(space, self, &small_runs[1], small_slots / 4);
+    KeepObjects(space, self, &small_runs[2], small_slots / 2);
+    // Too dense to be evacuated.
+    KeepObjects(space, self, &small_runs[3], small_slots * 3 / 4);
+    KeepObjects(space, self, &small_runs[4], small_slots - 1);
+    // small_runs[5] is full.
+    KeepObjects(space, self, &large_runs[0], 1);
+    KeepObjects(space, self, &large_runs[1], large_slots / 4);
+    // Sparse enough, but the fullest non full run of its size bracket.
+    KeepObjects(space, self, &large_runs[2], large_slots / 2);
+    // large_runs[3] is full.
+  }
+
+  std::set<uint8_t*> runs;
+  size_t evacuated_bytes = EvacuateRuns(space, SIZE_MAX, &runs);
+  std::set<uint8_t*> expected_runs;
+  size_t expected_bytes = 0;
+  for (size_t i = 0; i < 3; ++i) {
+    expected_runs.insert(GetRun(space, small_runs[i][0]));
+    expected_bytes += small_runs[i].size() * KB;
+  }
+  for (size_t i = 0; i < 2; ++i) {
+    expected_runs.insert(GetRun(space, large_runs[i][0]));
+    expected_bytes += large_runs[i].size() * 2 * KB;
+  }
+  EXPECT_EQ(expected_runs, runs);
+  EXPECT_EQ(expected_bytes, evacuated_bytes);
+
+  // The runs were put back into the allocator and are taken again.
+  std::set<uint8_t*> runs_again;
+  EXPECT_EQ(evacuated_bytes, EvacuateRuns(space, SIZE_MAX, &runs_again));
+  EXPECT_EQ(runs, runs_again);
+
+  // The bytes in use in the runs stay within the budget, the two runs with a single object only
+  // fit in this one.
+  std::set<uint8_t*> budget_runs;
+  EXPECT_EQ(3 * KB, EvacuateRuns(space, 3 * KB, &budget_runs));
+  std::set<uint8_t*> single_object_runs;
+  single_object_runs.insert(GetRun(space, small_runs[0][0]));
+  single_object_runs.insert(GetRun(space, large_runs[0][0]));
+  EXPECT_EQ(single_object_runs, budget_runs);
+
+  // At least one run is taken, however small the budget.
+  std::set<uint8_t*> min_runs;
+  EXPECT_NE(0u, EvacuateRuns(space, 1, &min_runs));
+  ASSERT_EQ(1u, min_runs.size());
+  EXPECT_NE(0u, single_object_runs.count(*min_runs.begin()));
+}
+
+TEST_F(RosAllocSpaceCompactionTest, Compaction) {
+  Heap* heap = Runtime::Current()->GetHeap();
+  if (heap->GetCurrentAllocator() != kAllocatorTypeRosAlloc) {
+    // The objects are not allocated in RosAlloc spaces.
+    return;
+  }
+  RosAllocSpace* space = CreateSpace(true);
+  static constexpr size_t kNumObjects = 512;
+  static constexpr size_t kKeptInterval = 8;
+  // Fits the 1KB size bracket.
+  static constexpr int32_t kLength = 1000;
+  Thread* self = Thread::Current();
+  ScopedObjectAccess soa(self);
+  StackHandleScope<2> hs(self);
+  Handle<mirror::Class> array_class(
+      hs.NewHandle(class_linker_->FindSystemClass(self, "[Ljava/lang/Object;")));
+  Handle<mirror::ObjectArray<mirror::Object>> holder(
+      hs.NewHandle(mirror::ObjectArray<mirror::Object>::Alloc(self, array_class.Get(),
+                                                                kNumObjects)));
+  ASSERT_TRUE(holder.Get() != nullptr);
+  for (size_t i = 0; i < kNumObjects; ++i) {
+    mirror::ByteArray* array = mirror::ByteArray::Alloc(self, kLength);
+    ASSERT_TRUE(array != nullptr);
+    ASSERT_TRUE(space->Contains(array));
+    array->GetData()[0] = static_cast<int8_t>(i);
+    array->GetData()[kLength - 1] = static_cast<int8_t>(~i);
+    holder->Set<false>(i, array);
+  }
+  // Leave the runs sparse.
+  for (size_t i = 0; i < kNumObjects; ++i) {
+    if (i % kKeptInterval != 0) {
+      holder->Set<false>(i, nullptr);
+    }
+  }
+  heap->CollectGarbage(false);
+
+  // Hash some of the objects, lock some others, and do both for the rest, which inflates their
+  // monitors.
+  std::vector<uintptr_t> addresses;
+  std::vector<int32_t> hash_codes;
+  std::set<uint8_t*> runs_before;
+  for (size_t i = 0; i < kNumObjects; i += kKeptInterval) {
+    mirror::Object* obj = holder->Get(i);
+    size_t kind = (i / kKeptInterval) % 3;
+    hash_codes.push_back(kind != 2 ? obj->IdentityHashCode() : 0);
+    if (kind != 0) {
+      obj = Monitor::MonitorEnter(self, obj);
+    }
+    addresses.push_back(reinterpret_cast<uintptr_t>(obj));
+    runs_before.insert(GetRun(space, obj));
+  }
+  const size_t free_page_bytes_before = GetFreePageBytes(space);
+
+  collector::IncrementalCompact collector(heap);
+  {
+    ScopedThreadStateChange tsc(self, kWaitingPerformingGc);
+    collector.SetSpace(space);
+    collector.SetEvacuationBudget(16 * MB);
+    collector.Run(kGcCauseHomogeneousSpaceCompact, false);
+  }
+  EXPECT_NE(0u, collector.GetRunsEvacuated());
+
+  size_t moved = 0;
+  std::set<uint8_t*> runs_after;
+  for (size_t i = 0, j = 0; i < kNumObjects; i += kKeptInterval, ++j) {
+    mirror::Object* obj = holder->Get(i);
+    ASSERT_TRUE(obj != nullptr);
+    ASSERT_TRUE(space->Contains(obj));
+    if (reinterpret_cast<uintptr_t>(obj) != addresses[j]) {
+      ++moved;
+    }
+    runs_after.insert(GetRun(space, obj));
+    mirror::ByteArray* array = obj->AsByteArray();
+    EXPECT_EQ(kLength, array->GetLength());
+    EXPECT_EQ(static_cast<int8_t>(i), array->GetData()[0]);
+    EXPECT_EQ(static_cast<int8_t>(~i), array->GetData()[kLength - 1]);
+    size_t kind = (i / kKeptInterval) % 3;
+    if (kind != 2) {
+      EXPECT_EQ(hash_codes[j], obj->IdentityHashCode());
+    }
+    if (kind != 0) {
+      EXPECT_EQ(self->GetThreadId(), obj->GetLockOwnerThreadId());
+      if (kind == 1) {
+        LockWord lock_word = obj->GetLockWord(false);
+        ASSERT_EQ(LockWord::kFatLocked, lock_word.GetState());
+        EXPECT_EQ(obj, lock_word.FatLockMonitor()->GetObject());
+      }
+      EXPECT_TRUE(Monitor::MonitorExit(self, obj));
+    }
+  }
+  EXPECT_FALSE(self->IsExceptionPending());
+  EXPECT_NE(0u, moved);
+  EXPECT_LE(moved, collector.GetObjectsMoved());
+  // The objects were moved out of the evacuated runs, which released their pages.
+  EXPECT_LT(runs_after.size(), runs_before.size());
+  EXPECT_GT(GetFreePageBytes(space), free_page_bytes_before);
+}
+
+}  // namespace space
+}  // namespace gc
+}  // namespace art
@@ -247,6 +247,9 @@ class AllocSpace {
   virtual void LogFragmentationAllocFailure(std::ostream& os, size_t failed_alloc_bytes) = 0;
 
  protected:
+  // Parallel sweeping splits a space into this many ranges per thread to balance the load.
+  static constexpr size_t kParallelSweepRangesPerThread = 4;
+
   struct SweepCallbackContext {
     SweepCallbackContext(bool swap_bitmaps, space::Space* space);
     const bool swap_bitmaps;
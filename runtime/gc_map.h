@@ -82,6 +82,11 @@ class NativePcOffsetToReferenceMap {
     return hash;
   }
 
+  // The size of the encoded map in bytes, including the header.
+  size_t SizeInBytes() const {
+    return 4 + NumEntries() * EntryWidth();
+  }
+
   // The number of bytes used to encode registers.
   size_t RegWidth() const {
     return (static_cast<size_t>(data_[0]) | (static_cast<size_t>(data_[1]) << 8)) >> 3;
@@ -96,6 +96,11 @@ static constexpr bool kUseBakerOrBrooksReadBarrier = kUseBakerReadBarrier || kUs
 static constexpr bool kUseReadBarrier = kUseBakerReadBarrier || kUseBrooksReadBarrier ||
     kUseTableLookupReadBarrier;
 
+// If true, the optimizing compiler emits read barriers for heap reference and GC root loads.
+// Only Baker read barriers are supported by the compiler; with other kinds of read barriers,
+// the code is interpreted.
+static constexpr bool kEmitCompilerReadBarrier = kUseBakerReadBarrier;
+
 // If true, references within the heap are poisoned (negated).
 #ifdef ART_HEAP_POISONING
 static constexpr bool kPoisonHeapReferences = true;
@@ -27,6 +27,7 @@
 #include "entrypoints/quick/quick_entrypoints.h"
 #include "entrypoints/quick/quick_alloc_entrypoints.h"
 #include "entrypoints/runtime_asm_entrypoints.h"
+#include "gc/heap.h"
 #include "gc_root-inl.h"
 #include "interpreter/interpreter.h"
 #include "jit/jit.h"
@@ -616,6 +617,8 @@ void Instrumentation::SetEntrypointsInstrumented(bool instrumented) {
     SetQuickAllocEntryPointsInstrumented(instrumented);
     ResetQuickAllocEntryPoints();
   }
+  // Compiled code bump-allocates from thread-local buffers without calling the entrypoints.
+  runtime->GetHeap()->SetTlabsEnabled(!instrumented);
   if (runtime->IsStarted()) {
     tl->ResumeAll();
   }
@@ -328,6 +328,11 @@ class MANAGED Class FINAL : public Object {
   template<VerifyObjectFlags kVerifyFlags = kDefaultVerifyFlags>
   Primitive::Type GetPrimitiveType() ALWAYS_INLINE SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  // The primitive type is in the low 16 bits, the component size shift in the upper 16 bits.
+  static MemberOffset PrimitiveTypeOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(Class, primitive_type_);
+  }
+
   void SetPrimitiveType(Primitive::Type new_type) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
     DCHECK_EQ(sizeof(Primitive::Type), sizeof(int32_t));
     int32_t v32 = static_cast<int32_t>(new_type);
@@ -875,6 +880,10 @@ class MANAGED Class FINAL : public Object {
 
   ALWAYS_INLINE void SetIfTable(IfTable* new_iftable) SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
+  static MemberOffset IfTableOffset() {
+    return OFFSET_OF_OBJECT_MEMBER(Class, iftable_);
+  }
+
   // Get instance fields of the class (See also GetSFields).
   ArtField* GetIFields() SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
 
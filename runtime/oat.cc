@@ -119,6 +119,8 @@ OatHeader::OatHeader(InstructionSet instruction_set,
   quick_imt_conflict_trampoline_offset_ = 0;
   quick_resolution_trampoline_offset_ = 0;
   quick_to_interpreter_bridge_offset_ = 0;
+  verifier_deps_offset_ = 0;
+  verifier_deps_size_ = 0;
 }
 
 bool OatHeader::IsValid() const {
@@ -336,6 +338,27 @@ void OatHeader::SetQuickToInterpreterBridgeOffset(uint32_t offset) {
   UpdateChecksum(&quick_to_interpreter_bridge_offset_, sizeof(offset));
 }
 
+uint32_t OatHeader::GetVerifierDepsOffset() const {
+  DCHECK(IsValid());
+  return verifier_deps_offset_;
+}
+
+uint32_t OatHeader::GetVerifierDepsSize() const {
+  DCHECK(IsValid());
+  return verifier_deps_size_;
+}
+
+void OatHeader::SetVerifierDeps(uint32_t offset, uint32_t size) {
+  CHECK(size == 0 || offset >= sizeof(OatHeader));
+  DCHECK(IsValid());
+  DCHECK_EQ(verifier_deps_size_, 0U);
+
+  verifier_deps_offset_ = offset;
+  UpdateChecksum(&verifier_deps_offset_, sizeof(offset));
+  verifier_deps_size_ = size;
+  UpdateChecksum(&verifier_deps_size_, sizeof(size));
+}
+
 int32_t OatHeader::GetImagePatchDelta() const {
   CHECK(IsValid());
   return image_patch_delta_;
@@ -452,6 +475,10 @@ bool OatHeader::IsDebuggable() const {
   return IsKeyEnabled(OatHeader::kDebuggableKey);
 }
 
+bool OatHeader::IsDexCompressed() const {
+  return IsKeyEnabled(OatHeader::kCompressedDexKey);
+}
+
 bool OatHeader::IsKeyEnabled(const char* key) const {
   const char* key_value = GetStoreValueByKey(key);
   return (key_value != nullptr && strncmp(key_value, kTrueValue, sizeof(kTrueValue)) == 0);
@@ -32,7 +32,7 @@ class InstructionSetFeatures;
 class PACKED(4) OatHeader {
  public:
   static constexpr uint8_t kOatMagic[] = { 'o', 'a', 't', '\n' };
-  static constexpr uint8_t kOatVersion[] = { '0', '6', '4', '\0' };
+  static constexpr uint8_t kOatVersion[] = { '0', '6', '8', '\0' };
 
   static constexpr const char* kImageLocationKey = "image-location";
   static constexpr const char* kDex2OatCmdLineKey = "dex2oat-cmdline";
@@ -40,6 +40,10 @@ class PACKED(4) OatHeader {
   static constexpr const char* kPicKey = "pic";
   static constexpr const char* kDebuggableKey = "debuggable";
   static constexpr const char* kClassPathKey = "classpath";
+  static constexpr const char* kBootClassPathKey = "bootclasspath";
+  static constexpr const char* kBootClassPathChecksumsKey = "bootclasspath-checksums";
+  static constexpr const char* kInlineMaxCodeUnitsKey = "inline-max-code-units";
+  static constexpr const char* kCompressedDexKey = "compressed-dex";
 
   static constexpr const char kTrueValue[] = "true";
   static constexpr const char kFalseValue[] = "false";
@@ -87,6 +91,12 @@ class PACKED(4) OatHeader {
   uint32_t GetQuickToInterpreterBridgeOffset() const;
   void SetQuickToInterpreterBridgeOffset(uint32_t offset);
 
+  // The dependencies recorded while verifying the dex files, see verifier::VerifierDeps.
+  // The size is 0 if none were recorded.
+  uint32_t GetVerifierDepsOffset() const;
+  uint32_t GetVerifierDepsSize() const;
+  void SetVerifierDeps(uint32_t offset, uint32_t size);
+
   int32_t GetImagePatchDelta() const;
   void RelocateOat(off_t delta);
   void SetImagePatchDelta(int32_t off);
@@ -104,6 +114,7 @@ class PACKED(4) OatHeader {
   size_t GetHeaderSize() const;
   bool IsPic() const;
   bool IsDebuggable() const;
+  bool IsDexCompressed() const;
 
  private:
   OatHeader(InstructionSet instruction_set,
@@ -133,6 +144,8 @@ class PACKED(4) OatHeader {
   uint32_t quick_imt_conflict_trampoline_offset_;
   uint32_t quick_resolution_trampoline_offset_;
   uint32_t quick_to_interpreter_bridge_offset_;
+  uint32_t verifier_deps_offset_;
+  uint32_t verifier_deps_size_;
 
   // The amount that the image this oat is associated with has been patched.
   int32_t image_patch_delta_;
@@ -35,6 +35,8 @@
 #include "base/bit_vector.h"
 #include "base/stl_util.h"
 #include "base/unix_file/fd_file.h"
+#include "class_lookup_table.h"
+#include "compressed_section.h"
 #include "elf_file.h"
 #include "elf_utils.h"
 #include "oat.h"
@@ -400,6 +402,16 @@ bool OatFile::Setup(const char* abs_dex_location, std::string* error_msg) {
     return false;
   }
 
+  if (GetOatHeader().GetVerifierDepsSize() != 0u &&
+      (GetOatHeader().GetVerifierDepsOffset() > Size() ||
+       GetOatHeader().GetVerifierDepsSize() > Size() - GetOatHeader().GetVerifierDepsOffset())) {
+    *error_msg = StringPrintf("In oat file '%s' found truncated verifier dependencies: "
+                              "%u + %u > %zu", GetLocation().c_str(),
+                              GetOatHeader().GetVerifierDepsOffset(),
+                              GetOatHeader().GetVerifierDepsSize(), Size());
+    return false;
+  }
+
   uint32_t dex_file_count = GetOatHeader().GetDexFileCount();
   oat_dex_files_storage_.reserve(dex_file_count);
   for (size_t i = 0; i < dex_file_count; i++) {
@@ -457,6 +469,15 @@ bool OatFile::Setup(const char* abs_dex_location, std::string* error_msg) {
       return false;
     }
 
+    uint32_t lookup_table_offset = *reinterpret_cast<const uint32_t*>(oat);
+    oat += sizeof(lookup_table_offset);
+    if (UNLIKELY(oat > End())) {
+      *error_msg = StringPrintf("In oat file '%s' found OatDexFile #%zd for '%s' truncated "
+                                "after class lookup table offset", GetLocation().c_str(), i,
+                                dex_file_location.c_str());
+      return false;
+    }
+
     const uint8_t* dex_file_pointer = Begin() + dex_file_offset;
     if (UNLIKELY(!DexFile::IsMagicValid(dex_file_pointer))) {
       *error_msg = StringPrintf("In oat file '%s' found OatDexFile #%zd for '%s' with invalid "
@@ -471,6 +492,43 @@ bool OatFile::Setup(const char* abs_dex_location, std::string* error_msg) {
       return false;
     }
     const DexFile::Header* header = reinterpret_cast<const DexFile::Header*>(dex_file_pointer);
+    if (GetOatHeader().IsDexCompressed()) {
+      // The header of the dex file is followed by the compressed dex file.
+      const uint8_t* compressed_dex_file = dex_file_pointer + sizeof(DexFile::Header);
+      std::string section_error_msg;
+      if (UNLIKELY(compressed_dex_file > End() ||
+                   !CompressedSection::IsValid(compressed_dex_file,
+                                               End() - compressed_dex_file,
+                                               &section_error_msg))) {
+        *error_msg = StringPrintf("In oat file '%s' found OatDexFile #%zd for '%s' with invalid "
+                                  "compressed dex file: %s", GetLocation().c_str(), i,
+                                  dex_file_location.c_str(), section_error_msg.c_str());
+        return false;
+      }
+      if (UNLIKELY(CompressedSection(compressed_dex_file).UncompressedSize() !=
+                   header->file_size_)) {
+        *error_msg = StringPrintf("In oat file '%s' found OatDexFile #%zd for '%s' with "
+                                  "compressed dex file size mismatch", GetLocation().c_str(), i,
+                                  dex_file_location.c_str());
+        return false;
+      }
+    }
+    // A zero offset means that the compiler did not write a class lookup table.
+    const uint8_t* lookup_table_data = nullptr;
+    if (lookup_table_offset != 0u) {
+      if (UNLIKELY(lookup_table_offset > Size() ||
+                   !IsAligned<sizeof(uint32_t)>(lookup_table_offset) ||
+                   ClassLookupTable::ValidatedSize(header->class_defs_size_,
+                                                   Begin() + lookup_table_offset,
+                                                   Size() - lookup_table_offset) == 0u)) {
+        *error_msg = StringPrintf("In oat file '%s' found OatDexFile #%zd for '%s' with invalid "
+                                  "class lookup table at offset %u", GetLocation().c_str(), i,
+                                  dex_file_location.c_str(), lookup_table_offset);
+        return false;
+      }
+      lookup_table_data = Begin() + lookup_table_offset;
+    }
+
     const uint32_t* methods_offsets_pointer = reinterpret_cast<const uint32_t*>(oat);
 
     oat += (sizeof(*methods_offsets_pointer) * header->class_defs_size_);
@@ -489,6 +547,7 @@ bool OatFile::Setup(const char* abs_dex_location, std::string* error_msg) {
                                               canonical_location,
                                               dex_file_checksum,
                                               dex_file_pointer,
+                                              lookup_table_data,
                                               methods_offsets_pointer);
     oat_dex_files_storage_.push_back(oat_dex_file);
 
@@ -602,12 +661,14 @@ OatFile::OatDexFile::OatDexFile(const OatFile* oat_file,
                                 const std::string& canonical_dex_file_location,
                                 uint32_t dex_file_location_checksum,
                                 const uint8_t* dex_file_pointer,
+                                const uint8_t* lookup_table_data,
                                 const uint32_t* oat_class_offsets_pointer)
     : oat_file_(oat_file),
       dex_file_location_(dex_file_location),
       canonical_dex_file_location_(canonical_dex_file_location),
       dex_file_location_checksum_(dex_file_location_checksum),
       dex_file_pointer_(dex_file_pointer),
+      lookup_table_data_(lookup_table_data),
       oat_class_offsets_pointer_(oat_class_offsets_pointer) {}
 
 OatFile::OatDexFile::~OatDexFile() {}
@@ -617,10 +678,44 @@ size_t OatFile::OatDexFile::FileSize() const {
 }
 
 std::unique_ptr<const DexFile> OatFile::OatDexFile::OpenDexFile(std::string* error_msg) const {
+  if (oat_file_->GetOatHeader().IsDexCompressed()) {
+    return OpenCompressedDexFile(error_msg);
+  }
   return DexFile::Open(dex_file_pointer_, FileSize(), dex_file_location_,
                        dex_file_location_checksum_, this, error_msg);
 }
 
+std::unique_ptr<const DexFile> OatFile::OatDexFile::OpenCompressedDexFile(
+    std::string* error_msg) const {
+  CompressedSection compressed_dex_file(dex_file_pointer_ + sizeof(DexFile::Header));
+  const size_t size = FileSize();
+  DCHECK_EQ(size, compressed_dex_file.UncompressedSize());
+  std::unique_ptr<MemMap> map(MemMap::MapAnonymous(dex_file_location_.c_str(),
+                                                   nullptr,
+                                                   RoundUp(size, kPageSize),
+                                                   PROT_READ | PROT_WRITE,
+                                                   false,
+                                                   false,
+                                                   error_msg));
+  if (map.get() == nullptr) {
+    return nullptr;
+  }
+  std::string decompress_error_msg;
+  if (!compressed_dex_file.Decompress(map->Begin(), &decompress_error_msg)) {
+    *error_msg = StringPrintf("Failed to decompress dex file '%s' from '%s': %s",
+                              dex_file_location_.c_str(), oat_file_->GetLocation().c_str(),
+                              decompress_error_msg.c_str());
+    return nullptr;
+  }
+  if (!map->Protect(PROT_READ)) {
+    *error_msg = StringPrintf("Failed to make decompressed dex file '%s' read only",
+                              dex_file_location_.c_str());
+    return nullptr;
+  }
+  return DexFile::Open(map.release(), size, dex_file_location_, dex_file_location_checksum_,
+                       this, error_msg);
+}
+
 uint32_t OatFile::OatDexFile::GetOatClassOffset(uint16_t class_def_index) const {
   return oat_class_offsets_pointer_[class_def_index];
 }
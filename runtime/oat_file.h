@@ -239,6 +239,15 @@ class OatFile FINAL {
   const uint8_t* BssBegin() const;
   const uint8_t* BssEnd() const;
 
+  // The verifier dependencies recorded by the compiler, see verifier::VerifierDeps.
+  const uint8_t* GetVerifierDeps() const {
+    return Begin() + GetOatHeader().GetVerifierDepsOffset();
+  }
+
+  size_t GetVerifierDepsSize() const {
+    return GetOatHeader().GetVerifierDepsSize();
+  }
+
   // Returns the absolute dex location for the encoded relative dex location.
   //
   // If not null, abs_dex_location is used to resolve the absolute dex
@@ -369,13 +378,15 @@ class OatFile FINAL {
 class OatDexFile FINAL {
  public:
   // Opens the DexFile referred to by this OatDexFile from within the containing OatFile.
+  // If the oat file stores its dex files compressed, each call decompresses the dex file
+  // into memory owned by the returned DexFile.
   std::unique_ptr<const DexFile> OpenDexFile(std::string* error_msg) const;
 
   const OatFile* GetOatFile() const {
     return oat_file_;
   }
 
-  // Returns the size of the DexFile refered to by this OatDexFile.
+  // Returns the size of the DexFile refered to by this OatDexFile, uncompressed.
   size_t FileSize() const;
 
   // Returns original path of DexFile that was the source of this OatDexFile.
@@ -393,6 +404,12 @@ class OatDexFile FINAL {
     return dex_file_location_checksum_;
   }
 
+  // Returns the class lookup table written by the compiler, or null if there is none.
+  // See ClassLookupTable for the format.
+  const uint8_t* GetLookupTableData() const {
+    return lookup_table_data_;
+  }
+
   // Returns the OatClass for the class specified by the given DexFile class_def_index.
   OatFile::OatClass GetOatClass(uint16_t class_def_index) const;
 
@@ -407,13 +424,17 @@ class OatDexFile FINAL {
              const std::string& canonical_dex_file_location,
              uint32_t dex_file_checksum,
              const uint8_t* dex_file_pointer,
+             const uint8_t* lookup_table_data,
              const uint32_t* oat_class_offsets_pointer);
 
+  std::unique_ptr<const DexFile> OpenCompressedDexFile(std::string* error_msg) const;
+
   const OatFile* const oat_file_;
   const std::string dex_file_location_;
   const std::string canonical_dex_file_location_;
   const uint32_t dex_file_location_checksum_;
   const uint8_t* const dex_file_pointer_;
+  const uint8_t* const lookup_table_data_;
   const uint32_t* const oat_class_offsets_pointer_;
 
   friend class OatFile;
@@ -447,6 +447,16 @@ bool OatFileAssistant::GivenOatFileIsOutOfDate(const OatFile& file) {
     return true;
   }
 
+  // Verify the checksums of the boot class path entries outside the image, which the
+  // compiled code depends on as much as on the image.
+  std::string error_msg;
+  if (!OatFile::CheckStaticDexFileDependencies(
+          file.GetOatHeader().GetStoreValueByKey(OatHeader::kBootClassPathChecksumsKey),
+          &error_msg)) {
+    VLOG(oat) << "Boot class path entry outside the image has changed: " << error_msg;
+    return true;
+  }
+
   // The checksums are all good; the dex file is not out of date.
   return false;
 }
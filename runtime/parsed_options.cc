@@ -148,6 +148,9 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define({"-XX:EnableHSpaceCompactForOOM", "-XX:DisableHSpaceCompactForOOM"})
           .WithValues({true, false})
           .IntoKey(M::EnableHSpaceCompactForOOM)
+      .Define({"-XX:EnableGenerationalCC", "-XX:DisableGenerationalCC"})
+          .WithValues({true, false})
+          .IntoKey(M::EnableGenerationalCC)
       .Define("-Xusejit:_")
           .WithType<bool>()
           .WithValueMap({{"false", false}, {"true", true}})
@@ -194,6 +197,12 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:LargeObjectThreshold=_")
           .WithType<Memory<1>>()
           .IntoKey(M::LargeObjectThreshold)
+      .Define("-XX:RegionEvacuationBudget=_")
+          .WithType<Memory<1>>()
+          .IntoKey(M::RegionEvacuationBudget)
+      .Define("-XX:IncrementalCompactionPause=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::IncrementalCompactionPause)
       .Define("-XX:BackgroundGC=_")
           .WithType<BackgroundGcOption>()
           .IntoKey(M::BackgroundGc)
@@ -632,9 +641,12 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:DumpJITInfoOnShutdown\n");
   UsageMessage(stream, "  -XX:IgnoreMaxFootprint\n");
   UsageMessage(stream, "  -XX:UseTLAB\n");
+  UsageMessage(stream, "  -XX:EnableGenerationalCC\n");
   UsageMessage(stream, "  -XX:BackgroundGC=none\n");
   UsageMessage(stream, "  -XX:LargeObjectSpace={disabled,map,freelist}\n");
   UsageMessage(stream, "  -XX:LargeObjectThreshold=N\n");
+  UsageMessage(stream, "  -XX:RegionEvacuationBudget=N\n");
+  UsageMessage(stream, "  -XX:IncrementalCompactionPause=integervalue\n");
   UsageMessage(stream, "  -Xmethod-trace\n");
   UsageMessage(stream, "  -Xmethod-trace-file:filename");
   UsageMessage(stream, "  -Xmethod-trace-file-size:integervalue\n");
@@ -69,6 +69,7 @@ enum InlineMethodOpcode : uint16_t {
   kIntrinsicUnsafeGet,
   kIntrinsicUnsafePut,
   kIntrinsicSystemArrayCopyCharArray,
+  kIntrinsicCRC32Update,
 
   kInlineOpNop,
   kInlineOpReturnArg,
@@ -111,6 +112,9 @@ enum IntrinsicFlags {
 
   // kIntrinsicDoubleCvt, kIntrinsicFloatCvt.
   kIntrinsicFlagToFloatingPoint = kIntrinsicFlagMin,
+
+  // kIntrinsicCRC32Update
+  kIntrinsicFlagIsByteArray = kIntrinsicFlagMin,
 };
 
 struct InlineIGetIPutData {
@@ -32,6 +32,7 @@
 #include <cstdlib>
 #include <limits>
 #include <memory_representation.h>
+#include <set>
 #include <vector>
 #include <fcntl.h>
 
@@ -877,7 +878,10 @@ bool Runtime::Init(const RuntimeOptions& raw_options, bool ignore_unrecognized)
                        xgc_option.verify_post_gc_rosalloc_,
                        xgc_option.gcstress_,
                        runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
-                       runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs));
+                       runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs),
+                       runtime_options.GetOrDefault(Opt::EnableGenerationalCC),
+                       runtime_options.GetOrDefault(Opt::RegionEvacuationBudget),
+                       runtime_options.GetOrDefault(Opt::IncrementalCompactionPause));
   ATRACE_END();
 
   if (heap_->GetImageSpace() == nullptr && !allow_dex_file_fallback_) {
@@ -918,11 +922,17 @@ bool Runtime::Init(const RuntimeOptions& raw_options, bool ignore_unrecognized)
 
   // Change the implicit checks flags based on runtime architecture.
   switch (kRuntimeISA) {
+    case kArm64:
+    case kX86_64:
+      implicit_null_checks_ = true;
+      // Installing stack protection does not play well with valgrind.
+      implicit_so_checks_ = (RUNNING_ON_VALGRIND == 0);
+      // Code compiled with --implicit-suspend-checks polls the suspend trigger.
+      implicit_suspend_checks_ = true;
+      break;
     case kArm:
     case kThumb2:
     case kX86:
-    case kArm64:
-    case kX86_64:
     case kMips:
     case kMips64:
       implicit_null_checks_ = true;
@@ -990,15 +1000,44 @@ bool Runtime::Init(const RuntimeOptions& raw_options, bool ignore_unrecognized)
     if (kIsDebugBuild) {
       GetHeap()->GetImageSpace()->VerifyImageAllocations();
     }
+    // Whether the boot class path may list entries outside of the image.
+    bool has_boot_class_path_extension = true;
     if (boot_class_path_string_.empty()) {
-      // The bootclasspath is not explicitly specified: construct it from the loaded dex files.
-      const std::vector<const DexFile*>& boot_class_path = GetClassLinker()->GetBootClassPath();
+      // The bootclasspath is not explicitly specified: use the one recorded in the image, or
+      // construct it from the loaded dex files.
+      const char* recorded_boot_class_path = GetHeap()->GetImageSpace()->GetOatFile()->
+          GetOatHeader().GetStoreValueByKey(OatHeader::kBootClassPathKey);
+      if (recorded_boot_class_path != nullptr) {
+        boot_class_path_string_ = recorded_boot_class_path;
+      } else {
+        const std::vector<const DexFile*>& boot_class_path = GetClassLinker()->GetBootClassPath();
+        std::vector<std::string> dex_locations;
+        dex_locations.reserve(boot_class_path.size());
+        for (const DexFile* dex_file : boot_class_path) {
+          dex_locations.push_back(dex_file->GetLocation());
+        }
+        boot_class_path_string_ = Join(dex_locations, ':');
+        has_boot_class_path_extension = false;
+      }
+    }
+    if (has_boot_class_path_extension && !IsAotCompiler()) {
+      // The boot image may cover only part of the boot class path. Load the other entries with
+      // their own oat files. The compiler decides itself which entries it needs, see dex2oat.
+      std::vector<std::string> dex_filenames;
+      Split(boot_class_path_string_, ':', &dex_filenames);
       std::vector<std::string> dex_locations;
-      dex_locations.reserve(boot_class_path.size());
-      for (const DexFile* dex_file : boot_class_path) {
-        dex_locations.push_back(dex_file->GetLocation());
+      if (!runtime_options.Exists(Opt::BootClassPathLocations)) {
+        dex_locations = dex_filenames;
+      } else {
+        dex_locations = runtime_options.GetOrDefault(Opt::BootClassPathLocations);
+        CHECK_EQ(dex_filenames.size(), dex_locations.size());
       }
-      boot_class_path_string_ = Join(dex_locations, ':');
+      ATRACE_BEGIN("AppendBootClassPathExtension");
+      class_linker_->AppendBootClassPathExtension(dex_filenames,
+                                                  dex_locations,
+                                                  std::set<std::string>(),
+                                                  true);
+      ATRACE_END();
     }
   } else {
     std::vector<std::string> dex_filenames;
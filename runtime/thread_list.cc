@@ -33,6 +33,8 @@
 #include "base/time_utils.h"
 #include "base/timing_logger.h"
 #include "debugger.h"
+#include "gc/collector/concurrent_copying.h"
+#include "gc/heap.h"
 #include "jni_internal.h"
 #include "lock_word.h"
 #include "monitor.h"
@@ -1102,6 +1104,16 @@ void ThreadList::Register(Thread* self) {
   }
   CHECK(!Contains(self));
   list_.push_back(self);
+  if (kUseReadBarrier) {
+    // Initialize this according to the state of the CC collector. Threads registered before
+    // marking starts have the flag set by the thread flip, and marking is switched off while
+    // holding the thread list lock, so no change of state is missed.
+    gc::Heap* heap = Runtime::Current()->GetHeap();
+    bool is_gc_marking = heap != nullptr &&
+        heap->ConcurrentCopyingCollector() != nullptr &&
+        heap->ConcurrentCopyingCollector()->IsMarking();
+    self->SetIsGcMarking(is_gc_marking);
+  }
 }
 
 void ThreadList::Unregister(Thread* self) {
@@ -45,6 +45,7 @@
 #include "utils.h"
 #include "handle_scope-inl.h"
 #include "verifier/dex_gc_map.h"
+#include "verifier/verifier_deps.h"
 
 namespace art {
 namespace verifier {
@@ -762,6 +763,8 @@ bool MethodVerifier::ScanTryCatchBlocks() {
         mirror::Class* exception_type = linker->ResolveType(*dex_file_,
                                                             iterator.GetHandlerTypeIndex(),
                                                             dex_cache_, class_loader_);
+        VerifierDeps::MaybeRecordClassResolution(
+            dex_file_->StringByTypeIdx(iterator.GetHandlerTypeIndex()), exception_type);
         if (exception_type == nullptr) {
           DCHECK(self_->IsExceptionPending());
           self_->ClearException();
@@ -3038,6 +3041,8 @@ bool MethodVerifier::CodeFlowVerifyInstruction(uint32_t* start_guess) {
         // It is also a catch-all if it is java.lang.Throwable.
         mirror::Class* klass = linker->ResolveType(*dex_file_, handler_type_idx, dex_cache_,
                                                    class_loader_);
+        VerifierDeps::MaybeRecordClassResolution(dex_file_->StringByTypeIdx(handler_type_idx),
+                                                 klass);
         if (klass != nullptr) {
           if (klass == mirror::Throwable::GetJavaLangThrowable()) {
             has_catch_all_handler = true;
@@ -3230,6 +3235,16 @@ const RegType& MethodVerifier::GetCaughtExceptionType() {
   return *common_super;
 }
 
+static VerifierDeps::MethodResolutionKind GetMethodResolutionKind(MethodType method_type) {
+  if (method_type == METHOD_DIRECT || method_type == METHOD_STATIC) {
+    return VerifierDeps::kDirectMethodResolution;
+  } else if (method_type == METHOD_INTERFACE) {
+    return VerifierDeps::kInterfaceMethodResolution;
+  } else {
+    return VerifierDeps::kVirtualMethodResolution;
+  }
+}
+
 ArtMethod* MethodVerifier::ResolveMethodAndCheckAccess(
     uint32_t dex_method_idx, MethodType method_type) {
   const DexFile::MethodId& method_id = dex_file_->GetMethodId(dex_method_idx);
@@ -3269,6 +3284,8 @@ ArtMethod* MethodVerifier::ResolveMethodAndCheckAccess(
         res_method = klass->FindDirectMethod(name, signature, pointer_size);
       }
       if (res_method == nullptr) {
+        VerifierDeps::MaybeRecordMethodResolution(*dex_file_, dex_method_idx,
+                                                  GetMethodResolutionKind(method_type), nullptr);
         Fail(VERIFY_ERROR_NO_METHOD) << "couldn't find method "
                                      << PrettyDescriptor(klass) << "." << name
                                      << " " << signature;
@@ -3276,6 +3293,8 @@ ArtMethod* MethodVerifier::ResolveMethodAndCheckAccess(
       }
     }
   }
+  VerifierDeps::MaybeRecordMethodResolution(*dex_file_, dex_method_idx,
+                                            GetMethodResolutionKind(method_type), res_method);
   // Make sure calls to constructors are "direct". There are additional restrictions but we don't
   // enforce them here.
   if (res_method->IsConstructor() && method_type != METHOD_DIRECT) {
@@ -3884,6 +3903,7 @@ ArtField* MethodVerifier::GetStaticField(int field_idx) {
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   ArtField* field = class_linker->ResolveFieldJLS(*dex_file_, field_idx, dex_cache_,
                                                   class_loader_);
+  VerifierDeps::MaybeRecordFieldResolution(*dex_file_, field_idx, field);
   if (field == nullptr) {
     VLOG(verifier) << "Unable to resolve static field " << field_idx << " ("
               << dex_file_->GetFieldName(field_id) << ") in "
@@ -3919,6 +3939,7 @@ ArtField* MethodVerifier::GetInstanceField(const RegType& obj_type, int field_id
   ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
   ArtField* field = class_linker->ResolveFieldJLS(*dex_file_, field_idx, dex_cache_,
                                                   class_loader_);
+  VerifierDeps::MaybeRecordFieldResolution(*dex_file_, field_idx, field);
   if (field == nullptr) {
     VLOG(verifier) << "Unable to resolve instance field " << field_idx << " ("
               << dex_file_->GetFieldName(field_id) << ") in "
@@ -22,6 +22,7 @@
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "reg_type-inl.h"
+#include "verifier_deps.h"
 
 namespace art {
 namespace verifier {
@@ -171,6 +172,10 @@ const RegType& RegTypeCache::From(mirror::ClassLoader* loader, const char* descr
   // Class not found in the cache, will create a new type for that.
   // Try resolving class.
   mirror::Class* klass = ResolveClass(descriptor, loader);
+  if (can_load_classes_) {
+    // Without loading classes the lookup result is not meaningful.
+    VerifierDeps::MaybeRecordClassResolution(descriptor, klass);
+  }
   if (klass != nullptr) {
     // Class resolved, first look for the class in the list of entries
     // Class was not found, must create new type.
@@ -219,6 +224,7 @@ const RegType& RegTypeCache::FromClass(const char* descriptor, mirror::Class* kl
     // primitive classes are final.
     return RegTypeFromPrimitiveType(klass->GetPrimitiveType());
   } else {
+    VerifierDeps::MaybeRecordClassResolution(descriptor, klass);
     // Look for the reference in the list of entries to have.
     for (size_t i = primitive_count_; i < entries_.size(); i++) {
       const RegType* cur_entry = entries_[i];
@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verifier_deps.h"
+
+#include <memory>
+
+#include "art_field-inl.h"
+#include "art_method-inl.h"
+#include "base/stringprintf.h"
+#include "class_linker.h"
+#include "compiler_callbacks.h"
+#include "dex_file-inl.h"
+#include "handle_scope-inl.h"
+#include "leb128.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/iftable-inl.h"
+#include "modifiers.h"
+#include "runtime.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace verifier {
+
+// The first character of a method key, see VerifierDeps::methods_.
+static constexpr char kDirectMethodKey = 'd';
+static constexpr char kVirtualMethodKey = 'v';
+static constexpr char kInterfaceMethodKey = 'i';
+
+static constexpr uint32_t kResolvedFlag = 1u;
+static constexpr uint32_t kInternalFlag = 2u;
+
+static VerifierDeps* GetRecordingVerifierDeps() {
+  CompilerCallbacks* callbacks = Runtime::Current()->GetCompilerCallbacks();
+  return (callbacks != nullptr) ? callbacks->GetVerifierDeps() : nullptr;
+}
+
+static void EncodeString(std::vector<uint8_t>* buffer, const std::string& value) {
+  EncodeUnsignedLeb128(buffer, value.size());
+  buffer->insert(buffer->end(), value.begin(), value.end());
+}
+
+// Reads the data written by VerifierDeps::Encode(), failing on truncated data.
+class VerifierDepsReader {
+ public:
+  VerifierDepsReader(const uint8_t* data, size_t size) : ptr_(data), end_(data + size) { }
+
+  bool ReadUnsigned(uint32_t* value) {
+    uint32_t result = 0u;
+    for (size_t shift = 0u; shift < 35u; shift += 7u) {
+      if (ptr_ == end_) {
+        return false;
+      }
+      uint8_t byte = *ptr_++;
+      result |= static_cast<uint32_t>(byte & 0x7fu) << shift;
+      if ((byte & 0x80u) == 0u) {
+        *value = result;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadString(std::string* value) {
+    uint32_t length;
+    if (!ReadUnsigned(&length) || length > static_cast<size_t>(end_ - ptr_)) {
+      return false;
+    }
+    value->assign(reinterpret_cast<const char*>(ptr_), length);
+    ptr_ += length;
+    return true;
+  }
+
+  bool AtEnd() const {
+    return ptr_ == end_;
+  }
+
+ private:
+  const uint8_t* ptr_;
+  const uint8_t* const end_;
+};
+
+bool VerifierDeps::ClassResolution::operator==(const ClassResolution& other) const {
+  return resolved == other.resolved &&
+      internal == other.internal &&
+      access_flags == other.access_flags &&
+      super_descriptor == other.super_descriptor &&
+      interface_descriptors == other.interface_descriptors &&
+      component_descriptor == other.component_descriptor;
+}
+
+bool VerifierDeps::MemberResolution::operator==(const MemberResolution& other) const {
+  return resolved == other.resolved &&
+      declaring_class_descriptor == other.declaring_class_descriptor &&
+      access_flags == other.access_flags;
+}
+
+VerifierDeps::VerifierDeps(const std::vector<const DexFile*>& dex_files)
+    : dex_files_(dex_files.begin(), dex_files.end()),
+      lock_("verifier dependencies lock") {
+}
+
+VerifierDeps::~VerifierDeps() {
+}
+
+void VerifierDeps::MaybeRecordClassResolution(const char* descriptor, mirror::Class* klass) {
+  VerifierDeps* deps = GetRecordingVerifierDeps();
+  if (deps == nullptr) {
+    return;
+  }
+  if (klass != nullptr ? klass->IsPrimitive() : !IsValidDescriptor(descriptor)) {
+    // Neither depends on the class path.
+    return;
+  }
+  MutexLock mu(Thread::Current(), deps->lock_);
+  deps->RecordClass(descriptor, klass);
+}
+
+void VerifierDeps::MaybeRecordFieldResolution(const DexFile& dex_file,
+                                               uint32_t field_idx,
+                                               ArtField* field) {
+  VerifierDeps* deps = GetRecordingVerifierDeps();
+  if (deps == nullptr) {
+    return;
+  }
+  const DexFile::FieldId& field_id = dex_file.GetFieldId(field_idx);
+  std::string key = dex_file.GetFieldDeclaringClassDescriptor(field_id);
+  key += "->";
+  key += dex_file.GetFieldName(field_id);
+  key += ':';
+  key += dex_file.GetFieldTypeDescriptor(field_id);
+  MutexLock mu(Thread::Current(), deps->lock_);
+  if (field == nullptr) {
+    deps->RecordMember(&deps->fields_, key, nullptr, 0u);
+  } else {
+    deps->RecordMember(&deps->fields_, key, field->GetDeclaringClass(), field->GetAccessFlags());
+  }
+}
+
+void VerifierDeps::MaybeRecordMethodResolution(const DexFile& dex_file,
+                                                uint32_t method_idx,
+                                                MethodResolutionKind kind,
+                                                ArtMethod* method) {
+  VerifierDeps* deps = GetRecordingVerifierDeps();
+  if (deps == nullptr) {
+    return;
+  }
+  const DexFile::MethodId& method_id = dex_file.GetMethodId(method_idx);
+  std::string key;
+  switch (kind) {
+    case kDirectMethodResolution: key += kDirectMethodKey; break;
+    case kVirtualMethodResolution: key += kVirtualMethodKey; break;
+    case kInterfaceMethodResolution: key += kInterfaceMethodKey; break;
+  }
+  key += dex_file.GetMethodDeclaringClassDescriptor(method_id);
+  key += "->";
+  key += dex_file.GetMethodName(method_id);
+  key += dex_file.GetMethodSignature(method_id).ToString();
+  MutexLock mu(Thread::Current(), deps->lock_);
+  if (method == nullptr) {
+    deps->RecordMember(&deps->methods_, key, nullptr, 0u);
+  } else {
+    deps->RecordMember(&deps->methods_, key, method->GetDeclaringClass(),
+                       method->GetAccessFlags());
+  }
+}
+
+VerifierDeps::ClassResolution VerifierDeps::DescribeClass(mirror::Class* klass) const {
+  ClassResolution result;
+  result.resolved = true;
+  DCHECK(!klass->IsPrimitive());
+  result.internal = !klass->IsArrayClass() && !klass->IsProxyClass() &&
+      dex_files_.find(&klass->GetDexFile()) != dex_files_.end();
+  result.access_flags = klass->GetAccessFlags() & kAccJavaFlagsMask;
+  std::string temp;
+  if (klass->GetSuperClass() != nullptr) {
+    result.super_descriptor = klass->GetSuperClass()->GetDescriptor(&temp);
+  }
+  int32_t iftable_count = klass->GetIfTableCount();
+  mirror::IfTable* iftable = klass->GetIfTable();
+  for (int32_t i = 0; i < iftable_count; ++i) {
+    result.interface_descriptors.push_back(iftable->GetInterface(i)->GetDescriptor(&temp));
+  }
+  if (klass->IsArrayClass()) {
+    result.component_descriptor = klass->GetComponentType()->GetDescriptor(&temp);
+  }
+  return result;
+}
+
+VerifierDeps::MemberResolution VerifierDeps::DescribeMember(mirror::Class* declaring_class,
+                                                            uint32_t access_flags) const {
+  MemberResolution result;
+  result.resolved = true;
+  std::string temp;
+  result.declaring_class_descriptor = declaring_class->GetDescriptor(&temp);
+  result.access_flags = access_flags & kAccJavaFlagsMask;
+  return result;
+}
+
+void VerifierDeps::RecordClass(const std::string& descriptor, mirror::Class* klass) {
+  if (classes_.find(descriptor) != classes_.end()) {
+    // Lookups give the same result every time, keep the first one.
+    return;
+  }
+  if (klass == nullptr) {
+    classes_.Put(descriptor, ClassResolution { false, false, 0u, "", { }, "" });
+    return;
+  }
+  ClassResolution resolution = DescribeClass(klass);
+  classes_.Put(descriptor, resolution);
+  // The verifier checks assignability against the whole type hierarchy.
+  if (klass->GetSuperClass() != nullptr) {
+    RecordClass(resolution.super_descriptor, klass->GetSuperClass());
+  }
+  mirror::IfTable* iftable = klass->GetIfTable();
+  for (size_t i = 0; i != resolution.interface_descriptors.size(); ++i) {
+    RecordClass(resolution.interface_descriptors[i], iftable->GetInterface(i));
+  }
+  if (klass->IsArrayClass() && !klass->GetComponentType()->IsPrimitive()) {
+    RecordClass(resolution.component_descriptor, klass->GetComponentType());
+  }
+}
+
+void VerifierDeps::RecordMember(SafeMap<std::string, MemberResolution>* members,
+                                const std::string& key,
+                                mirror::Class* declaring_class,
+                                uint32_t access_flags) {
+  if (members->find(key) != members->end()) {
+    return;
+  }
+  if (declaring_class == nullptr) {
+    members->Put(key, MemberResolution { false, "", 0u });
+    return;
+  }
+  MemberResolution resolution = DescribeMember(declaring_class, access_flags);
+  members->Put(key, resolution);
+  RecordClass(resolution.declaring_class_descriptor, declaring_class);
+}
+
+void VerifierDeps::MergeFrom(const VerifierDeps& other) {
+  DCHECK_NE(this, &other);
+  Thread* self = Thread::Current();
+  // Do not hold both locks at once, they are at the same level.
+  SafeMap<std::string, ClassResolution> classes;
+  SafeMap<std::string, MemberResolution> fields;
+  SafeMap<std::string, MemberResolution> methods;
+  {
+    MutexLock mu(self, other.lock_);
+    classes = other.classes_;
+    fields = other.fields_;
+    methods = other.methods_;
+  }
+  MutexLock mu(self, lock_);
+  classes_.insert(classes.begin(), classes.end());
+  fields_.insert(fields.begin(), fields.end());
+  methods_.insert(methods.begin(), methods.end());
+}
+
+void VerifierDeps::Encode(std::vector<uint8_t>* buffer) const {
+  MutexLock mu(Thread::Current(), lock_);
+  EncodeUnsignedLeb128(buffer, classes_.size());
+  for (const auto& entry : classes_) {
+    const ClassResolution& resolution = entry.second;
+    EncodeString(buffer, entry.first);
+    EncodeUnsignedLeb128(buffer, (resolution.resolved ? kResolvedFlag : 0u) |
+                                 (resolution.internal ? kInternalFlag : 0u));
+    if (resolution.resolved) {
+      EncodeUnsignedLeb128(buffer, resolution.access_flags);
+      EncodeString(buffer, resolution.super_descriptor);
+      EncodeString(buffer, resolution.component_descriptor);
+      EncodeUnsignedLeb128(buffer, resolution.interface_descriptors.size());
+      for (const std::string& interface_descriptor : resolution.interface_descriptors) {
+        EncodeString(buffer, interface_descriptor);
+      }
+    }
+  }
+  for (const SafeMap<std::string, MemberResolution>* members : { &fields_, &methods_ }) {
+    EncodeUnsignedLeb128(buffer, members->size());
+    for (const auto& entry : *members) {
+      EncodeString(buffer, entry.first);
+      EncodeUnsignedLeb128(buffer, entry.second.resolved ? kResolvedFlag : 0u);
+      if (entry.second.resolved) {
+        EncodeString(buffer, entry.second.declaring_class_descriptor);
+        EncodeUnsignedLeb128(buffer, entry.second.access_flags);
+      }
+    }
+  }
+}
+
+VerifierDeps* VerifierDeps::Decode(const std::vector<const DexFile*>& dex_files,
+                                   const uint8_t* data,
+                                   size_t size) {
+  std::unique_ptr<VerifierDeps> deps(new VerifierDeps(dex_files));
+  VerifierDepsReader reader(data, size);
+  MutexLock mu(Thread::Current(), deps->lock_);
+
+  uint32_t num_classes;
+  if (!reader.ReadUnsigned(&num_classes)) {
+    return nullptr;
+  }
+  for (uint32_t i = 0; i != num_classes; ++i) {
+    std::string descriptor;
+    uint32_t flags;
+    if (!reader.ReadString(&descriptor) || !reader.ReadUnsigned(&flags)) {
+      return nullptr;
+    }
+    ClassResolution resolution { (flags & kResolvedFlag) != 0u, (flags & kInternalFlag) != 0u,
+                                 0u, "", { }, "" };
+    if (resolution.resolved) {
+      uint32_t num_interfaces;
+      if (!reader.ReadUnsigned(&resolution.access_flags) ||
+          !reader.ReadString(&resolution.super_descriptor) ||
+          !reader.ReadString(&resolution.component_descriptor) ||
+          !reader.ReadUnsigned(&num_interfaces)) {
+        return nullptr;
+      }
+      for (uint32_t j = 0; j != num_interfaces; ++j) {
+        std::string interface_descriptor;
+        if (!reader.ReadString(&interface_descriptor)) {
+          return nullptr;
+        }
+        resolution.interface_descriptors.push_back(interface_descriptor);
+      }
+    }
+    deps->classes_.Put(descriptor, resolution);
+  }
+  for (SafeMap<std::string, MemberResolution>* members : { &deps->fields_, &deps->methods_ }) {
+    uint32_t num_members;
+    if (!reader.ReadUnsigned(&num_members)) {
+      return nullptr;
+    }
+    for (uint32_t i = 0; i != num_members; ++i) {
+      std::string key;
+      uint32_t flags;
+      if (!reader.ReadString(&key) || !reader.ReadUnsigned(&flags)) {
+        return nullptr;
+      }
+      MemberResolution resolution { (flags & kResolvedFlag) != 0u, "", 0u };
+      if (resolution.resolved &&
+          (!reader.ReadString(&resolution.declaring_class_descriptor) ||
+           !reader.ReadUnsigned(&resolution.access_flags))) {
+        return nullptr;
+      }
+      members->Put(key, resolution);
+    }
+  }
+  if (!reader.AtEnd()) {
+    return nullptr;
+  }
+  return deps.release();
+}
+
+bool VerifierDeps::Validate(Handle<mirror::ClassLoader> class_loader,
+                            std::string* error_msg) const {
+  Thread* self = Thread::Current();
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  size_t pointer_size = class_linker->GetImagePointerSize();
+
+  // Class loading may suspend, so do not hold the lock while looking up.
+  SafeMap<std::string, ClassResolution> classes;
+  SafeMap<std::string, MemberResolution> fields;
+  SafeMap<std::string, MemberResolution> methods;
+  {
+    MutexLock mu(self, lock_);
+    classes = classes_;
+    fields = fields_;
+    methods = methods_;
+  }
+
+  for (const auto& entry : classes) {
+    const std::string& descriptor = entry.first;
+    mirror::Class* klass = class_linker->FindClass(self, descriptor.c_str(), class_loader);
+    if (klass == nullptr) {
+      DCHECK(self->IsExceptionPending());
+      self->ClearException();
+    }
+    if (!(entry.second == (klass != nullptr ? DescribeClass(klass)
+                                            : ClassResolution { false, false, 0u, "", { }, "" }))) {
+      *error_msg = StringPrintf("Resolution of class %s has changed", descriptor.c_str());
+      return false;
+    }
+  }
+
+  for (const auto& entry : fields) {
+    const std::string& key = entry.first;
+    size_t arrow = key.find("->");
+    size_t colon = key.find(':', arrow);
+    if (arrow == std::string::npos || colon == std::string::npos) {
+      *error_msg = StringPrintf("Malformed field dependency %s", key.c_str());
+      return false;
+    }
+    std::string descriptor = key.substr(0u, arrow);
+    std::string name = key.substr(arrow + 2u, colon - arrow - 2u);
+    std::string type = key.substr(colon + 1u);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::Class> klass(
+        hs.NewHandle(class_linker->FindClass(self, descriptor.c_str(), class_loader)));
+    ArtField* field = nullptr;
+    if (klass.Get() == nullptr) {
+      self->ClearException();
+    } else {
+      field = mirror::Class::FindField(self, klass, name, type);
+    }
+    if (!(entry.second == (field != nullptr
+                               ? DescribeMember(field->GetDeclaringClass(),
+                                                field->GetAccessFlags())
+                               : MemberResolution { false, "", 0u }))) {
+      *error_msg = StringPrintf("Resolution of field %s has changed", key.c_str());
+      return false;
+    }
+  }
+
+  for (const auto& entry : methods) {
+    const std::string& key = entry.first;
+    size_t arrow = key.find("->");
+    size_t paren = key.find('(', arrow);
+    if (arrow == std::string::npos || paren == std::string::npos) {
+      *error_msg = StringPrintf("Malformed method dependency %s", key.c_str());
+      return false;
+    }
+    char kind = key[0];
+    std::string descriptor = key.substr(1u, arrow - 1u);
+    std::string name = key.substr(arrow + 2u, paren - arrow - 2u);
+    std::string signature = key.substr(paren);
+    mirror::Class* klass = class_linker->FindClass(self, descriptor.c_str(), class_loader);
+    ArtMethod* method = nullptr;
+    if (klass == nullptr) {
+      self->ClearException();
+    } else {
+      // Same lookups as MethodVerifier::ResolveMethodAndCheckAccess().
+      if (kind == kDirectMethodKey) {
+        method = klass->FindDirectMethod(name, signature, pointer_size);
+      } else if (kind == kInterfaceMethodKey) {
+        method = klass->FindInterfaceMethod(name, signature, pointer_size);
+      } else {
+        DCHECK_EQ(kind, kVirtualMethodKey);
+        method = klass->FindVirtualMethod(name, signature, pointer_size);
+      }
+      if (method == nullptr && kind != kDirectMethodKey) {
+        method = klass->FindDirectMethod(name, signature, pointer_size);
+      }
+    }
+    if (!(entry.second == (method != nullptr
+                               ? DescribeMember(method->GetDeclaringClass(),
+                                                method->GetAccessFlags())
+                               : MemberResolution { false, "", 0u }))) {
+      *error_msg = StringPrintf("Resolution of method %s has changed", key.c_str());
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace verifier
+}  // namespace art
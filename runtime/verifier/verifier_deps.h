@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_VERIFIER_VERIFIER_DEPS_H_
+#define ART_RUNTIME_VERIFIER_VERIFIER_DEPS_H_
+
+#include <stdint.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "handle.h"
+#include "safe_map.h"
+
+namespace art {
+
+class ArtField;
+class ArtMethod;
+class DexFile;
+
+namespace mirror {
+  class Class;
+  class ClassLoader;
+}  // namespace mirror
+
+namespace verifier {
+
+// The results of the class, field and method lookups the verifier made while
+// verifying the classes of a set of dex files, recorded by the compiler so that a
+// later compilation of the same dex files can tell cheaply whether verifying them
+// again would reach the same verdicts.
+//
+// For each class descriptor the verifier looked up we record whether it resolved
+// and, if so, whether it is defined in one of the dex files, its access flags, its
+// superclass and all the interfaces it implements. Those classes are recorded in
+// turn, so the recorded classes describe every subtyping relation the verifier
+// could have observed. For each field and method reference we record whether it
+// resolved and to a member of which class with which access flags.
+//
+// Verification of unchanged dex files only depends on these lookups, so if all of
+// them still give the recorded results the verifier would decide as before.
+class VerifierDeps {
+ public:
+  // How the verifier looks up a method, see MethodVerifier::ResolveMethodAndCheckAccess().
+  enum MethodResolutionKind {
+    kDirectMethodResolution,
+    kVirtualMethodResolution,
+    kInterfaceMethodResolution,
+  };
+
+  explicit VerifierDeps(const std::vector<const DexFile*>& dex_files);
+  ~VerifierDeps();
+
+  // Decodes dependencies written by Encode(). Returns null if the data is malformed.
+  static VerifierDeps* Decode(const std::vector<const DexFile*>& dex_files,
+                              const uint8_t* data,
+                              size_t size);
+
+  // Record the result of a lookup if the compiler is recording verifier dependencies.
+  // A null class or member denotes a failed lookup.
+  static void MaybeRecordClassResolution(const char* descriptor, mirror::Class* klass)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void MaybeRecordFieldResolution(const DexFile& dex_file,
+                                         uint32_t field_idx,
+                                         ArtField* field)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  static void MaybeRecordMethodResolution(const DexFile& dex_file,
+                                          uint32_t method_idx,
+                                          MethodResolutionKind kind,
+                                          ArtMethod* method)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  // Adds the dependencies of `other` that are not recorded yet.
+  void MergeFrom(const VerifierDeps& other) LOCKS_EXCLUDED(lock_);
+
+  void Encode(std::vector<uint8_t>* buffer) const LOCKS_EXCLUDED(lock_);
+
+  // Returns true if all recorded lookups give the same results with `class_loader`.
+  // Otherwise returns false and describes the first mismatch in `error_msg`.
+  bool Validate(Handle<mirror::ClassLoader> class_loader, std::string* error_msg) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) LOCKS_EXCLUDED(lock_);
+
+ private:
+  struct ClassResolution {
+    bool resolved;
+    bool internal;  // Defined in one of the dex files.
+    uint32_t access_flags;
+    std::string super_descriptor;  // Empty if none.
+    std::vector<std::string> interface_descriptors;  // All, in iftable order.
+    std::string component_descriptor;  // Empty if not an array.
+
+    bool operator==(const ClassResolution& other) const;
+  };
+
+  struct MemberResolution {
+    bool resolved;
+    std::string declaring_class_descriptor;
+    uint32_t access_flags;
+
+    bool operator==(const MemberResolution& other) const;
+  };
+
+  void RecordClass(const std::string& descriptor, mirror::Class* klass)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void RecordMember(SafeMap<std::string, MemberResolution>* members,
+                    const std::string& key,
+                    mirror::Class* declaring_class,
+                    uint32_t access_flags)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  ClassResolution DescribeClass(mirror::Class* klass) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+  MemberResolution DescribeMember(mirror::Class* declaring_class, uint32_t access_flags) const
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_);
+
+  const std::set<const DexFile*> dex_files_;
+
+  mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  SafeMap<std::string, ClassResolution> classes_ GUARDED_BY(lock_);
+  // Keyed by "<class descriptor>-><name>:<type descriptor>".
+  SafeMap<std::string, MemberResolution> fields_ GUARDED_BY(lock_);
+  // Keyed by "<kind><class descriptor>-><name><signature>".
+  SafeMap<std::string, MemberResolution> methods_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(VerifierDeps);
+};
+
+}  // namespace verifier
+}  // namespace art
+
+#endif  // ART_RUNTIME_VERIFIER_VERIFIER_DEPS_H_
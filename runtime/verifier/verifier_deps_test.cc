@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verifier_deps.h"
+
+#include <memory>
+#include <vector>
+
+#include "class_linker.h"
+#include "common_runtime_test.h"
+#include "compiler_callbacks.h"
+#include "dex_file.h"
+#include "handle_scope-inl.h"
+#include "method_verifier.h"
+#include "mirror/class_loader.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace verifier {
+
+// Records the lookups of the verifier like the compiler does.
+class VerifierDepsCompilerCallbacks FINAL : public CompilerCallbacks {
+ public:
+  VerifierDepsCompilerCallbacks()
+      : CompilerCallbacks(CompilerCallbacks::CallbackMode::kCompileApp), deps_(nullptr) {}
+
+  bool MethodVerified(MethodVerifier* verifier ATTRIBUTE_UNUSED) OVERRIDE {
+    return true;
+  }
+  void ClassRejected(ClassReference ref ATTRIBUTE_UNUSED) OVERRIDE {}
+  bool IsRelocationPossible() OVERRIDE { return false; }
+
+  VerifierDeps* GetVerifierDeps() const OVERRIDE {
+    return deps_;
+  }
+
+  void SetVerifierDeps(VerifierDeps* deps) {
+    deps_ = deps;
+  }
+
+ private:
+  VerifierDeps* deps_;
+};
+
+class VerifierDepsTest : public CommonRuntimeTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) OVERRIDE {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    callbacks_.reset(new VerifierDepsCompilerCallbacks());
+  }
+
+  Handle<mirror::ClassLoader> DecodeClassLoader(StackHandleScope<1>* hs, jobject class_loader)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    return hs->NewHandle(Thread::Current()->DecodeJObject(class_loader)->AsClassLoader());
+  }
+
+  // Verifies the classes of the dex files of `class_loader` and returns the
+  // lookups the verifier made.
+  VerifierDeps* VerifyDexFiles(jobject class_loader)
+      SHARED_LOCKS_REQUIRED(Locks::mutator_lock_) {
+    Thread* self = Thread::Current();
+    StackHandleScope<1> hs(self);
+    Handle<mirror::ClassLoader> loader(DecodeClassLoader(&hs, class_loader));
+    std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+    std::unique_ptr<VerifierDeps> deps(new VerifierDeps(dex_files));
+    VerifierDepsCompilerCallbacks* callbacks =
+        down_cast<VerifierDepsCompilerCallbacks*>(callbacks_.get());
+    callbacks->SetVerifierDeps(deps.get());
+    for (const DexFile* dex_file : dex_files) {
+      for (size_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+        const char* descriptor = dex_file->GetClassDescriptor(dex_file->GetClassDef(i));
+        mirror::Class* klass = class_linker_->FindClass(self, descriptor, loader);
+        CHECK(klass != nullptr) << descriptor;
+        std::string error_msg;
+        EXPECT_EQ(MethodVerifier::kNoFailure,
+                  MethodVerifier::VerifyClass(self, klass, true, &error_msg)) << error_msg;
+      }
+    }
+    callbacks->SetVerifierDeps(nullptr);
+    return deps.release();
+  }
+};
+
+TEST_F(VerifierDepsTest, EncodeDecode) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject class_loader = LoadDex("XandY");
+  std::unique_ptr<VerifierDeps> deps(VerifyDexFiles(class_loader));
+
+  std::vector<uint8_t> buffer;
+  deps->Encode(&buffer);
+  ASSERT_FALSE(buffer.empty());
+
+  std::vector<const DexFile*> dex_files = GetDexFiles(class_loader);
+  std::unique_ptr<VerifierDeps> decoded(
+      VerifierDeps::Decode(dex_files, buffer.data(), buffer.size()));
+  ASSERT_TRUE(decoded != nullptr);
+  std::vector<uint8_t> decoded_buffer;
+  decoded->Encode(&decoded_buffer);
+  EXPECT_EQ(buffer, decoded_buffer);
+
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(DecodeClassLoader(&hs, class_loader));
+  std::string error_msg;
+  EXPECT_TRUE(decoded->Validate(loader, &error_msg)) << error_msg;
+
+  // Truncated or trailing data is rejected.
+  EXPECT_TRUE(VerifierDeps::Decode(dex_files, buffer.data(), buffer.size() - 1u) == nullptr);
+  buffer.push_back(0u);
+  EXPECT_TRUE(VerifierDeps::Decode(dex_files, buffer.data(), buffer.size()) == nullptr);
+}
+
+TEST_F(VerifierDepsTest, ValidateAfterDependencyChange) {
+  ScopedObjectAccess soa(Thread::Current());
+  jobject class_loader = LoadDex("XandY");
+  std::unique_ptr<VerifierDeps> deps(VerifyDexFiles(class_loader));
+
+  // Verifying Y looked up its superclass X. Where X is not found, the verifier could
+  // decide differently, so the dependencies no longer hold.
+  jobject other_class_loader = LoadDex("Nested");
+  StackHandleScope<1> hs(soa.Self());
+  Handle<mirror::ClassLoader> loader(DecodeClassLoader(&hs, other_class_loader));
+  std::string error_msg;
+  EXPECT_FALSE(deps->Validate(loader, &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("LX;")) << error_msg;
+  EXPECT_FALSE(soa.Self()->IsExceptionPending());
+}
+
+}  // namespace verifier
+}  // namespace art
@@ -37,9 +37,19 @@ public class Main {
     return a instanceof FinalClass;
   }
 
+  public static boolean $opt$InstanceOfInterface() {
+    return a instanceof Itf;
+  }
+
+  public static boolean $opt$InstanceOfObjectArray() {
+    return a instanceof Object[];
+  }
+
   public static void main(String[] args) {
     $opt$TestMain();
     $opt$TestFinalClass();
+    $opt$TestInterface();
+    $opt$TestObjectArray();
   }
 
   public static void $opt$TestMain() {
@@ -64,7 +74,51 @@ public class Main {
     assertFalse($opt$InstanceOfFinalClass());
   }
 
+  public static void $opt$TestInterface() {
+    a = new ItfImpl();
+    assertTrue($opt$InstanceOfInterface());
+    a = new ItfImplChild();
+    assertTrue($opt$InstanceOfInterface());
+    a = new OtherItfImpl();
+    assertTrue($opt$InstanceOfInterface());
+    a = null;
+    assertFalse($opt$InstanceOfInterface());
+    // Neither class implements an interface, so they have no interface table.
+    a = new Main();
+    assertFalse($opt$InstanceOfInterface());
+    a = new Object();
+    assertFalse($opt$InstanceOfInterface());
+    a = new Object[1];
+    assertFalse($opt$InstanceOfInterface());
+  }
+
+  public static void $opt$TestObjectArray() {
+    a = new Object[1];
+    assertTrue($opt$InstanceOfObjectArray());
+    a = new Main[1];
+    assertTrue($opt$InstanceOfObjectArray());
+    a = new int[1][1];
+    assertTrue($opt$InstanceOfObjectArray());
+    a = null;
+    assertFalse($opt$InstanceOfObjectArray());
+    a = new int[1];
+    assertFalse($opt$InstanceOfObjectArray());
+    a = new Main();
+    assertFalse($opt$InstanceOfObjectArray());
+  }
+
   static class MainChild extends Main {}
 
+  interface Itf {}
+  interface OtherItf extends Itf {}
+
+  static class ItfImpl implements Runnable, Itf {
+    public void run() {}
+  }
+
+  static class ItfImplChild extends ItfImpl {}
+
+  static class OtherItfImpl implements OtherItf {}
+
   static final class FinalClass {}
 }
@@ -25,9 +25,19 @@ public class Main {
     return (FinalClass)a;
   }
 
+  public static Object $opt$CheckCastInterface() {
+    return (Itf)a;
+  }
+
+  public static Object $opt$CheckCastObjectArray() {
+    return (Object[])a;
+  }
+
   public static void main(String[] args) {
     $opt$TestMain();
     $opt$TestFinalClass();
+    $opt$TestInterface();
+    $opt$TestObjectArray();
   }
 
   public static void $opt$TestMain() {
@@ -67,7 +77,60 @@ public class Main {
     } catch (ClassCastException ex) {}
   }
 
+  public static void $opt$TestInterface() {
+    a = new ItfImpl();
+    $opt$CheckCastInterface();
+
+    a = new OtherItfImpl();
+    $opt$CheckCastInterface();
+
+    a = null;
+    $opt$CheckCastInterface();
+
+    // Neither class implements an interface, so they have no interface table.
+    a = new Main();
+    try {
+      $opt$CheckCastInterface();
+      throw new Error("Should have gotten a ClassCastException");
+    } catch (ClassCastException ex) {}
+
+    a = new Object();
+    try {
+      $opt$CheckCastInterface();
+      throw new Error("Should have gotten a ClassCastException");
+    } catch (ClassCastException ex) {}
+  }
+
+  public static void $opt$TestObjectArray() {
+    a = new Main[1];
+    $opt$CheckCastObjectArray();
+
+    a = null;
+    $opt$CheckCastObjectArray();
+
+    a = new int[1];
+    try {
+      $opt$CheckCastObjectArray();
+      throw new Error("Should have gotten a ClassCastException");
+    } catch (ClassCastException ex) {}
+
+    a = new Main();
+    try {
+      $opt$CheckCastObjectArray();
+      throw new Error("Should have gotten a ClassCastException");
+    } catch (ClassCastException ex) {}
+  }
+
   static class MainChild extends Main {}
 
+  interface Itf {}
+  interface OtherItf extends Itf {}
+
+  static class ItfImpl implements Runnable, Itf {
+    public void run() {}
+  }
+
+  static class OtherItfImpl implements OtherItf {}
+
   static final class FinalClass {}
 }
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  static class Small {
+    int i;
+    long l;
+    Object o;
+  }
+
+  static class Finalizable {
+    int i;
+    protected void finalize() {
+    }
+  }
+
+  static class Uninitialized {
+    static int count = Main.initCount++;
+    long l;
+  }
+
+  static int initCount = 0;
+
+  public static void assertEquals(long expected, long actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected + ", got " + actual);
+    }
+  }
+
+  public static void assertTrue(boolean condition) {
+    if (!condition) {
+      throw new Error("Assertion failed");
+    }
+  }
+
+  public static Small newSmall(int i) {
+    Small s = new Small();
+    assertEquals(0, s.i);
+    assertEquals(0, s.l);
+    assertTrue(s.o == null);
+    assertTrue(s.getClass() == Small.class);
+    s.i = i;
+    s.l = ~i;
+    return s;
+  }
+
+  public static int[] newIntArray(int length) {
+    int[] array = new int[length];
+    assertEquals(length, array.length);
+    for (int i = 0; i < length; ++i) {
+      assertEquals(0, array[i]);
+    }
+    java.util.Arrays.fill(array, -1);
+    return array;
+  }
+
+  public static Object[] newObjectArray(int length) {
+    Object[] array = new Object[length];
+    assertEquals(length, array.length);
+    for (int i = 0; i < length; ++i) {
+      assertTrue(array[i] == null);
+    }
+    assertTrue(array.getClass() == Object[].class);
+    return array;
+  }
+
+  public static byte[] newByteArray(int length) {
+    byte[] array = new byte[length];
+    assertEquals(length, array.length);
+    for (int i = 0; i < length; ++i) {
+      assertEquals(0, array[i]);
+    }
+    java.util.Arrays.fill(array, (byte) -1);
+    return array;
+  }
+
+  public static void main(String[] args) {
+    // Enough allocations to refill the thread-local buffer many times, each filled with
+    // non-zero values so that a stale buffer would be noticed.
+    Object[] kept = new Object[64];
+    for (int i = 0; i < 100000; ++i) {
+      Small s = newSmall(i);
+      kept[i % kept.length] = s;
+      // Lengths below and above the inline allocation limit.
+      kept[(i + 1) % kept.length] = newIntArray(i % 700);
+      kept[(i + 2) % kept.length] = newByteArray(i % 3000);
+      kept[(i + 3) % kept.length] = newObjectArray(i % 600);
+    }
+    for (int i = 0; i < kept.length; ++i) {
+      assertTrue(kept[i] != null);
+    }
+    assertEquals(0, newIntArray(0).length);
+    try {
+      newIntArray(-1);
+      throw new Error("Expected NegativeArraySizeException");
+    } catch (NegativeArraySizeException e) {
+      // Expected.
+    }
+
+    // Finalizable and uninitialized classes take the runtime slow path.
+    for (int i = 0; i < 1000; ++i) {
+      Finalizable f = new Finalizable();
+      assertEquals(0, f.i);
+    }
+    assertEquals(0, initCount);
+    Uninitialized u = new Uninitialized();
+    assertEquals(1, initCount);
+    assertEquals(0, u.l);
+    assertEquals(0, Uninitialized.count);
+    System.out.println("passed");
+  }
+}
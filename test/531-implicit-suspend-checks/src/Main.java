@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  static volatile boolean done = false;
+  static volatile boolean started = false;
+
+  static class Spinner extends Thread {
+    long iterations;
+    long sum;
+    long sumOfSquares;
+    int xor;
+
+    public void run() {
+      // No calls in the loop, so its only suspend check is the one at the back edge. Keep
+      // several values live across it.
+      long i = 0;
+      long s = 0;
+      long s2 = 0;
+      int x = 0;
+      started = true;
+      while (!done) {
+        ++i;
+        s += i;
+        s2 += i * i;
+        x ^= (int) i;
+      }
+      iterations = i;
+      sum = s;
+      sumOfSquares = s2;
+      xor = x;
+    }
+  }
+
+  public static void main(String[] args) throws Exception {
+    Spinner spinner = new Spinner();
+    spinner.start();
+    while (!started) {
+      Thread.yield();
+    }
+    // Each collection suspends all threads, which makes the spinning thread fault on its
+    // suspend trigger.
+    for (int i = 0; i < 50; ++i) {
+      Runtime.getRuntime().gc();
+      spinner.getStackTrace();
+    }
+    done = true;
+    spinner.join();
+
+    // The sums may overflow, so recompute them the way the loop did.
+    long n = spinner.iterations;
+    long s = 0;
+    long s2 = 0;
+    int x = 0;
+    for (long i = 1; i <= n; ++i) {
+      s += i;
+      s2 += i * i;
+      x ^= (int) i;
+    }
+    if (spinner.sum != s || spinner.sumOfSquares != s2 || spinner.xor != x) {
+      System.out.println("Corrupted loop state after " + n + " iterations");
+    }
+    System.out.println("passed");
+  }
+}
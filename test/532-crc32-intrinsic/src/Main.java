@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2015 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.zip.CRC32;
+
+public class Main {
+  static final int[] TABLE = new int[256];
+
+  static {
+    for (int i = 0; i < 256; ++i) {
+      int c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = ((c & 1) != 0) ? (0xedb88320 ^ (c >>> 1)) : (c >>> 1);
+      }
+      TABLE[i] = c;
+    }
+  }
+
+  // The zlib CRC-32 of the given bytes, continuing from crc.
+  static long referenceCrc(long crc, byte[] bytes, int offset, int length) {
+    int c = ~(int) crc;
+    for (int i = offset; i < offset + length; ++i) {
+      c = TABLE[(c ^ bytes[i]) & 0xff] ^ (c >>> 8);
+    }
+    return (~c) & 0xffffffffL;
+  }
+
+  static void assertEquals(String what, long expected, long actual) {
+    if (expected != actual) {
+      throw new Error(what + ": expected " + Long.toHexString(expected) + ", got " +
+          Long.toHexString(actual));
+    }
+  }
+
+  static void testUpdateByte() {
+    CRC32 crc32 = new CRC32();
+    byte[] one = new byte[1];
+    long expected = 0;
+    for (int b = -300; b < 300; ++b) {
+      // update(int) only uses the low eight bits.
+      crc32.update(b);
+      one[0] = (byte) b;
+      expected = referenceCrc(expected, one, 0, 1);
+      assertEquals("update(" + b + ")", expected, crc32.getValue());
+    }
+  }
+
+  static void testUpdateBytes(byte[] data) {
+    // Every offset within a word and every length up to a few words, including zero.
+    for (int offset = 0; offset < 16; ++offset) {
+      for (int length = 0; length <= 80 && offset + length <= data.length; ++length) {
+        CRC32 crc32 = new CRC32();
+        crc32.update(data, offset, length);
+        assertEquals("update(data, " + offset + ", " + length + ")",
+                     referenceCrc(0, data, offset, length), crc32.getValue());
+      }
+    }
+    // Zero-length updates leave the value unchanged.
+    CRC32 crc32 = new CRC32();
+    crc32.update(data, 3, 17);
+    long value = crc32.getValue();
+    crc32.update(data, 0, 0);
+    crc32.update(data, data.length, 0);
+    crc32.update(new byte[0]);
+    assertEquals("zero-length update", value, crc32.getValue());
+    // Chained updates continue from the previous value.
+    crc32.reset();
+    crc32.update(data, 1, 7);
+    crc32.update(data, 8, 9);
+    crc32.update(data[17]);
+    crc32.update(data, 18, data.length - 18);
+    assertEquals("chained updates", referenceCrc(0, data, 1, data.length - 1),
+                 crc32.getValue());
+    // The whole array.
+    crc32.reset();
+    crc32.update(data);
+    assertEquals("update(data)", referenceCrc(0, data, 0, data.length), crc32.getValue());
+  }
+
+  public static void main(String[] args) {
+    testUpdateByte();
+    byte[] small = new byte[256];
+    for (int i = 0; i < small.length; ++i) {
+      small[i] = (byte) (i * 31 + 7);
+    }
+    testUpdateBytes(small);
+    // Larger than the inline threshold of the intrinsic, with an odd length.
+    byte[] large = new byte[200 * 1024 + 13];
+    for (int i = 0; i < large.length; ++i) {
+      large[i] = (byte) (i ^ (i >>> 8) ^ (i >>> 16));
+    }
+    testUpdateBytes(large);
+    CRC32 crc32 = new CRC32();
+    crc32.update(large, 5, large.length - 5);
+    assertEquals("large unaligned update", referenceCrc(0, large, 5, large.length - 5),
+                 crc32.getValue());
+    // Known value of "123456789".
+    crc32.reset();
+    crc32.update("123456789".getBytes());
+    assertEquals("check value", 0xcbf43926L, crc32.getValue());
+    System.out.println("passed");
+  }
+}